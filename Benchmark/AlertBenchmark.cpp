@@ -0,0 +1,53 @@
+﻿#include <benchmark/benchmark.h>
+#include <Sensor/AlertEngine.h>
+#include <Sensor/SensorSnapshot.h>
+#include <QRandomGenerator>
+#include <QStringList>
+
+/// <summary>
+/// 告警规则表单次遍历的开销 每条规则绑定一个传感器
+/// <para>参数: 规则数量</para>
+/// </summary>
+static void BM_AlertEvaluate(benchmark::State& state)
+{
+	const auto rules = static_cast<qint32>(state.range(0));
+	const auto sensors = 256;
+
+	SensorSnapshot snapshot;
+	for (auto i = 0; i < sensors; ++i)
+		snapshot.AddSensor(QString("sensor.%1").arg(i));
+
+	QStringList lines;
+	for (auto i = 0; i < rules; ++i)
+		lines.append(QString("sensor.%1 > %2 for 2s").arg(i % sensors).arg(5000 + i % 7));
+
+	AlertEngine engine;
+	engine.setNotifyInterval(0);
+	engine.setRules(lines.join('\n'));
+
+	// 读数在阈值附近随机游走 使状态机的各个分支都被执行
+	QRandomGenerator generator(0x5EED);
+	QVector<float> values(sensors, 5000.0f);
+	qint64 timestamp = 0;
+	qint64 raised = 0;
+	QObject::connect(&engine, &AlertEngine::alertRaised, [&raised]() { raised++; });
+
+	for (auto _ : state)
+	{
+		state.PauseTiming();
+		timestamp += 1000;
+		for (auto i = 0; i < sensors; ++i)
+		{
+			values[i] += static_cast<float>(generator.bounded(20.0) - 10.0);
+			snapshot.SetValue(i, values.at(i));
+		}
+		snapshot.SetTimestamp(timestamp);
+		state.ResumeTiming();
+
+		engine.OnSnapshot(snapshot);
+	}
+
+	state.SetItemsProcessed(state.iterations() * rules);
+	state.counters["raised"] = benchmark::Counter(static_cast<double>(raised));
+}
+BENCHMARK(BM_AlertEvaluate)->ArgName("rules")->RangeMultiplier(4)->Range(16, 1024);
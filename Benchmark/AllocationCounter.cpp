@@ -0,0 +1,112 @@
+﻿#include "AllocationCounter.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#if defined(_MSC_VER) && defined(_DEBUG)
+#include <crtdbg.h>
+#endif
+
+namespace
+{
+	std::atomic<quint64> g_allocations{ 0 };
+
+	inline void CountAllocation()
+	{
+		g_allocations.fetch_add(1, std::memory_order_relaxed);
+	}
+
+#if defined(_MSC_VER) && defined(_DEBUG)
+	int CrtAllocHook(int type, void*, size_t, int, long, const unsigned char*, int)
+	{
+		if (type == _HOOK_ALLOC || type == _HOOK_REALLOC)
+			CountAllocation();
+
+		return TRUE;
+	}
+
+	const auto g_hookInstalled = (_CrtSetAllocHook(CrtAllocHook), true);
+#endif
+}
+
+quint64 AllocationCounter::Count()
+{
+	return g_allocations.load(std::memory_order_relaxed);
+}
+
+#if defined(__GLIBC__)
+// 替换 malloc 系列函数 统计包括 Qt 容器在内的所有分配
+extern "C"
+{
+	void* __libc_malloc(size_t size);
+	void* __libc_calloc(size_t count, size_t size);
+	void* __libc_realloc(void* pointer, size_t size);
+	void __libc_free(void* pointer);
+
+	void* malloc(size_t size)
+	{
+		CountAllocation();
+		return __libc_malloc(size);
+	}
+
+	void* calloc(size_t count, size_t size)
+	{
+		CountAllocation();
+		return __libc_calloc(count, size);
+	}
+
+	void* realloc(void* pointer, size_t size)
+	{
+		CountAllocation();
+		return __libc_realloc(pointer, size);
+	}
+
+	void free(void* pointer)
+	{
+		__libc_free(pointer);
+	}
+}
+
+void* operator new(std::size_t size)
+{
+	// malloc 已计数
+	if (auto pointer = std::malloc(size ? size : 1))
+		return pointer;
+
+	throw std::bad_alloc();
+}
+#else
+void* operator new(std::size_t size)
+{
+	CountAllocation();
+	if (auto pointer = std::malloc(size ? size : 1))
+		return pointer;
+
+	throw std::bad_alloc();
+}
+#endif
+
+void* operator new[](std::size_t size)
+{
+	return operator new(size);
+}
+
+void operator delete(void* pointer) noexcept
+{
+	std::free(pointer);
+}
+
+void operator delete[](void* pointer) noexcept
+{
+	std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept
+{
+	std::free(pointer);
+}
+
+void operator delete[](void* pointer, std::size_t) noexcept
+{
+	std::free(pointer);
+}
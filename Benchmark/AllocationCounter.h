@@ -0,0 +1,17 @@
+﻿#pragma once
+
+#include <QtGlobal>
+
+/// <summary>
+/// 进程内堆分配计数 (用于验证热路径不分配内存)
+/// <para>统计 operator new; glibc 下同时统计 malloc/calloc/realloc (Qt 容器使用 malloc)</para>
+/// <para>MSVC 仅在 Debug 配置下通过 CRT 分配钩子统计 malloc</para>
+/// </summary>
+namespace AllocationCounter
+{
+	/// <summary>
+	/// 获取程序启动以来的分配次数
+	/// </summary>
+	/// <returns>分配次数</returns>
+	quint64 Count();
+}
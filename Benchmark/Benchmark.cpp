@@ -0,0 +1,43 @@
+﻿#include <QCoreApplication>
+#include <benchmark/benchmark.h>
+#include <cstring>
+#include <vector>
+
+/**
+ * DigiHMS 基准测试入口
+ *
+ * 默认以 JSON 格式将结果写入 DigiHMS_benchmark.json,
+ * 可通过 --benchmark_out / --benchmark_out_format 覆盖。
+ */
+int main(int argc, char* argv[])
+{
+	QCoreApplication app(argc, argv);
+	QCoreApplication::setOrganizationName("DigiHMS");
+	QCoreApplication::setApplicationName("DigiHMS Benchmark");
+
+	// 未指定输出文件时 默认输出机器可读的 JSON 结果
+	std::vector<char*> args(argv, argv + argc);
+	bool hasOutput = false;
+	for (auto arg : args)
+	{
+		if (std::strncmp(arg, "--benchmark_out=", 16) == 0)
+			hasOutput = true;
+	}
+
+	static char outArg[] = "--benchmark_out=DigiHMS_benchmark.json";
+	static char formatArg[] = "--benchmark_out_format=json";
+	if (!hasOutput)
+	{
+		args.push_back(outArg);
+		args.push_back(formatArg);
+	}
+
+	auto count = static_cast<int>(args.size());
+	benchmark::Initialize(&count, args.data());
+	if (benchmark::ReportUnrecognizedArguments(count, args.data()))
+		return 1;
+
+	benchmark::RunSpecifiedBenchmarks();
+	benchmark::Shutdown();
+	return 0;
+}
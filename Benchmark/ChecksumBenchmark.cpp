@@ -0,0 +1,82 @@
+﻿#include <benchmark/benchmark.h>
+#include <Common/Checksum.h>
+#include <QByteArray>
+#include <QRandomGenerator>
+
+/// <summary>
+/// 生成指定长度的随机数据
+/// </summary>
+static QByteArray RandomData(qint32 length)
+{
+	QByteArray data(length, Qt::Uninitialized);
+	QRandomGenerator generator(0x5EED);
+	for (auto i = 0; i < length; ++i)
+		data[i] = static_cast<char>(generator.bounded(256));
+
+	return data;
+}
+
+static void BM_CRC8(benchmark::State& state)
+{
+	const auto data = RandomData(static_cast<qint32>(state.range(0)));
+	for (auto _ : state)
+		benchmark::DoNotOptimize(CRC8(data.constData(), data.length()));
+
+	state.SetBytesProcessed(state.iterations() * data.length());
+}
+BENCHMARK(BM_CRC8)->RangeMultiplier(4)->Range(16, 4096);
+
+static void BM_CRC16(benchmark::State& state)
+{
+	const auto data = RandomData(static_cast<qint32>(state.range(0)));
+	for (auto _ : state)
+		benchmark::DoNotOptimize(CRC16(data.constData(), data.length()));
+
+	state.SetBytesProcessed(state.iterations() * data.length());
+}
+BENCHMARK(BM_CRC16)->RangeMultiplier(4)->Range(16, 4096);
+
+static void BM_CRC32(benchmark::State& state)
+{
+	const auto data = RandomData(static_cast<qint32>(state.range(0)));
+	for (auto _ : state)
+		benchmark::DoNotOptimize(CRC32(data.constData(), data.length()));
+
+	state.SetBytesProcessed(state.iterations() * data.length());
+}
+BENCHMARK(BM_CRC32)->RangeMultiplier(4)->Range(16, 4096);
+
+/// <summary>
+/// 帧内容分为三段时的 CRC16: 先拼接再计算 与 按段增量计算 (不拷贝负载)
+/// <para>参数: 负载长度, 是否增量计算</para>
+/// </summary>
+static void BM_CRC16Segmented(benchmark::State& state)
+{
+	const auto payload = RandomData(static_cast<qint32>(state.range(0)));
+	const auto incremental = state.range(1) != 0;
+	const QByteArray head("!42:method:");
+	const QByteArray tail(":end");
+
+	QByteArray frame;
+	for (auto _ : state)
+	{
+		if (incremental)
+		{
+			auto crc = CRC16_INIT;
+			crc = CRC16Update(crc, head.constData(), head.length());
+			crc = CRC16Update(crc, payload.constData(), payload.length());
+			crc = CRC16Update(crc, tail.constData(), tail.length());
+			benchmark::DoNotOptimize(crc);
+		}
+		else
+		{
+			frame = head + payload + tail;
+			benchmark::DoNotOptimize(CRC16(frame.constData(), frame.length()));
+		}
+	}
+
+	state.SetBytesProcessed(state.iterations() * (head.length() + payload.length() + tail.length()));
+}
+BENCHMARK(BM_CRC16Segmented)
+	->ArgNames({ "size", "incremental" })
+	->ArgsProduct({ { 64, 1024, 4096 }, { 0, 1 } });
@@ -0,0 +1,166 @@
+﻿#include <benchmark/benchmark.h>
+#include <Common/FrameFormatter.h>
+#include <IO/Compression/Codec.h>
+#include <QFile>
+#include <QRandomGenerator>
+#include <QVector>
+
+/// <summary>
+/// 获取压缩基准使用的帧序列
+/// <para>设置环境变量 DIGIHMS_COMPRESSION_TRACE 时从文件读取录制的帧 (每行一帧)</para>
+/// <para>否则生成模拟轨迹: 各传感器以随机游走变化, 每帧格式化为文本帧</para>
+/// </summary>
+/// <param name="sensors">传感器数量 (仅用于模拟轨迹)</param>
+/// <returns>帧序列</returns>
+static QVector<QByteArray> TraceFrames(qint32 sensors)
+{
+	QVector<QByteArray> frames;
+
+	const auto path = qEnvironmentVariable("DIGIHMS_COMPRESSION_TRACE");
+	if (!path.isEmpty())
+	{
+		QFile file(path);
+		if (file.open(QIODevice::ReadOnly))
+		{
+			while (!file.atEnd())
+			{
+				auto line = file.readLine();
+				line.chop(line.endsWith('\n') ? 1 : 0);
+				if (!line.isEmpty())
+					frames.append(line);
+			}
+		}
+
+		return frames;
+	}
+
+	// 模拟每核负载 / 温度 / 存储 / 网络等读数 相邻帧之间变化较小
+	QRandomGenerator generator(0x5EED);
+	QVector<float> values(sensors);
+	for (auto& value : values)
+		value = static_cast<float>(generator.bounded(100.0));
+
+	FrameFormatter formatter;
+	formatter.SetFields(sensors, 1);
+
+	for (auto frame = 0; frame < 600; ++frame)
+	{
+		for (auto& value : values)
+			value = qBound(0.0f, value + static_cast<float>(generator.bounded(4.0) - 2.0), 100.0f);
+
+		formatter.Format(values.constData(), values.count());
+		frames.append(QByteArray(formatter.Data(), formatter.Size()));
+	}
+
+	return frames;
+}
+
+/// <summary>
+/// 为当前构建中可用的压缩类型生成参数
+/// </summary>
+static void CodecArguments(benchmark::internal::Benchmark* benchmark)
+{
+	benchmark->ArgNames({ "codec", "sensors" });
+	for (auto type : Codec::Available())
+	{
+		if (type == Codec::Type::None)
+			continue;
+
+		for (auto sensors : { 16, 64, 256 })
+			benchmark->Args({ static_cast<qint64>(type), sensors });
+	}
+}
+
+/// <summary>
+/// 压缩 (含信封) 每次迭代处理轨迹中的一帧
+/// <para>参数: 压缩类型, 传感器数量</para>
+/// </summary>
+static void BM_Compress(benchmark::State& state)
+{
+	const auto type = static_cast<Codec::Type>(state.range(0));
+	const auto frames = TraceFrames(static_cast<qint32>(state.range(1)));
+	auto codec = Codec::Create(type);
+	if (!codec || frames.isEmpty())
+	{
+		state.SkipWithError("codec or trace unavailable");
+		return;
+	}
+
+	state.SetLabel(Codec::TypeName(type).toStdString());
+
+	QByteArray output;
+	qint64 rawBytes = 0;
+	qint64 packedBytes = 0;
+	qint32 index = 0;
+
+	for (auto _ : state)
+	{
+		const auto& frame = frames.at(index);
+		codec->Pack(frame.constData(), frame.length(), output);
+		benchmark::DoNotOptimize(output.constData());
+
+		rawBytes += frame.length();
+		packedBytes += output.length();
+		index = (index + 1) % frames.count();
+	}
+
+	state.SetBytesProcessed(rawBytes);
+	state.counters["ratio"] = packedBytes > 0 ? static_cast<double>(rawBytes) / packedBytes : 0;
+	state.counters["raw/frame"] = static_cast<double>(rawBytes) / state.iterations();
+	state.counters["packed/frame"] = static_cast<double>(packedBytes) / state.iterations();
+}
+BENCHMARK(BM_Compress)->Apply(CodecArguments);
+
+/// <summary>
+/// 解压 (含信封解析) 模拟接收端的开销
+/// <para>参数: 压缩类型, 传感器数量</para>
+/// </summary>
+static void BM_Decompress(benchmark::State& state)
+{
+	const auto type = static_cast<Codec::Type>(state.range(0));
+	const auto frames = TraceFrames(static_cast<qint32>(state.range(1)));
+	auto codec = Codec::Create(type);
+	if (!codec || frames.isEmpty())
+	{
+		state.SkipWithError("codec or trace unavailable");
+		return;
+	}
+
+	state.SetLabel(Codec::TypeName(type).toStdString());
+
+	// 只保留确实被压缩的帧
+	QVector<QByteArray> packed;
+	for (const auto& frame : frames)
+	{
+		QByteArray output;
+		if (codec->Pack(frame.constData(), frame.length(), output))
+			packed.append(output);
+	}
+
+	if (packed.isEmpty())
+	{
+		state.SkipWithError("trace does not compress");
+		return;
+	}
+
+	QByteArray output;
+	qint64 rawBytes = 0;
+	qint32 index = 0;
+
+	for (auto _ : state)
+	{
+		const auto& envelope = packed.at(index);
+		if (!Codec::Unpack(envelope.constData(), envelope.length(), output))
+		{
+			state.SkipWithError("decompression failed");
+			break;
+		}
+
+		benchmark::DoNotOptimize(output.constData());
+		rawBytes += output.length();
+		index = (index + 1) % packed.count();
+	}
+
+	state.SetBytesProcessed(rawBytes);
+}
+BENCHMARK(BM_Decompress)->Apply(CodecArguments);
@@ -0,0 +1,94 @@
+﻿#include <benchmark/benchmark.h>
+#include <IO/Manager/Manager.h>
+#include <Sensor/PayloadTemplate.h>
+#include <Sensor/SensorSnapshot.h>
+#include <QRandomGenerator>
+#include <QStringList>
+#include <QVector>
+
+/// <summary>
+/// 生成模拟的传感器快照
+/// </summary>
+/// <param name="count">传感器数量</param>
+/// <returns>传感器数值</returns>
+static QVector<float> SyntheticSnapshot(qint32 count)
+{
+	QRandomGenerator generator(0x5EED);
+	QVector<float> values(count);
+	for (auto& value : values)
+		value = static_cast<float>(generator.bounded(10000.0));
+
+	return values;
+}
+
+/// <summary>
+/// 当前帧格式的快照编码: 起始序列 + 以分隔序列连接的数值 + 结束序列
+/// </summary>
+static QByteArray EncodeSnapshot(const QVector<float>& values, const Manager& manager)
+{
+	QStringList fields;
+	for (auto value : values)
+		fields.append(QString::number(value, 'f', 1));
+
+	return (manager.StartSequence() + fields.join(manager.SeparatorSequence()) + manager.FinishSequence()).toUtf8();
+}
+
+/// <summary>
+/// 传感器快照编码
+/// <para>参数: 传感器数量</para>
+/// </summary>
+static void BM_EncodeSnapshot(benchmark::State& state)
+{
+	const auto values = SyntheticSnapshot(static_cast<qint32>(state.range(0)));
+	const auto isolated = Manager::CreateIsolated();
+	const auto& manager = *isolated;
+
+	qint64 bytes = 0;
+	for (auto _ : state)
+	{
+		auto frame = EncodeSnapshot(values, manager);
+		bytes += frame.length();
+		benchmark::DoNotOptimize(frame);
+	}
+
+	state.SetBytesProcessed(bytes);
+	state.SetItemsProcessed(state.iterations() * values.count());
+}
+BENCHMARK(BM_EncodeSnapshot)->ArgName("sensors")->RangeMultiplier(4)->Range(8, 512);
+
+/// <summary>
+/// 编译后的负载模板编码 输出与 BM_EncodeSnapshot 相同的帧格式
+/// <para>参数: 传感器数量</para>
+/// </summary>
+static void BM_EncodeTemplate(benchmark::State& state)
+{
+	const auto values = SyntheticSnapshot(static_cast<qint32>(state.range(0)));
+
+	SensorSnapshot snapshot;
+	QStringList fields;
+	for (auto i = 0; i < values.count(); ++i)
+	{
+		const auto name = QString("sensor.%1").arg(i);
+		snapshot.SetValue(snapshot.AddSensor(name), values.at(i));
+		fields.append(QString("{%1:.1f}").arg(name));
+	}
+
+	PayloadTemplate payload;
+	if (!payload.Compile("/*" + fields.join(",") + "*/"))
+	{
+		state.SkipWithError(payload.ErrorString().toUtf8().constData());
+		return;
+	}
+
+	qint64 bytes = 0;
+	for (auto _ : state)
+	{
+		const auto& frame = payload.Execute(snapshot);
+		bytes += frame.length();
+		benchmark::DoNotOptimize(frame.constData());
+	}
+
+	state.SetBytesProcessed(bytes);
+	state.SetItemsProcessed(state.iterations() * values.count());
+}
+BENCHMARK(BM_EncodeTemplate)->ArgName("sensors")->RangeMultiplier(4)->Range(8, 512);
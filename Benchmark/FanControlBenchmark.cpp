@@ -0,0 +1,57 @@
+﻿#include <benchmark/benchmark.h>
+#include <Sensor/FanControl.h>
+#include <Sensor/SensorSnapshot.h>
+#include <QStringList>
+#include <QtMath>
+
+/// <summary>
+/// 风扇控制器单次计算的开销 使用模拟后端
+/// <para>参数: 通道数量, 模式 (0 = 分段线性, 1 = PID)</para>
+/// </summary>
+static void BM_FanControllerTick(benchmark::State& state)
+{
+	const auto count = static_cast<qint32>(state.range(0));
+	const auto mode = state.range(1) == 0 ? FanCurve::Mode::Linear : FanCurve::Mode::Pid;
+
+	SensorSnapshot snapshot;
+	QStringList controls;
+	QVector<FanChannel> channels;
+	for (auto i = 0; i < count; ++i)
+	{
+		FanChannel channel;
+		channel.control = QString("Fan Control #%1").arg(i);
+		channel.sensor = QString("temp.%1").arg(i);
+		channel.curve.mode = mode;
+		channel.curve.points = { { 30, 20 }, { 50, 40 }, { 70, 70 }, { 85, 100 } };
+		channel.minWriteInterval = 0;
+
+		snapshot.AddSensor(channel.sensor);
+		controls.append(channel.control);
+		channels.append(channel);
+	}
+
+	auto backend = new SimulatedFanBackend(controls);
+	FanController controller(backend);
+	controller.SetChannels(channels);
+	controller.SetInterval(1000);
+
+	// 温度按正弦变化 使每次计算都可能产生写入
+	qint64 timestamp = 0;
+	qint64 tick = 0;
+	for (auto _ : state)
+	{
+		state.PauseTiming();
+		timestamp += 1000;
+		tick++;
+		for (auto i = 0; i < count; ++i)
+			snapshot.SetValue(i, 55.0f + 25.0f * qSin(tick * 0.05 + i));
+		snapshot.SetTimestamp(timestamp);
+		state.ResumeTiming();
+
+		controller.OnSnapshot(snapshot);
+	}
+
+	state.SetItemsProcessed(state.iterations() * count);
+	state.counters["writes/tick"] = benchmark::Counter(static_cast<double>(backend->Writes()) / qMax<qint64>(tick, 1));
+}
+BENCHMARK(BM_FanControllerTick)->ArgNames({ "channels", "pid" })->ArgsProduct({ { 1, 4, 16 }, { 0, 1 } });
@@ -0,0 +1,92 @@
+﻿#include <benchmark/benchmark.h>
+#include <Common/FrameFormatter.h>
+#include <QRandomGenerator>
+#include <QStringList>
+#include <QVector>
+#include "AllocationCounter.h"
+
+/// <summary>
+/// 生成模拟的传感器读数 (约 10% 为 NaN)
+/// </summary>
+static QVector<float> SyntheticValues(qint32 count)
+{
+	QRandomGenerator generator(0x5EED);
+	QVector<float> values(count);
+	for (auto& value : values)
+		value = generator.bounded(10) == 0 ? qQNaN() : static_cast<float>(generator.bounded(20000.0) - 10000.0);
+
+	return values;
+}
+
+/// <summary>
+/// 在计时循环外统计每帧分配次数
+/// </summary>
+template <typename Function>
+static double AllocationsPerFrame(Function&& function)
+{
+	constexpr auto frames = 1000;
+	const auto before = AllocationCounter::Count();
+	for (auto i = 0; i < frames; ++i)
+		function();
+
+	return static_cast<double>(AllocationCounter::Count() - before) / frames;
+}
+
+/// <summary>
+/// FrameFormatter 文本帧格式化
+/// <para>参数: 字段数量, 小数位数</para>
+/// </summary>
+static void BM_FormatFrame(benchmark::State& state)
+{
+	const auto values = SyntheticValues(static_cast<qint32>(state.range(0)));
+
+	FrameFormatter formatter;
+	formatter.SetFields(values.count(), static_cast<qint32>(state.range(1)));
+
+	auto format = [&]() {
+		formatter.Format(values.constData(), values.count());
+		benchmark::DoNotOptimize(formatter.Data());
+	};
+
+	const auto allocations = AllocationsPerFrame(format);
+	if (allocations != 0)
+		state.SkipWithError("FrameFormatter::Format allocated memory");
+
+	for (auto _ : state)
+		format();
+
+	state.counters["allocs/frame"] = allocations;
+	state.counters["bytes/frame"] = formatter.Size();
+	state.SetItemsProcessed(state.iterations() * values.count());
+}
+BENCHMARK(BM_FormatFrame)->ArgNames({ "fields", "precision" })->ArgsProduct({ { 8, 64, 512 }, { 0, 1, 3 } });
+
+/// <summary>
+/// 对照组: QString::number + join 格式化
+/// <para>参数: 字段数量, 小数位数</para>
+/// </summary>
+static void BM_FormatFrameQString(benchmark::State& state)
+{
+	const auto values = SyntheticValues(static_cast<qint32>(state.range(0)));
+	const auto precision = static_cast<qint32>(state.range(1));
+
+	QByteArray frame;
+	auto format = [&]() {
+		QStringList fields;
+		for (auto value : values)
+			fields.append(qIsNaN(value) ? QString("-") : QString::number(value, 'f', precision));
+
+		frame = ("/*" + fields.join(",") + "*/").toUtf8();
+		benchmark::DoNotOptimize(frame.constData());
+	};
+
+	const auto allocations = AllocationsPerFrame(format);
+
+	for (auto _ : state)
+		format();
+
+	state.counters["allocs/frame"] = allocations;
+	state.counters["bytes/frame"] = frame.size();
+	state.SetItemsProcessed(state.iterations() * values.count());
+}
+BENCHMARK(BM_FormatFrameQString)->ArgNames({ "fields", "precision" })->ArgsProduct({ { 8, 64, 512 }, { 0, 1, 3 } });
@@ -0,0 +1,76 @@
+﻿#include <benchmark/benchmark.h>
+#include <QtGlobal>
+
+#ifdef Q_OS_LINUX
+#include <Sensor/HwmonSensorSource.h>
+#include <Sensor/SensorSnapshot.h>
+#include <QDir>
+#include <QFile>
+#include <QTemporaryDir>
+
+/// <summary>
+/// 生成模拟的 hwmon 目录 (每个芯片 16 个温度通道)
+/// <para>临时目录中的普通文件 不经过 sysfs 的 show 回调, 这里只比较系统调用次数与提交开销</para>
+/// </summary>
+static bool CreateHwmonTree(const QString& root, qint32 channels)
+{
+	const qint32 perChip = 16;
+	for (auto i = 0; i < channels; ++i)
+	{
+		const auto chip = QString("%1/hwmon%2").arg(root).arg(i / perChip);
+		if (i % perChip == 0)
+		{
+			QDir().mkpath(chip);
+			QFile name(chip + "/name");
+			if (!name.open(QIODevice::WriteOnly))
+				return false;
+			name.write("coretemp\n");
+		}
+
+		QFile input(QString("%1/temp%2_input").arg(chip).arg(i % perChip + 1));
+		if (!input.open(QIODevice::WriteOnly))
+			return false;
+		input.write(QByteArray::number(40000 + i * 10) + '\n');
+	}
+
+	return true;
+}
+
+/// <summary>
+/// hwmon 数据源一次采样 (包含 /proc/stat 与 /proc/meminfo)
+/// <para>参数: 读取方式 (1 = pread, 2 = io_uring), 通道数量</para>
+/// </summary>
+static void BM_HwmonSample(benchmark::State& state)
+{
+	const auto backend = static_cast<BatchFileReader::Backend>(state.range(0));
+	const auto channels = static_cast<qint32>(state.range(1));
+
+	QTemporaryDir root;
+	if (!root.isValid() || !CreateHwmonTree(root.path(), channels))
+	{
+		state.SkipWithError("failed to create hwmon tree");
+		return;
+	}
+
+	SensorSnapshot snapshot;
+	HwmonSensorSource source(root.path(), "/proc", backend);
+	source.Update(snapshot);
+	if (source.Backend() != backend)
+	{
+		state.SkipWithError("backend unavailable");
+		return;
+	}
+
+	const auto syscalls = source.Syscalls();
+	for (auto _ : state)
+		benchmark::DoNotOptimize(source.Update(snapshot));
+
+	state.SetItemsProcessed(state.iterations() * channels);
+	state.counters["syscalls/tick"] = static_cast<double>(source.Syscalls() - syscalls) / state.iterations();
+}
+BENCHMARK(BM_HwmonSample)
+	->ArgNames({ "backend", "channels" })
+	->ArgsProduct({ { static_cast<qint64>(BatchFileReader::Backend::Pread), static_cast<qint64>(BatchFileReader::Backend::IoUring) }, { 16, 128, 512 } })
+	->Unit(benchmark::kMicrosecond);
+
+#endif
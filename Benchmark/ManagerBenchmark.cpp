@@ -0,0 +1,288 @@
+﻿#include <benchmark/benchmark.h>
+#include "AllocationCounter.h"
+#include <IO/Manager/Manager.h>
+#include <Common/Checksum.h>
+#include <Common/NotifyCoalescer.h>
+#include <QRandomGenerator>
+
+/// <summary>
+/// 帧尾校验模式
+/// </summary>
+enum CrcMode
+{
+	CrcNone,
+	Crc8,
+	Crc16,
+	Crc32
+};
+
+/// <summary>
+/// 生成合成数据流
+/// <para>每帧由逗号分隔的数值组成, 帧与帧之间按比例插入噪声字节</para>
+/// </summary>
+/// <param name="frameSize">帧负载长度</param>
+/// <param name="crcMode">帧尾校验模式</param>
+/// <param name="noisePercent">噪声字节占帧长度的百分比</param>
+/// <param name="frameCount">帧数量</param>
+/// <returns>数据流</returns>
+static QByteArray SyntheticStream(qint32 frameSize, CrcMode crcMode, qint32 noisePercent, qint32 frameCount)
+{
+	static const char noiseChars[] = "abcdefghijklmnopqrstuvwxyz0123456789 .,;:\r\n";
+	QRandomGenerator generator(0x5EED);
+
+	QByteArray payload;
+	while (payload.length() < frameSize)
+		payload.append(QByteArray::number(generator.bounded(10000) / 100.0, 'f', 2)).append(',');
+	payload.truncate(frameSize);
+
+	QByteArray trailer;
+	switch (crcMode)
+	{
+	case Crc8:
+	{
+		const auto crc = static_cast<quint8>(CRC8(payload.constData(), payload.length()));
+		trailer = QByteArray("crc8:").append(static_cast<char>(crc));
+		break;
+	}
+	case Crc16:
+	{
+		const auto crc = static_cast<quint16>(CRC16(payload.constData(), payload.length()));
+		trailer = QByteArray("crc16:").append(static_cast<char>(crc >> 8)).append(static_cast<char>(crc));
+		break;
+	}
+	case Crc32:
+	{
+		const auto crc = static_cast<quint32>(CRC32(payload.constData(), payload.length()));
+		trailer = QByteArray("crc32:");
+		for (auto shift = 24; shift >= 0; shift -= 8)
+			trailer.append(static_cast<char>(crc >> shift));
+		break;
+	}
+	default:
+		break;
+	}
+
+	const auto noiseLength = frameSize * noisePercent / 100;
+
+	QByteArray stream;
+	for (auto i = 0; i < frameCount; ++i)
+	{
+		for (auto j = 0; j < noiseLength; ++j)
+			stream.append(noiseChars[generator.bounded(static_cast<int>(sizeof(noiseChars) - 1))]);
+
+		stream.append("/*").append(payload).append("*/").append(trailer);
+	}
+
+	return stream;
+}
+
+/// <summary>
+/// Manager 帧解析吞吐量
+/// <para>参数: 帧长度, CRC 模式, 噪声百分比</para>
+/// </summary>
+static void BM_ReadFrames(benchmark::State& state)
+{
+	const auto frameSize = static_cast<qint32>(state.range(0));
+	const auto crcMode = static_cast<CrcMode>(state.range(1));
+	const auto noisePercent = static_cast<qint32>(state.range(2));
+	const auto frameCount = 64;
+
+	const auto stream = SyntheticStream(frameSize, crcMode, noisePercent, frameCount);
+
+	// 独立的实例 不影响应用程序的单例状态
+	const auto isolated = Manager::CreateIsolated();
+	auto& manager = *isolated;
+	manager.setStartSequence("/*");
+	manager.setFinishSequence("*/");
+
+	qint64 frames = 0;
+	auto connection = QObject::connect(&manager, &Manager::frameReceived, [&frames](const QByteArray&) {
+		++frames;
+	});
+
+	for (auto _ : state)
+		manager.processData(stream);
+
+	QObject::disconnect(connection);
+
+	state.SetBytesProcessed(state.iterations() * stream.length());
+	state.counters["frames/s"] = benchmark::Counter(static_cast<double>(frames), benchmark::Counter::kIsRate);
+	state.counters["frames/iter"] = static_cast<double>(frames) / state.iterations();
+}
+BENCHMARK(BM_ReadFrames)
+	->ArgNames({ "size", "crc", "noise%" })
+	->ArgsProduct({ { 32, 256, 1024 }, { CrcNone, Crc8, Crc16, Crc32 }, { 0, 10, 50 } });
+
+/// <summary>
+/// 没有 frameReceived 接收者时的帧解析 验证解析路径本身不分配内存
+/// <para>参数: 帧大小, 校验模式</para>
+/// </summary>
+static void BM_ParseFrames(benchmark::State& state)
+{
+	const auto frameSize = static_cast<qint32>(state.range(0));
+	const auto crcMode = static_cast<CrcMode>(state.range(1));
+	const auto stream = SyntheticStream(frameSize, crcMode, 0, 64);
+
+	const auto isolated = Manager::CreateIsolated();
+	auto& manager = *isolated;
+	manager.setStartSequence("/*");
+	manager.setFinishSequence("*/");
+
+	// 预热一次 使接收缓冲区达到稳定容量
+	manager.processData(stream);
+
+	const auto allocations = AllocationCounter::Count();
+	for (auto _ : state)
+		manager.processData(stream);
+
+	state.counters["allocs/iter"] = static_cast<double>(AllocationCounter::Count() - allocations) / state.iterations();
+
+	state.SetBytesProcessed(state.iterations() * stream.length());
+}
+BENCHMARK(BM_ParseFrames)
+	->ArgNames({ "size", "crc" })
+	->ArgsProduct({ { 32, 1024 }, { CrcNone, Crc16 } });
+
+/// <summary>
+/// 帧分发方式
+/// </summary>
+enum DeliveryMode
+{
+	PerFrameSignal,
+	BatchSignal,
+	DirectSink
+};
+
+/// <summary>
+/// 只统计帧数量的接收者
+/// </summary>
+class CountingSink : public FrameSink
+{
+public:
+	void OnFrames(const char* data, const FrameSpan* spans, qint32 count) override
+	{
+		benchmark::DoNotOptimize(data);
+		benchmark::DoNotOptimize(spans);
+		frames += count;
+	}
+
+	qint64 frames = 0;
+};
+
+/// <summary>
+/// 不同分发方式的帧接收开销: 逐帧 frameReceived, 批量 framesReceived, 直接调用 FrameSink
+/// <para>参数: 分发方式, 帧大小</para>
+/// </summary>
+static void BM_FrameDelivery(benchmark::State& state)
+{
+	const auto mode = static_cast<DeliveryMode>(state.range(0));
+	const auto frameSize = static_cast<qint32>(state.range(1));
+	const auto stream = SyntheticStream(frameSize, CrcNone, 0, 64);
+
+	const auto isolated = Manager::CreateIsolated();
+	auto& manager = *isolated;
+	manager.setStartSequence("/*");
+	manager.setFinishSequence("*/");
+
+	CountingSink sink;
+	QMetaObject::Connection connection;
+	switch (mode)
+	{
+	case PerFrameSignal:
+		connection = QObject::connect(&manager, &Manager::frameReceived, [&sink](const QByteArray& frame) {
+			benchmark::DoNotOptimize(frame.constData());
+			++sink.frames;
+		});
+		break;
+	case BatchSignal:
+		connection = QObject::connect(&manager, &Manager::framesReceived, [&sink](const FrameBatch& batch) {
+			benchmark::DoNotOptimize(batch.Buffer().constData());
+			sink.frames += batch.Count();
+		});
+		break;
+	case DirectSink:
+		manager.AddFrameSink(&sink);
+		break;
+	}
+
+	manager.processData(stream);
+	sink.frames = 0;
+
+	const auto allocations = AllocationCounter::Count();
+	for (auto _ : state)
+		manager.processData(stream);
+
+	state.counters["allocs/iter"] = static_cast<double>(AllocationCounter::Count() - allocations) / state.iterations();
+
+	QObject::disconnect(connection);
+	manager.RemoveFrameSink(&sink);
+
+	state.SetItemsProcessed(sink.frames);
+	state.SetBytesProcessed(state.iterations() * stream.length());
+}
+BENCHMARK(BM_FrameDelivery)
+	->ArgNames({ "mode", "size" })
+	->ArgsProduct({ { PerFrameSignal, BatchSignal, DirectSink }, { 32, 256 } });
+
+/// <summary>
+/// 高频属性通知的接收开销: 直接连接时每次通知都执行界面更新, 合并时每帧只执行一次
+/// <para>参数: 是否合并, 每帧的通知数量</para>
+/// </summary>
+static void BM_CoalescedNotify(benchmark::State& state)
+{
+	const auto coalesced = state.range(0) != 0;
+	const auto notifications = static_cast<qint32>(state.range(1));
+
+	const auto isolated = Manager::CreateIsolated();
+	auto& manager = *isolated;
+	auto& coalescer = NotifyCoalescer::Instance();
+
+	// 模拟界面更新: 格式化显示文本
+	qint64 updates = 0;
+	QString text;
+	const auto update = [&updates, &text]() {
+		text = QString::number(++updates);
+	};
+
+	QObject context;
+	QMetaObject::Connection connection;
+	qint32 id = 0;
+	if (coalesced)
+		id = coalescer.Connect(&manager, &Manager::receivedBytesChanged, &context, update);
+	else
+		connection = QObject::connect(&manager, &Manager::receivedBytesChanged, &context, update);
+
+	for (auto _ : state)
+	{
+		for (auto i = 0; i < notifications; ++i)
+			emit manager.receivedBytesChanged();
+
+		// 代替 TimerEvents 的刷新周期
+		coalescer.flush();
+	}
+
+	coalescer.Disconnect(id);
+	QObject::disconnect(connection);
+
+	state.SetItemsProcessed(state.iterations() * notifications);
+	state.counters["updates/frame"] = static_cast<double>(updates) / state.iterations();
+}
+BENCHMARK(BM_CoalescedNotify)
+	->ArgNames({ "coalesced", "notifications" })
+	->ArgsProduct({ { 0, 1 }, { 1, 64, 1024 } });
+
+/// <summary>
+/// 转义字符替换 (用于起始/结束/分隔序列的设置)
+/// </summary>
+static void BM_AddEscapeSequences(benchmark::State& state)
+{
+	const QString sequences[] = { "/*", "\\r\\n", "*/\\r\\n", "\\t|\\t" };
+	for (auto _ : state)
+	{
+		for (const auto& sequence : sequences)
+			benchmark::DoNotOptimize(ADD_ESCAPE_SEQUENCES(sequence));
+	}
+
+	state.SetItemsProcessed(state.iterations() * 4);
+}
+BENCHMARK(BM_AddEscapeSequences);
@@ -0,0 +1,145 @@
+﻿#include <benchmark/benchmark.h>
+#include <Sensor/MetricsExporter.h>
+#include <Sensor/SensorSnapshot.h>
+#include <QTcpSocket>
+#include <atomic>
+#include <thread>
+
+namespace
+{
+	void AddSensors(SensorSnapshot& snapshot, qint32 count)
+	{
+		for (auto i = 0; i < count; ++i)
+		{
+			snapshot.AddSensor(QString("sensor.%1").arg(i), "unit");
+			snapshot.SetValue(i, static_cast<float>(i) * 0.5f);
+		}
+	}
+}
+
+/// <summary>
+/// 采样线程更新预生成响应的开销
+/// <para>参数: 传感器数量, 每次采样变化的读数比例 (%)</para>
+/// </summary>
+static void BM_MetricsRender(benchmark::State& state)
+{
+	const auto count = static_cast<qint32>(state.range(0));
+	const auto changed = qMax(static_cast<qint32>(count * state.range(1) / 100), 0);
+
+	SensorSnapshot snapshot;
+	AddSensors(snapshot, count);
+
+	MetricsExporter exporter;
+	exporter.OnSnapshot(snapshot);
+
+	quint64 sequence = 0;
+	qint32 next = 0;
+	for (auto _ : state)
+	{
+		snapshot.SetSequence(++sequence);
+		for (auto i = 0; i < changed; ++i)
+		{
+			snapshot.SetValue(next, static_cast<float>(sequence) + next * 0.01f);
+			next = (next + 1) % count;
+		}
+		exporter.OnSnapshot(snapshot);
+	}
+
+	state.counters["rendered/iter"] = static_cast<double>(exporter.RenderedValues()) / state.iterations();
+	state.counters["bytes"] = static_cast<double>(exporter.Response().size());
+}
+BENCHMARK(BM_MetricsRender)
+	->ArgNames({ "sensors", "changed%" })
+	->ArgsProduct({ { 64, 256, 1024 }, { 0, 10, 100 } });
+
+/// <summary>
+/// 本机 HTTP 客户端连续抓取 /metrics (每次新建连接)
+/// <para>参数: 传感器数量, 是否同时以最高速率采样 (与抓取并发改写响应)</para>
+/// </summary>
+static void BM_MetricsScrape(benchmark::State& state)
+{
+	const auto count = static_cast<qint32>(state.range(0));
+	const auto sampling = state.range(1) != 0;
+
+	SensorSnapshot snapshot;
+	AddSensors(snapshot, count);
+
+	MetricsExporter exporter;
+	exporter.OnSnapshot(snapshot);
+	if (!exporter.Start(QHostAddress::LocalHost, 0))
+	{
+		state.SkipWithError("listen failed");
+		return;
+	}
+
+	// 模拟采样线程 每次改写 10% 的读数
+	std::atomic<bool> running(true);
+	std::thread sampler;
+	if (sampling)
+	{
+		sampler = std::thread([&]() {
+			quint64 sequence = 0;
+			qint32 next = 0;
+			while (running)
+			{
+				snapshot.SetSequence(++sequence);
+				for (auto i = 0; i < qMax(count / 10, 1); ++i)
+				{
+					snapshot.SetValue(next, static_cast<float>(sequence));
+					next = (next + 1) % count;
+				}
+				exporter.OnSnapshot(snapshot);
+				std::this_thread::yield();
+			}
+		});
+	}
+
+	static const QByteArray request = "GET /metrics HTTP/1.1\r\nHost: 127.0.0.1\r\nAccept: text/plain\r\n\r\n";
+	qint64 bytes = 0;
+	auto failed = false;
+	for (auto _ : state)
+	{
+		QTcpSocket socket;
+		socket.connectToHost(QHostAddress::LocalHost, exporter.Port());
+		if (!socket.waitForConnected(1000))
+		{
+			failed = true;
+			break;
+		}
+
+		socket.write(request);
+		socket.waitForBytesWritten(1000);
+
+		// 服务端写入完整响应后关闭连接
+		qint64 received = 0;
+		while (socket.waitForReadyRead(1000))
+			received += socket.readAll().size();
+		received += socket.readAll().size();
+
+		if (received == 0)
+		{
+			failed = true;
+			break;
+		}
+		bytes += received;
+	}
+
+	running = false;
+	if (sampler.joinable())
+		sampler.join();
+	exporter.Stop();
+
+	if (failed)
+	{
+		state.SkipWithError("scrape failed");
+		return;
+	}
+
+	state.SetItemsProcessed(state.iterations());
+	state.SetBytesProcessed(bytes);
+	state.counters["scrapes"] = static_cast<double>(exporter.Scrapes());
+}
+BENCHMARK(BM_MetricsScrape)
+	->ArgNames({ "sensors", "sampling" })
+	->ArgsProduct({ { 64, 1024 }, { 0, 1 } })
+	->UseRealTime();
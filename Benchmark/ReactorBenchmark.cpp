@@ -0,0 +1,175 @@
+﻿#include <benchmark/benchmark.h>
+#include <QtGlobal>
+
+#ifdef Q_OS_LINUX
+#include <IO/Reactor/FdDriver.h>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QSocketNotifier>
+#include <fcntl.h>
+#include <pty.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+#include <memory>
+#include <vector>
+
+/// <summary>
+/// 接收端的通知方式
+/// </summary>
+enum NotifyMode
+{
+	/// <summary>
+	/// 每个设备一个 QSocketNotifier (主线程事件循环中读取)
+	/// </summary>
+	Notifier,
+	/// <summary>
+	/// FdDriver + Reactor (一个 I/O 线程 epoll 读取, 主线程只处理完成通知)
+	/// </summary>
+	Epoll
+};
+
+namespace
+{
+	/// <summary>
+	/// 一个连接: 主端模拟显示设备 从端由接收方读取
+	/// </summary>
+	struct Connection
+	{
+		Connection()
+			: master(-1)
+			, slave(-1)
+		{
+			termios options;
+			::cfmakeraw(&options);
+			::openpty(&master, &slave, Q_NULLPTR, &options, Q_NULLPTR);
+			if (slave >= 0)
+				::fcntl(slave, F_SETFL, ::fcntl(slave, F_GETFL) | O_NONBLOCK);
+		}
+
+		~Connection()
+		{
+			// 先释放接收方 再关闭文件描述符
+			notifier.reset();
+			driver.reset();
+			if (master >= 0)
+				::close(master);
+			if (slave >= 0)
+				::close(slave);
+		}
+
+		int master;
+		int slave;
+		std::unique_ptr<QSocketNotifier> notifier;
+		std::unique_ptr<FdDriver> driver;
+	};
+
+	/// <summary>
+	/// 进程 CPU 时间 (包含 Reactor 线程, 秒)
+	/// </summary>
+	double ProcessCpuTime()
+	{
+		timespec time;
+		::clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &time);
+		return time.tv_sec + time.tv_nsec / 1e9;
+	}
+}
+
+/// <summary>
+/// 多个伪终端同时收到一帧数据 直到全部被接收方读取
+/// <para>参数: 通知方式, 连接数量</para>
+/// <para>cpu/conn 为每个连接每帧消耗的进程 CPU 时间 (微秒)</para>
+/// </summary>
+static void BM_ReactorScaling(benchmark::State& state)
+{
+	const auto mode = static_cast<NotifyMode>(state.range(0));
+	const auto connections = static_cast<qint32>(state.range(1));
+	const QByteArray frame(48, 'x');
+
+	qint64 received = 0;
+	std::vector<std::unique_ptr<Connection>> list;
+	for (auto i = 0; i < connections; ++i)
+	{
+		auto connection = std::make_unique<Connection>();
+		if (connection->master < 0 || connection->slave < 0)
+		{
+			state.SkipWithError("openpty failed");
+			return;
+		}
+
+		const auto fd = connection->slave;
+		if (mode == Notifier)
+		{
+			connection->notifier = std::make_unique<QSocketNotifier>(fd, QSocketNotifier::Read);
+			QObject::connect(connection->notifier.get(), &QSocketNotifier::activated, [fd, &received]() {
+				char buffer[4096];
+				qint64 bytes;
+				while ((bytes = ::read(fd, buffer, sizeof(buffer))) > 0)
+					received += bytes;
+			});
+		}
+		else
+		{
+			connection->driver = std::make_unique<FdDriver>();
+			QObject::connect(connection->driver.get(), &HAL_Driver::dataReceived, [&received](const QByteArray& data) {
+				received += data.length();
+			});
+
+			if (!connection->driver->Attach(fd, QIODevice::ReadOnly, false))
+			{
+				state.SkipWithError("reactor register failed");
+				return;
+			}
+		}
+
+		list.push_back(std::move(connection));
+	}
+
+	const auto wakeups = Reactor::Instance().Wakeups();
+	const auto cpuStart = ProcessCpuTime();
+	QElapsedTimer timer;
+
+	for (auto _ : state)
+	{
+		received = 0;
+		bool failed = false;
+		for (const auto& connection : list)
+		{
+			if (::write(connection->master, frame.constData(), frame.length()) != frame.length())
+			{
+				state.SkipWithError("pty write failed");
+				failed = true;
+				break;
+			}
+		}
+
+		const auto expected = static_cast<qint64>(connections) * frame.length();
+		timer.start();
+		while (!failed && received < expected)
+		{
+			// 阻塞等待 (不轮询) 以免事件循环本身计入 CPU 时间
+			QCoreApplication::processEvents(QEventLoop::WaitForMoreEvents);
+			if (timer.elapsed() > 1000)
+			{
+				state.SkipWithError("pty read timeout");
+				failed = true;
+			}
+		}
+
+		if (failed)
+			break;
+	}
+
+	const auto cpu = ProcessCpuTime() - cpuStart;
+	const auto transfers = static_cast<double>(state.iterations()) * connections;
+	state.counters["cpu/conn(us)"] = cpu * 1e6 / transfers;
+	if (mode == Epoll)
+		state.counters["wakeups/iter"] = static_cast<double>(Reactor::Instance().Wakeups() - wakeups) / state.iterations();
+	state.SetBytesProcessed(state.iterations() * connections * frame.length());
+}
+BENCHMARK(BM_ReactorScaling)
+	->ArgNames({ "mode", "conns" })
+	->ArgsProduct({ { Notifier, Epoll }, { 1, 16, 64, 128 } })
+	->Unit(benchmark::kMicrosecond);
+
+#endif
@@ -0,0 +1,150 @@
+﻿#include <benchmark/benchmark.h>
+#include <QtGlobal>
+
+#ifdef Q_OS_LINUX
+#include <IO/Serial/SerialTuning.h>
+#include <chrono>
+#include <fcntl.h>
+#include <poll.h>
+#include <pty.h>
+#include <termios.h>
+#include <unistd.h>
+#include <vector>
+
+/// <summary>
+/// 接收端的读取方式
+/// </summary>
+enum ReadMode
+{
+	/// <summary>
+	/// 阻塞读取 VMIN = 1 / VTIME = 0
+	/// </summary>
+	BlockingRead,
+	/// <summary>
+	/// 非阻塞 poll + read, VMIN = 0 / VTIME = 0 (与 QSerialPort 的通知方式一致)
+	/// </summary>
+	TunedPoll
+};
+
+/// <summary>
+/// 伪终端对 (主端模拟设备, 从端模拟串口)
+/// </summary>
+class PtyPair
+{
+public:
+	PtyPair()
+		: master(-1)
+		, slave(-1)
+	{
+		termios options;
+		::cfmakeraw(&options);
+		::openpty(&master, &slave, Q_NULLPTR, &options, Q_NULLPTR);
+	}
+
+	~PtyPair()
+	{
+		if (master >= 0)
+			::close(master);
+		if (slave >= 0)
+			::close(slave);
+	}
+
+	bool IsValid() const
+	{
+		return master >= 0 && slave >= 0;
+	}
+
+	int master;
+	int slave;
+};
+
+/// <summary>
+/// 从端按读取方式接收完整的一帧
+/// </summary>
+static bool ReceiveFrame(int fd, ReadMode mode, char* buffer, qint32 length)
+{
+	qint32 received = 0;
+	while (received < length)
+	{
+		if (mode == TunedPoll)
+		{
+			pollfd descriptor{ fd, POLLIN, 0 };
+			if (::poll(&descriptor, 1, 1000) <= 0)
+				return false;
+		}
+
+		const auto bytes = ::read(fd, buffer + received, length - received);
+		if (bytes < 0)
+			return false;
+
+		received += static_cast<qint32>(bytes);
+	}
+
+	return true;
+}
+
+/// <summary>
+/// 伪终端上一帧数据从写入到完整读取的延迟
+/// <para>参数: 读取方式, 帧长度</para>
+/// <para>伪终端不支持 ASYNC_LOW_LATENCY 与 latency_timer, 这里只比较 termios 与读取方式带来的差异</para>
+/// </summary>
+static void BM_PtyFrameLatency(benchmark::State& state)
+{
+	const auto mode = static_cast<ReadMode>(state.range(0));
+	const auto frameSize = static_cast<qint32>(state.range(1));
+
+	PtyPair pty;
+	if (!pty.IsValid())
+	{
+		state.SkipWithError("openpty failed");
+		return;
+	}
+
+	termios options;
+	::tcgetattr(pty.slave, &options);
+	switch (mode)
+	{
+	case BlockingRead:
+		options.c_cc[VMIN] = 1;
+		options.c_cc[VTIME] = 0;
+		break;
+	case TunedPoll:
+		options.c_cc[VMIN] = 0;
+		options.c_cc[VTIME] = 0;
+		::fcntl(pty.slave, F_SETFL, ::fcntl(pty.slave, F_GETFL) | O_NONBLOCK);
+		break;
+	}
+	::tcsetattr(pty.slave, TCSANOW, &options);
+
+	// 伪终端上调优只有 termios 一项生效
+	SerialTuning::State tuning;
+	if (mode == TunedPoll)
+		SerialTuning::Apply(pty.slave, QString(), &tuning);
+
+	const std::vector<char> frame(frameSize, 'x');
+	std::vector<char> buffer(frameSize);
+
+	for (auto _ : state)
+	{
+		const auto start = std::chrono::steady_clock::now();
+
+		if (::write(pty.master, frame.data(), frame.size()) != static_cast<ssize_t>(frame.size())
+			|| !ReceiveFrame(pty.slave, mode, buffer.data(), frameSize))
+		{
+			state.SkipWithError("pty transfer failed");
+			break;
+		}
+
+		const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start);
+		state.SetIterationTime(elapsed.count());
+	}
+
+	state.SetBytesProcessed(state.iterations() * frameSize);
+}
+BENCHMARK(BM_PtyFrameLatency)
+	->ArgNames({ "mode", "size" })
+	->ArgsProduct({ { BlockingRead, TunedPoll }, { 16, 256 } })
+	->UseManualTime()
+	->Unit(benchmark::kMicrosecond);
+
+#endif
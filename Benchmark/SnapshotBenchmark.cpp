@@ -0,0 +1,61 @@
+﻿#include <benchmark/benchmark.h>
+#include <QtGlobal>
+
+#ifdef DIGIHMS_WITH_SHM
+#include <Sensor/SensorSnapshot.h>
+#include <Sensor/SnapshotPublisher.h>
+#include <SharedSnapshot.h>
+#include <QString>
+#include <unistd.h>
+
+/// <summary>
+/// 采样线程发布一次快照到共享内存的开销 (布局不变时只复制读数)
+/// <para>参数: 传感器数量, 是否有读取方同时轮询</para>
+/// </summary>
+static void BM_SnapshotPublish(benchmark::State& state)
+{
+	const auto count = static_cast<qint32>(state.range(0));
+	const auto withReader = state.range(1) != 0;
+	const auto name = QString("/DigiHMS.snapshot.bench.%1").arg(::getpid()).toUtf8();
+
+	SensorSnapshot snapshot;
+	for (auto i = 0; i < count; ++i)
+		snapshot.AddSensor(QString("sensor.%1").arg(i), "unit");
+
+	SnapshotPublisher publisher;
+	if (!publisher.Open(name.constData()))
+	{
+		state.SkipWithError("shm_open failed");
+		return;
+	}
+
+	// 读取方在同一线程中轮询 只用于验证发布不受读取方影响
+	SharedSnapshotReader reader;
+	if (withReader && !reader.Open(name.constData()))
+	{
+		state.SkipWithError("reader open failed");
+		return;
+	}
+
+	quint64 sequence = 0;
+	for (auto _ : state)
+	{
+		snapshot.SetSequence(++sequence);
+		snapshot.SetValue(static_cast<qint32>(sequence % count), static_cast<float>(sequence));
+		publisher.OnSnapshot(snapshot);
+
+		if (withReader)
+		{
+			state.PauseTiming();
+			reader.Read();
+			state.ResumeTiming();
+		}
+	}
+
+	state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_SnapshotPublish)
+	->ArgNames({ "sensors", "reader" })
+	->ArgsProduct({ { 64, 256, 1024 }, { 0, 1 } });
+
+#endif
@@ -2,7 +2,11 @@
 
 qint8 CRC8(const char* data, const qint32 length)
 {
-	qint8 crc = 0xff;
+	return CRC8Update(CRC8_INIT, data, length);
+}
+
+qint8 CRC8Update(qint8 crc, const char* data, const qint32 length)
+{
 	for (qint32 i = 0; i < length; i++)
 	{
 		crc ^= data[i];
@@ -23,9 +27,13 @@ qint8 CRC8(const char* data, const qint32 length)
 }
 
 qint16 CRC16(const char* data, const qint32 length)
+{
+	return CRC16Update(CRC16_INIT, data, length);
+}
+
+qint16 CRC16Update(qint16 crc, const char* data, const qint32 length)
 {
 	qint8 x;
-	qint16 crc = 0xFFFF;
 
 	for (qint32 i = 0; i < length; ++i)
 	{
@@ -38,9 +46,13 @@ qint16 CRC16(const char* data, const qint32 length)
 }
 
 qint32 CRC32(const char* data, const qint32 length)
+{
+	return ~CRC32Update(CRC32_INIT, data, length);
+}
+
+qint32 CRC32Update(qint32 crc, const char* data, const qint32 length)
 {
 	qint32 mask;
-	qint32 crc = 0xFFFFFFFF;
 	for (qint32 i = 0; i < length; ++i)
 	{
 		crc = crc ^ data[i];
@@ -51,5 +63,5 @@ qint32 CRC32(const char* data, const qint32 length)
 		}
 	}
 
-	return ~crc;
+	return crc;
 }
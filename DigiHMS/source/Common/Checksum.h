@@ -4,3 +4,15 @@
 qint8  CRC8(const char* data, const qint32 length);
 qint16 CRC16(const char* data, const qint32 length);
 qint32 CRC32(const char* data, const qint32 length);
+
+/// <summary>
+/// 增量计算 CRC: 以 CRCx_INIT 为初值依次处理各段数据
+/// <para>分段计算的结果与对拼接后的数据调用 CRC8 / CRC16 / CRC32 相同 (CRC32 需对最终结果取反)</para>
+/// </summary>
+constexpr qint8  CRC8_INIT  = static_cast<qint8>(0xFF);
+constexpr qint16 CRC16_INIT = static_cast<qint16>(0xFFFF);
+constexpr qint32 CRC32_INIT = static_cast<qint32>(0xFFFFFFFF);
+
+qint8  CRC8Update(qint8 crc, const char* data, const qint32 length);
+qint16 CRC16Update(qint16 crc, const char* data, const qint32 length);
+qint32 CRC32Update(qint32 crc, const char* data, const qint32 length);
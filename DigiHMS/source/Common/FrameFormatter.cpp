@@ -0,0 +1,117 @@
+﻿#include "FrameFormatter.h"
+#include <QtMath>
+#include <charconv>
+#include <cstring>
+
+char* FloatFormat::Fixed(char* first, char* last, float value, qint32 precision)
+{
+	const auto result = std::to_chars(first, last, value, std::chars_format::fixed, qBound(0, precision, MaxPrecision));
+	return result.ec == std::errc() ? result.ptr : Q_NULLPTR;
+}
+
+FrameFormatter::FrameFormatter()
+	: m_start("/*")
+	, m_separator(",")
+	, m_finish("*/")
+	, m_missingText("-")
+	, m_size(0)
+{
+	allocate();
+}
+
+void FrameFormatter::SetSequences(const QByteArray& start, const QByteArray& separator, const QByteArray& finish)
+{
+	m_start = start;
+	m_separator = separator;
+	m_finish = finish;
+	allocate();
+}
+
+void FrameFormatter::SetMissingText(const QByteArray& text)
+{
+	m_missingText = text;
+	allocate();
+}
+
+void FrameFormatter::SetFields(qint32 count, qint32 precision)
+{
+	m_precision.fill(static_cast<qint8>(qBound(0, precision, FloatFormat::MaxPrecision)), qMax(count, 0));
+	allocate();
+}
+
+void FrameFormatter::SetPrecision(qint32 field, qint32 precision)
+{
+	if (field >= 0 && field < m_precision.count())
+		m_precision[field] = static_cast<qint8>(qBound(0, precision, FloatFormat::MaxPrecision));
+}
+
+qint32 FrameFormatter::FieldCount() const
+{
+	return m_precision.count();
+}
+
+qint32 FrameFormatter::Capacity() const
+{
+	return static_cast<qint32>(m_buffer.size());
+}
+
+qint32 FrameFormatter::Format(const float* values, qint32 count)
+{
+	auto out = m_buffer.data();
+	const auto end = out + m_buffer.size();
+
+	auto append = [&out](const QByteArray& bytes) {
+		std::memcpy(out, bytes.constData(), bytes.size());
+		out += bytes.size();
+	};
+
+	append(m_start);
+
+	const auto fields = m_precision.count();
+	for (auto i = 0; i < fields; ++i)
+	{
+		if (i > 0)
+			append(m_separator);
+
+		char* next = Q_NULLPTR;
+		if (i < count && !qIsNaN(values[i]))
+			next = FloatFormat::Fixed(out, end, values[i], m_precision.at(i));
+
+		if (next)
+			out = next;
+		else
+			append(m_missingText);
+	}
+
+	append(m_finish);
+
+	m_size = static_cast<qint32>(out - m_buffer.data());
+	return m_size;
+}
+
+const char* FrameFormatter::Data() const
+{
+	return m_buffer.data();
+}
+
+qint32 FrameFormatter::Size() const
+{
+	return m_size;
+}
+
+QByteArray FrameFormatter::Frame() const
+{
+	return QByteArray::fromRawData(m_buffer.data(), m_size);
+}
+
+void FrameFormatter::allocate()
+{
+	// 按最坏情况分配: 每个字段取数值最大长度与缺失文本长度中的较大者
+	const auto field = qMax(FloatFormat::MaxLength, static_cast<qint32>(m_missingText.size()));
+	const auto fields = m_precision.count();
+	const auto capacity = m_start.size() + m_finish.size()
+		+ fields * field + qMax(fields - 1, 0) * m_separator.size();
+
+	m_buffer.assign(capacity, '\0');
+	m_size = 0;
+}
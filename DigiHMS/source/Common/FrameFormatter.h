@@ -0,0 +1,103 @@
+﻿#pragma once
+
+#include <QByteArray>
+#include <QVector>
+#include <vector>
+
+/// <summary>
+/// 浮点数格式化 (基于 std::to_chars, 不分配内存)
+/// </summary>
+namespace FloatFormat
+{
+	/// <summary>
+	/// 单个数值格式化结果的最大长度 (包含符号与小数部分)
+	/// </summary>
+	constexpr qint32 MaxLength = 64;
+	/// <summary>
+	/// 支持的最大精度
+	/// </summary>
+	constexpr qint32 MaxPrecision = 9;
+
+	/// <summary>
+	/// 以固定小数位数格式化数值
+	/// </summary>
+	/// <param name="first">输出起始位置</param>
+	/// <param name="last">输出结束位置</param>
+	/// <param name="value">数值</param>
+	/// <param name="precision">小数位数</param>
+	/// <returns>写入结束位置 空间不足时返回 Q_NULLPTR</returns>
+	char* Fixed(char* first, char* last, float value, qint32 precision);
+}
+
+/// <summary>
+/// 文本帧格式化器
+/// <para>输出 起始序列 + 以分隔序列连接的数值 + 结束序列, 每个字段有各自的小数位数</para>
+/// <para>输出缓冲区按最坏情况预先分配, Format 不会分配内存</para>
+/// </summary>
+class FrameFormatter
+{
+public:
+	FrameFormatter();
+
+	/// <summary>
+	/// 设置帧的起始/分隔/结束序列
+	/// </summary>
+	void SetSequences(const QByteArray& start, const QByteArray& separator, const QByteArray& finish);
+	/// <summary>
+	/// 设置没有读数 (NaN) 时输出的文本
+	/// </summary>
+	/// <param name="text">文本</param>
+	void SetMissingText(const QByteArray& text);
+	/// <summary>
+	/// 设置字段数量 所有字段使用相同的小数位数
+	/// </summary>
+	/// <param name="count">字段数量</param>
+	/// <param name="precision">小数位数</param>
+	void SetFields(qint32 count, qint32 precision);
+	/// <summary>
+	/// 设置单个字段的小数位数
+	/// </summary>
+	/// <param name="field">字段索引</param>
+	/// <param name="precision">小数位数</param>
+	void SetPrecision(qint32 field, qint32 precision);
+
+	qint32 FieldCount() const;
+	/// <summary>
+	/// 获取输出缓冲区容量 (最长帧的字节数)
+	/// </summary>
+	/// <returns>容量</returns>
+	qint32 Capacity() const;
+
+	/// <summary>
+	/// 格式化一帧
+	/// <para>数值少于字段数量时其余字段输出缺失文本, 多余的数值被忽略</para>
+	/// </summary>
+	/// <param name="values">数值</param>
+	/// <param name="count">数值数量</param>
+	/// <returns>帧长度</returns>
+	qint32 Format(const float* values, qint32 count);
+	/// <summary>
+	/// 获取最近一次格式化的帧
+	/// </summary>
+	/// <returns>帧数据</returns>
+	const char* Data() const;
+	qint32 Size() const;
+	/// <summary>
+	/// 以 QByteArray 形式获取最近一次格式化的帧 (不拷贝数据, 下次 Format 前有效)
+	/// </summary>
+	/// <returns>帧</returns>
+	QByteArray Frame() const;
+
+private:
+	void allocate();
+
+private:
+	QByteArray m_start;
+	QByteArray m_separator;
+	QByteArray m_finish;
+	QByteArray m_missingText;
+
+	QVector<qint8> m_precision;
+	std::vector<char> m_buffer;
+	qint32 m_size;
+};
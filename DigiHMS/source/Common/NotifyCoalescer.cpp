@@ -0,0 +1,173 @@
+﻿#include "NotifyCoalescer.h"
+#include "TimerEvents.h"
+
+namespace
+{
+	/// <summary>
+	/// 默认刷新周期 (毫秒) 约 60 Hz
+	/// </summary>
+	const qint32 DefaultInterval = 16;
+}
+
+NotifyCoalescer::NotifyCoalescer()
+	: m_nextId(1)
+	, m_consumerId(0)
+	, m_interval(DefaultInterval)
+	, m_notifications(0)
+	, m_deliveries(0)
+{
+	m_consumerId = TimerEvents::Instance().RegisterConsumer("NotifyCoalescer", m_interval, [this]() {
+		flush();
+	});
+	TimerEvents::Instance().SetConsumerActive(m_consumerId, false);
+}
+
+NotifyCoalescer& NotifyCoalescer::Instance()
+{
+	static NotifyCoalescer singleton;
+	return singleton;
+}
+
+void NotifyCoalescer::Disconnect(qint32 id)
+{
+	const auto it = m_targets.find(id);
+	if (it == m_targets.end())
+		return;
+
+	const auto source = it.value().source;
+	m_targets.erase(it);
+
+	auto sourceIt = m_sources.find(source);
+	if (sourceIt == m_sources.end())
+		return;
+
+	sourceIt.value().targets.removeAll(id);
+	if (sourceIt.value().targets.isEmpty())
+		removeSource(source);
+}
+
+qint32 NotifyCoalescer::Interval() const
+{
+	return m_interval;
+}
+
+void NotifyCoalescer::SetInterval(qint32 intervalMs)
+{
+	intervalMs = qMax(intervalMs, 1);
+	if (m_interval == intervalMs)
+		return;
+
+	m_interval = intervalMs;
+	TimerEvents::Instance().SetConsumerPeriod(m_consumerId, m_interval);
+}
+
+quint64 NotifyCoalescer::Notifications() const
+{
+	return m_notifications;
+}
+
+quint64 NotifyCoalescer::Deliveries() const
+{
+	return m_deliveries;
+}
+
+void NotifyCoalescer::flush()
+{
+	// 没有脏信号时停止刷新 直到下一次 markDirty
+	TimerEvents::Instance().SetConsumerActive(m_consumerId, false);
+	if (m_dirty.isEmpty())
+		return;
+
+	// 接收者中可能再次触发源信号 新的变化留到下一帧
+	QVector<qint32> dirty;
+	dirty.swap(m_dirty);
+
+	QVector<std::function<void()>> callbacks;
+	for (auto source : dirty)
+	{
+		auto it = m_sources.find(source);
+		if (it == m_sources.end())
+			continue;
+
+		it.value().dirty = false;
+		for (auto id : it.value().targets)
+		{
+			const auto& target = m_targets[id];
+			if (!target.context.isNull())
+				callbacks.append(target.callback);
+		}
+	}
+
+	// 回调中可能连接或断开 因此先复制回调
+	for (const auto& callback : callbacks)
+		callback();
+
+	m_deliveries += callbacks.count();
+}
+
+qint32 NotifyCoalescer::findSource(const QObject* sender, qint32 signalIndex) const
+{
+	for (auto it = m_sources.constBegin(); it != m_sources.constEnd(); ++it)
+	{
+		if (it.value().sender == sender && it.value().signalIndex == signalIndex)
+			return it.key();
+	}
+
+	return 0;
+}
+
+qint32 NotifyCoalescer::addSource(const QObject* sender, qint32 signalIndex)
+{
+	const auto id = m_nextId++;
+	m_sources.insert(id, Source{ sender, signalIndex, false, {}, {} });
+
+	connect(sender, &QObject::destroyed, this, [this, id]() {
+		removeSource(id);
+	});
+
+	return id;
+}
+
+qint32 NotifyCoalescer::addTarget(qint32 source, const QObject* context, std::function<void()> callback)
+{
+	const auto id = m_nextId++;
+	m_targets.insert(id, Target{ source, context, std::move(callback) });
+	m_sources[source].targets.append(id);
+
+	if (context)
+	{
+		connect(context, &QObject::destroyed, this, [this, id]() {
+			Disconnect(id);
+		});
+	}
+
+	return id;
+}
+
+void NotifyCoalescer::removeSource(qint32 source)
+{
+	const auto it = m_sources.find(source);
+	if (it == m_sources.end())
+		return;
+
+	disconnect(it.value().connection);
+	for (auto id : it.value().targets)
+		m_targets.remove(id);
+
+	m_sources.erase(it);
+	m_dirty.removeAll(source);
+}
+
+void NotifyCoalescer::markDirty(qint32 source)
+{
+	m_notifications++;
+
+	// 同一帧内重复的通知只记录一次
+	auto it = m_sources.find(source);
+	if (it == m_sources.end() || it.value().dirty)
+		return;
+
+	it.value().dirty = true;
+	m_dirty.append(source);
+	TimerEvents::Instance().SetConsumerActive(m_consumerId, true);
+}
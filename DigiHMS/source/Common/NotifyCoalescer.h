@@ -0,0 +1,127 @@
+﻿#pragma once
+
+#include <QObject>
+#include <QHash>
+#include <QMetaMethod>
+#include <QPointer>
+#include <QVector>
+#include <functional>
+
+/// <summary>
+/// 属性变化通知合并器
+/// <para>源信号 (如 receivedBytesChanged / connectedChanged / Serial 的 *Changed) 触发时只标记为脏</para>
+/// <para>由 TimerEvents 以显示刷新频率统一刷新, 每个源信号每帧最多通知一次接收者</para>
+/// <para>无论源信号触发多快, 界面的更新开销都不超过刷新频率; 没有脏信号时不占用定时器</para>
+/// </summary>
+class NotifyCoalescer : public QObject
+{
+	Q_OBJECT
+
+public:
+	static NotifyCoalescer& Instance();
+
+	/// <summary>
+	/// 以合并方式连接无参数的通知信号
+	/// <para>slot 在下一次刷新时于合并器所在线程调用; sender 或 context 销毁时自动断开</para>
+	/// </summary>
+	/// <param name="sender">信号发送者</param>
+	/// <param name="signal">通知信号</param>
+	/// <param name="context">接收者上下文</param>
+	/// <param name="slot">接收函数</param>
+	/// <returns>连接 ID</returns>
+	template <typename Signal, typename Slot>
+	qint32 Connect(const typename QtPrivate::FunctionPointer<Signal>::Object* sender, Signal signal, const QObject* context, Slot slot)
+	{
+		static_assert(QtPrivate::FunctionPointer<Signal>::ArgumentCount == 0, "only parameterless notify signals can be coalesced");
+
+		const auto signalIndex = QMetaMethod::fromSignal(signal).methodIndex();
+		auto source = findSource(sender, signalIndex);
+		if (source == 0)
+		{
+			source = addSource(sender, signalIndex);
+			m_sources[source].connection = connect(sender, signal, this, [this, source]() {
+				markDirty(source);
+			});
+		}
+
+		return addTarget(source, context, std::function<void()>(std::move(slot)));
+	}
+	/// <summary>
+	/// 断开合并连接 (源信号没有其他接收者时一并断开源信号)
+	/// </summary>
+	/// <param name="id">连接 ID</param>
+	void Disconnect(qint32 id);
+
+	/// <summary>
+	/// 获取刷新周期 (毫秒)
+	/// </summary>
+	/// <returns>刷新周期</returns>
+	qint32 Interval() const;
+	/// <summary>
+	/// 设置刷新周期 (通常为显示器的帧间隔)
+	/// </summary>
+	/// <param name="intervalMs">刷新周期 (毫秒)</param>
+	void SetInterval(qint32 intervalMs);
+
+	/// <summary>
+	/// 获取累计收到的源信号数量 (用于诊断)
+	/// </summary>
+	/// <returns>信号数量</returns>
+	quint64 Notifications() const;
+	/// <summary>
+	/// 获取累计调用接收者的次数 (用于诊断)
+	/// </summary>
+	/// <returns>调用次数</returns>
+	quint64 Deliveries() const;
+
+public slots:
+	/// <summary>
+	/// 立即通知所有脏信号的接收者
+	/// </summary>
+	void flush();
+
+private:
+	NotifyCoalescer();
+	NotifyCoalescer(NotifyCoalescer&&) = delete;
+	NotifyCoalescer(const NotifyCoalescer&) = delete;
+	NotifyCoalescer& operator=(NotifyCoalescer&&) = delete;
+	NotifyCoalescer& operator=(const NotifyCoalescer&) = delete;
+
+	struct Source
+	{
+		const QObject* sender;
+		qint32 signalIndex;
+		bool dirty;
+		QVector<qint32> targets;
+		QMetaObject::Connection connection;
+	};
+
+	struct Target
+	{
+		qint32 source;
+		QPointer<const QObject> context;
+		std::function<void()> callback;
+	};
+
+	qint32 findSource(const QObject* sender, qint32 signalIndex) const;
+	qint32 addSource(const QObject* sender, qint32 signalIndex);
+	qint32 addTarget(qint32 source, const QObject* context, std::function<void()> callback);
+	void removeSource(qint32 source);
+	void markDirty(qint32 source);
+
+private:
+	QHash<qint32, Source> m_sources;
+	QHash<qint32, Target> m_targets;
+	qint32 m_nextId;
+
+	/// <summary>
+	/// 按首次变脏的顺序排列的源 ID
+	/// </summary>
+	QVector<qint32> m_dirty;
+
+	qint32 m_consumerId;
+	qint32 m_interval;
+
+	quint64 m_notifications;
+	quint64 m_deliveries;
+};
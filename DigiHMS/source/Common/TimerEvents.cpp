@@ -1,5 +1,27 @@
 ﻿#include "TimerEvents.h"
 #include <QTimerEvent>
+#include <QMetaMethod>
+#include <QVarLengthArray>
+#include <QtMath>
+#include <limits>
+
+/// <summary>
+/// 消费者允许提前触发的容差: 周期的 1/10, 最大 20 毫秒
+/// </summary>
+static qint64 SlackForPeriod(qint64 periodNs)
+{
+	return qMin<qint64>(periodNs / 10, 20 * 1000 * 1000);
+}
+
+TimerEvents::TimerEvents()
+	: m_nextId(1)
+	, m_enabled(false)
+	, m_consumer1Hz(0)
+	, m_consumer10Hz(0)
+	, m_consumer20Hz(0)
+{
+	m_clock.start();
+}
 
 TimerEvents& TimerEvents::Instance()
 {
@@ -7,26 +29,278 @@ TimerEvents& TimerEvents::Instance()
 	return singleton;
 }
 
+qint32 TimerEvents::RegisterConsumer(const QString& name, qint32 periodMs, std::function<void()> callback)
+{
+	Q_ASSERT(periodMs > 0);
+
+	Consumer consumer;
+	consumer.id = m_nextId++;
+	consumer.name = name;
+	consumer.periodNs = qMax(periodMs, 1) * qint64(1000000);
+	consumer.slackNs = SlackForPeriod(consumer.periodNs);
+	consumer.deadlineNs = m_clock.nsecsElapsed() + consumer.periodNs;
+	consumer.active = true;
+	consumer.callback = std::move(callback);
+	consumer.ticks = 0;
+	consumer.jitterMean = 0;
+	consumer.jitterM2 = 0;
+	consumer.jitterMax = 0;
+
+	// 与已有的同周期消费者对齐相位 便于合并唤醒
+	for (const auto& other : m_consumers)
+	{
+		if (other.active && other.periodNs == consumer.periodNs)
+		{
+			consumer.deadlineNs = other.deadlineNs;
+			break;
+		}
+	}
+
+	m_consumers.append(consumer);
+	reschedule();
+
+	return consumer.id;
+}
+
+void TimerEvents::UnregisterConsumer(qint32 id)
+{
+	for (auto i = 0; i < m_consumers.count(); ++i)
+	{
+		if (m_consumers.at(i).id == id)
+		{
+			m_consumers.remove(i);
+			break;
+		}
+	}
+
+	reschedule();
+}
+
+void TimerEvents::SetConsumerPeriod(qint32 id, qint32 periodMs)
+{
+	Q_ASSERT(periodMs > 0);
+
+	auto consumer = findConsumer(id);
+	if (consumer)
+	{
+		consumer->periodNs = qMax(periodMs, 1) * qint64(1000000);
+		consumer->slackNs = SlackForPeriod(consumer->periodNs);
+		consumer->deadlineNs = m_clock.nsecsElapsed() + consumer->periodNs;
+		reschedule();
+	}
+}
+
+void TimerEvents::SetConsumerActive(qint32 id, bool active)
+{
+	auto consumer = findConsumer(id);
+	if (consumer && consumer->active != active)
+	{
+		consumer->active = active;
+		if (active)
+			consumer->deadlineNs = m_clock.nsecsElapsed() + consumer->periodNs;
+
+		reschedule();
+	}
+}
+
+TimerEvents::JitterStats TimerEvents::ConsumerJitter(qint32 id) const
+{
+	JitterStats stats;
+
+	auto consumer = findConsumer(id);
+	if (consumer && consumer->ticks > 0)
+	{
+		stats.ticks = consumer->ticks;
+		stats.meanMs = consumer->jitterMean / 1e6;
+		stats.maxMs = consumer->jitterMax / 1e6;
+		if (consumer->ticks > 1)
+			stats.stdDevMs = qSqrt(consumer->jitterM2 / (consumer->ticks - 1)) / 1e6;
+	}
+
+	return stats;
+}
+
+QString TimerEvents::JitterReport() const
+{
+	QString report;
+	for (const auto& consumer : m_consumers)
+	{
+		auto stats = ConsumerJitter(consumer.id);
+		report += QString("%1 (%2 ms): ticks=%3 mean=%4 ms max=%5 ms stddev=%6 ms\n")
+			.arg(consumer.name)
+			.arg(consumer.periodNs / 1000000)
+			.arg(stats.ticks)
+			.arg(stats.meanMs, 0, 'f', 3)
+			.arg(stats.maxMs, 0, 'f', 3)
+			.arg(stats.stdDevMs, 0, 'f', 3);
+	}
+
+	return report;
+}
+
+bool TimerEvents::IsRunning() const
+{
+	return m_timer.isActive();
+}
+
 void TimerEvents::timerEvent(QTimerEvent* event)
 {
-	if (event->timerId() == m_timer1Hz.timerId())
-		emit timeout1Hz();
-	if (event->timerId() == m_timer10Hz.timerId())
-		emit timeout10Hz();
-	if (event->timerId() == m_timer20Hz.timerId())
-		emit timeout20Hz();
+	if (event->timerId() != m_timer.timerId())
+		return;
+
+	m_timer.stop();
+
+	// 以最早的 "到期时间 + 容差" 为基准 合并所有在此之前到期的消费者
+	const auto now = m_clock.nsecsElapsed();
+	QVarLengthArray<qint32, 8> due;
+	for (const auto& consumer : m_consumers)
+	{
+		if (consumer.active && consumer.deadlineNs - consumer.slackNs <= now)
+			due.append(consumer.id);
+	}
+
+	for (auto id : due)
+	{
+		auto consumer = findConsumer(id);
+		if (consumer == Q_NULLPTR)
+			continue;
+
+		// 更新抖动统计 (Welford 算法)
+		// 容差内的提前触发是调度器有意合并的结果 只统计晚于到期时间的部分
+		const double jitter = qMax<qint64>(0, now - consumer->deadlineNs);
+		consumer->ticks++;
+		const auto delta = jitter - consumer->jitterMean;
+		consumer->jitterMean += delta / consumer->ticks;
+		consumer->jitterM2 += delta * (jitter - consumer->jitterMean);
+		consumer->jitterMax = qMax(consumer->jitterMax, jitter);
+
+		// 保持相位 落后超过一个周期时重新对齐
+		consumer->deadlineNs += consumer->periodNs;
+		if (consumer->deadlineNs <= now)
+			consumer->deadlineNs = now + consumer->periodNs;
+
+		// 回调中可能注册或注销消费者 因此先复制回调
+		auto callback = consumer->callback;
+		if (callback)
+			callback();
+	}
+
+	reschedule();
+}
+
+void TimerEvents::connectNotify(const QMetaMethod& signal)
+{
+	Q_UNUSED(signal);
+	updateLegacyConsumers();
+}
+
+void TimerEvents::disconnectNotify(const QMetaMethod& signal)
+{
+	Q_UNUSED(signal);
+	updateLegacyConsumers();
+}
+
+TimerEvents::Consumer* TimerEvents::findConsumer(qint32 id)
+{
+	for (auto& consumer : m_consumers)
+	{
+		if (consumer.id == id)
+			return &consumer;
+	}
+
+	return Q_NULLPTR;
+}
+
+const TimerEvents::Consumer* TimerEvents::findConsumer(qint32 id) const
+{
+	for (const auto& consumer : m_consumers)
+	{
+		if (consumer.id == id)
+			return &consumer;
+	}
+
+	return Q_NULLPTR;
+}
+
+void TimerEvents::reschedule()
+{
+	if (!m_enabled)
+	{
+		m_timer.stop();
+		return;
+	}
+
+	// 选择最早的 "到期时间 + 容差" 作为唤醒时间
+	// 使容差窗口重叠的消费者在同一次唤醒中执行
+	auto wakeup = std::numeric_limits<qint64>::max();
+	for (const auto& consumer : m_consumers)
+	{
+		if (consumer.active)
+			wakeup = qMin(wakeup, consumer.deadlineNs + consumer.slackNs);
+	}
+
+	// 没有活动的消费者 完全停止定时器
+	if (wakeup == std::numeric_limits<qint64>::max())
+	{
+		m_timer.stop();
+		return;
+	}
+
+	// 向上取整到毫秒 不足 1 ms 时若舍为 0 ms, 尚未到期的消费者会使定时器空转
+	const auto now = m_clock.nsecsElapsed();
+	const auto delayMs = qMax<qint64>(0, (wakeup - now + 999999) / 1000000);
+	m_timer.start(static_cast<int>(delayMs), Qt::PreciseTimer, this);
+}
+
+void TimerEvents::updateLegacyConsumers()
+{
+	struct Legacy
+	{
+		void (TimerEvents::*signal)();
+		qint32 periodMs;
+		const char* name;
+		qint32* id;
+	};
+
+	const Legacy legacy[] = {
+		{ &TimerEvents::timeout1Hz, 1000, "timeout1Hz", &m_consumer1Hz },
+		{ &TimerEvents::timeout10Hz, 100, "timeout10Hz", &m_consumer10Hz },
+		{ &TimerEvents::timeout20Hz, 20, "timeout20Hz", &m_consumer20Hz },
+	};
+
+	// 只有信号被连接时才注册对应的消费者
+	for (const auto& item : legacy)
+	{
+		const auto connected = isSignalConnected(QMetaMethod::fromSignal(item.signal));
+		if (connected && *item.id == 0)
+		{
+			auto signal = item.signal;
+			*item.id = RegisterConsumer(item.name, item.periodMs, [this, signal]() {
+				emit (this->*signal)();
+			});
+		}
+		else if (!connected && *item.id != 0)
+		{
+			UnregisterConsumer(*item.id);
+			*item.id = 0;
+		}
+	}
 }
 
 void TimerEvents::startTimers()
 {
-	m_timer1Hz.start(1000, this);
-	m_timer10Hz.start(100, this);
-	m_timer20Hz.start(20, this);
+	m_enabled = true;
+
+	// 重新开始计时 避免停止期间累积的到期
+	const auto now = m_clock.nsecsElapsed();
+	for (auto& consumer : m_consumers)
+		consumer.deadlineNs = now + consumer.periodNs;
+
+	reschedule();
 }
 
 void TimerEvents::stopTimers()
 {
-	m_timer1Hz.stop();
-	m_timer10Hz.stop();
-	m_timer20Hz.stop();
+	m_enabled = false;
+	m_timer.stop();
 }
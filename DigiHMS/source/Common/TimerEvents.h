@@ -2,36 +2,137 @@
 
 #include <QObject>
 #include <QBasicTimer>
+#include <QElapsedTimer>
+#include <QVector>
+#include <functional>
 
+/// <summary>
+/// 自适应定时调度器
+/// <para>所有消费者共享一个定时器, 每次唤醒时合并执行容差范围内到期的消费者</para>
+/// <para>没有活动的消费者时定时器完全停止</para>
+/// </summary>
 class TimerEvents  : public QObject
 {
 	Q_OBJECT
 
 public:
+	/// <summary>
+	/// 消费者触发抖动统计 (实际触发时间晚于期望触发时间的部分, 提前触发计为 0)
+	/// </summary>
+	struct JitterStats
+	{
+		quint64 ticks = 0;
+		double meanMs = 0;
+		double maxMs = 0;
+		double stdDevMs = 0;
+	};
+
 	static TimerEvents& Instance();
 
+	/// <summary>
+	/// 注册定时消费者
+	/// </summary>
+	/// <param name="name">消费者名称 (用于统计输出)</param>
+	/// <param name="periodMs">期望周期 (毫秒)</param>
+	/// <param name="callback">到期回调 在调度器所在线程执行</param>
+	/// <returns>消费者 ID</returns>
+	qint32 RegisterConsumer(const QString& name, qint32 periodMs, std::function<void()> callback);
+	/// <summary>
+	/// 注销定时消费者
+	/// </summary>
+	/// <param name="id">消费者 ID</param>
+	void UnregisterConsumer(qint32 id);
+	/// <summary>
+	/// 修改消费者周期
+	/// </summary>
+	/// <param name="id">消费者 ID</param>
+	/// <param name="periodMs">期望周期 (毫秒)</param>
+	void SetConsumerPeriod(qint32 id, qint32 periodMs);
+	/// <summary>
+	/// 暂停或恢复消费者
+	/// </summary>
+	/// <param name="id">消费者 ID</param>
+	/// <param name="active">是否活动</param>
+	void SetConsumerActive(qint32 id, bool active);
+	/// <summary>
+	/// 获取消费者抖动统计
+	/// </summary>
+	/// <param name="id">消费者 ID</param>
+	/// <returns>抖动统计</returns>
+	JitterStats ConsumerJitter(qint32 id) const;
+	/// <summary>
+	/// 获取所有消费者的抖动统计文本 (每行一个消费者)
+	/// </summary>
+	/// <returns>统计文本</returns>
+	QString JitterReport() const;
+	/// <summary>
+	/// 获取调度定时器当前是否在运行
+	/// </summary>
+	/// <returns>运行状态</returns>
+	bool IsRunning() const;
+
 protected:
 	void timerEvent(QTimerEvent* event) override;
+	void connectNotify(const QMetaMethod& signal) override;
+	void disconnectNotify(const QMetaMethod& signal) override;
 
 private:
-	TimerEvents() {};
+	TimerEvents();
 	TimerEvents(TimerEvents&&) = delete;
 	TimerEvents(const TimerEvents&) = delete;
 	TimerEvents& operator=(TimerEvents&&) = delete;
 	TimerEvents& operator=(const TimerEvents&) = delete;
 
+	struct Consumer
+	{
+		qint32 id;
+		QString name;
+		qint64 periodNs;
+		qint64 slackNs;
+		qint64 deadlineNs;
+		bool active;
+		std::function<void()> callback;
+
+		quint64 ticks;
+		double jitterMean;
+		double jitterM2;
+		double jitterMax;
+	};
+
+	Consumer* findConsumer(qint32 id);
+	const Consumer* findConsumer(qint32 id) const;
+	/// <summary>
+	/// 根据所有活动消费者的到期时间重新设置定时器
+	/// </summary>
+	void reschedule();
+	/// <summary>
+	/// 根据信号连接状态注册或注销 timeout1Hz/10Hz/20Hz 的内部消费者
+	/// </summary>
+	void updateLegacyConsumers();
+
 signals:
 	void timeout1Hz();
 	void timeout10Hz();
 	void timeout20Hz();
 
 public slots:
+	/// <summary>
+	/// 开启调度 (仅在存在活动消费者时才会启动定时器)
+	/// </summary>
 	void startTimers();
+	/// <summary>
+	/// 停止调度
+	/// </summary>
 	void stopTimers();
 
 private:
-	QBasicTimer m_timer1Hz;
-	QBasicTimer m_timer10Hz;
-	QBasicTimer m_timer20Hz;
+	QBasicTimer m_timer;
+	QElapsedTimer m_clock;
+	QVector<Consumer> m_consumers;
+	qint32 m_nextId;
+	bool m_enabled;
 
+	qint32 m_consumer1Hz;
+	qint32 m_consumer10Hz;
+	qint32 m_consumer20Hz;
 };
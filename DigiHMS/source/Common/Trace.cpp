@@ -0,0 +1,172 @@
+﻿#include "Trace.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#if defined(DIGIHMS_TRACE_TSC)
+#if defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#else
+#undef DIGIHMS_TRACE_TSC
+#endif
+#endif
+
+namespace Trace
+{
+	static_assert((kThreadBufferEvents & (kThreadBufferEvents - 1)) == 0,
+		"kThreadBufferEvents must be a power of two");
+
+	/// <summary>
+	/// 单个线程的事件环形缓冲区
+	/// <para>只有所属线程写入, 导出时由其他线程读取</para>
+	/// </summary>
+	struct ThreadBuffer
+	{
+		uint32_t threadIndex = 0;
+		std::atomic<uint64_t> head{ 0 };
+		Event events[kThreadBufferEvents];
+	};
+
+	/// <summary>
+	/// 所有线程缓冲区的注册表
+	/// <para>缓冲区在进程结束前不会释放, 以便线程退出后仍可导出</para>
+	/// </summary>
+	struct Registry
+	{
+		std::mutex mutex;
+		std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+		uint64_t originTicks = 0;
+		std::chrono::steady_clock::time_point originTime;
+	};
+
+	static Registry& GetRegistry()
+	{
+		static Registry registry;
+		return registry;
+	}
+
+	static ThreadBuffer* CreateThreadBuffer()
+	{
+		auto& registry = GetRegistry();
+		std::lock_guard<std::mutex> lock(registry.mutex);
+
+		// 第一个缓冲区创建时记录时间原点 用于 TSC 换算
+		if (registry.buffers.empty())
+		{
+			registry.originTicks = Now();
+			registry.originTime = std::chrono::steady_clock::now();
+		}
+
+		auto buffer = std::make_unique<ThreadBuffer>();
+		buffer->threadIndex = static_cast<uint32_t>(registry.buffers.size() + 1);
+		registry.buffers.push_back(std::move(buffer));
+		return registry.buffers.back().get();
+	}
+
+	uint64_t Now()
+	{
+#if defined(DIGIHMS_TRACE_TSC)
+		return __rdtsc();
+#else
+		return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+	}
+
+	void Record(EventId id, Phase phase, uint32_t payload)
+	{
+		thread_local ThreadBuffer* buffer = CreateThreadBuffer();
+
+		const auto head = buffer->head.load(std::memory_order_relaxed);
+		auto& event = buffer->events[head & (kThreadBufferEvents - 1)];
+		event.timestamp = Now();
+		event.id = static_cast<uint16_t>(id);
+		event.phase = static_cast<uint8_t>(phase);
+		event.reserved = 0;
+		event.payload = payload;
+		buffer->head.store(head + 1, std::memory_order_release);
+	}
+
+	const char* EventName(EventId id)
+	{
+		static const char* names[] = {
+			"Serial::onReadyRead",
+			"Manager::onDataReceived",
+			"Manager::readFrames",
+			"Manager::frameReceived",
+		};
+		static_assert(sizeof(names) / sizeof(names[0]) == static_cast<size_t>(EventId::Count),
+			"Trace event name table is out of date");
+
+		const auto index = static_cast<size_t>(id);
+		if (index < static_cast<size_t>(EventId::Count))
+			return names[index];
+
+		return "Unknown";
+	}
+
+	void Reset()
+	{
+		auto& registry = GetRegistry();
+		std::lock_guard<std::mutex> lock(registry.mutex);
+		for (auto& buffer : registry.buffers)
+			buffer->head.store(0, std::memory_order_release);
+	}
+
+	bool ExportChromeJson(const std::string& path)
+	{
+		auto& registry = GetRegistry();
+		std::lock_guard<std::mutex> lock(registry.mutex);
+
+		auto file = std::fopen(path.c_str(), "wb");
+		if (file == nullptr)
+			return false;
+
+		// 计算时间戳到微秒的换算系数
+		double ticksPerMicrosecond = 1000.0;
+#if defined(DIGIHMS_TRACE_TSC)
+		const auto elapsedTicks = Now() - registry.originTicks;
+		const auto elapsedTime = std::chrono::duration<double, std::micro>(
+			std::chrono::steady_clock::now() - registry.originTime).count();
+		if (elapsedTime > 0)
+			ticksPerMicrosecond = elapsedTicks / elapsedTime;
+#endif
+
+		static const char phases[] = { 'B', 'E', 'i' };
+
+		std::fputs("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[", file);
+
+		bool first = true;
+		for (const auto& buffer : registry.buffers)
+		{
+			const auto head = buffer->head.load(std::memory_order_acquire);
+			const auto begin = head > kThreadBufferEvents ? head - kThreadBufferEvents : 0;
+
+			for (auto i = begin; i < head; ++i)
+			{
+				const auto& event = buffer->events[i & (kThreadBufferEvents - 1)];
+				const auto timestamp = (event.timestamp - registry.originTicks) / ticksPerMicrosecond;
+
+				std::fprintf(file,
+					"%s{\"name\":\"%s\",\"cat\":\"DigiHMS\",\"ph\":\"%c\",\"ts\":%.3f,"
+					"\"pid\":1,\"tid\":%u%s,\"args\":{\"bytes\":%u}}",
+					first ? "" : ",\n",
+					EventName(static_cast<EventId>(event.id)),
+					phases[event.phase < 3 ? event.phase : 2],
+					timestamp,
+					buffer->threadIndex,
+					event.phase == static_cast<uint8_t>(Phase::Instant) ? ",\"s\":\"t\"" : "",
+					event.payload);
+				first = false;
+			}
+		}
+
+		std::fputs("]}\n", file);
+		return std::fclose(file) == 0;
+	}
+}
@@ -0,0 +1,121 @@
+﻿#pragma once
+
+#include <cstdint>
+#include <string>
+
+/**
+ * 热路径追踪
+ *
+ * 定义 DIGIHMS_ENABLE_TRACE 后 TRACE_SCOPE / TRACE_INSTANT 才会记录事件,
+ * 否则宏展开为空语句, 参数表达式也不会被求值。
+ * 定义 DIGIHMS_TRACE_TSC 时在 x86 平台使用 TSC 作为时间戳, 否则使用 steady_clock。
+ */
+namespace Trace
+{
+	/// <summary>
+	/// 追踪事件 ID
+	/// <para>新增事件时需同步更新 Trace.cpp 中的名称表</para>
+	/// </summary>
+	enum class EventId : uint16_t
+	{
+		SerialReadyRead,
+		ManagerDataReceived,
+		ManagerReadFrames,
+		ManagerFrameReceived,
+		Count
+	};
+
+	enum class Phase : uint8_t
+	{
+		Begin,
+		End,
+		Instant
+	};
+
+	/// <summary>
+	/// 固定 16 字节的二进制事件
+	/// </summary>
+	struct Event
+	{
+		uint64_t timestamp;
+		uint16_t id;
+		uint8_t phase;
+		uint8_t reserved;
+		uint32_t payload;
+	};
+	static_assert(sizeof(Event) == 16, "Trace::Event must stay 16 bytes");
+
+	/// <summary>
+	/// 每个线程环形缓冲区可容纳的事件数量 (必须为 2 的幂)
+	/// </summary>
+	constexpr uint32_t kThreadBufferEvents = 1u << 14;
+
+	/// <summary>
+	/// 获取当前时间戳 (TSC 周期或 steady_clock 纳秒)
+	/// </summary>
+	/// <returns>时间戳</returns>
+	uint64_t Now();
+	/// <summary>
+	/// 将事件写入当前线程的环形缓冲区
+	/// <para>缓冲区写满后覆盖最旧的事件</para>
+	/// </summary>
+	/// <param name="id">事件 ID</param>
+	/// <param name="phase">事件阶段</param>
+	/// <param name="payload">负载长度</param>
+	void Record(EventId id, Phase phase, uint32_t payload);
+	/// <summary>
+	/// 获取事件名称
+	/// </summary>
+	/// <param name="id">事件 ID</param>
+	/// <returns>事件名称</returns>
+	const char* EventName(EventId id);
+	/// <summary>
+	/// 清空所有线程的缓冲区
+	/// <para>仅应在没有线程正在记录时调用</para>
+	/// </summary>
+	void Reset();
+	/// <summary>
+	/// 导出全部事件为 Chrome trace JSON (chrome://tracing 与 Perfetto UI 均可打开)
+	/// <para>仅应在没有线程正在记录时调用</para>
+	/// </summary>
+	/// <param name="path">输出文件路径</param>
+	/// <returns>导出结果</returns>
+	bool ExportChromeJson(const std::string& path);
+
+	/// <summary>
+	/// 作用域事件, 构造时记录 Begin, 析构时记录 End
+	/// </summary>
+	class Scope
+	{
+	public:
+		Scope(EventId id, uint32_t payload)
+			: m_id(id)
+		{
+			Record(m_id, Phase::Begin, payload);
+		}
+
+		~Scope()
+		{
+			Record(m_id, Phase::End, 0);
+		}
+
+		Scope(const Scope&) = delete;
+		Scope& operator=(const Scope&) = delete;
+
+	private:
+		EventId m_id;
+	};
+}
+
+#define TRACE_CONCAT_IMPL(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_IMPL(a, b)
+
+#ifdef DIGIHMS_ENABLE_TRACE
+#define TRACE_SCOPE(id, payload) \
+	Trace::Scope TRACE_CONCAT(traceScope_, __LINE__)(Trace::EventId::id, static_cast<uint32_t>(payload))
+#define TRACE_INSTANT(id, payload) \
+	Trace::Record(Trace::EventId::id, Trace::Phase::Instant, static_cast<uint32_t>(payload))
+#else
+#define TRACE_SCOPE(id, payload) ((void)0)
+#define TRACE_INSTANT(id, payload) ((void)0)
+#endif
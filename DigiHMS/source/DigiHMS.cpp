@@ -1,13 +1,229 @@
 ﻿#include "DigiHMS.h"
 #include <TrayIcon/TrayIcon.h>
+#include <TrayIcon/TrayMenuModel.h>
+#include <IO/Serial/Serial.h>
+#include <Common/Utilities.h>
+#include <Common/TimerEvents.h>
+#include <Common/NotifyCoalescer.h>
+#include <Sensor/SensorSampler.h>
+#include <Sensor/SensorHistory.h>
+#include <Sensor/HistoryWriter.h>
+#include <Sensor/PayloadPublisher.h>
+#include <Sensor/FanControl.h>
+#include <Sensor/AlertEngine.h>
+#include <Sensor/SnapshotPublisher.h>
+#include <Sensor/MetricsExporter.h>
+#include <IO/Manager/Manager.h>
+#include <IO/Manager/RpcChannel.h>
+#include <QDate>
+#include <QDebug>
+#include <QDir>
+#include <QGuiApplication>
+#include <QScreen>
+#include <QSettings>
+#include <QStandardPaths>
+#include <QtMath>
+#include <limits>
+#ifdef DIGIHMS_WITH_LHM
+#include <Sensor/LhmSensorSource.h>
+#endif
+#ifdef Q_OS_LINUX
+#include <Sensor/HwmonSensorSource.h>
+#endif
 
 DigiHMS::DigiHMS()
+	: m_fans(Q_NULLPTR)
+	, m_lhm(Q_NULLPTR)
+	, m_snapshotPublisher(Q_NULLPTR)
+	, m_metrics(Q_NULLPTR)
 {
 	m_trayIcon = new TrayIcon(this);
-	m_trayIcon->AddAction("COM1", this, SLOT(Test()));
+
+	// 新的波特率添加成功后弹出消息框
+	connect(&Serial::Instance(), &Serial::baudRateRegistered, this, [](const QString& baudRate) {
+		Utilities::ShowMessageBox(Serial::tr("Baud rate registered successfully"),
+			Serial::tr("Rate \"%1\" has been added to baud rate list").arg(baudRate));
+	});
+
+	// 开启定时调度 (没有活动的消费者时不会产生唤醒)
+	TimerEvents::Instance().startTimers();
+
+	// 属性变化通知按显示器刷新率合并
+	if (auto screen = QGuiApplication::primaryScreen())
+		NotifyCoalescer::Instance().SetInterval(qMax(qFloor(1000.0 / qMax(screen->refreshRate(), 1.0)), 1));
+
+	// 传感器采样与历史记录
+#ifdef DIGIHMS_WITH_LHM
+	m_lhm = new LhmSensorSource();
+	SensorSampler::Instance().AddSource(m_lhm);
+#endif
+#ifdef Q_OS_LINUX
+	SensorSampler::Instance().AddSource(new HwmonSensorSource());
+#endif
+	m_history = new SensorHistory();
+	SensorSampler::Instance().AddConsumer(m_history);
+
+	// 持久化历史 按日期分文件 同一天多次运行时追加
+	HistoryWriterConfig historyConfig;
+	const auto historyDir = QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation) + "/History";
+	QDir().mkpath(historyDir);
+	historyConfig.path = historyDir + QString("/DigiHMS-%1.dhh").arg(QDate::currentDate().toString("yyyyMMdd"));
+	m_historyWriter = new HistoryWriter(historyConfig, this);
+	if (m_historyWriter->Open())
+		SensorSampler::Instance().AddConsumer(m_historyWriter);
+	else
+		qWarning() << "History disabled:" << m_historyWriter->ErrorString();
+
+	// 风扇曲线 在历史记录之后运行 以便使用平滑后的温度
+#ifdef DIGIHMS_WITH_LHM
+	m_fans = new FanController(new LhmFanBackend(m_lhm->Monitor()), m_history);
+	m_fans->SetChannels(FanChannel::FromVariant(QSettings().value("Fan_Channels").toList()));
+	SensorSampler::Instance().AddConsumer(m_fans);
+#endif
+
+	// 写入路径压缩 连接后与设备协商 (设置项 Link_Codecs 按优先级排列, 为空时不压缩)
+	Manager::Instance().setPreferredCodecs(Codec::TypesFromNames(QSettings().value("Link_Codecs", "lzss").toString()));
+
+	// 每次采样后按负载模板向显示设备发送数据
+	m_publisher = new PayloadPublisher(this);
+
+	// 显示设备通过同一链路发送的命令
+	m_rpc = new RpcChannel(this);
+	registerCommands();
+
+	// 阈值告警 通过托盘消息与设备链路通知
+	m_alerts = new AlertEngine(this);
+	connect(m_alerts, &AlertEngine::alertRaised, this, [this](const QString& sensor, const QString& rule, float value) {
+		m_trayIcon->ShowMessage(tr("Alert: %1 = %2 (%3)").arg(sensor).arg(value, 0, 'f', 1).arg(rule));
+		m_rpc->Notify("alert", sensor.toUtf8() + ',' + QByteArray::number(value, 'f', 1));
+	});
+	connect(m_alerts, &AlertEngine::alertCleared, this, [this](const QString& sensor, const QString&, float value) {
+		m_rpc->Notify("clear", sensor.toUtf8() + ',' + QByteArray::number(value, 'f', 1));
+	});
+	SensorSampler::Instance().AddConsumer(m_alerts);
+
+	// 共享内存快照 供本机其他工具读取 (仅 POSIX)
+	m_snapshotPublisher = new SnapshotPublisher();
+	if (m_snapshotPublisher->Open())
+		SensorSampler::Instance().AddConsumer(m_snapshotPublisher);
+
+	// Prometheus 指标 默认仅监听本机 (设置项 Metrics_Address, Metrics_Port)
+	const auto metricsPort = QSettings().value("Metrics_Port", 9810).toUInt();
+	if (metricsPort > 0 && metricsPort <= 65535)
+	{
+		m_metrics = new MetricsExporter(this);
+		if (m_metrics->Start(QHostAddress(QSettings().value("Metrics_Address", "127.0.0.1").toString()), static_cast<quint16>(metricsPort)))
+			SensorSampler::Instance().AddConsumer(m_metrics);
+		else
+			qWarning() << "Metrics disabled:" << m_metrics->ErrorString();
+	}
+
+	// 托盘菜单: 串口列表与传感器读数 (设置项 Tray_MenuSensors)
+	const auto menuSensors = QSettings().value("Tray_MenuSensors", "cpu.temp,cpu.load,gpu.temp,gpu.load,memory.load").toString();
+	m_trayMenu = new TrayMenuModel(m_trayIcon, menuSensors.split(',', Qt::SkipEmptyParts));
+
+	// 托盘实时数值 图标仅在显示文本变化时更新
+	m_traySensor = QSettings().value("Tray_Sensor").toString();
+	if (!m_traySensor.isEmpty())
+		connect(&SensorSampler::Instance(), &SensorSampler::snapshotUpdated, this, &DigiHMS::updateTrayText);
+
+	SensorSampler::Instance().start();
 }
 
 DigiHMS::~DigiHMS()
 {
+	// 先停止采样线程 之后移除并释放的消费者不会再被采样线程调用
+	SensorSampler::Instance().stop();
+
+	// 风扇恢复默认控制 (采样已停止 不会与采样线程中的写入并发)
+	if (m_fans)
+	{
+		SensorSampler::Instance().RemoveConsumer(m_fans);
+		m_fans->RestoreDefaults();
+		delete m_fans;
+	}
+
+	SensorSampler::Instance().RemoveConsumer(m_alerts);
+	SensorSampler::Instance().RemoveConsumer(m_snapshotPublisher);
+	delete m_snapshotPublisher;
+	if (m_metrics)
+	{
+		SensorSampler::Instance().RemoveConsumer(m_metrics);
+		m_metrics->Stop();
+	}
+	SensorSampler::Instance().RemoveConsumer(m_historyWriter);
+	m_historyWriter->Close();
+
+	SensorSampler::Instance().RemoveConsumer(m_history);
+	delete m_history;
+}
+
+void DigiHMS::updateTrayText()
+{
+	const auto snapshot = SensorSampler::Instance().LatestSnapshot();
+	const auto slot = snapshot.Slot(m_traySensor);
+	const auto value = slot < 0 ? qQNaN() : snapshot.Value(slot);
+
+	m_trayIcon->SetText(qIsNaN(value) ? QString() : QString::number(qRound(value)));
+}
+
+void DigiHMS::registerCommands()
+{
+	// rate:<ms> 修改采样周期
+	m_rpc->RegisterHandler("rate", [](const QByteArray& args, const RpcChannel::Reply& reply) {
+		bool ok = false;
+		const auto period = args.toInt(&ok);
+		if (!ok || period < 50 || period > 60 * 1000)
+		{
+			reply(false, "invalid period");
+			return;
+		}
+
+		SensorSampler::Instance().setPeriod(period);
+		reply(true, QByteArray::number(period));
+	});
+
+	// keyframe 立即发送一帧完整数据
+	m_rpc->RegisterHandler("keyframe", [this](const QByteArray&, const RpcChannel::Reply& reply) {
+		m_publisher->publish();
+		reply(true, QByteArray());
+	});
+
+	// fan:<name>,<percent|auto> 设置风扇转速
+	// 风扇曲线控制的通道作为控制器的手动覆盖 (auto 恢复曲线), 否则在采样线程中直接写入以免与读取并发
+	m_rpc->RegisterHandler("fan", [this](const QByteArray& args, const RpcChannel::Reply& reply) {
+		const auto separator = args.lastIndexOf(',');
+		const auto value = separator > 0 ? args.mid(separator + 1).trimmed() : QByteArray();
+		const auto automatic = value == "auto";
+		bool ok = automatic;
+		const auto percent = automatic ? std::numeric_limits<float>::quiet_NaN() : value.toFloat(&ok);
+		if (!ok || percent < 0 || percent > 100)
+		{
+			reply(false, "invalid arguments");
+			return;
+		}
+
+#ifdef DIGIHMS_WITH_LHM
+		const auto control = QString::fromUtf8(args.left(separator));
+		if (m_fans && m_fans->SetOverride(control, percent))
+		{
+			reply(true, QByteArray());
+			return;
+		}
+
+		const auto monitor = m_lhm ? m_lhm->Monitor() : Q_NULLPTR;
+		if (!monitor || automatic)
+		{
+			reply(false, monitor ? "not controlled" : "unavailable");
+			return;
+		}
 
+		const auto name = control.toStdWString();
+		SensorSampler::Instance().Post([monitor, name, percent, reply]() {
+			reply(monitor->SetFanSpeed(name, percent), QByteArray());
+		});
+#else
+		reply(false, "unavailable");
+#endif
+	});
 }
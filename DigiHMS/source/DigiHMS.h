@@ -1,8 +1,19 @@
 ﻿#pragma once
 
 #include <QObject>
+#include <QString>
 
 class TrayIcon;
+class TrayMenuModel;
+class SensorHistory;
+class HistoryWriter;
+class PayloadPublisher;
+class RpcChannel;
+class FanController;
+class AlertEngine;
+class LhmSensorSource;
+class SnapshotPublisher;
+class MetricsExporter;
 
 class DigiHMS : public QObject
 {
@@ -12,9 +23,44 @@ public:
 	DigiHMS();
 	virtual ~DigiHMS();
 	
-public slots:
-	void Test() {};
+private slots:
+	/// <summary>
+	/// 在托盘图标上显示所选传感器的最新读数
+	/// </summary>
+	void updateTrayText();
+
+private:
+	/// <summary>
+	/// 注册显示设备可调用的命令
+	/// </summary>
+	void registerCommands();
 
 private:
 	TrayIcon* m_trayIcon;
+	TrayMenuModel* m_trayMenu;
+	SensorHistory* m_history;
+	HistoryWriter* m_historyWriter;
+	PayloadPublisher* m_publisher;
+	RpcChannel* m_rpc;
+	/// <summary>
+	/// 风扇曲线控制 未启用 LHM 时为空
+	/// </summary>
+	FanController* m_fans;
+	AlertEngine* m_alerts;
+	/// <summary>
+	/// 托盘图标显示的传感器 (设置项 Tray_Sensor, 为空时显示默认图标)
+	/// </summary>
+	QString m_traySensor;
+	/// <summary>
+	/// 由采样器持有 未启用 LHM 时为空
+	/// </summary>
+	LhmSensorSource* m_lhm;
+	/// <summary>
+	/// 共享内存快照 创建失败时不注册为消费者
+	/// </summary>
+	SnapshotPublisher* m_snapshotPublisher;
+	/// <summary>
+	/// Prometheus 指标导出 (设置项 Metrics_Port 为 0 时不启用)
+	/// </summary>
+	MetricsExporter* m_metrics;
 };
\ No newline at end of file
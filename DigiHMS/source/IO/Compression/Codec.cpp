@@ -0,0 +1,151 @@
+﻿#include "Codec.h"
+#include "LzssCodec.h"
+#include "Lz4Codec.h"
+#include <cstring>
+
+std::unique_ptr<Codec> Codec::Create(Type type)
+{
+	switch (type)
+	{
+	case Type::Lzss:
+		return std::unique_ptr<Codec>(new LzssCodec());
+#ifdef DIGIHMS_WITH_LZ4
+	case Type::Lz4:
+		return std::unique_ptr<Codec>(new Lz4Codec());
+#endif
+	default:
+		return Q_NULLPTR;
+	}
+}
+
+QList<Codec::Type> Codec::Available()
+{
+	QList<Type> types{ Type::None, Type::Lzss };
+#ifdef DIGIHMS_WITH_LZ4
+	types.append(Type::Lz4);
+#endif
+	return types;
+}
+
+QString Codec::TypeName(Type type)
+{
+	switch (type)
+	{
+	case Type::None:
+		return "none";
+	case Type::Lzss:
+		return "lzss";
+	case Type::Lz4:
+		return "lz4";
+	default:
+		return QString();
+	}
+}
+
+bool Codec::TypeFromName(const QString& name, Type& type)
+{
+	for (auto candidate : { Type::None, Type::Lzss, Type::Lz4 })
+	{
+		if (name.compare(TypeName(candidate), Qt::CaseInsensitive) == 0)
+		{
+			type = candidate;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+QList<Codec::Type> Codec::TypesFromNames(const QString& names)
+{
+	QList<Type> types;
+	for (const auto& name : names.split(',', Qt::SkipEmptyParts))
+	{
+		Type type;
+		if (TypeFromName(name.trimmed(), type) && !types.contains(type))
+			types.append(type);
+	}
+
+	return types;
+}
+
+bool Codec::Pack(const char* data, qint32 length, QByteArray& output)
+{
+	auto writeHeader = [](char* envelope, Type type, qint32 rawLength, qint32 dataLength) {
+		envelope[0] = static_cast<char>(EnvelopeMagic);
+		envelope[1] = static_cast<char>(type);
+		envelope[2] = static_cast<char>(rawLength & 0xFF);
+		envelope[3] = static_cast<char>((rawLength >> 8) & 0xFF);
+		envelope[4] = static_cast<char>(dataLength & 0xFF);
+		envelope[5] = static_cast<char>((dataLength >> 8) & 0xFF);
+	};
+
+	output.resize(0);
+	bool packed = false;
+
+	for (qint32 offset = 0; offset < length; offset += MaxEnvelopePayload)
+	{
+		const auto chunk = qMin(length - offset, MaxEnvelopePayload);
+		const auto start = static_cast<qint32>(output.size());
+
+		output.resize(start + EnvelopeHeaderSize + qMax(MaxCompressedSize(chunk), chunk));
+		auto envelope = output.data() + start;
+
+		// 压缩没有收益时 原样放入 None 类型的信封
+		const auto compressed = Compress(data + offset, chunk, envelope + EnvelopeHeaderSize);
+		if (compressed >= 0 && compressed < chunk)
+		{
+			writeHeader(envelope, GetType(), chunk, compressed);
+			output.resize(start + EnvelopeHeaderSize + compressed);
+			packed = true;
+		}
+		else
+		{
+			writeHeader(envelope, Type::None, chunk, chunk);
+			std::memcpy(envelope + EnvelopeHeaderSize, data + offset, chunk);
+			output.resize(start + EnvelopeHeaderSize + chunk);
+		}
+	}
+
+	return packed;
+}
+
+bool Codec::Unpack(const char* data, qint32 length, QByteArray& output, qint32* consumed)
+{
+	if (consumed)
+		*consumed = 0;
+
+	if (length < EnvelopeHeaderSize || static_cast<quint8>(data[0]) != EnvelopeMagic)
+		return false;
+
+	const auto type = static_cast<Type>(static_cast<quint8>(data[1]));
+	const auto rawLength = static_cast<quint8>(data[2]) | (static_cast<quint8>(data[3]) << 8);
+	const auto compressed = static_cast<quint8>(data[4]) | (static_cast<quint8>(data[5]) << 8);
+
+	// 数据不完整
+	if (length < EnvelopeHeaderSize + compressed)
+		return false;
+
+	if (type == Type::None)
+	{
+		if (compressed != rawLength)
+			return false;
+
+		output = QByteArray(data + EnvelopeHeaderSize, rawLength);
+	}
+	else
+	{
+		auto codec = Create(type);
+		if (!codec)
+			return false;
+
+		output.resize(rawLength);
+		if (!codec->Decompress(data + EnvelopeHeaderSize, compressed, output.data(), rawLength))
+			return false;
+	}
+
+	if (consumed)
+		*consumed = EnvelopeHeaderSize + compressed;
+
+	return true;
+}
@@ -0,0 +1,126 @@
+﻿#pragma once
+
+#include <QByteArray>
+#include <QList>
+#include <QString>
+#include <memory>
+
+/// <summary>
+/// 写入路径的压缩编解码器
+/// <para>信封格式: 标识 0xDC, 编码类型, 原始长度 (uint16 LE), 数据长度 (uint16 LE), 数据</para>
+/// <para>与设备协商启用压缩后, 写入的所有数据都封装为信封; 压缩没有收益的部分使用 None 类型的信封原样携带</para>
+/// <para>因此接收方不需要根据首字节猜测数据是否为信封, 标识只用于检查同步</para>
+/// </summary>
+class Codec
+{
+public:
+	enum class Type : quint8
+	{
+		/// <summary>
+		/// 不压缩
+		/// </summary>
+		None = 0,
+		/// <summary>
+		/// heatshrink 兼容的 LZSS (窗口 2^8, 前瞻 2^4) 适合 MCU 解码
+		/// </summary>
+		Lzss = 1,
+		/// <summary>
+		/// LZ4 块格式 适合网络/文件 (需要以 DIGIHMS_WITH_LZ4 编译)
+		/// </summary>
+		Lz4 = 2
+	};
+
+	/// <summary>
+	/// 信封标识
+	/// </summary>
+	static constexpr quint8 EnvelopeMagic = 0xDC;
+	/// <summary>
+	/// 信封头长度
+	/// </summary>
+	static constexpr qint32 EnvelopeHeaderSize = 6;
+	/// <summary>
+	/// 单个信封可承载的最大原始长度 (更长的数据拆分为多个信封)
+	/// </summary>
+	static constexpr qint32 MaxEnvelopePayload = 0xFFFF;
+
+	virtual ~Codec() {}
+
+	/// <summary>
+	/// 创建编解码器
+	/// </summary>
+	/// <param name="type">编码类型</param>
+	/// <returns>编解码器 类型为 None 或未编译时返回空</returns>
+	static std::unique_ptr<Codec> Create(Type type);
+	/// <summary>
+	/// 获取当前构建中可用的编码类型 (包含 None)
+	/// </summary>
+	/// <returns>编码类型列表</returns>
+	static QList<Type> Available();
+	/// <summary>
+	/// 获取编码类型名称
+	/// </summary>
+	/// <param name="type">编码类型</param>
+	/// <returns>名称</returns>
+	static QString TypeName(Type type);
+	/// <summary>
+	/// 根据名称获取编码类型
+	/// </summary>
+	/// <param name="name">名称 (与 TypeName 相同, 不区分大小写)</param>
+	/// <param name="type">编码类型</param>
+	/// <returns>是否为已知的名称</returns>
+	static bool TypeFromName(const QString& name, Type& type);
+	/// <summary>
+	/// 解析逗号分隔的编码类型名称列表 (忽略未知的名称与重复项)
+	/// </summary>
+	/// <param name="names">名称列表 例如 "none,lzss"</param>
+	/// <returns>编码类型列表 (保持原有顺序)</returns>
+	static QList<Type> TypesFromNames(const QString& names);
+
+	/// <summary>
+	/// 压缩并封装为信封 (输出缓冲区容量复用)
+	/// <para>超过 MaxEnvelopePayload 的数据拆分为多个信封, 压缩没有收益的部分封装为 None 类型的信封</para>
+	/// </summary>
+	/// <param name="data">原始数据</param>
+	/// <param name="length">原始长度</param>
+	/// <param name="output">输出信封</param>
+	/// <returns>是否有数据被压缩</returns>
+	bool Pack(const char* data, qint32 length, QByteArray& output);
+	/// <summary>
+	/// 解析并解压一个信封
+	/// </summary>
+	/// <param name="data">信封数据</param>
+	/// <param name="length">数据长度</param>
+	/// <param name="output">输出原始数据</param>
+	/// <param name="consumed">输出已处理的字节数 (数据不完整时为 0)</param>
+	/// <returns>是否成功</returns>
+	static bool Unpack(const char* data, qint32 length, QByteArray& output, qint32* consumed = Q_NULLPTR);
+
+	/// <summary>
+	/// 获取编码类型
+	/// </summary>
+	/// <returns>编码类型</returns>
+	virtual Type GetType() const = 0;
+	/// <summary>
+	/// 获取最坏情况下的压缩长度
+	/// </summary>
+	/// <param name="length">原始长度</param>
+	/// <returns>压缩长度</returns>
+	virtual qint32 MaxCompressedSize(qint32 length) const = 0;
+	/// <summary>
+	/// 压缩数据 写入 output 起始处, output 需有 MaxCompressedSize 的空间
+	/// </summary>
+	/// <param name="data">原始数据</param>
+	/// <param name="length">原始长度</param>
+	/// <param name="output">输出缓冲区</param>
+	/// <returns>压缩长度 失败时返回 -1</returns>
+	virtual qint32 Compress(const char* data, qint32 length, char* output) = 0;
+	/// <summary>
+	/// 解压数据
+	/// </summary>
+	/// <param name="data">压缩数据</param>
+	/// <param name="length">压缩长度</param>
+	/// <param name="output">输出缓冲区</param>
+	/// <param name="rawLength">原始长度</param>
+	/// <returns>是否成功</returns>
+	virtual bool Decompress(const char* data, qint32 length, char* output, qint32 rawLength) = 0;
+};
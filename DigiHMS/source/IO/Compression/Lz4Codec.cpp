@@ -0,0 +1,28 @@
+﻿#include "Lz4Codec.h"
+
+#ifdef DIGIHMS_WITH_LZ4
+
+#include <lz4.h>
+
+Codec::Type Lz4Codec::GetType() const
+{
+	return Type::Lz4;
+}
+
+qint32 Lz4Codec::MaxCompressedSize(qint32 length) const
+{
+	return LZ4_compressBound(length);
+}
+
+qint32 Lz4Codec::Compress(const char* data, qint32 length, char* output)
+{
+	const auto bytes = LZ4_compress_default(data, output, length, MaxCompressedSize(length));
+	return bytes > 0 ? bytes : -1;
+}
+
+bool Lz4Codec::Decompress(const char* data, qint32 length, char* output, qint32 rawLength)
+{
+	return LZ4_decompress_safe(data, output, length, rawLength) == rawLength;
+}
+
+#endif
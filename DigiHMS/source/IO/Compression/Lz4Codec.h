@@ -0,0 +1,19 @@
+﻿#pragma once
+
+#ifdef DIGIHMS_WITH_LZ4
+
+#include "Codec.h"
+
+/// <summary>
+/// LZ4 块格式编解码器 (可选依赖 liblz4)
+/// </summary>
+class Lz4Codec : public Codec
+{
+public:
+	Type GetType() const override;
+	qint32 MaxCompressedSize(qint32 length) const override;
+	qint32 Compress(const char* data, qint32 length, char* output) override;
+	bool Decompress(const char* data, qint32 length, char* output, qint32 rawLength) override;
+};
+
+#endif
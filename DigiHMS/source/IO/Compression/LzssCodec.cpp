@@ -0,0 +1,202 @@
+﻿#include "LzssCodec.h"
+#include <algorithm>
+
+namespace
+{
+	constexpr qint32 WindowSize = 1 << LzssCodec::WindowBits;
+	constexpr qint32 MaxMatch = 1 << LzssCodec::LookaheadBits;
+	/// <summary>
+	/// 回溯引用占 13 位 两个字节的字面量占 18 位
+	/// </summary>
+	constexpr qint32 MinMatch = 2;
+	/// <summary>
+	/// 每个位置最多比较的候选数量
+	/// </summary>
+	constexpr qint32 MaxChainDepth = 64;
+
+	/// <summary>
+	/// 高位在前的位写入器
+	/// </summary>
+	class BitWriter
+	{
+	public:
+		explicit BitWriter(char* output)
+			: m_output(output), m_bytes(0), m_accumulator(0), m_bits(0) {}
+
+		void Write(quint32 value, qint32 bits)
+		{
+			m_accumulator = (m_accumulator << bits) | (value & ((1u << bits) - 1));
+			m_bits += bits;
+			while (m_bits >= 8)
+			{
+				m_bits -= 8;
+				m_output[m_bytes++] = static_cast<char>((m_accumulator >> m_bits) & 0xFF);
+			}
+		}
+
+		qint32 Finish()
+		{
+			// 末尾不足一个字节的部分以 0 填充
+			if (m_bits > 0)
+				Write(0, 8 - m_bits);
+
+			return m_bytes;
+		}
+
+	private:
+		char* m_output;
+		qint32 m_bytes;
+		quint32 m_accumulator;
+		qint32 m_bits;
+	};
+
+	class BitReader
+	{
+	public:
+		BitReader(const char* input, qint32 length)
+			: m_input(input), m_length(length), m_position(0), m_accumulator(0), m_bits(0) {}
+
+		bool Read(qint32 bits, quint32& value)
+		{
+			while (m_bits < bits)
+			{
+				if (m_position >= m_length)
+					return false;
+
+				m_accumulator = (m_accumulator << 8) | static_cast<quint8>(m_input[m_position++]);
+				m_bits += 8;
+			}
+
+			m_bits -= bits;
+			value = (m_accumulator >> m_bits) & ((1u << bits) - 1);
+			return true;
+		}
+
+	private:
+		const char* m_input;
+		qint32 m_length;
+		qint32 m_position;
+		quint32 m_accumulator;
+		qint32 m_bits;
+	};
+}
+
+LzssCodec::LzssCodec()
+{
+	std::fill(std::begin(m_head), std::end(m_head), -1);
+}
+
+Codec::Type LzssCodec::GetType() const
+{
+	return Type::Lzss;
+}
+
+qint32 LzssCodec::MaxCompressedSize(qint32 length) const
+{
+	// 全部为字面量时每字节 9 位
+	return (length * 9 + 7) / 8;
+}
+
+qint32 LzssCodec::Compress(const char* data, qint32 length, char* output)
+{
+	const auto input = reinterpret_cast<const quint8*>(data);
+
+	std::fill(std::begin(m_head), std::end(m_head), -1);
+	if (static_cast<qint32>(m_previous.size()) < length)
+		m_previous.resize(length);
+
+	auto insert = [&](qint32 position) {
+		m_previous[position] = m_head[input[position]];
+		m_head[input[position]] = position;
+	};
+
+	BitWriter writer(output);
+	qint32 position = 0;
+
+	while (position < length)
+	{
+		const auto maxLength = std::min(MaxMatch, length - position);
+		qint32 bestLength = 0;
+		qint32 bestDistance = 0;
+
+		if (maxLength >= MinMatch)
+		{
+			auto candidate = m_head[input[position]];
+			for (auto depth = 0; candidate >= 0 && position - candidate <= WindowSize && depth < MaxChainDepth; ++depth)
+			{
+				qint32 matched = 1;
+				while (matched < maxLength && input[candidate + matched] == input[position + matched])
+					++matched;
+
+				if (matched > bestLength)
+				{
+					bestLength = matched;
+					bestDistance = position - candidate;
+					if (matched == maxLength)
+						break;
+				}
+
+				candidate = m_previous[candidate];
+			}
+		}
+
+		if (bestLength >= MinMatch)
+		{
+			writer.Write(0, 1);
+			writer.Write(static_cast<quint32>(bestDistance - 1), WindowBits);
+			writer.Write(static_cast<quint32>(bestLength - 1), LookaheadBits);
+
+			for (auto i = 0; i < bestLength; ++i)
+				insert(position + i);
+			position += bestLength;
+		}
+		else
+		{
+			writer.Write(1, 1);
+			writer.Write(input[position], 8);
+
+			insert(position);
+			position++;
+		}
+	}
+
+	return writer.Finish();
+}
+
+bool LzssCodec::Decompress(const char* data, qint32 length, char* output, qint32 rawLength)
+{
+	BitReader reader(data, length);
+	qint32 position = 0;
+	quint32 tag = 0;
+	quint32 value = 0;
+
+	while (position < rawLength)
+	{
+		if (!reader.Read(1, tag))
+			return false;
+
+		if (tag)
+		{
+			if (!reader.Read(8, value))
+				return false;
+
+			output[position++] = static_cast<char>(value);
+			continue;
+		}
+
+		quint32 count = 0;
+		if (!reader.Read(WindowBits, value) || !reader.Read(LookaheadBits, count))
+			return false;
+
+		const auto distance = static_cast<qint32>(value) + 1;
+		const auto matched = static_cast<qint32>(count) + 1;
+		if (distance > position || position + matched > rawLength)
+			return false;
+
+		// 源与目标可能重叠 逐字节拷贝
+		for (auto i = 0; i < matched; ++i, ++position)
+			output[position] = output[position - distance];
+	}
+
+	return true;
+}
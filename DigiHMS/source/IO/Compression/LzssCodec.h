@@ -0,0 +1,36 @@
+﻿#pragma once
+
+#include "Codec.h"
+#include <vector>
+
+/// <summary>
+/// heatshrink 兼容的 LZSS 编解码器
+/// <para>比特流与 heatshrink (-w 8 -l 4) 相同, 固件可直接使用 heatshrink_decoder 解码</para>
+/// <para>字面量: 1 + 8 位; 回溯引用: 0 + 8 位 (距离 - 1) + 4 位 (长度 - 1)</para>
+/// </summary>
+class LzssCodec : public Codec
+{
+public:
+	/// <summary>
+	/// 窗口大小 (2 的幂次)
+	/// </summary>
+	static constexpr qint32 WindowBits = 8;
+	/// <summary>
+	/// 前瞻长度 (2 的幂次)
+	/// </summary>
+	static constexpr qint32 LookaheadBits = 4;
+
+	LzssCodec();
+
+	Type GetType() const override;
+	qint32 MaxCompressedSize(qint32 length) const override;
+	qint32 Compress(const char* data, qint32 length, char* output) override;
+	bool Decompress(const char* data, qint32 length, char* output, qint32 rawLength) override;
+
+private:
+	/// <summary>
+	/// 以首字节为键的位置链 (复用 避免每次压缩分配)
+	/// </summary>
+	qint32 m_head[256];
+	std::vector<qint32> m_previous;
+};
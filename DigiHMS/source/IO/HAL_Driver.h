@@ -12,6 +12,9 @@
 
 #include <QObject>
 #include <QIODevice>
+#include <QByteArrayView>
+#include <QList>
+#include "Compression/Codec.h"
 
 class HAL_Driver : public QObject
 {
@@ -21,13 +24,38 @@ signals:
 	void configurationChanged();
 	void dataSend(const QByteArray& data);
 	void dataReceived(const QByteArray& data);
+	/// <summary>
+	/// OpenAsync 完成 (被 Close 取消的请求不会发送)
+	/// </summary>
+	/// <param name="ok">是否打开成功</param>
+	void openFinished(bool ok);
 
 public:
 	virtual bool Open(const QIODevice::OpenMode mode) = 0;
+	/// <summary>
+	/// 异步打开设备 完成时发送 openFinished
+	/// <para>默认在当前线程中调用 Open</para>
+	/// </summary>
+	/// <param name="mode">打开方式</param>
+	virtual void OpenAsync(const QIODevice::OpenMode mode) { emit openFinished(Open(mode)); }
 	virtual void Close() = 0;
 	virtual bool IsOpen() const = 0;
 	virtual bool IsReadable() const = 0;
 	virtual bool IsWritable() const = 0;
 	virtual quint64 Write(const QByteArray& data) = 0;
+	/// <summary>
+	/// 依次写入多段数据 (分散/聚集写入, 不需要先拼接)
+	/// <para>默认不支持, 返回 -1 时由调用方拼接后调用 Write</para>
+	/// </summary>
+	/// <param name="parts">数据段</param>
+	/// <param name="count">数据段数量</param>
+	/// <returns>成功写入 (或已进入发送缓冲区) 的字节数量 不支持时返回 -1</returns>
+	virtual qint64 WriteGather(const QByteArrayView* parts, qint32 count) { Q_UNUSED(parts); Q_UNUSED(count); return -1; }
 	virtual bool ConfigurationOk() const = 0;
+	/// <summary>
+	/// 链路可以承载的压缩类型 (用于协商写入路径的压缩)
+	/// <para>设备固件是否能解码由 Manager 连接后查询设备另行确认</para>
+	/// </summary>
+	/// <returns>压缩类型列表</returns>
+	virtual QList<Codec::Type> SupportedCodecs() const { return { Codec::Type::None }; }
 };
\ No newline at end of file
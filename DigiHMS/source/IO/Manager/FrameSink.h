@@ -0,0 +1,91 @@
+﻿#pragma once
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QMetaType>
+#include <QVector>
+
+/// <summary>
+/// 帧在缓冲区中的位置
+/// </summary>
+struct FrameSpan
+{
+	qint32 offset;
+	qint32 length;
+};
+
+/// <summary>
+/// 一次解析得到的所有帧
+/// <para>帧内容不单独复制, 以偏移列表引用共享的接收缓冲区 (隐式共享, 跨线程传递安全)</para>
+/// </summary>
+class FrameBatch
+{
+public:
+	FrameBatch() {}
+	FrameBatch(const QByteArray& buffer, const QVector<FrameSpan>& spans)
+		: m_buffer(buffer)
+		, m_spans(spans)
+	{
+
+	}
+
+	/// <summary>
+	/// 获取帧数量
+	/// </summary>
+	/// <returns>帧数量</returns>
+	qint32 Count() const
+	{
+		return m_spans.count();
+	}
+	/// <summary>
+	/// 获取帧内容 (在 FrameBatch 生命周期内有效)
+	/// </summary>
+	/// <param name="index">帧序号</param>
+	/// <returns>帧内容</returns>
+	QByteArrayView At(qint32 index) const
+	{
+		const auto& span = m_spans.at(index);
+		return QByteArrayView(m_buffer.constData() + span.offset, span.length);
+	}
+	/// <summary>
+	/// 获取共享的接收缓冲区
+	/// </summary>
+	/// <returns>接收缓冲区</returns>
+	const QByteArray& Buffer() const
+	{
+		return m_buffer;
+	}
+	/// <summary>
+	/// 获取帧位置列表
+	/// </summary>
+	/// <returns>帧位置列表</returns>
+	const QVector<FrameSpan>& Spans() const
+	{
+		return m_spans;
+	}
+
+private:
+	QByteArray m_buffer;
+	QVector<FrameSpan> m_spans;
+};
+
+Q_DECLARE_METATYPE(FrameBatch)
+
+/// <summary>
+/// 进程内的帧接收者
+/// <para>在 Manager 所在线程中解析完成后被直接调用, 不经过元对象系统也不复制帧内容</para>
+/// <para>data 与 spans 仅在调用期间有效, 实现必须快速返回</para>
+/// </summary>
+class FrameSink
+{
+public:
+	virtual ~FrameSink() {}
+
+	/// <summary>
+	/// 一次解析得到的所有帧
+	/// </summary>
+	/// <param name="data">接收缓冲区</param>
+	/// <param name="spans">帧在缓冲区中的位置</param>
+	/// <param name="count">帧数量</param>
+	virtual void OnFrames(const char* data, const FrameSpan* spans, qint32 count) = 0;
+};
@@ -1,9 +1,26 @@
 ﻿#include "Manager.h"
 #include "../HAL_Driver.h"
 #include <IO/Serial/Serial.h>
+#include <IO/Reactor/FdDriver.h>
 #include <Common/Checksum.h>
+#include <Common/Trace.h>
+#include <QMetaMethod>
+#include <QVarLengthArray>
+#include <cstring>
 
-static QString ADD_ESCAPE_SEQUENCES(const QString& str)
+namespace
+{
+	/// <summary>
+	/// 压缩握手的控制帧 (不作为遥测帧分发)
+	/// <para>主机: #codecs? 查询设备可以解码的类型, 设备: #codecs:none,lzss 响应</para>
+	/// <para>主机: #codec=lzss 宣告切换 此后写入的所有数据都是信封, #codec=none 恢复原始帧</para>
+	/// </summary>
+	const QByteArray CodecQuery = "#codecs?";
+	const QByteArray CodecReply = "#codecs:";
+	const QByteArray CodecSelect = "#codec=";
+}
+
+QString ADD_ESCAPE_SEQUENCES(const QString& str)
 {
 	auto escapedStr = str;
 	escapedStr = escapedStr.replace("\\a", "\a");
@@ -16,22 +33,33 @@ static QString ADD_ESCAPE_SEQUENCES(const QString& str)
 	return escapedStr;
 }
 
-Manager::Manager()
+Manager::Manager(bool attachDriver)
 	: m_writeEnabled(true)
+	, m_connecting(false)
 	, m_maxBufferSize(1024 * 1024)
 	, m_driver(Q_NULLPTR)
+	, m_deviceDriver(new FdDriver(this))
 	, m_receivedBytes(0)
 	, m_enableCrc(false)
 	, m_startSequence("/*")
 	, m_finishSequence("*/")
 	, m_separatorSequence(",")
+	, m_deviceCodecs({ Codec::Type::None })
+	, m_selectedDriver(SelectedDriver::Serial)
 {
 	// 初始化设置
 	setMaxBufferSize(1024 * 1024);
-	setSelectedDriver(SelectedDriver::Serial);
+	if (attachDriver)
+		setSelectedDriver(SelectedDriver::Serial);
+
+	// framesReceived 可通过队列连接跨线程传递
+	qRegisterMetaType<FrameBatch>();
 
 	// 绑定选择设备更换信号
 	connect(this, &Manager::selectedDriverChanged, this, &Manager::configurationChanged);
+
+	// 协议描述 仅在序列变化时重新生成
+	updateProtocol();
 }
 
 Manager& Manager::Instance()
@@ -40,6 +68,11 @@ Manager& Manager::Instance()
 	return singleton;
 }
 
+std::unique_ptr<Manager> Manager::CreateIsolated()
+{
+	return std::unique_ptr<Manager>(new Manager(false));
+}
+
 bool Manager::ReadOnly()
 {
 	return Connected() && !m_writeEnabled;
@@ -58,6 +91,11 @@ bool Manager::Connected()
 	return false;
 }
 
+bool Manager::Connecting() const
+{
+	return m_connecting;
+}
+
 bool Manager::DeviceAvailable()
 {
 	return m_driver != Q_NULLPTR;
@@ -81,6 +119,11 @@ HAL_Driver* Manager::Driver()
 	return m_driver;
 }
 
+FdDriver* Manager::DeviceDriver()
+{
+	return m_deviceDriver;
+}
+
 Manager::SelectedDriver Manager::GetSelectedDriver()
 {
 	return m_selectedDriver;
@@ -90,6 +133,9 @@ QStringList Manager::AvailableDrivers() const
 {
 	QStringList list;
 	list.append(tr("Serial port"));
+#ifdef Q_OS_LINUX
+	list.append(tr("Device file"));
+#endif
 	return list;
 }
 
@@ -98,7 +144,7 @@ qint64 Manager::WriteData(const QByteArray& data)
 	if (Connected())
 	{
 		// 写入数据到设备
-		auto bytes = m_driver->Write(data);
+		auto bytes = writeToDriver(data);
 
 		// 触发信号
 		if (bytes > 0)
@@ -114,6 +160,110 @@ qint64 Manager::WriteData(const QByteArray& data)
 	return -1;
 }
 
+qint64 Manager::WriteFrameParts(const QByteArrayView* parts, qint32 count, ProtocolDescriptor::Checksum checksum)
+{
+	if (!Connected())
+		return -1;
+
+	const auto& protocol = *m_protocol;
+
+	// 校验值覆盖起始与结束序列之间的内容 按大端序排列 (与 IntegrityChecks 一致)
+	char crc[4];
+	const auto crcSize = ProtocolDescriptor::ChecksumSize(checksum);
+	switch (checksum)
+	{
+	case ProtocolDescriptor::Checksum::Crc8:
+	{
+		auto value = CRC8_INIT;
+		for (auto i = 0; i < count; ++i)
+			value = CRC8Update(value, parts[i].data(), static_cast<qint32>(parts[i].size()));
+		crc[0] = static_cast<char>(value);
+		break;
+	}
+	case ProtocolDescriptor::Checksum::Crc16:
+	{
+		auto value = CRC16_INIT;
+		for (auto i = 0; i < count; ++i)
+			value = CRC16Update(value, parts[i].data(), static_cast<qint32>(parts[i].size()));
+		crc[0] = static_cast<char>(static_cast<quint16>(value) >> 8);
+		crc[1] = static_cast<char>(value);
+		break;
+	}
+	case ProtocolDescriptor::Checksum::Crc32:
+	{
+		auto value = CRC32_INIT;
+		for (auto i = 0; i < count; ++i)
+			value = CRC32Update(value, parts[i].data(), static_cast<qint32>(parts[i].size()));
+		const auto result = static_cast<quint32>(~value);
+		for (auto i = 0; i < 4; ++i)
+			crc[i] = static_cast<char>(result >> (24 - i * 8));
+		break;
+	}
+	default:
+		break;
+	}
+
+	QVarLengthArray<QByteArrayView, 16> spans;
+	spans.append(protocol.Start());
+	for (auto i = 0; i < count; ++i)
+		spans.append(parts[i]);
+	spans.append(protocol.Trailer(checksum));
+	if (crcSize > 0)
+		spans.append(QByteArrayView(crc, crcSize));
+
+	// 压缩信封只能对连续的数据编码
+	qint64 bytes = -1;
+	if (!m_codec)
+		bytes = m_driver->WriteGather(spans.constData(), static_cast<qint32>(spans.count()));
+
+	const auto emitSent = isSignalConnected(QMetaMethod::fromSignal(&Manager::dataSent));
+	if (bytes < 0 || emitSent)
+	{
+		m_gatherBuffer.resize(0);
+		for (const auto& span : spans)
+			m_gatherBuffer.append(span.data(), span.size());
+	}
+
+	if (bytes < 0)
+		bytes = static_cast<qint64>(writeToDriver(m_gatherBuffer));
+
+	if (bytes > 0 && emitSent)
+		emit dataSent(m_gatherBuffer.left(bytes));
+
+	return bytes;
+}
+
+QList<Codec::Type> Manager::PreferredCodecs() const
+{
+	return m_preferredCodecs;
+}
+
+Codec::Type Manager::ActiveCodec() const
+{
+	return m_codec ? m_codec->GetType() : Codec::Type::None;
+}
+
+QList<Codec::Type> Manager::DeviceCodecs() const
+{
+	return m_deviceCodecs;
+}
+
+std::shared_ptr<const ProtocolDescriptor> Manager::Protocol() const
+{
+	return m_protocol;
+}
+
+void Manager::AddFrameSink(FrameSink* sink)
+{
+	if (sink && !m_sinks.contains(sink))
+		m_sinks.append(sink);
+}
+
+void Manager::RemoveFrameSink(FrameSink* sink)
+{
+	m_sinks.removeAll(sink);
+}
+
 QString Manager::StartSequence() const
 {
 	return m_startSequence;
@@ -129,91 +279,58 @@ QString Manager::SeparatorSequence() const
 	return m_separatorSequence;
 }
 
-Manager::ValidationStatus Manager::IntegrityChecks(const QByteArray& frame, const QByteArray& cursor, qint32* bytes)
+Manager::ValidationStatus Manager::IntegrityChecks(const char* frame, qint32 frameLength, const char* trailer, qint32 trailerLength, qint32* bytes)
 {
-	auto finish = FinishSequence().toUtf8();
-	auto crc8Header = finish + "crc8:";
-	auto crc16Header = finish + "crc16:";
-	auto crc32Header = finish + "crc32:";
+	qint32 header = 0;
+	const auto checksum = m_protocol->MatchTrailer(trailer, trailerLength, &header);
 
-	if (cursor.contains(crc8Header))
+	if (checksum != ProtocolDescriptor::Checksum::None)
 	{
+		// 收到过带校验的帧后 不带校验的帧视为不完整
 		m_enableCrc = true;
-		auto offset = cursor.indexOf(crc8Header) + crc8Header.length() - 1;
-
-		if (cursor.length() >= offset + 1)
-		{
-			*bytes += crc8Header.length() + 1;
 
-			const quint8 crc = cursor.at(offset + 1);
+		// 等待完整的校验值
+		const auto size = ProtocolDescriptor::ChecksumSize(checksum);
+		if (trailerLength < header + size)
+			return ValidationStatus::ChecksumIncomplete;
 
-			if (CRC8(frame.data(), frame.length()) == crc)
-				return ValidationStatus::FrameOk;
-			else
-				return ValidationStatus::ChecksumError;
-		}
-	}
-	// Check CRC-16
-	else if (cursor.contains(crc16Header))
-	{
-		// Enable the CRC flag
-		m_enableCrc = true;
-		auto offset = cursor.indexOf(crc16Header) + crc16Header.length() - 1;
+		*bytes += header + size;
 
-		// Check if we have enough data in the buffer
-		if (cursor.length() >= offset + 2)
+		// 校验值按大端序排列
+		const auto crc = reinterpret_cast<const quint8*>(trailer + header);
+		bool valid = false;
+		switch (checksum)
 		{
-			// Increment the number of bytes to remove from master buffer
-			*bytes += crc16Header.length() + 2;
-
-			// Get 16-bit checksum
-			const quint8 a = cursor.at(offset + 1);
-			const quint8 b = cursor.at(offset + 2);
-			const quint16 crc = (a << 8) | (b & 0xff);
-
-			// Compare checksums
-			if (CRC16(frame.data(), frame.length()) == crc)
-				return ValidationStatus::FrameOk;
-			else
-				return ValidationStatus::ChecksumError;
+		case ProtocolDescriptor::Checksum::Crc8:
+			valid = static_cast<quint8>(CRC8(frame, frameLength)) == crc[0];
+			break;
+		case ProtocolDescriptor::Checksum::Crc16:
+			valid = static_cast<quint16>(CRC16(frame, frameLength)) == static_cast<quint16>((crc[0] << 8) | crc[1]);
+			break;
+		case ProtocolDescriptor::Checksum::Crc32:
+			valid = static_cast<quint32>(CRC32(frame, frameLength))
+				== ((quint32(crc[0]) << 24) | (quint32(crc[1]) << 16) | (quint32(crc[2]) << 8) | quint32(crc[3]));
+			break;
+		default:
+			break;
 		}
-	}
-	// Check CRC-32
-	else if (cursor.contains(crc32Header))
-	{
-		// Enable the CRC flag
-		m_enableCrc = true;
-		auto offset = cursor.indexOf(crc32Header) + crc32Header.length() - 1;
 
-		// Check if we have enough data in the buffer
-		if (cursor.length() >= offset + 4)
-		{
-			// Increment the number of bytes to remove from master buffer
-			*bytes += crc32Header.length() + 4;
-
-			// Get 32-bit checksum
-			const quint8 a = cursor.at(offset + 1);
-			const quint8 b = cursor.at(offset + 2);
-			const quint8 c = cursor.at(offset + 3);
-			const quint8 d = cursor.at(offset + 4);
-			const quint32 crc = (a << 24) | (b << 16) | (c << 8) | (d & 0xff);
-
-			// Compare checksums
-			if (CRC32(frame.data(), frame.length()) == crc)
-				return ValidationStatus::FrameOk;
-			else
-				return ValidationStatus::ChecksumError;
-		}
+		return valid ? ValidationStatus::FrameOk : ValidationStatus::ChecksumError;
 	}
 	else if (!m_enableCrc)
 	{
-		*bytes += finish.length();
+		*bytes += m_protocol->Finish().length();
 		return ValidationStatus::FrameOk;
 	}
 
 	return ValidationStatus::ChecksumIncomplete;
 }
 
+void Manager::updateProtocol()
+{
+	m_protocol = ProtocolDescriptor::Create(m_startSequence, m_finishSequence, m_separatorSequence);
+}
+
 void Manager::connectDevice()
 {
 	// 设置新的设备连接
@@ -226,18 +343,36 @@ void Manager::connectDevice()
 		if (m_writeEnabled)
 			mode = QIODevice::ReadWrite;
 
-		// 打开设备
-		if (m_driver->Open(mode))
-		{
-			connect(m_driver, &HAL_Driver::dataReceived, this, &Manager::onDataReceived);
-		}
-		else
-		{
-			disconnectDriver();
-		}
+		// 异步打开设备 结果在 onOpenFinished 中处理
+		m_connecting = true;
+		emit connectingChanged();
 
-		emit connectedChanged();
+		m_driver->OpenAsync(mode);
+	}
+}
+
+void Manager::onOpenFinished(bool ok)
+{
+	if (!m_connecting)
+		return;
+
+	m_connecting = false;
+
+	// 新的连接在设备确认前不压缩 (设备同样以原始帧开始)
+	m_deviceCodecs = { Codec::Type::None };
+	negotiateCodec(false);
+
+	if (ok)
+	{
+		connect(m_driver, &HAL_Driver::dataReceived, this, &Manager::onDataReceived);
+		queryDeviceCodecs();
 	}
+	else
+		disconnectDriver();
+
+	emit connectingChanged();
+	emit connectedChanged();
+	emit connectFinished(ok);
 }
 
 void Manager::disconnectDriver()
@@ -246,14 +381,24 @@ void Manager::disconnectDriver()
 	{
 		disconnect(m_driver, &HAL_Driver::dataReceived, this, &Manager::onDataReceived);
 		disconnect(m_driver, &HAL_Driver::configurationChanged, this, &Manager::configurationChanged);
+		disconnect(m_driver, &HAL_Driver::openFinished, this, &Manager::onOpenFinished);
+
+		// 取消进行中的连接
+		const auto connecting = m_connecting;
+		m_connecting = false;
 
 		m_driver->Close();
 
 		m_driver = Q_NULLPTR;
+		m_deviceCodecs = { Codec::Type::None };
+		negotiateCodec(false);
 		m_receivedBytes = 0;
 		m_dataBuffer.clear();
 		m_dataBuffer.reserve(MaxBufferSize());
 
+		if (connecting)
+			emit connectingChanged();
+
 		emit driverChanged();
 		emit connectedChanged();
 	}
@@ -261,7 +406,7 @@ void Manager::disconnectDriver()
 
 void Manager::toggleConnection()
 {
-	if (Connected())
+	if (Connected() || Connecting())
 		disconnectDriver();
 	else
 		connectDevice();
@@ -282,7 +427,7 @@ void Manager::processPayload(const QByteArray& payload)
 			m_receivedBytes = 0;
 
 		emit dataReceived(payload);
-		emit frameReceived(payload);
+		dispatchFrames(payload, { FrameSpan{ 0, static_cast<qint32>(payload.size()) } });
 		emit receivedBytesChanged();
 	}
 }
@@ -310,6 +455,9 @@ void Manager::setSelectedDriver(const SelectedDriver& driver)
 	case Manager::SelectedDriver::Serial:
 		setDriver(&(Serial::Instance()));
 		break;
+	case Manager::SelectedDriver::Device:
+		setDriver(m_deviceDriver);
+		break;
 	default:
 		setDriver(Q_NULLPTR);
 		break;
@@ -324,6 +472,7 @@ void Manager::setStartSequence(const QString& sequence)
 	if (m_startSequence.isEmpty())
 		m_startSequence = "/*";
 
+	updateProtocol();
 	emit startSequenceChanged();
 }
 
@@ -333,6 +482,7 @@ void Manager::setFinishSequence(const QString& sequence)
 	if (m_finishSequence.isEmpty())
 		m_finishSequence = "*/";
 
+	updateProtocol();
 	Q_EMIT finishSequenceChanged();
 }
 
@@ -342,51 +492,137 @@ void Manager::setSeparatorSequence(const QString& sequence)
 	if (m_separatorSequence.isEmpty())
 		m_separatorSequence = ",";
 
+	updateProtocol();
 	Q_EMIT separatorSequenceChanged();
 }
 
+void Manager::setPreferredCodecs(const QList<Codec::Type>& codecs)
+{
+	if (m_preferredCodecs == codecs)
+		return;
+
+	m_preferredCodecs = codecs;
+	negotiateCodec();
+
+	// 设备尚未确认任何压缩类型时重新查询
+	if (m_deviceCodecs.count() <= 1)
+		queryDeviceCodecs();
+}
+
+void Manager::setDeviceCodecs(const QList<Codec::Type>& codecs)
+{
+	if (m_deviceCodecs == codecs)
+		return;
+
+	m_deviceCodecs = codecs;
+	negotiateCodec();
+}
+
+void Manager::processData(const QByteArray& data)
+{
+	m_dataBuffer.append(data);
+	parseFrames();
+}
+
 void Manager::readFrames()
 {
 	if (!Connected())
 		return;
 
-	auto bytes = 0;
-	auto prevBytes = 0;
-	auto cursor = m_dataBuffer;
-	auto start = m_startSequence.toUtf8();
-	auto finish = m_finishSequence.toUtf8();
+	parseFrames();
+}
 
-	while (cursor.contains(start) && cursor.contains(finish))
-	{
-		auto sIndex = cursor.indexOf(start);
-		cursor = cursor.mid(sIndex + start.length(), -1);
-		bytes += sIndex + start.length();
+void Manager::parseFrames()
+{
+	TRACE_SCOPE(ManagerReadFrames, m_dataBuffer.size());
 
-		auto fIndex = cursor.indexOf(finish);
-		auto frame = cursor.left(fIndex);
+	const auto& protocol = *m_protocol;
 
-		qint32 chop = 0;
-		auto result = IntegrityChecks(frame, cursor, &chop);
-		if (result == ValidationStatus::FrameOk)
-		{
-			emit frameReceived(frame);
-		}
-		else if (result == ValidationStatus::ChecksumIncomplete)
+	// 直接在缓冲区上按偏移解析 (持有一个共享引用 防止接收者修改缓冲区)
+	// 帧只记录位置 全部解析完成后统一分发
+	m_spans.resize(0);
+	qint32 bytes = 0;
+	QByteArray codecReply;
+	auto codecReplied = false;
+	{
+		const auto buffer = m_dataBuffer;
+		const auto data = buffer.constData();
+		const auto length = static_cast<qint32>(buffer.length());
+
+		while (bytes < length)
 		{
-			bytes = prevBytes;
-			break;
+			const auto sIndex = protocol.IndexOfStart(data, length, bytes);
+			if (sIndex < 0)
+				break;
+
+			const auto frameStart = sIndex + protocol.Start().length();
+			const auto fIndex = protocol.IndexOfFinish(data, length, frameStart);
+			if (fIndex < 0)
+				break;
+
+			qint32 chop = 0;
+			const auto frameLength = fIndex - frameStart;
+			const auto result = IntegrityChecks(data + frameStart, frameLength, data + fIndex, length - fIndex, &chop);
+			if (result == ValidationStatus::ChecksumIncomplete)
+				break;
+
+			if (result == ValidationStatus::FrameOk)
+			{
+				// 压缩握手的响应 遥测帧只检查首字节
+				if (frameLength >= CodecReply.length() && data[frameStart] == '#'
+					&& std::memcmp(data + frameStart, CodecReply.constData(), CodecReply.length()) == 0)
+				{
+					codecReply = QByteArray(data + frameStart + CodecReply.length(), frameLength - CodecReply.length());
+					codecReplied = true;
+				}
+				else
+					m_spans.append(FrameSpan{ frameStart, frameLength });
+			}
+
+			bytes = fIndex + chop;
 		}
 
-		cursor = cursor.mid(fIndex + chop, -1);
-		bytes += fIndex + chop;
-
-		prevBytes = bytes;
+		// 持有位置列表的共享引用 接收者重入解析时不会影响本次分发
+		const auto spans = m_spans;
+		if (!spans.isEmpty())
+			dispatchFrames(buffer, spans);
 	}
 
 	m_dataBuffer.remove(0, bytes);
 	if (m_dataBuffer.size() > m_maxBufferSize)
 		clearTempBuffer();
 
+	// 未知的名称被忽略 设备总能接收原始帧
+	if (codecReplied)
+	{
+		auto codecs = Codec::TypesFromNames(QString::fromLatin1(codecReply));
+		if (!codecs.contains(Codec::Type::None))
+			codecs.prepend(Codec::Type::None);
+
+		setDeviceCodecs(codecs);
+	}
+}
+
+void Manager::dispatchFrames(const QByteArray& buffer, const QVector<FrameSpan>& spans)
+{
+	TRACE_SCOPE(ManagerFrameReceived, spans.count());
+
+	const auto data = buffer.constData();
+
+	// 进程内接收者 直接调用
+	for (auto i = 0; i < m_sinks.count(); ++i)
+		m_sinks.at(i)->OnFrames(data, spans.constData(), spans.count());
+
+	// 批量信号 每次解析一次 帧内容与位置列表均为共享引用
+	if (isSignalConnected(QMetaMethod::fromSignal(&Manager::framesReceived)))
+		emit framesReceived(FrameBatch(buffer, spans));
+
+	// 逐帧信号 保留给现有的接收者
+	if (isSignalConnected(QMetaMethod::fromSignal(&Manager::frameReceived)))
+	{
+		for (const auto& span : spans)
+			emit frameReceived(QByteArray(data + span.offset, span.length));
+	}
 }
 
 void Manager::clearTempBuffer()
@@ -397,9 +633,13 @@ void Manager::clearTempBuffer()
 void Manager::setDriver(HAL_Driver* driver)
 {
 	if (driver)
+	{
 		connect(driver, &HAL_Driver::configurationChanged, this, &Manager::configurationChanged);
+		connect(driver, &HAL_Driver::openFinished, this, &Manager::onOpenFinished);
+	}
 
 	m_driver = driver;
+	negotiateCodec(false);
 
 	emit driverChanged();
 	emit configurationChanged();
@@ -407,6 +647,8 @@ void Manager::setDriver(HAL_Driver* driver)
 
 void Manager::onDataReceived(const QByteArray& data)
 {
+	TRACE_SCOPE(ManagerDataReceived, data.length());
+
 	if (m_driver == Q_NULLPTR)
 		disconnectDriver();
 
@@ -419,6 +661,79 @@ void Manager::onDataReceived(const QByteArray& data)
 	if (m_receivedBytes >= UINT64_MAX)
 		m_receivedBytes = 0;
 
-	emit receivedBytesChanged();
-	emit dataReceived(data);
+	// 高速接收时逐块发送信号的开销可观 没有接收者时跳过
+	if (isSignalConnected(QMetaMethod::fromSignal(&Manager::receivedBytesChanged)))
+		emit receivedBytesChanged();
+	if (isSignalConnected(QMetaMethod::fromSignal(&Manager::dataReceived)))
+		emit dataReceived(data);
+}
+
+quint64 Manager::writeToDriver(const QByteArray& data)
+{
+	if (!m_codec)
+		return m_driver->Write(data);
+
+	m_codec->Pack(data.constData(), data.length(), m_packBuffer);
+	const auto bytes = m_driver->Write(m_packBuffer);
+
+	// 信封只能整体解码 全部写入时才计为成功
+	return bytes == static_cast<quint64>(m_packBuffer.length()) ? data.length() : 0;
+}
+
+void Manager::writeControl(const QByteArray& command)
+{
+	const auto& protocol = *m_protocol;
+
+	QByteArray frame;
+	frame.reserve(protocol.Start().length() + command.length() + protocol.Finish().length());
+	frame.append(protocol.Start());
+	frame.append(command);
+	frame.append(protocol.Finish());
+	writeToDriver(frame);
+}
+
+void Manager::queryDeviceCodecs()
+{
+	if (!ReadWrite())
+		return;
+
+	// 没有可用的压缩类型时不打扰设备
+	const auto supported = m_driver->SupportedCodecs();
+	const auto available = Codec::Available();
+	for (auto type : m_preferredCodecs)
+	{
+		if (type != Codec::Type::None && supported.contains(type) && available.contains(type))
+		{
+			writeControl(CodecQuery);
+			return;
+		}
+	}
+}
+
+void Manager::negotiateCodec(bool announce)
+{
+	const auto previous = ActiveCodec();
+	const auto supported = m_driver ? m_driver->SupportedCodecs() : QList<Codec::Type>();
+	const auto available = Codec::Available();
+
+	// 链路, 本机与设备固件都支持的类型
+	auto selected = Codec::Type::None;
+	for (auto type : m_preferredCodecs)
+	{
+		if (supported.contains(type) && available.contains(type) && m_deviceCodecs.contains(type))
+		{
+			selected = type;
+			break;
+		}
+	}
+
+	if (selected != previous)
+	{
+		// 以切换前的方式宣告 设备据此切换帧格式
+		if (announce && ReadWrite())
+			writeControl(CodecSelect + Codec::TypeName(selected).toLatin1());
+
+		m_codec = Codec::Create(selected);
+		emit codecChanged();
+	}
 }
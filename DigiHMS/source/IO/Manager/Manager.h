@@ -11,9 +11,22 @@
 #pragma once
 
 #include <QObject>
+#include <IO/Compression/Codec.h>
+#include <IO/Manager/ProtocolDescriptor.h>
+#include <IO/Manager/FrameSink.h>
+#include <QVector>
+#include <memory>
 // #include <IO/HAL_Driver.h>
 
 class HAL_Driver;
+class FdDriver;
+
+/// <summary>
+/// 将字符串中的转义字符文本 (如 "\\n") 替换为对应的控制字符
+/// </summary>
+/// <param name="str">原始字符串</param>
+/// <returns>替换后的字符串</returns>
+QString ADD_ESCAPE_SEQUENCES(const QString& str);
 
 class Manager : public QObject
 {
@@ -28,6 +41,9 @@ class Manager : public QObject
 	Q_PROPERTY(bool connected
 		READ Connected
 		NOTIFY connectedChanged)
+	Q_PROPERTY(bool connecting
+		READ Connecting
+		NOTIFY connectingChanged)
 	Q_PROPERTY(bool deviceAvailable
 		READ DeviceAvailable
 		NOTIFY driverChanged)
@@ -58,7 +74,8 @@ private:
 	/// <summary>
 	/// 构造 Manager
 	/// </summary>
-	explicit Manager();
+	/// <param name="attachDriver">是否绑定默认的串口设备</param>
+	explicit Manager(bool attachDriver = true);
 	Manager(Manager&&) = delete;
 	Manager(const Manager&) = delete;
 	Manager& operator=(Manager&&) = delete;
@@ -67,7 +84,11 @@ private:
 public:
 	enum class SelectedDriver
 	{
-		Serial
+		Serial,
+		/// <summary>
+		/// 设备文件 / 伪终端 (由 Reactor 线程读取, 仅 Linux)
+		/// </summary>
+		Device
 	};
 	Q_ENUM(SelectedDriver)
 
@@ -84,6 +105,12 @@ public:
 	/// </summary>
 	/// <returns>Manager 实例</returns>
 	static Manager& Instance();
+	/// <summary>
+	/// 创建独立于单例的 Manager
+	/// <para>不绑定任何设备, 只能通过 processData 解析数据, 为了方便测试与基准测试</para>
+	/// </summary>
+	/// <returns>Manager 实例</returns>
+	static std::unique_ptr<Manager> CreateIsolated();
 
 	/// <summary>
 	/// 获取设备已连接且是否为只读模式
@@ -101,6 +128,11 @@ public:
 	/// <returns>连接状态</returns>
 	bool Connected();
 	/// <summary>
+	/// 获取是否正在异步打开设备
+	/// </summary>
+	/// <returns>连接中状态</returns>
+	bool Connecting() const;
+	/// <summary>
 	/// 获取当前是否已选择设备
 	/// </summary>
 	/// <returns>选择状态</returns>
@@ -121,8 +153,13 @@ public:
 	/// <returns>设备指针</returns>
 	HAL_Driver* Driver();
 	/// <summary>
+	/// 获取设备文件驱动 (选择 SelectedDriver::Device 时使用)
+	/// </summary>
+	/// <returns>设备文件驱动指针</returns>
+	FdDriver* DeviceDriver();
+	/// <summary>
 	/// 获取当前选择的设备类型
-	/// <para>Serial</para>
+	/// <para>Serial, Device</para>
 	/// </summary>
 	/// <returns>设备类型</returns>
 	SelectedDriver GetSelectedDriver();
@@ -137,6 +174,49 @@ public:
 	/// <param name="data">要写入的数据</param>
 	/// <returns>成功写入数据数量</returns>
 	Q_INVOKABLE qint64 WriteData(const QByteArray& data);
+	/// <summary>
+	/// 写入一帧: 起始序列 + 各段数据 + 结束序列 [+ "crcN:" 与校验值]
+	/// <para>校验值按段增量计算, 各段通过 HAL_Driver::WriteGather 直接提交, 不拼接负载</para>
+	/// <para>设备不支持分散写入或启用了压缩时, 拼接到复用的缓冲区后写入</para>
+	/// </summary>
+	/// <param name="parts">帧内容的各段</param>
+	/// <param name="count">段数量</param>
+	/// <param name="checksum">校验类型</param>
+	/// <returns>成功写入数据数量 (包含起始序列与帧尾部)</returns>
+	qint64 WriteFrameParts(const QByteArrayView* parts, qint32 count, ProtocolDescriptor::Checksum checksum = ProtocolDescriptor::Checksum::None);
+	/// <summary>
+	/// 获取首选的压缩类型 (按优先级排列)
+	/// </summary>
+	/// <returns>压缩类型列表</returns>
+	QList<Codec::Type> PreferredCodecs() const;
+	/// <summary>
+	/// 获取与当前设备协商后使用的压缩类型
+	/// </summary>
+	/// <returns>压缩类型</returns>
+	Codec::Type ActiveCodec() const;
+	/// <summary>
+	/// 获取设备确认可以解码的压缩类型 (未确认时只有 None)
+	/// </summary>
+	/// <returns>压缩类型列表</returns>
+	QList<Codec::Type> DeviceCodecs() const;
+
+	/// <summary>
+	/// 获取当前的帧协议描述 (解析与编码共享, 序列变化时整体替换)
+	/// </summary>
+	/// <returns>协议描述</returns>
+	std::shared_ptr<const ProtocolDescriptor> Protocol() const;
+
+	/// <summary>
+	/// 添加进程内帧接收者 (不获取所有权)
+	/// <para>每次解析完成后在 Manager 所在线程中直接调用, 先于 framesReceived 与 frameReceived 信号</para>
+	/// </summary>
+	/// <param name="sink">帧接收者</param>
+	void AddFrameSink(FrameSink* sink);
+	/// <summary>
+	/// 移除进程内帧接收者
+	/// </summary>
+	/// <param name="sink">帧接收者</param>
+	void RemoveFrameSink(FrameSink* sink);
 
 	QString StartSequence() const;
 
@@ -145,11 +225,60 @@ public:
 	QString SeparatorSequence() const;
 
 private:
-	ValidationStatus IntegrityChecks(const QByteArray& frame, const QByteArray& cursor, qint32* bytes);
+	/// <summary>
+	/// 从缓冲区中解析完整的帧并移除已处理的数据
+	/// </summary>
+	void parseFrames();
+	/// <summary>
+	/// 校验帧尾部
+	/// </summary>
+	/// <param name="frame">帧内容</param>
+	/// <param name="frameLength">帧内容长度</param>
+	/// <param name="trailer">结束序列开始的数据</param>
+	/// <param name="trailerLength">可用数据长度</param>
+	/// <param name="bytes">累加帧尾部 (结束序列与校验值) 的字节数</param>
+	/// <returns>校验结果</returns>
+	ValidationStatus IntegrityChecks(const char* frame, qint32 frameLength, const char* trailer, qint32 trailerLength, qint32* bytes);
+	/// <summary>
+	/// 将一次解析得到的帧分发给帧接收者与已连接的信号
+	/// </summary>
+	/// <param name="buffer">帧所在的缓冲区</param>
+	/// <param name="spans">帧位置</param>
+	void dispatchFrames(const QByteArray& buffer, const QVector<FrameSpan>& spans);
+	/// <summary>
+	/// 根据起始/结束/分隔序列重新生成协议描述
+	/// </summary>
+	void updateProtocol();
+	/// <summary>
+	/// 经过压缩阶段后写入设备
+	/// </summary>
+	/// <param name="data">要写入的数据</param>
+	/// <returns>成功写入的原始数据字节数量</returns>
+	quint64 writeToDriver(const QByteArray& data);
+	/// <summary>
+	/// 写入控制帧 (起始序列 + 命令 + 结束序列, 不带校验值)
+	/// </summary>
+	/// <param name="command">命令</param>
+	void writeControl(const QByteArray& command);
+	/// <summary>
+	/// 存在可用的压缩类型时 查询设备可以解码的类型 (响应由 parseFrames 处理)
+	/// </summary>
+	void queryDeviceCodecs();
+	/// <summary>
+	/// 根据首选列表与设备支持的类型选择压缩类型
+	/// </summary>
+	/// <param name="announce">类型变化时是否向设备宣告 (连接建立或断开时不宣告)</param>
+	void negotiateCodec(bool announce = true);
 
 signals:
 	void driverChanged();
 	void connectedChanged();
+	void connectingChanged();
+	/// <summary>
+	/// connectDevice 发起的连接完成 (成功, 失败或超时)
+	/// </summary>
+	/// <param name="ok">是否连接成功</param>
+	void connectFinished(bool ok);
 	void writeEnabledChanged();
 	void configurationChanged();
 	void receivedBytesChanged();
@@ -162,10 +291,17 @@ signals:
 	void dataSent(const QByteArray& data);
 	void dataReceived(const QByteArray& data);
 	void frameReceived(const QByteArray& frame);
+	/// <summary>
+	/// 一次解析得到的所有帧 (每次解析最多发送一次 没有连接时不构造)
+	/// </summary>
+	/// <param name="batch">帧列表</param>
+	void framesReceived(const FrameBatch& batch);
+	void codecChanged();
 
 public slots:
 	/// <summary>
-	/// 关闭当前连接打开新的设备连接
+	/// 关闭当前连接 异步打开新的设备连接
+	/// <para>立即返回, 完成时发送 connectedChanged 与 connectFinished</para>
 	/// </summary>
 	void connectDevice();
 	/// <summary>
@@ -188,6 +324,12 @@ public slots:
 	/// <param name="payload">模拟数据</param>
 	void processPayload(const QByteArray& payload);
 	/// <summary>
+	/// 模拟设备接收到原始数据并执行帧解析
+	/// <para>不要求设备已连接, 为了方便调试与基准测试</para>
+	/// </summary>
+	/// <param name="data">模拟数据</param>
+	void processData(const QByteArray& data);
+	/// <summary>
 	/// 设置缓冲区最大容量
 	/// </summary>
 	/// <param name="maxBufferSize">缓冲区大小</param>
@@ -203,6 +345,18 @@ public slots:
 	void setFinishSequence(const QString& sequence);
 
 	void setSeparatorSequence(const QString& sequence);
+	/// <summary>
+	/// 设置首选的压缩类型 并与当前设备重新协商
+	/// <para>选择列表中第一个设备支持且已编译的类型, 都不支持时不压缩</para>
+	/// </summary>
+	/// <param name="codecs">压缩类型列表 (按优先级排列)</param>
+	void setPreferredCodecs(const QList<Codec::Type>& codecs);
+	/// <summary>
+	/// 设置设备确认可以解码的压缩类型 并重新协商
+	/// <para>每次连接后重置为只有 None, 连接后发送 #codecs? 查询, 由设备的 #codecs: 响应设置</para>
+	/// </summary>
+	/// <param name="codecs">压缩类型列表</param>
+	void setDeviceCodecs(const QList<Codec::Type>& codecs);
 
 private slots:
 	void readFrames();
@@ -220,18 +374,40 @@ private slots:
 	/// </summary>
 	/// <param name="data">接收到的数据</param>
 	void onDataReceived(const QByteArray& data);
+	/// <summary>
+	/// 设备异步打开完成时回调函数
+	/// </summary>
+	/// <param name="ok">是否打开成功</param>
+	void onOpenFinished(bool ok);
 
 private:
 	bool m_writeEnabled;
+	bool m_connecting;
 	qint32 m_maxBufferSize;
 	HAL_Driver* m_driver;
+	FdDriver* m_deviceDriver;
 
 	bool m_enableCrc;
 	QString m_startSequence;
 	QString m_finishSequence;
 	QString m_separatorSequence;
+	std::shared_ptr<const ProtocolDescriptor> m_protocol;
+
+	QList<Codec::Type> m_preferredCodecs;
+	QList<Codec::Type> m_deviceCodecs;
+	std::unique_ptr<Codec> m_codec;
+	QByteArray m_packBuffer;
+	/// <summary>
+	/// 分散写入不可用时拼接帧的缓冲区 (复用 避免逐帧分配)
+	/// </summary>
+	QByteArray m_gatherBuffer;
 
 	QByteArray m_dataBuffer;
+	/// <summary>
+	/// 解析时收集的帧位置 (复用 避免逐次分配)
+	/// </summary>
+	QVector<FrameSpan> m_spans;
+	QVector<FrameSink*> m_sinks;
 	quint64 m_receivedBytes;
 
 	SelectedDriver m_selectedDriver;
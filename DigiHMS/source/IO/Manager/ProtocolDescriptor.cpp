@@ -0,0 +1,88 @@
+﻿#include "ProtocolDescriptor.h"
+#include <cstring>
+
+std::shared_ptr<const ProtocolDescriptor> ProtocolDescriptor::Create(const QString& start, const QString& finish, const QString& separator)
+{
+	return std::shared_ptr<const ProtocolDescriptor>(new ProtocolDescriptor(start, finish, separator));
+}
+
+ProtocolDescriptor::ProtocolDescriptor(const QString& start, const QString& finish, const QString& separator)
+	: m_start(start.toUtf8())
+	, m_finish(finish.toUtf8())
+	, m_separator(separator.toUtf8())
+{
+	m_startMatcher.setPattern(m_start);
+	m_finishMatcher.setPattern(m_finish);
+
+	m_trailers[0] = m_finish + "crc8:";
+	m_trailers[1] = m_finish + "crc16:";
+	m_trailers[2] = m_finish + "crc32:";
+}
+
+const QByteArray& ProtocolDescriptor::Start() const
+{
+	return m_start;
+}
+
+const QByteArray& ProtocolDescriptor::Finish() const
+{
+	return m_finish;
+}
+
+const QByteArray& ProtocolDescriptor::Separator() const
+{
+	return m_separator;
+}
+
+qint32 ProtocolDescriptor::IndexOfStart(const char* data, qint32 length, qint32 from) const
+{
+	return static_cast<qint32>(m_startMatcher.indexIn(data, length, from));
+}
+
+qint32 ProtocolDescriptor::IndexOfFinish(const char* data, qint32 length, qint32 from) const
+{
+	return static_cast<qint32>(m_finishMatcher.indexIn(data, length, from));
+}
+
+ProtocolDescriptor::Checksum ProtocolDescriptor::MatchTrailer(const char* data, qint32 length, qint32* headerLength) const
+{
+	// 三种尾部头均以 结束序列 + "crc" 开头 先比较公共前缀
+	const auto prefix = m_finish.length() + 3;
+	if (length < prefix + 2 || std::memcmp(data, m_trailers[0].constData(), prefix) != 0)
+		return Checksum::None;
+
+	for (auto i = 0; i < 3; ++i)
+	{
+		const auto& trailer = m_trailers[i];
+		if (length >= trailer.length() && std::memcmp(data + prefix, trailer.constData() + prefix, trailer.length() - prefix) == 0)
+		{
+			*headerLength = trailer.length();
+			return static_cast<Checksum>(i + 1);
+		}
+	}
+
+	return Checksum::None;
+}
+
+const QByteArray& ProtocolDescriptor::Trailer(Checksum checksum) const
+{
+	if (checksum == Checksum::None)
+		return m_finish;
+
+	return m_trailers[static_cast<qint32>(checksum) - 1];
+}
+
+qint32 ProtocolDescriptor::ChecksumSize(Checksum checksum)
+{
+	switch (checksum)
+	{
+	case Checksum::Crc8:
+		return 1;
+	case Checksum::Crc16:
+		return 2;
+	case Checksum::Crc32:
+		return 4;
+	default:
+		return 0;
+	}
+}
@@ -0,0 +1,86 @@
+﻿#pragma once
+
+#include <QByteArray>
+#include <QByteArrayMatcher>
+#include <QString>
+#include <memory>
+
+/// <summary>
+/// 编译后的帧协议描述 (不可变)
+/// <para>包含起始/结束/分隔序列的 UTF-8 字节, 起始与结束序列的查找表, 以及校验尾部 (结束序列 + "crcN:") 的匹配数据</para>
+/// <para>仅在序列配置变化时重新生成, 解析与编码共享同一实例, 逐帧处理时不再转换编码或分配内存</para>
+/// </summary>
+class ProtocolDescriptor
+{
+public:
+	/// <summary>
+	/// 帧尾部的校验类型
+	/// </summary>
+	enum class Checksum
+	{
+		None,
+		Crc8,
+		Crc16,
+		Crc32
+	};
+
+	/// <summary>
+	/// 生成协议描述
+	/// </summary>
+	/// <param name="start">起始序列</param>
+	/// <param name="finish">结束序列</param>
+	/// <param name="separator">分隔序列</param>
+	/// <returns>协议描述</returns>
+	static std::shared_ptr<const ProtocolDescriptor> Create(const QString& start, const QString& finish, const QString& separator);
+
+	const QByteArray& Start() const;
+	const QByteArray& Finish() const;
+	const QByteArray& Separator() const;
+
+	/// <summary>
+	/// 在 [data, data + length) 的 from 位置之后查找起始序列
+	/// </summary>
+	/// <returns>位置 未找到时返回 -1</returns>
+	qint32 IndexOfStart(const char* data, qint32 length, qint32 from) const;
+	/// <summary>
+	/// 在 [data, data + length) 的 from 位置之后查找结束序列
+	/// </summary>
+	/// <returns>位置 未找到时返回 -1</returns>
+	qint32 IndexOfFinish(const char* data, qint32 length, qint32 from) const;
+	/// <summary>
+	/// 判断 data 是否以校验尾部开头 (结束序列 + "crc8:" / "crc16:" / "crc32:")
+	/// </summary>
+	/// <param name="data">数据 (应位于结束序列处)</param>
+	/// <param name="length">可用数据长度</param>
+	/// <param name="headerLength">输出尾部头的长度 (不含校验值)</param>
+	/// <returns>校验类型 不匹配或数据不足以判断时返回 None</returns>
+	Checksum MatchTrailer(const char* data, qint32 length, qint32* headerLength) const;
+	/// <summary>
+	/// 获取帧尾部头 (不含校验值)
+	/// </summary>
+	/// <param name="checksum">校验类型</param>
+	/// <returns>None 时为结束序列, 否则为 结束序列 + "crcN:"</returns>
+	const QByteArray& Trailer(Checksum checksum) const;
+	/// <summary>
+	/// 获取校验值的字节数
+	/// </summary>
+	/// <param name="checksum">校验类型</param>
+	/// <returns>字节数</returns>
+	static qint32 ChecksumSize(Checksum checksum);
+
+private:
+	ProtocolDescriptor(const QString& start, const QString& finish, const QString& separator);
+
+private:
+	QByteArray m_start;
+	QByteArray m_finish;
+	QByteArray m_separator;
+
+	QByteArrayMatcher m_startMatcher;
+	QByteArrayMatcher m_finishMatcher;
+
+	/// <summary>
+	/// 按 Crc8 / Crc16 / Crc32 顺序排列的校验尾部头
+	/// </summary>
+	QByteArray m_trailers[3];
+};
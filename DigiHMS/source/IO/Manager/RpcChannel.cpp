@@ -0,0 +1,268 @@
+﻿#include "RpcChannel.h"
+#include "Manager.h"
+#include <Common/TimerEvents.h>
+#include <QPointer>
+#include <atomic>
+#include <charconv>
+#include <memory>
+
+namespace
+{
+	/// <summary>
+	/// 超时检查周期 (毫秒)
+	/// </summary>
+	const qint32 TimeoutResolution = 100;
+
+	/// <summary>
+	/// 从 data[offset] 开始截取到下一个 ':' 为止的字段 并将 offset 移动到 ':' 之后
+	/// </summary>
+	QByteArray nextField(const QByteArray& data, qint32& offset)
+	{
+		const auto end = data.indexOf(':', offset);
+		const auto field = end < 0 ? data.mid(offset) : data.mid(offset, end - offset);
+		offset = end < 0 ? data.length() : end + 1;
+		return field;
+	}
+}
+
+RpcChannel::RpcChannel(QObject* parent)
+	: QObject(parent)
+	, m_nextId(1)
+	, m_timeoutConsumer(0)
+{
+	m_clock.start();
+
+	auto manager = &Manager::Instance();
+	manager->AddFrameSink(this);
+	connect(manager, &Manager::connectedChanged, this, &RpcChannel::onConnectedChanged);
+
+	m_timeoutConsumer = TimerEvents::Instance().RegisterConsumer("RpcChannel", TimeoutResolution, [this]() {
+		checkTimeouts();
+	});
+	TimerEvents::Instance().SetConsumerActive(m_timeoutConsumer, false);
+}
+
+RpcChannel::~RpcChannel()
+{
+	Manager::Instance().RemoveFrameSink(this);
+	TimerEvents::Instance().UnregisterConsumer(m_timeoutConsumer);
+}
+
+void RpcChannel::RegisterHandler(const QByteArray& method, const Handler& handler)
+{
+	Q_ASSERT(!method.isEmpty() && !method.contains(':'));
+
+	if (handler)
+		m_handlers.insert(method, handler);
+}
+
+void RpcChannel::UnregisterHandler(const QByteArray& method)
+{
+	m_handlers.remove(method);
+}
+
+quint32 RpcChannel::Call(const QByteArray& method, const QByteArray& args, const Callback& callback, qint32 timeoutMs)
+{
+	Q_ASSERT(!method.isEmpty() && !method.contains(':'));
+
+	// 0 保留为无效 ID
+	const auto id = m_nextId++;
+	if (m_nextId == 0)
+		m_nextId = 1;
+
+	if (!send('!', id, method, args))
+		return 0;
+
+	m_pending.insert(id, Pending{ callback, m_clock.elapsed() + qMax(timeoutMs, 0) });
+	TimerEvents::Instance().SetConsumerActive(m_timeoutConsumer, true);
+
+	return id;
+}
+
+bool RpcChannel::Notify(const QByteArray& method, const QByteArray& args)
+{
+	Q_ASSERT(!method.isEmpty() && !method.contains(':'));
+	return send('!', 0, method, args);
+}
+
+void RpcChannel::Cancel(quint32 id)
+{
+	m_pending.remove(id);
+	if (m_pending.isEmpty())
+		TimerEvents::Instance().SetConsumerActive(m_timeoutConsumer, false);
+}
+
+qint32 RpcChannel::PendingCount() const
+{
+	return m_pending.count();
+}
+
+void RpcChannel::OnFrames(const char* data, const FrameSpan* spans, qint32 count)
+{
+	// 遥测帧不以 '!' 或 '=' 开头 直接忽略 不复制内容
+	for (auto i = 0; i < count; ++i)
+	{
+		const auto frame = data + spans[i].offset;
+		if (spans[i].length >= 3 && (frame[0] == '!' || frame[0] == '='))
+			handleFrame(QByteArray(frame, spans[i].length));
+	}
+}
+
+void RpcChannel::handleFrame(const QByteArray& frame)
+{
+	qint32 offset = 1;
+	bool valid = false;
+	const auto id = nextField(frame, offset).toUInt(&valid);
+	if (!valid || (id == 0 && frame.at(0) == '='))
+		return;
+
+	const auto second = nextField(frame, offset);
+	const auto rest = frame.mid(offset);
+
+	if (frame.at(0) == '!')
+		handleRequest(id, second, rest);
+	else if (second == "ok" || second == "err")
+		handleResponse(id, second == "ok", rest);
+}
+
+void RpcChannel::onConnectedChanged()
+{
+	if (!Manager::Instance().Connected())
+		finish(Status::Disconnected);
+}
+
+void RpcChannel::handleRequest(quint32 id, const QByteArray& method, const QByteArray& args)
+{
+	emit requestReceived(method);
+
+	// 通知不需要响应
+	const auto it = m_handlers.constFind(method);
+	if (it == m_handlers.constEnd())
+	{
+		if (id != 0)
+			sendResponse(id, false, "unknown method");
+		return;
+	}
+
+	if (id == 0)
+	{
+		it.value()(args, [](bool, const QByteArray&) {});
+		return;
+	}
+
+	// 处理函数可能在其他线程中完成 响应统一回到通道所在线程发送
+	QPointer<RpcChannel> self(this);
+	auto replied = std::make_shared<std::atomic<bool>>(false);
+	const Reply reply = [self, id, replied](bool ok, const QByteArray& payload) {
+		if (replied->exchange(true) || self.isNull())
+			return;
+
+		QMetaObject::invokeMethod(self.data(), [self, id, ok, payload]() {
+			if (!self.isNull())
+				self->sendResponse(id, ok, payload);
+		}, Qt::AutoConnection);
+	};
+
+	it.value()(args, reply);
+}
+
+void RpcChannel::handleResponse(quint32 id, bool ok, const QByteArray& payload)
+{
+	// 未知或已超时的响应直接丢弃
+	const auto it = m_pending.find(id);
+	if (it == m_pending.end())
+		return;
+
+	const auto callback = it.value().callback;
+	m_pending.erase(it);
+	if (m_pending.isEmpty())
+		TimerEvents::Instance().SetConsumerActive(m_timeoutConsumer, false);
+
+	if (callback)
+		callback(ok ? Status::Ok : Status::Error, payload);
+}
+
+void RpcChannel::sendResponse(quint32 id, bool ok, const QByteArray& payload)
+{
+	// 载荷无法发送时仍回复错误 避免设备端等待超时
+	if (!send('=', id, ok ? QByteArrayLiteral("ok") : QByteArrayLiteral("err"), payload) && containsFinish(payload))
+		send('=', id, QByteArrayLiteral("err"), QByteArrayLiteral("payload contains frame delimiter"));
+}
+
+bool RpcChannel::containsFinish(const QByteArray& data)
+{
+	const auto protocol = Manager::Instance().Protocol();
+	return !protocol->Finish().isEmpty() && data.contains(protocol->Finish());
+}
+
+bool RpcChannel::send(char kind, quint32 id, const QByteArray& head, const QByteArray& tail)
+{
+	auto& manager = Manager::Instance();
+	if (!manager.Connected())
+		return false;
+
+	// 载荷中不能出现结束序列 否则接收端会提前截断帧并失去同步
+	// (例如包含 "*/" 的传感器名称或错误信息) 这类消息不发送
+	const auto protocol = manager.Protocol();
+	if (containsFinish(head) || containsFinish(tail))
+		return false;
+
+	// 各段分别提交 起始/结束序列由 Manager 添加
+	char prefix[16];
+	prefix[0] = kind;
+	auto end = std::to_chars(prefix + 1, prefix + sizeof(prefix) - 1, id).ptr;
+	*end++ = ':';
+
+	const QByteArrayView parts[] = {
+		QByteArrayView(prefix, end - prefix),
+		head,
+		tail.isEmpty() ? QByteArrayView() : QByteArrayView(":"),
+		tail
+	};
+	const auto length = protocol->Start().length() + (end - prefix) + head.length()
+		+ (tail.isEmpty() ? 0 : tail.length() + 1) + protocol->Finish().length();
+
+	return manager.WriteFrameParts(parts, 4) == length;
+}
+
+void RpcChannel::checkTimeouts()
+{
+	const auto now = m_clock.elapsed();
+
+	// 先收集再回调 回调中可能发起新的请求
+	QList<Callback> expired;
+	for (auto it = m_pending.begin(); it != m_pending.end();)
+	{
+		if (it.value().deadline <= now)
+		{
+			expired.append(it.value().callback);
+			it = m_pending.erase(it);
+		}
+		else
+		{
+			++it;
+		}
+	}
+
+	if (m_pending.isEmpty())
+		TimerEvents::Instance().SetConsumerActive(m_timeoutConsumer, false);
+
+	for (const auto& callback : expired)
+	{
+		if (callback)
+			callback(Status::Timeout, QByteArray());
+	}
+}
+
+void RpcChannel::finish(Status status)
+{
+	const auto pending = m_pending;
+	m_pending.clear();
+	TimerEvents::Instance().SetConsumerActive(m_timeoutConsumer, false);
+
+	for (const auto& entry : pending)
+	{
+		if (entry.callback)
+			entry.callback(status, QByteArray());
+	}
+}
@@ -0,0 +1,128 @@
+﻿#pragma once
+
+#include <QObject>
+#include <IO/Manager/FrameSink.h>
+#include <QHash>
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <functional>
+
+/// <summary>
+/// 基于帧的双向命令通道
+/// <para>请求帧: !&lt;id&gt;:&lt;method&gt;[:&lt;args&gt;]</para>
+/// <para>响应帧: =&lt;id&gt;:ok[:&lt;payload&gt;] 或 =&lt;id&gt;:err[:&lt;message&gt;]</para>
+/// <para>帧仍由 Manager 的起始/结束序列包围; 其他帧 (遥测) 不受影响</para>
+/// <para>每个请求有独立的 ID, 可同时有多个请求在途, 响应可以乱序到达</para>
+/// <para>ID 为 0 的请求是通知, 接收方不发送响应</para>
+/// <para>作为 Manager 的帧接收者直接读取接收缓冲区, 遥测帧只检查首字节</para>
+/// </summary>
+class RpcChannel : public QObject, public FrameSink
+{
+	Q_OBJECT
+
+public:
+	enum class Status
+	{
+		Ok,
+		Error,
+		Timeout,
+		Disconnected
+	};
+
+	/// <summary>
+	/// 请求处理结果回调 (可在任意线程调用 且只能调用一次)
+	/// </summary>
+	using Reply = std::function<void(bool ok, const QByteArray& payload)>;
+	/// <summary>
+	/// 请求处理函数 可以立即或稍后调用 reply
+	/// </summary>
+	using Handler = std::function<void(const QByteArray& args, const Reply& reply)>;
+	/// <summary>
+	/// 主动请求的结果回调
+	/// </summary>
+	using Callback = std::function<void(Status status, const QByteArray& payload)>;
+
+	explicit RpcChannel(QObject* parent = Q_NULLPTR);
+	virtual ~RpcChannel();
+
+	/// <summary>
+	/// 注册请求处理函数
+	/// </summary>
+	/// <param name="method">方法名称</param>
+	/// <param name="handler">处理函数</param>
+	void RegisterHandler(const QByteArray& method, const Handler& handler);
+	/// <summary>
+	/// 注销请求处理函数
+	/// </summary>
+	/// <param name="method">方法名称</param>
+	void UnregisterHandler(const QByteArray& method);
+
+	/// <summary>
+	/// 向设备发送请求 不等待响应
+	/// </summary>
+	/// <param name="method">方法名称</param>
+	/// <param name="args">参数</param>
+	/// <param name="callback">结果回调</param>
+	/// <param name="timeoutMs">超时时间 (毫秒)</param>
+	/// <returns>请求 ID 发送失败 (未连接或参数包含结束序列) 时返回 0</returns>
+	quint32 Call(const QByteArray& method, const QByteArray& args, const Callback& callback, qint32 timeoutMs = 1000);
+	/// <summary>
+	/// 向设备发送通知 (不需要响应)
+	/// </summary>
+	/// <param name="method">方法名称</param>
+	/// <param name="args">参数</param>
+	/// <returns>是否发送成功 (参数包含结束序列时不发送)</returns>
+	bool Notify(const QByteArray& method, const QByteArray& args);
+	/// <summary>
+	/// 取消在途请求 (不会调用回调)
+	/// </summary>
+	/// <param name="id">请求 ID</param>
+	void Cancel(quint32 id);
+	/// <summary>
+	/// 获取在途请求数量
+	/// </summary>
+	/// <returns>请求数量</returns>
+	qint32 PendingCount() const;
+
+	void OnFrames(const char* data, const FrameSpan* spans, qint32 count) override;
+
+signals:
+	/// <summary>
+	/// 收到设备请求
+	/// </summary>
+	/// <param name="method">方法名称</param>
+	void requestReceived(const QByteArray& method);
+
+private slots:
+	void onConnectedChanged();
+
+private:
+	void handleFrame(const QByteArray& frame);
+	void handleRequest(quint32 id, const QByteArray& method, const QByteArray& args);
+	void handleResponse(quint32 id, bool ok, const QByteArray& payload);
+	void sendResponse(quint32 id, bool ok, const QByteArray& payload);
+	bool send(char kind, quint32 id, const QByteArray& head, const QByteArray& tail);
+	/// <summary>
+	/// 是否包含当前协议的结束序列
+	/// </summary>
+	static bool containsFinish(const QByteArray& data);
+	void checkTimeouts();
+	void finish(Status status);
+
+private:
+	struct Pending
+	{
+		Callback callback;
+		qint64 deadline;
+	};
+
+	QHash<QByteArray, Handler> m_handlers;
+	QHash<quint32, Pending> m_pending;
+	quint32 m_nextId;
+
+	/// <summary>
+	/// 超时检查 仅在存在在途请求时活动
+	/// </summary>
+	qint32 m_timeoutConsumer;
+	QElapsedTimer m_clock;
+};
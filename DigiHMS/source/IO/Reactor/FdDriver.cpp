@@ -0,0 +1,336 @@
+﻿#include "FdDriver.h"
+#include <IO/Manager/Manager.h>
+
+#ifdef Q_OS_LINUX
+#include <fcntl.h>
+#include <termios.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+namespace
+{
+	/// <summary>
+	/// 每个设备的接收缓冲区容量
+	/// </summary>
+	const qint32 InputCapacity = 64 * 1024;
+}
+
+FdDriver::FdDriver(QObject* parent)
+	: m_reactor(Reactor::Instance())
+	, m_fd(-1)
+	, m_ownsFd(false)
+	, m_mode(QIODevice::NotOpen)
+	, m_input(InputCapacity)
+	, m_drainPending(false)
+	, m_stalled(false)
+	, m_stalls(0)
+{
+	setParent(parent);
+}
+
+FdDriver::~FdDriver()
+{
+	Close();
+}
+
+bool FdDriver::Open(const QIODevice::OpenMode mode)
+{
+	Close();
+
+#ifdef Q_OS_LINUX
+	if (m_path.isEmpty())
+		return false;
+
+	int flags = O_NOCTTY | O_NONBLOCK | O_CLOEXEC;
+	if ((mode & QIODevice::ReadWrite) == QIODevice::ReadWrite)
+		flags |= O_RDWR;
+	else if (mode & QIODevice::WriteOnly)
+		flags |= O_WRONLY;
+	else
+		flags |= O_RDONLY;
+
+	const auto fd = ::open(m_path.toLocal8Bit().constData(), flags);
+	if (fd < 0)
+		return false;
+
+	// 终端设备使用原始模式 波特率沿用设备当前的设置
+	termios options;
+	if (::isatty(fd) && ::tcgetattr(fd, &options) == 0)
+	{
+		::cfmakeraw(&options);
+		options.c_cc[VMIN] = 0;
+		options.c_cc[VTIME] = 0;
+		::tcsetattr(fd, TCSANOW, &options);
+	}
+
+	return Attach(fd, mode, true);
+#else
+	Q_UNUSED(mode);
+	return false;
+#endif
+}
+
+bool FdDriver::Attach(int fd, const QIODevice::OpenMode mode, bool takeOwnership)
+{
+	Close();
+
+#ifdef Q_OS_LINUX
+	if (fd < 0)
+		return false;
+
+	::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK);
+
+	m_fd = fd;
+	m_ownsFd = takeOwnership;
+	m_mode = mode;
+	if (m_reactor.Register(fd, this))
+		return true;
+
+	if (takeOwnership)
+		::close(fd);
+#else
+	Q_UNUSED(mode);
+	Q_UNUSED(takeOwnership);
+#endif
+
+	m_fd = -1;
+	m_ownsFd = false;
+	m_mode = QIODevice::NotOpen;
+	return false;
+}
+
+void FdDriver::Close()
+{
+	if (m_fd < 0)
+		return;
+
+	// 返回后 Reactor 不再回调
+	m_reactor.Unregister(m_fd);
+
+#ifdef Q_OS_LINUX
+	if (m_ownsFd)
+		::close(m_fd);
+#endif
+
+	m_fd = -1;
+	m_ownsFd = false;
+	m_mode = QIODevice::NotOpen;
+	m_input.Clear();
+	m_stalled = false;
+
+	QMutexLocker lock(&m_writeMutex);
+	m_output.clear();
+}
+
+bool FdDriver::IsOpen() const
+{
+	return m_fd >= 0;
+}
+
+bool FdDriver::IsReadable() const
+{
+	return IsOpen() && (m_mode & QIODevice::ReadOnly);
+}
+
+bool FdDriver::IsWritable() const
+{
+	return IsOpen() && (m_mode & QIODevice::WriteOnly);
+}
+
+quint64 FdDriver::Write(const QByteArray& data)
+{
+	if (!IsWritable())
+		return -1;
+
+	bool waitWritable = false;
+	{
+		QMutexLocker lock(&m_writeMutex);
+
+		// 发送缓冲区中还有数据时 直接写入会打乱顺序
+		if (m_output.isEmpty())
+		{
+			qint64 written = 0;
+#ifdef Q_OS_LINUX
+			while (written < data.length())
+			{
+				const auto bytes = ::write(m_fd, data.constData() + written, data.length() - written);
+				if (bytes < 0)
+				{
+					if (errno == EINTR)
+						continue;
+					break;
+				}
+
+				written += bytes;
+			}
+#endif
+			if (written < data.length())
+			{
+				m_output.append(data.constData() + written, data.length() - written);
+				waitWritable = true;
+			}
+		}
+		else
+		{
+			m_output.append(data);
+		}
+	}
+
+	// 在 m_writeMutex 之外调用 避免与 Reactor 回调的加锁顺序相反
+	if (waitWritable)
+		m_reactor.SetWritable(m_fd, true);
+
+	emit dataSend(data);
+	return data.length();
+}
+
+bool FdDriver::ConfigurationOk() const
+{
+	return IsOpen() || !m_path.isEmpty();
+}
+
+QList<Codec::Type> FdDriver::SupportedCodecs() const
+{
+	return { Codec::Type::None, Codec::Type::Lzss };
+}
+
+QString FdDriver::DevicePath() const
+{
+	return m_path;
+}
+
+int FdDriver::Handle() const
+{
+	return m_fd;
+}
+
+quint64 FdDriver::Stalls() const
+{
+	return m_stalls;
+}
+
+void FdDriver::setDevicePath(const QString& path)
+{
+	if (m_path == path)
+		return;
+
+	m_path = path;
+	emit devicePathChanged();
+	emit configurationChanged();
+}
+
+void FdDriver::OnReadable()
+{
+#ifdef Q_OS_LINUX
+	// 边沿触发 需要一直读取到 EAGAIN
+	bool received = false;
+	while (true)
+	{
+		qint32 length = 0;
+		const auto region = m_input.WriteRegion(&length);
+		if (length == 0)
+		{
+			// 缓冲区已满 drain 后重新评估就绪状态
+			m_stalled = true;
+			m_stalls++;
+			break;
+		}
+
+		const auto bytes = ::read(m_fd, region, length);
+		if (bytes > 0)
+		{
+			m_input.Commit(static_cast<qint32>(bytes));
+			received = true;
+			continue;
+		}
+
+		if (bytes < 0 && errno == EINTR)
+			continue;
+
+		// EAGAIN, 文件结束或错误 (挂断由 OnHangup 处理)
+		break;
+	}
+
+	// 一批数据只投递一次 drain
+	if (received && !m_drainPending.exchange(true))
+	{
+		QMetaObject::invokeMethod(this, [this]() {
+			drain();
+		}, Qt::QueuedConnection);
+	}
+#endif
+}
+
+void FdDriver::OnWritable()
+{
+	bool empty;
+	{
+		QMutexLocker lock(&m_writeMutex);
+		empty = flushOutput();
+	}
+
+	if (empty)
+		m_reactor.SetWritable(m_fd, false);
+}
+
+void FdDriver::OnHangup()
+{
+	QMetaObject::invokeMethod(this, [this]() {
+		handleHangup();
+	}, Qt::QueuedConnection);
+}
+
+void FdDriver::drain()
+{
+	// 先清除标记 读取期间到达的数据会再次投递
+	m_drainPending = false;
+
+	const auto size = m_input.Size();
+	if (size > 0)
+	{
+		// 复用读取缓冲区 接收者未持有上一批数据时不重新分配
+		m_readBuffer.resize(size);
+		m_input.Read(m_readBuffer.data(), size);
+		emit dataReceived(m_readBuffer);
+	}
+
+	if (m_stalled.exchange(false) && IsOpen())
+		m_reactor.Rearm(m_fd);
+}
+
+void FdDriver::handleHangup()
+{
+	if (!IsOpen())
+		return;
+
+	drain();
+	emit hangup();
+
+	// 与 Serial 出错时的处理一致
+	auto& manager = Manager::Instance();
+	if (manager.Driver() == this)
+		manager.disconnectDriver();
+	else
+		Close();
+}
+
+bool FdDriver::flushOutput()
+{
+#ifdef Q_OS_LINUX
+	while (!m_output.isEmpty())
+	{
+		const auto bytes = ::write(m_fd, m_output.constData(), m_output.length());
+		if (bytes < 0)
+		{
+			if (errno == EINTR)
+				continue;
+			return false;
+		}
+
+		m_output.remove(0, bytes);
+	}
+#endif
+
+	return m_output.isEmpty();
+}
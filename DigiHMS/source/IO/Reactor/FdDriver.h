@@ -0,0 +1,129 @@
+﻿#pragma once
+
+#include "../HAL_Driver.h"
+#include "Reactor.h"
+#include "RingBuffer.h"
+#include <QMutex>
+#include <atomic>
+
+/// <summary>
+/// 基于文件描述符的设备 (串口设备文件, 伪终端, 已连接的套接字)
+/// <para>读取由 Reactor 线程以边沿触发方式完成并写入环形缓冲区, 每批数据在所属线程中合并为一次 dataReceived</para>
+/// <para>多个实例共用一个 I/O 线程 (Manager 只持有一个, 用于 SelectedDriver::Device; 串口仍由 QSerialPort 读取)</para>
+/// </summary>
+class FdDriver : public HAL_Driver, public ReactorHandler
+{
+	Q_OBJECT
+
+public:
+	Q_PROPERTY(QString devicePath
+			   READ DevicePath
+			   WRITE setDevicePath
+			   NOTIFY devicePathChanged)
+
+public:
+	explicit FdDriver(QObject* parent = Q_NULLPTR);
+	virtual ~FdDriver();
+
+	/// <summary>
+	/// 打开 DevicePath 指定的设备文件 (终端设备设置为原始模式, 保留波特率)
+	/// </summary>
+	/// <param name="mode">打开方式</param>
+	/// <returns>是否打开成功</returns>
+	bool Open(const QIODevice::OpenMode mode) override;
+	/// <summary>
+	/// 使用已经打开的文件描述符 (例如已连接的套接字)
+	/// </summary>
+	/// <param name="fd">文件描述符 会被设置为非阻塞模式</param>
+	/// <param name="mode">打开方式</param>
+	/// <param name="takeOwnership">关闭时是否关闭文件描述符</param>
+	/// <returns>是否注册成功</returns>
+	bool Attach(int fd, const QIODevice::OpenMode mode, bool takeOwnership);
+	void Close() override;
+	bool IsOpen() const override;
+	bool IsReadable() const override;
+	bool IsWritable() const override;
+	/// <summary>
+	/// 写入数据 设备暂时不可写时剩余数据进入发送缓冲区, 由 Reactor 线程在可写时发送
+	/// </summary>
+	/// <param name="data">数据</param>
+	/// <returns>写入或进入发送缓冲区的字节数量</returns>
+	quint64 Write(const QByteArray& data) override;
+	bool ConfigurationOk() const override;
+	QList<Codec::Type> SupportedCodecs() const override;
+
+	/// <summary>
+	/// 获取设备文件路径
+	/// </summary>
+	/// <returns>设备文件路径</returns>
+	QString DevicePath() const;
+	/// <summary>
+	/// 获取文件描述符
+	/// </summary>
+	/// <returns>文件描述符 未打开时返回 -1</returns>
+	int Handle() const;
+	/// <summary>
+	/// 接收环形缓冲区已满而暂停读取的次数 (数据留在内核缓冲区中 不会丢失)
+	/// </summary>
+	/// <returns>次数</returns>
+	quint64 Stalls() const;
+
+signals:
+	void devicePathChanged();
+	/// <summary>
+	/// 对端挂断或设备出错 (已在所属线程中读取剩余数据)
+	/// </summary>
+	void hangup();
+
+public slots:
+	void setDevicePath(const QString& path);
+
+protected:
+	void OnReadable() override;
+	void OnWritable() override;
+	void OnHangup() override;
+
+private:
+	/// <summary>
+	/// 在所属线程中取出环形缓冲区的数据并发送 dataReceived
+	/// </summary>
+	void drain();
+	/// <summary>
+	/// 在所属线程中处理挂断
+	/// </summary>
+	void handleHangup();
+	/// <summary>
+	/// 发送缓冲区中的数据 (调用前需要持有 m_writeMutex)
+	/// </summary>
+	/// <returns>发送缓冲区是否已清空</returns>
+	bool flushOutput();
+
+private:
+	/// <summary>
+	/// 保证 Reactor 在所有 FdDriver 之前构造 在之后析构
+	/// </summary>
+	Reactor& m_reactor;
+
+	QString m_path;
+	int m_fd;
+	bool m_ownsFd;
+	QIODevice::OpenMode m_mode;
+
+	/// <summary>
+	/// 接收缓冲区 (Reactor 线程写入 所属线程读取)
+	/// </summary>
+	RingBuffer m_input;
+	QByteArray m_readBuffer;
+	/// <summary>
+	/// 已投递 drain 尚未执行 (一批数据只投递一次)
+	/// </summary>
+	std::atomic<bool> m_drainPending;
+	/// <summary>
+	/// 缓冲区已满而停止读取 drain 后需要 Rearm
+	/// </summary>
+	std::atomic<bool> m_stalled;
+	std::atomic<quint64> m_stalls;
+
+	QMutex m_writeMutex;
+	QByteArray m_output;
+};
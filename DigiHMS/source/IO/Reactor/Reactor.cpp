@@ -0,0 +1,250 @@
+﻿#include "Reactor.h"
+#include <QThread>
+
+#ifdef Q_OS_LINUX
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <cerrno>
+
+namespace
+{
+	/// <summary>
+	/// 单次 epoll_wait 最多取回的事件数量
+	/// </summary>
+	const int MaxEvents = 64;
+
+	/// <summary>
+	/// 默认监听的事件 (边沿触发)
+	/// </summary>
+	const quint32 ReadEvents = EPOLLIN | EPOLLRDHUP | EPOLLET;
+}
+
+Reactor::Reactor()
+	: m_epoll(::epoll_create1(EPOLL_CLOEXEC))
+	, m_wakeup(::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC))
+	, m_thread(Q_NULLPTR)
+	, m_running(false)
+	, m_wakeups(0)
+{
+	if (m_epoll >= 0 && m_wakeup >= 0)
+	{
+		epoll_event event{};
+		event.events = EPOLLIN;
+		event.data.fd = m_wakeup;
+		::epoll_ctl(m_epoll, EPOLL_CTL_ADD, m_wakeup, &event);
+	}
+}
+
+Reactor::~Reactor()
+{
+	if (m_thread)
+	{
+		// 唤醒 epoll_wait 后退出线程
+		m_running = false;
+		const quint64 value = 1;
+		Q_UNUSED(::write(m_wakeup, &value, sizeof(value)));
+
+		m_thread->wait();
+		delete m_thread;
+	}
+
+	if (m_wakeup >= 0)
+		::close(m_wakeup);
+	if (m_epoll >= 0)
+		::close(m_epoll);
+}
+
+bool Reactor::Register(int fd, ReactorHandler* handler)
+{
+	if (m_epoll < 0 || fd < 0 || handler == Q_NULLPTR)
+		return false;
+
+	QMutexLocker lock(&m_mutex);
+	if (m_entries.contains(fd))
+		return false;
+
+	epoll_event event{};
+	event.events = ReadEvents;
+	event.data.fd = fd;
+	if (::epoll_ctl(m_epoll, EPOLL_CTL_ADD, fd, &event) != 0)
+		return false;
+
+	m_entries.insert(fd, Entry{ handler, ReadEvents });
+	start();
+	return true;
+}
+
+void Reactor::Unregister(int fd)
+{
+	QMutexLocker lock(&m_mutex);
+	if (m_entries.remove(fd) > 0)
+		::epoll_ctl(m_epoll, EPOLL_CTL_DEL, fd, Q_NULLPTR);
+}
+
+void Reactor::SetWritable(int fd, bool enabled)
+{
+	QMutexLocker lock(&m_mutex);
+	auto it = m_entries.find(fd);
+	if (it == m_entries.end())
+		return;
+
+	const quint32 events = enabled ? (ReadEvents | EPOLLOUT) : ReadEvents;
+	if (it.value().events != events && modify(fd, events))
+		it.value().events = events;
+}
+
+void Reactor::Rearm(int fd)
+{
+	QMutexLocker lock(&m_mutex);
+	const auto it = m_entries.constFind(fd);
+	if (it != m_entries.constEnd())
+		modify(fd, it.value().events);
+}
+
+qint32 Reactor::Count() const
+{
+	QMutexLocker lock(&m_mutex);
+	return static_cast<qint32>(m_entries.count());
+}
+
+quint64 Reactor::Wakeups() const
+{
+	return m_wakeups;
+}
+
+void Reactor::run()
+{
+	epoll_event events[MaxEvents];
+	while (m_running)
+	{
+		const auto count = ::epoll_wait(m_epoll, events, MaxEvents, -1);
+		if (count < 0)
+		{
+			if (errno == EINTR)
+				continue;
+			break;
+		}
+
+		m_wakeups++;
+		for (auto i = 0; i < count; ++i)
+		{
+			const auto fd = events[i].data.fd;
+			const auto flags = events[i].events;
+			if (fd == m_wakeup)
+			{
+				quint64 value;
+				Q_UNUSED(::read(m_wakeup, &value, sizeof(value)));
+				continue;
+			}
+
+			// 同一批事件中前面的回调可能已经注销了该文件描述符
+			QMutexLocker lock(&m_mutex);
+			const auto it = m_entries.constFind(fd);
+			if (it == m_entries.constEnd())
+				continue;
+
+			const auto handler = it.value().handler;
+
+			// 挂断前先读取剩余的数据
+			if (flags & (EPOLLIN | EPOLLRDHUP | EPOLLHUP))
+				handler->OnReadable();
+			if (flags & EPOLLOUT)
+				handler->OnWritable();
+			if (flags & (EPOLLRDHUP | EPOLLHUP | EPOLLERR))
+				handler->OnHangup();
+		}
+	}
+}
+
+void Reactor::start()
+{
+	if (m_thread)
+		return;
+
+	m_running = true;
+	m_thread = QThread::create([this]() {
+		run();
+	});
+	m_thread->setObjectName("Reactor");
+	m_thread->start(QThread::TimeCriticalPriority);
+}
+
+bool Reactor::modify(int fd, quint32 events)
+{
+	epoll_event event{};
+	event.events = events;
+	event.data.fd = fd;
+	return ::epoll_ctl(m_epoll, EPOLL_CTL_MOD, fd, &event) == 0;
+}
+
+#else
+
+Reactor::Reactor()
+	: m_epoll(-1)
+	, m_wakeup(-1)
+	, m_thread(Q_NULLPTR)
+	, m_running(false)
+	, m_wakeups(0)
+{
+}
+
+Reactor::~Reactor()
+{
+}
+
+bool Reactor::Register(int fd, ReactorHandler* handler)
+{
+	Q_UNUSED(fd);
+	Q_UNUSED(handler);
+	return false;
+}
+
+void Reactor::Unregister(int fd)
+{
+	Q_UNUSED(fd);
+}
+
+void Reactor::SetWritable(int fd, bool enabled)
+{
+	Q_UNUSED(fd);
+	Q_UNUSED(enabled);
+}
+
+void Reactor::Rearm(int fd)
+{
+	Q_UNUSED(fd);
+}
+
+qint32 Reactor::Count() const
+{
+	return 0;
+}
+
+quint64 Reactor::Wakeups() const
+{
+	return 0;
+}
+
+void Reactor::run()
+{
+}
+
+void Reactor::start()
+{
+}
+
+bool Reactor::modify(int fd, quint32 events)
+{
+	Q_UNUSED(fd);
+	Q_UNUSED(events);
+	return false;
+}
+
+#endif
+
+Reactor& Reactor::Instance()
+{
+	static Reactor singleton;
+	return singleton;
+}
@@ -0,0 +1,113 @@
+﻿#pragma once
+
+#include <QHash>
+#include <QRecursiveMutex>
+#include <atomic>
+
+class QThread;
+
+/// <summary>
+/// 反应器事件处理接口
+/// <para>所有回调都在反应器线程中执行, 回调中不能阻塞</para>
+/// </summary>
+class ReactorHandler
+{
+public:
+	virtual ~ReactorHandler() = default;
+
+	/// <summary>
+	/// 文件描述符可读 (边沿触发, 需要一直读取到 EAGAIN)
+	/// </summary>
+	virtual void OnReadable() = 0;
+	/// <summary>
+	/// 文件描述符可写 (仅在 SetWritable 开启后通知)
+	/// </summary>
+	virtual void OnWritable() {}
+	/// <summary>
+	/// 对端挂断或发生错误
+	/// </summary>
+	virtual void OnHangup() = 0;
+};
+
+/// <summary>
+/// 单线程 epoll 反应器 (仅 Linux 有效, 其他平台 Register 返回 false)
+/// <para>一个 I/O 线程以边沿触发方式等待所有已注册的文件描述符, 代替每个设备一个 QSocketNotifier</para>
+/// <para>目前只有 FdDriver 注册到反应器, 串口 (Serial) 仍使用 QSerialPort 的通知</para>
+/// <para>首次注册时启动反应器线程</para>
+/// </summary>
+class Reactor
+{
+	/**
+	*  只能通过 Instance() 获取 Reactor 实例
+	*/
+private:
+	explicit Reactor();
+	Reactor(Reactor&&) = delete;
+	Reactor(const Reactor&) = delete;
+	Reactor& operator=(Reactor&&) = delete;
+	Reactor& operator=(const Reactor&) = delete;
+	~Reactor();
+
+public:
+	/// <summary>
+	/// 获取 Reactor 单例
+	/// </summary>
+	/// <returns>Reactor 实例</returns>
+	static Reactor& Instance();
+
+	/// <summary>
+	/// 注册文件描述符 (文件描述符需要为非阻塞模式)
+	/// </summary>
+	/// <param name="fd">文件描述符</param>
+	/// <param name="handler">事件处理者 注销前必须保持有效</param>
+	/// <returns>是否注册成功</returns>
+	bool Register(int fd, ReactorHandler* handler);
+	/// <summary>
+	/// 注销文件描述符
+	/// <para>返回后不会再有该文件描述符的回调 (不能在回调中调用)</para>
+	/// </summary>
+	/// <param name="fd">文件描述符</param>
+	void Unregister(int fd);
+	/// <summary>
+	/// 开启或关闭可写通知 (可以在回调中调用)
+	/// </summary>
+	/// <param name="fd">文件描述符</param>
+	/// <param name="enabled">是否通知可写</param>
+	void SetWritable(int fd, bool enabled);
+	/// <summary>
+	/// 重新评估文件描述符的就绪状态
+	/// <para>处理者因缓冲区满停止读取后调用, 仍有未读数据时会再次通知 OnReadable</para>
+	/// </summary>
+	/// <param name="fd">文件描述符</param>
+	void Rearm(int fd);
+	/// <summary>
+	/// 已注册的文件描述符数量
+	/// </summary>
+	qint32 Count() const;
+	/// <summary>
+	/// epoll_wait 返回的次数 (用于统计)
+	/// </summary>
+	quint64 Wakeups() const;
+
+private:
+	void run();
+	void start();
+	bool modify(int fd, quint32 events);
+
+private:
+	struct Entry
+	{
+		ReactorHandler* handler;
+		quint32 events;
+	};
+
+	int m_epoll;
+	int m_wakeup;
+	QThread* m_thread;
+	std::atomic<bool> m_running;
+	std::atomic<quint64> m_wakeups;
+
+	// 分发回调时持有 保证 Unregister 返回后不再回调
+	mutable QRecursiveMutex m_mutex;
+	QHash<int, Entry> m_entries;
+};
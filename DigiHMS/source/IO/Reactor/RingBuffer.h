@@ -0,0 +1,114 @@
+﻿#pragma once
+
+#include <QtGlobal>
+#include <atomic>
+#include <cstring>
+#include <memory>
+
+/// <summary>
+/// 单生产者单消费者字节环形缓冲区 (无锁)
+/// <para>生产者与消费者可以位于不同线程, 但各自只能有一个</para>
+/// <para>容量向上取整为 2 的幂</para>
+/// </summary>
+class RingBuffer
+{
+public:
+	explicit RingBuffer(qint32 capacity)
+		: m_capacity(roundUp(capacity))
+		, m_mask(m_capacity - 1)
+		, m_data(new char[m_capacity])
+		, m_head(0)
+		, m_tail(0)
+	{
+	}
+
+	RingBuffer(const RingBuffer&) = delete;
+	RingBuffer& operator=(const RingBuffer&) = delete;
+
+	/// <summary>
+	/// 缓冲区容量
+	/// </summary>
+	qint32 Capacity() const
+	{
+		return static_cast<qint32>(m_capacity);
+	}
+
+	/// <summary>
+	/// 可读取的字节数量
+	/// </summary>
+	qint32 Size() const
+	{
+		return static_cast<qint32>(m_head.load(std::memory_order_acquire) - m_tail.load(std::memory_order_acquire));
+	}
+
+	/// <summary>
+	/// 获取可以直接写入的连续空间 (生产者调用)
+	/// <para>写入后调用 Commit 提交, 回绕时连续空间可能小于剩余空间</para>
+	/// </summary>
+	/// <param name="length">输出连续空间长度 为 0 时缓冲区已满</param>
+	/// <returns>写入位置</returns>
+	char* WriteRegion(qint32* length)
+	{
+		const auto head = m_head.load(std::memory_order_relaxed);
+		const auto free = m_capacity - (head - m_tail.load(std::memory_order_acquire));
+		const auto offset = head & m_mask;
+		*length = static_cast<qint32>(qMin(free, m_capacity - offset));
+		return m_data.get() + offset;
+	}
+
+	/// <summary>
+	/// 提交 WriteRegion 中写入的字节 (生产者调用)
+	/// </summary>
+	void Commit(qint32 length)
+	{
+		m_head.store(m_head.load(std::memory_order_relaxed) + length, std::memory_order_release);
+	}
+
+	/// <summary>
+	/// 读取并移除数据 (消费者调用)
+	/// </summary>
+	/// <param name="data">目标缓冲区</param>
+	/// <param name="maxLength">最多读取的字节数量</param>
+	/// <returns>实际读取的字节数量</returns>
+	qint32 Read(char* data, qint32 maxLength)
+	{
+		const auto tail = m_tail.load(std::memory_order_relaxed);
+		const auto available = m_head.load(std::memory_order_acquire) - tail;
+		const auto length = qMin<quint64>(available, static_cast<quint64>(maxLength));
+		const auto offset = tail & m_mask;
+		const auto first = qMin(length, m_capacity - offset);
+
+		std::memcpy(data, m_data.get() + offset, first);
+		std::memcpy(data + first, m_data.get(), length - first);
+
+		m_tail.store(tail + length, std::memory_order_release);
+		return static_cast<qint32>(length);
+	}
+
+	/// <summary>
+	/// 丢弃所有数据 (仅在生产者停止时调用)
+	/// </summary>
+	void Clear()
+	{
+		m_tail.store(m_head.load(std::memory_order_acquire), std::memory_order_release);
+	}
+
+private:
+	static quint64 roundUp(qint32 capacity)
+	{
+		quint64 value = 64;
+		while (value < static_cast<quint64>(capacity))
+			value <<= 1;
+
+		return value;
+	}
+
+private:
+	const quint64 m_capacity;
+	const quint64 m_mask;
+	std::unique_ptr<char[]> m_data;
+
+	// 生产者与消费者的计数器位于不同缓存行 避免伪共享
+	alignas(64) std::atomic<quint64> m_head;
+	alignas(64) std::atomic<quint64> m_tail;
+};
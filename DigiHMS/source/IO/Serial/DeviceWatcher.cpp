@@ -0,0 +1,251 @@
+﻿#include "DeviceWatcher.h"
+#include <QSet>
+#include <QTimer>
+#include <QSocketNotifier>
+#include <Common/TimerEvents.h>
+
+#ifdef Q_OS_LINUX
+#include <linux/netlink.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <cstring>
+#include <QFileInfo>
+
+namespace
+{
+	/// <summary>
+	/// netlink 广播组: 内核 uevent 与 udev 处理完成后转发的事件
+	/// </summary>
+	constexpr unsigned KernelGroup = 1;
+	constexpr unsigned UdevGroup = 2;
+	/// <summary>
+	/// udev 消息头 ("libudev\0" 之后依次为 magic, header_size, properties_off ...)
+	/// </summary>
+	constexpr char UdevPrefix[] = "libudev";
+	constexpr int UdevPropertiesOffset = 16;
+
+	/// <summary>
+	/// 检查消息是否来自内核或 udevd
+	/// <para>任何本机进程都可以向广播组发送消息, 只接受 root 发送的广播; 内核消息的发送端口为 0</para>
+	/// </summary>
+	bool trustedSender(const sockaddr_nl& sender, msghdr& message, bool udev)
+	{
+		if (sender.nl_groups == 0)
+			return false;
+		if (!udev && sender.nl_pid != 0)
+			return false;
+
+		const auto control = CMSG_FIRSTHDR(&message);
+		if (control == Q_NULLPTR || control->cmsg_level != SOL_SOCKET || control->cmsg_type != SCM_CREDENTIALS)
+			return false;
+
+		ucred credentials;
+		std::memcpy(&credentials, CMSG_DATA(control), sizeof(credentials));
+		return credentials.uid == 0;
+	}
+}
+#endif
+
+DeviceWatcher* DeviceWatcher::Create(QObject* parent)
+{
+#ifdef Q_OS_LINUX
+	auto watcher = new NetlinkDeviceWatcher(parent);
+	if (watcher->IsValid())
+		return watcher;
+
+	delete watcher;
+#endif
+
+	return new PollingDeviceWatcher(parent);
+}
+
+DeviceWatcher::DeviceWatcher(QObject* parent)
+	: QObject(parent)
+{
+}
+
+const QVector<QSerialPortInfo>& DeviceWatcher::Ports() const
+{
+	return m_ports;
+}
+
+void DeviceWatcher::refresh()
+{
+	QVector<QSerialPortInfo> ports;
+	Q_FOREACH(QSerialPortInfo info, QSerialPortInfo::availablePorts())
+	{
+		if (!info.isNull())
+			ports.append(info);
+	}
+
+	// 对比新旧列表 找出插入与移除的设备
+	QSet<QString> oldNames;
+	QSet<QString> newNames;
+	for (const auto& info : m_ports)
+		oldNames.insert(info.portName());
+	for (const auto& info : ports)
+		newNames.insert(info.portName());
+
+	if (oldNames == newNames)
+		return;
+
+	m_ports = ports;
+
+	for (const auto& name : oldNames)
+	{
+		if (!newNames.contains(name))
+			emit deviceRemoved(name);
+	}
+
+	for (const auto& name : newNames)
+	{
+		if (!oldNames.contains(name))
+			emit deviceAdded(name);
+	}
+
+	emit portsChanged();
+}
+
+PollingDeviceWatcher::PollingDeviceWatcher(QObject* parent)
+	: DeviceWatcher(parent)
+	, m_consumerId(0)
+{
+	refresh();
+
+	m_consumerId = TimerEvents::Instance().RegisterConsumer("DeviceWatcher", 1000, [this]() {
+		refresh();
+	});
+}
+
+PollingDeviceWatcher::~PollingDeviceWatcher()
+{
+	TimerEvents::Instance().UnregisterConsumer(m_consumerId);
+}
+
+QString PollingDeviceWatcher::Backend() const
+{
+	return "polling";
+}
+
+#ifdef Q_OS_LINUX
+NetlinkDeviceWatcher::NetlinkDeviceWatcher(QObject* parent)
+	: DeviceWatcher(parent)
+	, m_socket(-1)
+	, m_notifier(Q_NULLPTR)
+	, m_debounce(Q_NULLPTR)
+	, m_udev(false)
+{
+	// 优先订阅 udev 转发的事件: 内核 uevent 早于 udev 创建设备节点并设置权限, 此时打开串口会失败
+	// 没有运行 udev 时 (例如容器中) 设备节点由 devtmpfs 创建, 直接订阅内核事件
+	m_udev = QFileInfo::exists("/run/udev/control");
+
+	m_socket = ::socket(AF_NETLINK, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, NETLINK_KOBJECT_UEVENT);
+	if (m_socket < 0)
+		return;
+
+	sockaddr_nl address;
+	std::memset(&address, 0, sizeof(address));
+	address.nl_family = AF_NETLINK;
+	address.nl_pid = 0;
+	address.nl_groups = m_udev ? UdevGroup : KernelGroup;
+	if (::bind(m_socket, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0)
+	{
+		::close(m_socket);
+		m_socket = -1;
+		return;
+	}
+
+	// 接收发送者的凭据 用于丢弃非内核与 udevd 发送的消息
+	const int passCredentials = 1;
+	::setsockopt(m_socket, SOL_SOCKET, SO_PASSCRED, &passCredentials, sizeof(passCredentials));
+
+	// 一次插拔会产生多条消息 (usb/usb-serial/tty) 合并后只枚举一次
+	m_debounce = new QTimer(this);
+	m_debounce->setSingleShot(true);
+	m_debounce->setInterval(50);
+	connect(m_debounce, &QTimer::timeout, this, &DeviceWatcher::refresh);
+
+	m_notifier = new QSocketNotifier(m_socket, QSocketNotifier::Read, this);
+	connect(m_notifier, &QSocketNotifier::activated, this, &NetlinkDeviceWatcher::onActivated);
+
+	refresh();
+}
+
+NetlinkDeviceWatcher::~NetlinkDeviceWatcher()
+{
+	if (m_socket >= 0)
+		::close(m_socket);
+}
+
+bool NetlinkDeviceWatcher::IsValid() const
+{
+	return m_socket >= 0;
+}
+
+QString NetlinkDeviceWatcher::Backend() const
+{
+	return m_udev ? "netlink (udev)" : "netlink";
+}
+
+void NetlinkDeviceWatcher::onActivated()
+{
+	char buffer[8192];
+	char control[CMSG_SPACE(sizeof(ucred))];
+
+	for (;;)
+	{
+		sockaddr_nl sender;
+		iovec vector = { buffer, sizeof(buffer) - 1 };
+		msghdr message;
+		std::memset(&message, 0, sizeof(message));
+		message.msg_name = &sender;
+		message.msg_namelen = sizeof(sender);
+		message.msg_iov = &vector;
+		message.msg_iovlen = 1;
+		message.msg_control = control;
+		message.msg_controllen = sizeof(control);
+
+		auto length = ::recvmsg(m_socket, &message, 0);
+		if (length <= 0)
+			break;
+
+		if (!trustedSender(sender, message, m_udev))
+			continue;
+
+		buffer[length] = '\0';
+
+		// 内核消息格式: "ACTION@DEVPATH\0KEY=VALUE\0KEY=VALUE\0..."
+		// udev 消息格式: 消息头之后 properties_off 处开始为 "KEY=VALUE\0..."
+		const auto udevMessage = length >= static_cast<int>(sizeof(UdevPrefix)) && std::memcmp(buffer, UdevPrefix, sizeof(UdevPrefix)) == 0;
+		if (udevMessage != m_udev)
+			continue;
+
+		int begin = 0;
+		if (udevMessage)
+		{
+			if (length < UdevPropertiesOffset + static_cast<int>(sizeof(quint32)))
+				continue;
+
+			quint32 properties;
+			std::memcpy(&properties, buffer + UdevPropertiesOffset, sizeof(properties));
+			if (properties >= static_cast<quint32>(length))
+				continue;
+			begin = static_cast<int>(properties);
+		}
+
+		bool tty = false;
+		bool hotplug = false;
+		for (auto offset = begin; offset < length; offset += static_cast<int>(std::strlen(buffer + offset)) + 1)
+		{
+			const char* field = buffer + offset;
+			if (std::strcmp(field, "SUBSYSTEM=tty") == 0)
+				tty = true;
+			else if (std::strcmp(field, "ACTION=add") == 0 || std::strcmp(field, "ACTION=remove") == 0)
+				hotplug = true;
+		}
+
+		if (tty && hotplug)
+			m_debounce->start();
+	}
+}
+#endif
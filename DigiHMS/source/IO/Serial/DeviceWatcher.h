@@ -0,0 +1,112 @@
+﻿#pragma once
+
+#include <QObject>
+#include <QVector>
+#include <QSerialPortInfo>
+
+class QSocketNotifier;
+class QTimer;
+
+/// <summary>
+/// 串口设备监视器
+/// <para>缓存当前有效的串口列表, 并在设备插拔时发出通知</para>
+/// </summary>
+class DeviceWatcher : public QObject
+{
+	Q_OBJECT
+
+public:
+	/// <summary>
+	/// 创建当前平台最合适的监视器
+	/// <para>Linux 使用 netlink uevent, 其他平台或创建失败时使用轮询</para>
+	/// </summary>
+	/// <param name="parent">父对象</param>
+	/// <returns>监视器</returns>
+	static DeviceWatcher* Create(QObject* parent = Q_NULLPTR);
+
+	virtual ~DeviceWatcher() {}
+
+	/// <summary>
+	/// 获取缓存的串口设备列表 (不会重新枚举设备)
+	/// </summary>
+	/// <returns>串口设备信息列表</returns>
+	const QVector<QSerialPortInfo>& Ports() const;
+	/// <summary>
+	/// 获取监视器后端名称
+	/// </summary>
+	/// <returns>后端名称</returns>
+	virtual QString Backend() const = 0;
+
+signals:
+	void portsChanged();
+	void deviceAdded(const QString& portName);
+	void deviceRemoved(const QString& portName);
+
+public slots:
+	/// <summary>
+	/// 立即重新枚举串口设备 并发出变化通知
+	/// </summary>
+	void refresh();
+
+protected:
+	explicit DeviceWatcher(QObject* parent);
+
+private:
+	QVector<QSerialPortInfo> m_ports;
+};
+
+/// <summary>
+/// 轮询方式的设备监视器 (每秒枚举一次)
+/// </summary>
+class PollingDeviceWatcher : public DeviceWatcher
+{
+	Q_OBJECT
+
+public:
+	explicit PollingDeviceWatcher(QObject* parent = Q_NULLPTR);
+	virtual ~PollingDeviceWatcher();
+
+	QString Backend() const override;
+
+private:
+	qint32 m_consumerId;
+};
+
+#ifdef Q_OS_LINUX
+/// <summary>
+/// 基于 netlink uevent 的设备监视器
+/// <para>只在 tty 子系统发生插拔事件时才重新枚举设备</para>
+/// <para>运行 udev 时订阅 udev 转发的事件, 收到通知时设备节点已可以打开</para>
+/// <para>根据发送者凭据只接受内核或 udevd (root) 发送的消息</para>
+/// </summary>
+class NetlinkDeviceWatcher : public DeviceWatcher
+{
+	Q_OBJECT
+
+public:
+	explicit NetlinkDeviceWatcher(QObject* parent = Q_NULLPTR);
+	virtual ~NetlinkDeviceWatcher();
+
+	/// <summary>
+	/// 获取 netlink 套接字是否创建成功
+	/// </summary>
+	/// <returns>是否可用</returns>
+	bool IsValid() const;
+	QString Backend() const override;
+
+private slots:
+	/// <summary>
+	/// 读取并解析 uevent 消息
+	/// </summary>
+	void onActivated();
+
+private:
+	int m_socket;
+	QSocketNotifier* m_notifier;
+	QTimer* m_debounce;
+	/// <summary>
+	/// 是否订阅 udev 事件 (否则为内核 uevent)
+	/// </summary>
+	bool m_udev;
+};
+#endif
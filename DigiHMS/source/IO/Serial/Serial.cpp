@@ -1,19 +1,64 @@
 ﻿#include "Serial.h"
+#include "DeviceWatcher.h"
 #include <QSerialPortInfo>
-#include <Common\TimerEvents.h>
-#include <Common\Utilities.h>
-#include <IO\Manager\Manager.h>
+#include <IO/Manager/Manager.h>
+#include <Common/Trace.h>
+#include <Common/TimerEvents.h>
+#include <QThread>
+#ifdef Q_OS_UNIX
+#include <QVarLengthArray>
+#include <sys/uio.h>
+#include <errno.h>
+#include <limits.h>
+#endif
 
 #define SETTINGS_BAUDRATELIST "IO_Serial_BauRates"
+#define SETTINGS_LOWLATENCY "IO_Serial_LowLatency"
+
+namespace
+{
+	/// <summary>
+	/// 打开操作超时时间 (毫秒)
+	/// </summary>
+	const qint64 OpenTimeout = 3000;
+	/// <summary>
+	/// 自动重连的初始与最大退避时间 (毫秒)
+	/// </summary>
+	const qint64 ReconnectInitialDelay = 500;
+	const qint64 ReconnectMaxDelay = 30000;
+	/// <summary>
+	/// 超时与重连检查周期 (毫秒)
+	/// </summary>
+	const qint32 TimerResolution = 100;
+	/// <summary>
+	/// 退出时等待工作线程结束的时间 (毫秒)
+	/// </summary>
+	const unsigned long ShutdownTimeout = 2000;
+}
 
 Serial::Serial()
 	: m_port(Q_NULLPTR)
+	, m_watcher(Q_NULLPTR)
 	, m_autoReconnect(false)
-	, m_lastSerialDeviceIndex(0)
+	, m_lowLatency(false)
 	, m_portIndex(0)
+	, m_timerConsumer(0)
+	, m_openRequest(0)
+	, m_opening(false)
+	, m_openDeadline(0)
+	, m_reconnectPending(false)
+	, m_reconnectAt(0)
+	, m_reconnectAttempts(0)
 {
 	readSettings();
 
+	m_clock.start();
+
+	m_timerConsumer = TimerEvents::Instance().RegisterConsumer("Serial", TimerResolution, [this]() {
+		checkTimers();
+	});
+	TimerEvents::Instance().SetConsumerActive(m_timerConsumer, false);
+
 	disconnectDevice();
 
 	// 初始化串口参数配置
@@ -23,8 +68,12 @@ Serial::Serial()
 	setParity(ParityList().indexOf(tr("None")));
 	setFlowControl(FlowControlList().indexOf(tr("None")));
 
-	// 每秒更新一次串口设备列表
-	connect(&TimerEvents::Instance(), &TimerEvents::timeout1Hz, this, &Serial::refreshSerialDevices);
+	// 设备插拔时更新串口设备列表 (Linux 下由 netlink 事件驱动 其他平台轮询)
+	m_watcher = DeviceWatcher::Create(this);
+	connect(m_watcher, &DeviceWatcher::portsChanged, this, &Serial::refreshSerialDevices);
+
+	// 延迟到事件循环中生成初始列表 (refreshSerialDevices 会访问 Manager 单例)
+	QMetaObject::invokeMethod(this, "refreshSerialDevices", Qt::QueuedConnection);
 
 	// 当选择新的串口时 通知配置更改
 	connect(this, &Serial::portIndexChanged, this, &Serial::configurationChanged);
@@ -37,6 +86,18 @@ Serial::~Serial()
 
 	if (m_port)
 		m_port->disconnect();
+
+	TimerEvents::Instance().UnregisterConsumer(m_timerConsumer);
+
+	// 工作线程被挂起的驱动阻塞时不再等待 (线程对象随进程退出释放)
+	QElapsedTimer shutdown;
+	shutdown.start();
+	for (auto worker : m_workers.keys())
+	{
+		const auto remaining = qMax<qint64>(qint64(ShutdownTimeout) - shutdown.elapsed(), 0);
+		if (worker->wait(static_cast<unsigned long>(remaining)))
+			delete worker;
+	}
 }
 
 Serial& Serial::Instance()
@@ -57,18 +118,11 @@ bool Serial::Open(const QIODevice::OpenMode mode)
 		// 断开当前串口连接 更新当前选择的串口设备索引
 		disconnectDevice();
 		m_portIndex = portId + 1;
-		m_lastSerialDeviceIndex = m_portIndex;
+		m_lastPortName = ports.at(portId).portName();
 		emit portIndexChanged();
 
 		// 创建新的串口设备对象
-		m_port = new QSerialPort(ports.at(portId));
-
-		// 配置串口参数
-		m_port->setParity(m_parity);
-		m_port->setBaudRate(m_baudRate);
-		m_port->setDataBits(m_dataBits);
-		m_port->setStopBits(m_stopBits);
-		m_port->setFlowControl(m_flowControl);
+		m_port = createPort(ports.at(portId));
 
 		// 绑定串口错误信号
 		connect(m_port, &QSerialPort::errorOccurred, this, &Serial::handleError);
@@ -76,6 +130,9 @@ bool Serial::Open(const QIODevice::OpenMode mode)
 		// 开启串口
 		if (m_port->open(mode))
 		{
+			if (m_lowLatency)
+				SerialTuning::Apply(m_port->handle(), m_port->portName(), &m_tuning);
+
 			// 绑定串口准备读取信号
 			connect(m_port, &QIODevice::readyRead, this, &Serial::onReadyRead);
 			return true;
@@ -86,10 +143,67 @@ bool Serial::Open(const QIODevice::OpenMode mode)
 	return false;
 }
 
+void Serial::OpenAsync(const QIODevice::OpenMode mode)
+{
+	auto ports = ValidPorts();
+	auto portId = m_portIndex - 1;
+
+	disconnectDevice();
+	if (portId < 0 || portId >= ports.count())
+	{
+		emit openFinished(false);
+		return;
+	}
+
+	// 更新当前选择的串口设备索引
+	m_portIndex = portId + 1;
+	m_lastPortName = ports.at(portId).portName();
+	emit portIndexChanged();
+
+	// 同一串口上次的打开或关闭仍未返回 (适配器挂起) 时不再排队新的操作
+	if (workerBusy(m_lastPortName))
+	{
+		emit openFinished(false);
+		scheduleReconnect();
+		return;
+	}
+
+	// 新的请求使之前未完成的请求失效
+	const auto request = ++m_openRequest;
+	m_opening = true;
+	m_openDeadline = m_clock.elapsed() + OpenTimeout;
+	m_reconnectPending = false;
+	updateTimerConsumer();
+
+	// 串口对象在工作线程中打开 完成后移回当前线程
+	auto port = createPort(ports.at(portId));
+
+	auto owner = thread();
+	const auto lowLatency = m_lowLatency;
+	runOnWorker(port, [this, port, mode, request, owner, lowLatency]() {
+		const auto ok = port->open(mode);
+
+		SerialTuning::State tuning;
+		if (ok && lowLatency)
+			SerialTuning::Apply(port->handle(), port->portName(), &tuning);
+
+		port->moveToThread(owner);
+
+		QMetaObject::invokeMethod(this, [this, port, ok, request, tuning]() {
+			openCompleted(port, ok, request, tuning);
+		}, Qt::QueuedConnection);
+	});
+}
+
 void Serial::Close()
 {
-	if (IsOpen())
-		m_port->close();
+	// 取消进行中的打开请求 结果到达时直接释放
+	m_openRequest++;
+	m_opening = false;
+	m_reconnectPending = false;
+	updateTimerConsumer();
+
+	disconnectDevice();
 }
 
 bool Serial::IsOpen() const
@@ -124,11 +238,72 @@ quint64 Serial::Write(const QByteArray& data)
 	return -1;
 }
 
+qint64 Serial::WriteGather(const QByteArrayView* parts, qint32 count)
+{
+#ifdef Q_OS_UNIX
+	if (!IsWritable())
+		return -1;
+
+	// QSerialPort 中还有待发送的数据时 直接写入会打乱顺序
+	if (m_port->bytesToWrite() > 0)
+		return -1;
+
+	QVarLengthArray<iovec, 8> vectors;
+	qint64 total = 0;
+	for (auto i = 0; i < count; ++i)
+	{
+		if (parts[i].isEmpty())
+			continue;
+
+		vectors.append(iovec{ const_cast<char*>(parts[i].data()), static_cast<size_t>(parts[i].size()) });
+		total += parts[i].size();
+	}
+
+	if (vectors.count() > IOV_MAX)
+		return -1;
+
+	auto written = static_cast<qint64>(::writev(static_cast<int>(m_port->handle()), vectors.constData(), vectors.count()));
+	if (written < 0)
+	{
+		if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+			return -1;
+
+		written = 0;
+	}
+
+	// 设备暂时写不下的部分 交给 QSerialPort 在可写时发送
+	qint64 offset = 0;
+	for (auto i = 0; i < count && written < total; ++i)
+	{
+		const auto& part = parts[i];
+		const auto end = offset + part.size();
+		if (end > written)
+		{
+			const auto skip = qMax<qint64>(written - offset, 0);
+			m_port->write(part.data() + skip, part.size() - skip);
+		}
+
+		offset = end;
+	}
+
+	return total;
+#else
+	Q_UNUSED(parts);
+	Q_UNUSED(count);
+	return -1;
+#endif
+}
+
 bool Serial::ConfigurationOk() const
 {
 	return m_portIndex > 0;
 }
 
+QList<Codec::Type> Serial::SupportedCodecs() const
+{
+	return { Codec::Type::None, Codec::Type::Lzss };
+}
+
 QString Serial::PortName() const
 {
 	if (m_port)
@@ -147,6 +322,11 @@ bool Serial::AutoReconnect() const
 	return m_autoReconnect;
 }
 
+bool Serial::LowLatency() const
+{
+	return m_lowLatency;
+}
+
 quint8 Serial::PortIndex() const
 {
 	return m_portIndex;
@@ -239,8 +419,9 @@ QStringList Serial::FlowControlList() const
 
 QVector<QSerialPortInfo> Serial::ValidPorts() const
 {
+	// 使用监视器缓存的设备列表 避免重复枚举设备
 	QVector<QSerialPortInfo> ports;
-	Q_FOREACH(QSerialPortInfo info, QSerialPortInfo::availablePorts())
+	Q_FOREACH(QSerialPortInfo info, m_watcher->Ports())
 	{
 		if (!info.isNull())
 		{
@@ -260,13 +441,9 @@ void Serial::disconnectDevice()
 {
 	if (m_port != Q_NULLPTR)
 	{
-		// 解除串口绑定的槽
-		m_port->disconnect(this, SLOT(onReadyRead()));
-		m_port->disconnect(this, SLOT(handleError(QSerialPort::SerialPortError)));
-
-		// 关闭串口并释放指针
-		m_port->close();
-		m_port->deleteLater();
+		// 解除串口绑定的槽 关闭串口并释放指针
+		releasePort(m_port, m_tuning);
+		m_tuning = SerialTuning::State();
 	}
 
 	m_port = Q_NULLPTR;
@@ -274,10 +451,151 @@ void Serial::disconnectDevice()
 	emit availablePortsChanged();
 }
 
+QSerialPort* Serial::createPort(const QSerialPortInfo& info) const
+{
+	auto port = new QSerialPort(info);
+
+	// 配置串口参数
+	port->setParity(m_parity);
+	port->setBaudRate(m_baudRate);
+	port->setDataBits(m_dataBits);
+	port->setStopBits(m_stopBits);
+	port->setFlowControl(m_flowControl);
+
+	return port;
+}
+
+void Serial::releasePort(QSerialPort* port, const SerialTuning::State& tuning)
+{
+	port->disconnect(this);
+
+	if (!port->isOpen())
+	{
+		port->deleteLater();
+		return;
+	}
+
+	// 关闭时会等待驱动刷新缓冲区 挂起的适配器不应阻塞界面
+	runOnWorker(port, [port, tuning]() {
+		SerialTuning::Restore(port->handle(), port->portName(), tuning);
+		port->close();
+		delete port;
+	});
+}
+
+void Serial::runOnWorker(QSerialPort* port, const std::function<void()>& function)
+{
+	auto worker = QThread::create(function);
+	worker->setObjectName("SerialIO " + port->portName());
+	m_workers.insert(worker, port->portName());
+
+	// 工作线程没有事件循环 串口对象在其中只执行这一个操作
+	port->moveToThread(worker);
+
+	connect(worker, &QThread::finished, this, [this, worker]() {
+		m_workers.remove(worker);
+		worker->deleteLater();
+	});
+	worker->start();
+}
+
+bool Serial::workerBusy(const QString& portName) const
+{
+	for (auto it = m_workers.constBegin(); it != m_workers.constEnd(); ++it)
+	{
+		if (it.value() == portName && it.key()->isRunning())
+			return true;
+	}
+
+	return false;
+}
+
+void Serial::openCompleted(QSerialPort* port, bool ok, quint32 request, const SerialTuning::State& tuning)
+{
+	// 已超时或已被 Close 取消
+	if (request != m_openRequest)
+	{
+		releasePort(port, tuning);
+		return;
+	}
+
+	m_opening = false;
+	updateTimerConsumer();
+
+	if (!ok)
+	{
+		releasePort(port);
+
+		// Manager 处理失败时会调用 Close 因此在通知之后安排重连
+		emit openFinished(false);
+		scheduleReconnect();
+		return;
+	}
+
+	m_port = port;
+	m_tuning = tuning;
+	m_reconnectAttempts = 0;
+
+	// 绑定串口错误与准备读取信号
+	connect(m_port, &QSerialPort::errorOccurred, this, &Serial::handleError);
+	connect(m_port, &QIODevice::readyRead, this, &Serial::onReadyRead);
+
+	emit portChanged();
+	emit openFinished(true);
+}
+
+void Serial::scheduleReconnect()
+{
+	if (!m_autoReconnect || m_lastPortName.isEmpty())
+		return;
+
+	// 500 ms, 1 s, 2 s ... 最多 30 s
+	const auto delay = qMin(ReconnectInitialDelay << qMin(m_reconnectAttempts, 16), ReconnectMaxDelay);
+	m_reconnectAttempts++;
+	m_reconnectPending = true;
+	m_reconnectAt = m_clock.elapsed() + delay;
+	updateTimerConsumer();
+}
+
+void Serial::checkTimers()
+{
+	const auto now = m_clock.elapsed();
+
+	// 驱动没有在限定时间内返回 放弃本次请求 (结果到达时直接释放)
+	if (m_opening && now >= m_openDeadline)
+	{
+		m_openRequest++;
+		m_opening = false;
+		updateTimerConsumer();
+		emit openFinished(false);
+		scheduleReconnect();
+	}
+
+	if (m_reconnectPending && now >= m_reconnectAt)
+	{
+		m_reconnectPending = false;
+		updateTimerConsumer();
+
+		auto& manager = Manager::Instance();
+		const auto index = m_portList.indexOf(m_lastPortName);
+		if (index > 0 && manager.GetSelectedDriver() == Manager::SelectedDriver::Serial
+			&& !manager.Connected() && !manager.Connecting())
+		{
+			setPortIndex(index);
+			manager.connectDevice();
+		}
+	}
+}
+
+void Serial::updateTimerConsumer()
+{
+	TimerEvents::Instance().SetConsumerActive(m_timerConsumer, m_opening || m_reconnectPending);
+}
+
 void Serial::setPortIndex(const quint8 portIndex)
 {
-	auto portId = portIndex - 1;
-	if (portId >= 0 && portId < ValidPorts().count())
+	// 使用缓存的串口列表 (第一个元素为占位项) 避免重新枚举设备
+	if (portIndex > 0 && portIndex < m_portList.count())
 		m_portIndex = portIndex;
 	else
 		m_portIndex = 0;
@@ -431,6 +749,15 @@ void Serial::setAutoReconnect(const bool autoreconnect)
 	emit autoReconnectChanged();
 }
 
+void Serial::setLowLatency(const bool enabled)
+{
+	if (m_lowLatency == enabled)
+		return;
+
+	m_lowLatency = enabled;
+	emit lowLatencyChanged();
+}
+
 void Serial::appendBaudRate(const QString& baudRate)
 {
 	if (!m_baudRateList.contains(baudRate))
@@ -439,14 +766,15 @@ void Serial::appendBaudRate(const QString& baudRate)
 		writeSettings();
 		emit baudRateListChanged();
 
-		// 弹出消息框
-		Utilities::ShowMessageBox(tr("Baud rate registered successfully"),
-			tr("Rate \"%1\" has been added to baud rate list").arg(baudRate));
+		// 通知 UI 层 (核心库不依赖 QtWidgets)
+		emit baudRateRegistered(baudRate);
 	}
 }
 
 void Serial::onReadyRead()
 {
+	TRACE_SCOPE(SerialReadyRead, m_port ? m_port->bytesAvailable() : 0);
+
 	if (IsOpen())
 		emit dataReceived(m_port->readAll());
 }
@@ -480,6 +808,8 @@ void Serial::readSettings()
 
 	emit baudRateListChanged();
 
+	// 低延迟模式
+	m_lowLatency = m_settings.value(SETTINGS_LOWLATENCY, false).toBool();
 }
 
 void Serial::writeSettings()
@@ -501,6 +831,7 @@ void Serial::writeSettings()
 	}
 
 	m_settings.setValue(SETTINGS_BAUDRATELIST, m_baudRateList);
+	m_settings.setValue(SETTINGS_LOWLATENCY, m_lowLatency);
 }
 
 void Serial::refreshSerialDevices()
@@ -540,14 +871,15 @@ void Serial::refreshSerialDevices()
 			}
 		}
 
-		// 如果当前选择的设备为串口 则检查是否需要自动重连
+		// 如果当前选择的设备为串口 且上次连接的设备重新出现 则立即自动重连
 		if (Manager::Instance().GetSelectedDriver() == Manager::SelectedDriver::Serial)
 		{
-			if (m_autoReconnect && m_lastSerialDeviceIndex > 0)
+			if (m_autoReconnect && !m_lastPortName.isEmpty() && !Manager::Instance().Connected() && !Manager::Instance().Connecting())
 			{
-				if (m_lastSerialDeviceIndex < m_portList.count())
+				auto index = m_portList.indexOf(m_lastPortName);
+				if (index > 0)
 				{
-					setPortIndex(m_lastSerialDeviceIndex);
+					setPortIndex(index);
 					Manager::Instance().connectDevice();
 				}
 			}
@@ -560,6 +892,9 @@ void Serial::refreshSerialDevices()
 void Serial::handleError(QSerialPort::SerialPortError error)
 {
 	if (error != QSerialPort::NoError)
+	{
 		Manager::Instance().disconnectDriver();
+		scheduleReconnect();
+	}
 }
 
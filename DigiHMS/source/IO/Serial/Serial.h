@@ -11,8 +11,15 @@
 #pragma once
 
 #include "../HAL_Driver.h"
+#include "SerialTuning.h"
 #include <QSerialPort>
 #include <QSettings>
+#include <QElapsedTimer>
+#include <QHash>
+#include <functional>
+
+class DeviceWatcher;
+class QThread;
 
 /// <summary>
 /// 串口设备类
@@ -28,6 +35,10 @@ public:
 	Q_PROPERTY(bool autoReconnect
 			   READ AutoReconnect
 			   NOTIFY autoReconnectChanged)
+	Q_PROPERTY(bool lowLatency
+			   READ LowLatency
+			   WRITE setLowLatency
+			   NOTIFY lowLatencyChanged)
 	Q_PROPERTY(quint8 portIndex
 			   READ PortIndex
 			   NOTIFY portIndexChanged)
@@ -106,7 +117,14 @@ public:
 	/// <returns>开启结果</returns>
 	bool Open(const QIODevice::OpenMode mode) override;
 	/// <summary>
-	/// 关闭当前串口连接
+	/// 在工作线程中开启当前选择的串口设备 完成或超时时发送 openFinished
+	/// <para>打开成功后串口对象移回 Serial 所在线程, 失败且开启自动重连时按指数退避重试</para>
+	/// </summary>
+	/// <param name="mode">串口开启模式</param>
+	void OpenAsync(const QIODevice::OpenMode mode) override;
+	/// <summary>
+	/// 关闭当前串口连接 (在工作线程中关闭 不阻塞调用线程)
+	/// <para>同时取消进行中的打开请求与等待中的重连</para>
 	/// </summary>
 	void Close() override;
 	/// <summary>
@@ -131,10 +149,24 @@ public:
 	/// <returns>成功写入的字节数量</returns>
 	quint64 Write(const QByteArray& data) override;
 	/// <summary>
+	/// 将多段数据写入到串口设备
+	/// <para>Unix 下发送缓冲区为空时通过 writev 直接写入文件描述符, 未写完的部分交给 QSerialPort 缓冲</para>
+	/// <para>其他平台不支持 (WriteFileGather 要求页对齐的缓冲区)</para>
+	/// </summary>
+	/// <param name="parts">数据段</param>
+	/// <param name="count">数据段数量</param>
+	/// <returns>成功写入的字节数量 不支持时返回 -1</returns>
+	qint64 WriteGather(const QByteArrayView* parts, qint32 count) override;
+	/// <summary>
 	/// 当前串口是否完成配置
 	/// </summary>
 	/// <returns>串口配置状态</returns>
 	bool ConfigurationOk() const override;
+	/// <summary>
+	/// 串口链路可以承载的压缩类型: 不压缩 / LZSS (固件是否支持需要设备确认)
+	/// </summary>
+	/// <returns>压缩类型列表</returns>
+	QList<Codec::Type> SupportedCodecs() const override;
 
 public:
 	/// <summary>
@@ -152,6 +184,11 @@ public:
 	/// </summary>
 	/// <returns>自动重连开启状态</returns>
 	bool AutoReconnect() const;
+	/// <summary>
+	/// 获取是否开启低延迟模式 (见 SerialTuning)
+	/// </summary>
+	/// <returns>低延迟模式开启状态</returns>
+	bool LowLatency() const;
 	
 	/// <summary>
 	/// 获取当前选择的串口设备索引
@@ -240,7 +277,7 @@ public:
 
 private:
 	/// <summary>
-	/// 获取所有有效串口设备
+	/// 获取所有有效串口设备 (来自设备监视器的缓存)
 	/// </summary>
 	/// <returns>串口设备信息列表</returns>
 	QVector<QSerialPortInfo> ValidPorts() const;
@@ -255,9 +292,11 @@ signals:
 	void flowControlChanged();
 	void baudRateListChanged();
 	void autoReconnectChanged();
+	void lowLatencyChanged();
 	void baudRateIndexChanged();
 	void availablePortsChanged();
 	void connectionError(const QString& name);
+	void baudRateRegistered(const QString& baudRate);
 
 public slots:
 	/// <summary>
@@ -265,6 +304,51 @@ public slots:
 	/// </summary>
 	void disconnectDevice();
 	/// <summary>
+	/// 根据当前参数创建串口对象 (不打开)
+	/// </summary>
+	/// <param name="info">串口信息</param>
+	/// <returns>串口对象</returns>
+	QSerialPort* createPort(const QSerialPortInfo& info) const;
+	/// <summary>
+	/// 解除串口对象的绑定 并在工作线程中恢复调优状态, 关闭与释放
+	/// </summary>
+	/// <param name="port">串口对象 (位于 Serial 所在线程)</param>
+	/// <param name="tuning">打开时应用的调优状态</param>
+	void releasePort(QSerialPort* port, const SerialTuning::State& tuning = SerialTuning::State());
+	/// <summary>
+	/// 工作线程中的打开操作完成
+	/// </summary>
+	/// <param name="port">串口对象</param>
+	/// <param name="ok">是否打开成功</param>
+	/// <param name="request">请求序号 与当前序号不同时说明请求已超时或已取消</param>
+	/// <param name="tuning">打开时应用的调优状态</param>
+	void openCompleted(QSerialPort* port, bool ok, quint32 request, const SerialTuning::State& tuning);
+	/// <summary>
+	/// 将串口对象移到新的工作线程 并在其中执行可能阻塞的操作
+	/// <para>每个操作使用独立的线程, 一个挂起的适配器不会阻塞其他串口的打开与关闭</para>
+	/// </summary>
+	/// <param name="port">串口对象 (位于 Serial 所在线程)</param>
+	/// <param name="function">在工作线程中执行的操作 结束前需将串口移出或释放</param>
+	void runOnWorker(QSerialPort* port, const std::function<void()>& function);
+	/// <summary>
+	/// 指定串口是否还有未完成的打开或关闭操作
+	/// </summary>
+	/// <param name="portName">串口名称</param>
+	/// <returns>是否有未完成的操作</returns>
+	bool workerBusy(const QString& portName) const;
+	/// <summary>
+	/// 按指数退避安排下一次自动重连
+	/// </summary>
+	void scheduleReconnect();
+	/// <summary>
+	/// 检查打开超时与重连时间
+	/// </summary>
+	void checkTimers();
+	/// <summary>
+	/// 仅在打开中或等待重连时启用定时检查
+	/// </summary>
+	void updateTimerConsumer();
+	/// <summary>
 	/// 更改当前串口设备索引值
 	/// <para>该索引值稍后会在 <c>Serial::Open()</c> 中用到</para>
 	/// </summary>
@@ -301,6 +385,11 @@ public slots:
 	/// <param name="autoreconnect">是否开启</param>
 	void setAutoReconnect(const bool autoreconnect);
 	/// <summary>
+	/// 设置是否开启低延迟模式 (下次打开串口时生效)
+	/// </summary>
+	/// <param name="enabled">是否开启</param>
+	void setLowLatency(const bool enabled);
+	/// <summary>
 	/// 添加新的波特率到列表中
 	/// </summary>
 	/// <param name="baudRate">波特率</param>
@@ -321,7 +410,7 @@ private slots:
 	/// </summary>
 	void writeSettings();
 	/// <summary>
-	/// 扫描可用串口设备并生成新的列表
+	/// 根据设备监视器缓存的设备生成新的列表
 	/// </summary>
 	void refreshSerialDevices();
 	/// <summary>
@@ -335,12 +424,24 @@ private:
 	/// 串口设备对象指针
 	/// </summary>
 	QSerialPort* m_port;
+	/// <summary>
+	/// 串口设备监视器
+	/// </summary>
+	DeviceWatcher* m_watcher;
 
 	/// <summary>
 	/// 串口自动重连开启状态
 	/// </summary>
 	bool m_autoReconnect;
-	qint32 m_lastSerialDeviceIndex;
+	/// <summary>
+	/// 低延迟模式开启状态 与当前串口应用调优前的状态
+	/// </summary>
+	bool m_lowLatency;
+	SerialTuning::State m_tuning;
+	/// <summary>
+	/// 上次成功选择的串口名称 (用于自动重连)
+	/// </summary>
+	QString m_lastPortName;
 	QSettings m_settings;
 
 	qint32 m_baudRate;
@@ -360,4 +461,25 @@ private:
 
 	QStringList m_portList;
 	QStringList m_baudRateList;
+
+	/// <summary>
+	/// 正在执行打开或关闭操作的工作线程与对应的串口名称 (驱动异常时可能长时间不返回)
+	/// </summary>
+	QHash<QThread*, QString> m_workers;
+	QElapsedTimer m_clock;
+	qint32 m_timerConsumer;
+
+	/// <summary>
+	/// 打开请求序号 超时或取消时递增 使迟到的结果失效
+	/// </summary>
+	quint32 m_openRequest;
+	bool m_opening;
+	qint64 m_openDeadline;
+
+	bool m_reconnectPending;
+	qint64 m_reconnectAt;
+	/// <summary>
+	/// 连续失败的重连次数 (决定退避时间)
+	/// </summary>
+	qint32 m_reconnectAttempts;
 };
@@ -0,0 +1,109 @@
+﻿#include "SerialTuning.h"
+
+#ifdef Q_OS_LINUX
+#include <QFile>
+#include <linux/serial.h>
+#include <sys/ioctl.h>
+
+namespace
+{
+	/// <summary>
+	/// 低延迟模式下的 latency_timer (毫秒)
+	/// </summary>
+	const int LowLatencyTimer = 1;
+
+	QString latencyTimerPath(const QString& portName)
+	{
+		return QString("/sys/class/tty/%1/device/latency_timer").arg(portName);
+	}
+
+	bool writeLatencyTimer(const QString& portName, int value)
+	{
+		QFile file(latencyTimerPath(portName));
+		if (!file.open(QIODevice::WriteOnly))
+			return false;
+
+		return file.write(QByteArray::number(value)) > 0;
+	}
+}
+
+bool SerialTuning::Apply(qintptr handle, const QString& portName, State* state)
+{
+	const auto fd = static_cast<int>(handle);
+	bool applied = false;
+
+	// 伪终端等设备不支持 TIOCGSERIAL
+	serial_struct serial;
+	if (::ioctl(fd, TIOCGSERIAL, &serial) == 0 && (serial.flags & ASYNC_LOW_LATENCY) == 0)
+	{
+		state->serialFlags = serial.flags;
+		serial.flags |= ASYNC_LOW_LATENCY;
+		if (::ioctl(fd, TIOCSSERIAL, &serial) == 0)
+		{
+			state->lowLatencyChanged = true;
+			applied = true;
+		}
+	}
+
+	const auto latency = LatencyTimer(portName);
+	if (latency > LowLatencyTimer && writeLatencyTimer(portName, LowLatencyTimer))
+	{
+		state->latencyTimer = latency;
+		state->latencyTimerChanged = true;
+		applied = true;
+	}
+
+	return applied;
+}
+
+void SerialTuning::Restore(qintptr handle, const QString& portName, const State& state)
+{
+	if (state.lowLatencyChanged)
+	{
+		serial_struct serial;
+		if (::ioctl(static_cast<int>(handle), TIOCGSERIAL, &serial) == 0)
+		{
+			serial.flags = (serial.flags & ~ASYNC_LOW_LATENCY) | (state.serialFlags & ASYNC_LOW_LATENCY);
+			::ioctl(static_cast<int>(handle), TIOCSSERIAL, &serial);
+		}
+	}
+
+	if (state.latencyTimerChanged)
+		writeLatencyTimer(portName, state.latencyTimer);
+}
+
+int SerialTuning::LatencyTimer(const QString& portName)
+{
+	QFile file(latencyTimerPath(portName));
+	if (!file.open(QIODevice::ReadOnly))
+		return -1;
+
+	bool ok = false;
+	const auto value = file.readAll().trimmed().toInt(&ok);
+	return ok ? value : -1;
+}
+
+#else
+
+bool SerialTuning::Apply(qintptr handle, const QString& portName, State* state)
+{
+	Q_UNUSED(handle);
+	Q_UNUSED(portName);
+	Q_UNUSED(state);
+	return false;
+}
+
+void SerialTuning::Restore(qintptr handle, const QString& portName, const State& state)
+{
+	Q_UNUSED(handle);
+	Q_UNUSED(portName);
+	Q_UNUSED(state);
+}
+
+int SerialTuning::LatencyTimer(const QString& portName)
+{
+	Q_UNUSED(portName);
+	return -1;
+}
+
+#endif
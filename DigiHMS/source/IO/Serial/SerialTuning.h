@@ -0,0 +1,46 @@
+﻿#pragma once
+
+#include <QString>
+
+/// <summary>
+/// 串口底层低延迟调优 (仅 Linux 有效, 其他平台为空操作)
+/// <para>1. TIOCSSERIAL 设置 ASYNC_LOW_LATENCY, 接收数据不经过 tty 缓冲延迟直接推送</para>
+/// <para>2. USB 转串口芯片 (FTDI) 的 latency_timer 设置为 1 毫秒 (默认 16 毫秒, 需要写入 sysfs 的权限)</para>
+/// <para>ASYNC_LOW_LATENCY 与 latency_timer 在关闭后仍然保留在设备上, 因此关闭前需要调用 Restore</para>
+/// </summary>
+class SerialTuning
+{
+public:
+	/// <summary>
+	/// 调优前的设备状态
+	/// </summary>
+	struct State
+	{
+		bool lowLatencyChanged = false;
+		int serialFlags = 0;
+		bool latencyTimerChanged = false;
+		int latencyTimer = -1;
+	};
+
+	/// <summary>
+	/// 对已打开的串口应用低延迟设置 (各项独立, 不支持的项被跳过)
+	/// </summary>
+	/// <param name="handle">串口句柄 (QSerialPort::handle)</param>
+	/// <param name="portName">串口名称 (如 ttyUSB0)</param>
+	/// <param name="state">输出调优前的状态</param>
+	/// <returns>是否至少有一项生效</returns>
+	static bool Apply(qintptr handle, const QString& portName, State* state);
+	/// <summary>
+	/// 恢复 Apply 修改的设备状态
+	/// </summary>
+	/// <param name="handle">串口句柄</param>
+	/// <param name="portName">串口名称</param>
+	/// <param name="state">Apply 输出的状态</param>
+	static void Restore(qintptr handle, const QString& portName, const State& state);
+	/// <summary>
+	/// 读取 USB 转串口芯片的 latency_timer (毫秒)
+	/// </summary>
+	/// <param name="portName">串口名称</param>
+	/// <returns>延迟 不支持时返回 -1</returns>
+	static int LatencyTimer(const QString& portName);
+};
@@ -0,0 +1,306 @@
+﻿#include "AlertEngine.h"
+#include "SensorSnapshot.h"
+#include <QRegularExpression>
+#include <QStringList>
+#include <QtMath>
+
+#define SETTINGS_ALERTRULES          "Alert_Rules"
+#define SETTINGS_ALERTNOTIFYINTERVAL "Alert_NotifyInterval"
+
+/// <summary>
+/// 默认规则
+/// </summary>
+#define DEFAULT_ALERTRULES "cpu.temp > 90 for 5s\ngpu.temp > 90 for 5s\nstorage.temp.* > 55 for 30s"
+
+bool AlertRule::Parse(const QString& text, QVector<AlertRule>& rules, QString* error)
+{
+	static const QRegularExpression expression(
+		"^(\\S+?)\\s*(>=|<=|==|!=|>|<)\\s*(-?[0-9]+(?:\\.[0-9]+)?)(?:\\s+for\\s+([0-9]+(?:\\.[0-9]+)?)\\s*(ms|s|m)?)?$");
+
+	rules.clear();
+
+	const auto lines = text.split('\n');
+	for (auto i = 0; i < lines.count(); ++i)
+	{
+		const auto line = lines.at(i).trimmed();
+		if (line.isEmpty() || line.startsWith('#'))
+			continue;
+
+		const auto match = expression.match(line);
+		if (!match.hasMatch())
+		{
+			if (error)
+				*error = QObject::tr("Invalid alert rule at line %1: \"%2\"").arg(i + 1).arg(line);
+			rules.clear();
+			return false;
+		}
+
+		AlertRule rule;
+		rule.sensor = match.captured(1);
+		rule.threshold = match.captured(3).toFloat();
+		rule.text = line;
+
+		const auto op = match.captured(2);
+		if (op == ">")
+			rule.comparator = Comparator::Greater;
+		else if (op == ">=")
+			rule.comparator = Comparator::GreaterEqual;
+		else if (op == "<")
+			rule.comparator = Comparator::Less;
+		else if (op == "<=")
+			rule.comparator = Comparator::LessEqual;
+		else if (op == "==")
+			rule.comparator = Comparator::Equal;
+		else
+			rule.comparator = Comparator::NotEqual;
+
+		// 省略单位时按秒计算
+		const auto hold = match.captured(4).toDouble();
+		const auto unit = match.captured(5);
+		const auto scale = unit == "ms" ? 1.0 : (unit == "m" ? 60 * 1000.0 : 1000.0);
+		rule.hold = static_cast<qint32>(qMin(hold * scale, 24 * 60 * 60 * 1000.0));
+
+		rules.append(rule);
+	}
+
+	return true;
+}
+
+AlertEngine::AlertEngine(QObject* parent)
+	: QObject(parent)
+	, m_notifyInterval(60 * 1000)
+	, m_compiled(false)
+	, m_layoutVersion(0)
+{
+	readSettings();
+}
+
+AlertEngine::~AlertEngine()
+{
+	writeSettings();
+}
+
+QString AlertEngine::Rules() const
+{
+	return m_text;
+}
+
+qint32 AlertEngine::NotifyInterval() const
+{
+	return m_notifyInterval;
+}
+
+qint32 AlertEngine::CompiledCount() const
+{
+	QMutexLocker lock(&m_mutex);
+	return static_cast<qint32>(m_entries.size());
+}
+
+void AlertEngine::setRules(const QString& text)
+{
+	if (text == m_text)
+		return;
+
+	QVector<AlertRule> rules;
+	QString error;
+	if (!AlertRule::Parse(text, rules, &error))
+	{
+		emit rulesError(error);
+		return;
+	}
+
+	{
+		QMutexLocker lock(&m_mutex);
+		m_rules = rules;
+		m_compiled = false;
+	}
+
+	m_text = text;
+	writeSettings();
+
+	emit rulesChanged();
+}
+
+void AlertEngine::setNotifyInterval(const qint32 intervalMs)
+{
+	if (intervalMs < 0 || intervalMs == m_notifyInterval)
+		return;
+
+	{
+		QMutexLocker lock(&m_mutex);
+		m_notifyInterval = intervalMs;
+	}
+
+	writeSettings();
+
+	emit notifyIntervalChanged();
+}
+
+void AlertEngine::OnSnapshot(const SensorSnapshot& snapshot)
+{
+	{
+		QMutexLocker lock(&m_mutex);
+
+		if (!m_compiled || m_layoutVersion != snapshot.LayoutVersion())
+			compile(snapshot);
+
+		const auto values = snapshot.Values();
+		const auto now = snapshot.Timestamp();
+		m_events.clear();
+
+		for (auto i = 0; i < static_cast<qint32>(m_entries.size()); ++i)
+		{
+			auto& entry = m_entries[i];
+			const auto value = values[entry.slot];
+
+			// NaN 与任何阈值比较均不成立 没有读数视为条件不满足
+			bool active = false;
+			switch (entry.comparator)
+			{
+			case AlertRule::Comparator::Greater:
+				active = value > entry.threshold;
+				break;
+			case AlertRule::Comparator::GreaterEqual:
+				active = value >= entry.threshold;
+				break;
+			case AlertRule::Comparator::Less:
+				active = value < entry.threshold;
+				break;
+			case AlertRule::Comparator::LessEqual:
+				active = value <= entry.threshold;
+				break;
+			case AlertRule::Comparator::Equal:
+				active = value == entry.threshold;
+				break;
+			case AlertRule::Comparator::NotEqual:
+				active = !qIsNaN(value) && value != entry.threshold;
+				break;
+			}
+
+			// 条件需持续 hold 毫秒才切换状态 (触发与解除均去抖)
+			switch (entry.state)
+			{
+			case State::Idle:
+				if (!active)
+					break;
+				entry.state = State::Pending;
+				entry.since = now;
+				Q_FALLTHROUGH();
+			case State::Pending:
+				if (!active)
+				{
+					entry.state = State::Idle;
+				}
+				else if (now - entry.since >= entry.hold)
+				{
+					entry.state = State::Firing;
+					entry.notified = entry.lastNotify < 0 || now - entry.lastNotify >= m_notifyInterval;
+					if (entry.notified)
+					{
+						entry.lastNotify = now;
+						m_events.push_back(Event{ i, true, value });
+					}
+				}
+				break;
+			case State::Firing:
+				if (active)
+					break;
+				entry.state = State::Clearing;
+				entry.since = now;
+				Q_FALLTHROUGH();
+			case State::Clearing:
+				if (active)
+				{
+					entry.state = State::Firing;
+				}
+				else if (now - entry.since >= entry.hold)
+				{
+					entry.state = State::Idle;
+					if (entry.notified)
+						m_events.push_back(Event{ i, false, value });
+					entry.notified = false;
+				}
+				break;
+			}
+		}
+
+		if (m_events.empty())
+			return;
+	}
+
+	// 在锁外发出信号 直接连接的接收者可以安全地修改规则
+	for (const auto& event : m_events)
+	{
+		QString sensor;
+		QString rule;
+		{
+			QMutexLocker lock(&m_mutex);
+			if (event.entry >= static_cast<qint32>(m_entries.size()))
+				break;
+
+			const auto& entry = m_entries.at(event.entry);
+			sensor = snapshot.Info(entry.slot).name;
+			rule = m_rules.value(entry.rule).text;
+		}
+
+		if (event.raised)
+			emit alertRaised(sensor, rule, event.value);
+		else
+			emit alertCleared(sensor, rule, event.value);
+	}
+}
+
+void AlertEngine::compile(const SensorSnapshot& snapshot)
+{
+	// 保留已有条目的状态 避免布局变化时重复告警
+	std::vector<Entry> previous;
+	previous.swap(m_entries);
+
+	for (auto r = 0; r < m_rules.count(); ++r)
+	{
+		const auto& rule = m_rules.at(r);
+		const auto wildcard = rule.sensor.endsWith('*');
+		const auto prefix = wildcard ? rule.sensor.chopped(1) : rule.sensor;
+
+		for (auto slot = 0; slot < snapshot.Count(); ++slot)
+		{
+			const auto& name = snapshot.Info(slot).name;
+			if (wildcard ? !name.startsWith(prefix) : name != prefix)
+				continue;
+
+			Entry entry{ slot, r, rule.threshold, rule.hold, rule.comparator, State::Idle, false, 0, -1 };
+			for (const auto& old : previous)
+			{
+				if (m_compiled && old.slot == slot && old.rule == r)
+				{
+					entry = old;
+					break;
+				}
+			}
+
+			m_entries.push_back(entry);
+		}
+	}
+
+	m_events.reserve(m_entries.size());
+	m_layoutVersion = snapshot.LayoutVersion();
+	m_compiled = true;
+}
+
+void AlertEngine::readSettings()
+{
+	const auto text = m_settings.value(SETTINGS_ALERTRULES, DEFAULT_ALERTRULES).toString();
+	m_notifyInterval = qMax(0, m_settings.value(SETTINGS_ALERTNOTIFYINTERVAL, m_notifyInterval).toInt());
+
+	// 保存的规则无效时回退到默认规则
+	if (AlertRule::Parse(text, m_rules))
+		m_text = text;
+	else if (AlertRule::Parse(DEFAULT_ALERTRULES, m_rules))
+		m_text = DEFAULT_ALERTRULES;
+}
+
+void AlertEngine::writeSettings()
+{
+	m_settings.setValue(SETTINGS_ALERTRULES, m_text);
+	m_settings.setValue(SETTINGS_ALERTNOTIFYINTERVAL, m_notifyInterval);
+}
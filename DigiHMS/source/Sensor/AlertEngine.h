@@ -0,0 +1,180 @@
+﻿#pragma once
+
+#include <QObject>
+#include <QMutex>
+#include <QSettings>
+#include <QVector>
+#include <vector>
+#include "SensorSource.h"
+
+/// <summary>
+/// 阈值告警规则 (解析后的文本规则)
+/// <para>语法: &lt;sensor&gt; &lt;op&gt; &lt;threshold&gt; [for &lt;hold&gt;(ms|s|m)]</para>
+/// <para>op 为 &gt; &gt;= &lt; &lt;= == != 之一; sensor 以 * 结尾时匹配所有同前缀的传感器</para>
+/// <para>例如: cpu.temp &gt; 90 for 5s, storage.temp.* &gt; 55 for 30s</para>
+/// </summary>
+struct AlertRule
+{
+	enum class Comparator : quint8
+	{
+		Greater,
+		GreaterEqual,
+		Less,
+		LessEqual,
+		Equal,
+		NotEqual
+	};
+
+	QString sensor;
+	Comparator comparator;
+	float threshold;
+	/// <summary>
+	/// 条件持续满足 (或持续不满足) 多久后才触发 (或解除) 告警 (毫秒)
+	/// </summary>
+	qint32 hold;
+	/// <summary>
+	/// 规则原文
+	/// </summary>
+	QString text;
+
+	/// <summary>
+	/// 解析规则文本 每行一条 '#' 开头的行为注释
+	/// </summary>
+	/// <param name="text">规则文本</param>
+	/// <param name="rules">输出规则</param>
+	/// <param name="error">错误信息 (可为空)</param>
+	/// <returns>是否全部解析成功</returns>
+	static bool Parse(const QString& text, QVector<AlertRule>& rules, QString* error = Q_NULLPTR);
+};
+
+/// <summary>
+/// 阈值告警引擎
+/// <para>规则在传感器布局变化时编译为平铺的规则表 (槽位, 比较符, 阈值, 保持时间)</para>
+/// <para>每次采样在采样线程中对规则表做一次线性遍历, 稳态下不分配内存</para>
+/// <para>告警经过去抖 (保持时间) 与限频 (同一规则两次触发通知的最小间隔) 后以信号发出</para>
+/// </summary>
+class AlertEngine : public QObject, public SensorConsumer
+{
+	Q_OBJECT
+
+	Q_PROPERTY(QString rules
+		READ Rules
+		WRITE setRules
+		NOTIFY rulesChanged)
+	Q_PROPERTY(qint32 notifyInterval
+		READ NotifyInterval
+		WRITE setNotifyInterval
+		NOTIFY notifyIntervalChanged)
+
+public:
+	explicit AlertEngine(QObject* parent = Q_NULLPTR);
+	virtual ~AlertEngine();
+
+	/// <summary>
+	/// 获取规则文本
+	/// </summary>
+	/// <returns>规则文本</returns>
+	QString Rules() const;
+	/// <summary>
+	/// 获取同一规则两次通知的最小间隔 (毫秒)
+	/// </summary>
+	/// <returns>通知间隔</returns>
+	qint32 NotifyInterval() const;
+	/// <summary>
+	/// 获取编译后的规则表条目数量 (通配符规则按匹配的传感器展开)
+	/// </summary>
+	/// <returns>条目数量</returns>
+	qint32 CompiledCount() const;
+
+signals:
+	void rulesChanged();
+	void notifyIntervalChanged();
+	/// <summary>
+	/// 规则解析失败
+	/// </summary>
+	/// <param name="message">错误信息</param>
+	void rulesError(const QString& message);
+	/// <summary>
+	/// 告警触发 (从采样线程发出)
+	/// </summary>
+	/// <param name="sensor">传感器名称</param>
+	/// <param name="rule">规则原文</param>
+	/// <param name="value">当前读数</param>
+	void alertRaised(const QString& sensor, const QString& rule, float value);
+	/// <summary>
+	/// 告警解除 (从采样线程发出, 仅针对已通知过的告警)
+	/// </summary>
+	/// <param name="sensor">传感器名称</param>
+	/// <param name="rule">规则原文</param>
+	/// <param name="value">当前读数</param>
+	void alertCleared(const QString& sensor, const QString& rule, float value);
+
+public slots:
+	/// <summary>
+	/// 设置规则文本 解析失败时保留原有规则
+	/// </summary>
+	/// <param name="text">规则文本</param>
+	void setRules(const QString& text);
+	/// <summary>
+	/// 设置同一规则两次通知的最小间隔
+	/// </summary>
+	/// <param name="intervalMs">通知间隔 (毫秒)</param>
+	void setNotifyInterval(const qint32 intervalMs);
+
+	/**
+	 * SensorConsumer 接口
+	 */
+public:
+	void OnSnapshot(const SensorSnapshot& snapshot) override;
+
+private:
+	enum class State : quint8
+	{
+		Idle,
+		Pending,
+		Firing,
+		Clearing
+	};
+
+	/// <summary>
+	/// 编译后的规则表条目
+	/// </summary>
+	struct Entry
+	{
+		qint32 slot;
+		qint32 rule;
+		float threshold;
+		qint32 hold;
+		AlertRule::Comparator comparator;
+		State state;
+		bool notified;
+		qint64 since;
+		qint64 lastNotify;
+	};
+
+	/// <summary>
+	/// 本次遍历产生的通知 遍历结束释放锁后再发出信号
+	/// </summary>
+	struct Event
+	{
+		qint32 entry;
+		bool raised;
+		float value;
+	};
+
+	void compile(const SensorSnapshot& snapshot);
+	void readSettings();
+	void writeSettings();
+
+private:
+	QString m_text;
+	qint32 m_notifyInterval;
+	QSettings m_settings;
+
+	mutable QMutex m_mutex;
+	QVector<AlertRule> m_rules;
+	std::vector<Entry> m_entries;
+	std::vector<Event> m_events;
+	bool m_compiled;
+	quint32 m_layoutVersion;
+};
@@ -0,0 +1,409 @@
+﻿#include "BatchFileReader.h"
+
+#if defined(Q_OS_LINUX)
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#define DIGIHMS_HAS_IO_URING
+#endif
+#endif
+
+#ifdef DIGIHMS_HAS_IO_URING
+
+namespace
+{
+	/// <summary>
+	/// 与内核共享的环形队列计数器 (C++17 没有 atomic_ref)
+	/// </summary>
+	inline quint32 loadAcquire(const quint32* value)
+	{
+		return __atomic_load_n(value, __ATOMIC_ACQUIRE);
+	}
+
+	inline void storeRelease(quint32* value, quint32 data)
+	{
+		__atomic_store_n(value, data, __ATOMIC_RELEASE);
+	}
+}
+
+/// <summary>
+/// 最小的 io_uring 封装 (不依赖 liburing)
+/// </summary>
+class BatchFileReader::Ring
+{
+public:
+	Ring()
+		: m_fd(-1)
+		, m_sqRing(MAP_FAILED)
+		, m_cqRing(MAP_FAILED)
+		, m_sqes(MAP_FAILED)
+		, m_sqRingSize(0)
+		, m_cqRingSize(0)
+		, m_sqesSize(0)
+	{
+	}
+
+	~Ring()
+	{
+		if (m_sqes != MAP_FAILED)
+			::munmap(m_sqes, m_sqesSize);
+		if (m_cqRing != MAP_FAILED && m_cqRing != m_sqRing)
+			::munmap(m_cqRing, m_cqRingSize);
+		if (m_sqRing != MAP_FAILED)
+			::munmap(m_sqRing, m_sqRingSize);
+		if (m_fd >= 0)
+			::close(m_fd);
+	}
+
+	/// <summary>
+	/// 创建 io_uring 并注册文件与缓冲区
+	/// </summary>
+	bool Setup(quint32 entries, const QVector<int>& fds, char* buffer, qint32 size)
+	{
+		io_uring_params params;
+		std::memset(&params, 0, sizeof(params));
+		m_fd = static_cast<int>(::syscall(__NR_io_uring_setup, entries, &params));
+		if (m_fd < 0)
+			return false;
+
+		m_sqRingSize = params.sq_off.array + params.sq_entries * sizeof(quint32);
+		m_cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+		const bool singleMap = params.features & IORING_FEAT_SINGLE_MMAP;
+		if (singleMap)
+			m_sqRingSize = m_cqRingSize = qMax(m_sqRingSize, m_cqRingSize);
+
+		m_sqRing = ::mmap(Q_NULLPTR, m_sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_fd, IORING_OFF_SQ_RING);
+		if (m_sqRing == MAP_FAILED)
+			return false;
+
+		m_cqRing = singleMap ? m_sqRing
+			: ::mmap(Q_NULLPTR, m_cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_fd, IORING_OFF_CQ_RING);
+		if (m_cqRing == MAP_FAILED)
+			return false;
+
+		m_sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+		m_sqes = ::mmap(Q_NULLPTR, m_sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_fd, IORING_OFF_SQES);
+		if (m_sqes == MAP_FAILED)
+			return false;
+
+		auto sq = static_cast<char*>(m_sqRing);
+		m_sqHead = reinterpret_cast<quint32*>(sq + params.sq_off.head);
+		m_sqTail = reinterpret_cast<quint32*>(sq + params.sq_off.tail);
+		m_sqMask = *reinterpret_cast<quint32*>(sq + params.sq_off.ring_mask);
+		m_sqArray = reinterpret_cast<quint32*>(sq + params.sq_off.array);
+		m_sqEntries = params.sq_entries;
+
+		auto cq = static_cast<char*>(m_cqRing);
+		m_cqHead = reinterpret_cast<quint32*>(cq + params.cq_off.head);
+		m_cqTail = reinterpret_cast<quint32*>(cq + params.cq_off.tail);
+		m_cqMask = *reinterpret_cast<quint32*>(cq + params.cq_off.ring_mask);
+		m_cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+
+		// 注册后每次读取不再查找文件表与固定用户缓冲区页
+		iovec vector{ buffer, static_cast<size_t>(size) };
+		if (::syscall(__NR_io_uring_register, m_fd, IORING_REGISTER_BUFFERS, &vector, 1) != 0)
+			return false;
+
+		return ::syscall(__NR_io_uring_register, m_fd, IORING_REGISTER_FILES, fds.constData(), fds.count()) == 0;
+	}
+
+	/// <summary>
+	/// 提交队列容量
+	/// </summary>
+	quint32 Entries() const
+	{
+		return m_sqEntries;
+	}
+
+	/// <summary>
+	/// 写入一个读取请求 (调用 SubmitAndWait 后生效)
+	/// </summary>
+	void PrepareRead(quint32 slot, char* data, quint32 length, quint64 userData)
+	{
+		const auto tail = *m_sqTail + m_pending;
+		const auto index = tail & m_sqMask;
+
+		auto& sqe = static_cast<io_uring_sqe*>(m_sqes)[index];
+		std::memset(&sqe, 0, sizeof(sqe));
+		sqe.opcode = IORING_OP_READ_FIXED;
+		sqe.flags = IOSQE_FIXED_FILE;
+		sqe.fd = static_cast<qint32>(slot);
+		sqe.addr = reinterpret_cast<quint64>(data);
+		sqe.len = length;
+		sqe.off = 0;
+		sqe.buf_index = 0;
+		sqe.user_data = userData;
+
+		m_sqArray[index] = index;
+		m_pending++;
+	}
+
+	/// <summary>
+	/// 提交所有请求并等待全部完成
+	/// </summary>
+	/// <param name="complete">每个完成事件的回调 (user_data, res)</param>
+	/// <param name="syscalls">累计系统调用次数</param>
+	/// <returns>是否成功</returns>
+	template<typename Complete>
+	bool SubmitAndWait(Complete complete, quint64* syscalls)
+	{
+		const auto submitted = m_pending;
+		storeRelease(m_sqTail, *m_sqTail + m_pending);
+		m_pending = 0;
+
+		quint32 toSubmit = submitted;
+		quint32 remaining = submitted;
+		while (remaining > 0)
+		{
+			// 一次系统调用同时提交并等待所有完成事件
+			const auto result = ::syscall(__NR_io_uring_enter, m_fd, toSubmit, remaining, IORING_ENTER_GETEVENTS, Q_NULLPTR, 0);
+			(*syscalls)++;
+			if (result < 0)
+			{
+				if (errno == EINTR)
+					continue;
+				return false;
+			}
+
+			toSubmit -= qMin(toSubmit, static_cast<quint32>(result));
+
+			auto head = *m_cqHead;
+			const auto tail = loadAcquire(m_cqTail);
+			for (; head != tail; ++head)
+			{
+				const auto& cqe = m_cqes[head & m_cqMask];
+				complete(cqe.user_data, cqe.res);
+				remaining--;
+			}
+			storeRelease(m_cqHead, head);
+		}
+
+		return true;
+	}
+
+private:
+	int m_fd;
+	void* m_sqRing;
+	void* m_cqRing;
+	void* m_sqes;
+	size_t m_sqRingSize;
+	size_t m_cqRingSize;
+	size_t m_sqesSize;
+
+	quint32* m_sqHead = Q_NULLPTR;
+	quint32* m_sqTail = Q_NULLPTR;
+	quint32* m_sqArray = Q_NULLPTR;
+	quint32 m_sqMask = 0;
+	quint32 m_sqEntries = 0;
+	quint32 m_pending = 0;
+
+	quint32* m_cqHead = Q_NULLPTR;
+	quint32* m_cqTail = Q_NULLPTR;
+	quint32 m_cqMask = 0;
+	io_uring_cqe* m_cqes = Q_NULLPTR;
+};
+
+#else
+
+class BatchFileReader::Ring
+{
+};
+
+#endif
+
+namespace
+{
+	/// <summary>
+	/// io_uring 提交队列的最大容量 (文件更多时分批提交)
+	/// </summary>
+	const quint32 MaxRingEntries = 1024;
+}
+
+BatchFileReader::BatchFileReader()
+	: m_bufferSize(0)
+	, m_backend(Backend::None)
+	, m_syscalls(0)
+{
+}
+
+BatchFileReader::~BatchFileReader()
+{
+	Close();
+}
+
+qint32 BatchFileReader::Add(const QString& path, qint32 capacity)
+{
+	m_files.append(File{ path, -1, -1, 0, qMax(capacity, 1), -1 });
+	return static_cast<qint32>(m_files.count() - 1);
+}
+
+bool BatchFileReader::Open(Backend preferred)
+{
+	Close();
+
+	// 所有文件共用一块缓冲区 每段末尾保留 '\0'
+	m_bufferSize = 0;
+	for (auto& file : m_files)
+	{
+		file.offset = m_bufferSize;
+		m_bufferSize += file.capacity + 1;
+	}
+	m_buffer.reset(new char[qMax(m_bufferSize, 1)]());
+
+	bool opened = false;
+#ifdef Q_OS_LINUX
+	QVector<int> fds;
+	for (auto& file : m_files)
+	{
+		file.fd = ::open(file.path.toLocal8Bit().constData(), O_RDONLY | O_CLOEXEC);
+		file.slot = -1;
+		if (file.fd >= 0)
+		{
+			file.slot = static_cast<qint32>(fds.count());
+			fds.append(file.fd);
+			opened = true;
+		}
+	}
+
+	m_backend = Backend::Pread;
+#ifdef DIGIHMS_HAS_IO_URING
+	if (preferred == Backend::IoUring && !fds.isEmpty())
+	{
+		auto ring = std::make_unique<Ring>();
+		const auto entries = qMin(static_cast<quint32>(fds.count()), MaxRingEntries);
+		if (ring->Setup(entries, fds, m_buffer.get(), m_bufferSize))
+		{
+			m_ring = std::move(ring);
+			m_backend = Backend::IoUring;
+		}
+	}
+#else
+	Q_UNUSED(preferred);
+#endif
+#else
+	Q_UNUSED(preferred);
+#endif
+
+	return opened;
+}
+
+void BatchFileReader::Close()
+{
+	m_ring.reset();
+
+#ifdef Q_OS_LINUX
+	for (auto& file : m_files)
+	{
+		if (file.fd >= 0)
+			::close(file.fd);
+		file.fd = -1;
+		file.slot = -1;
+		file.length = -1;
+	}
+#endif
+
+	m_backend = Backend::None;
+}
+
+bool BatchFileReader::Read()
+{
+	switch (m_backend)
+	{
+	case Backend::IoUring:
+		// io_uring 运行中失败 (例如被取消) 时回退到 pread
+		if (readRing())
+			return true;
+		m_ring.reset();
+		m_backend = Backend::Pread;
+		return readPread();
+	case Backend::Pread:
+		return readPread();
+	default:
+		return false;
+	}
+}
+
+qint32 BatchFileReader::Count() const
+{
+	return static_cast<qint32>(m_files.count());
+}
+
+const char* BatchFileReader::Data(qint32 index) const
+{
+	return m_buffer.get() + m_files[index].offset;
+}
+
+qint32 BatchFileReader::Length(qint32 index) const
+{
+	return m_files[index].length;
+}
+
+BatchFileReader::Backend BatchFileReader::CurrentBackend() const
+{
+	return m_backend;
+}
+
+quint64 BatchFileReader::Syscalls() const
+{
+	return m_syscalls;
+}
+
+bool BatchFileReader::readPread()
+{
+#ifdef Q_OS_LINUX
+	for (auto& file : m_files)
+	{
+		if (file.fd < 0)
+			continue;
+
+		const auto data = m_buffer.get() + file.offset;
+		const auto bytes = ::pread(file.fd, data, file.capacity, 0);
+		m_syscalls++;
+
+		file.length = bytes < 0 ? -1 : static_cast<qint32>(bytes);
+		data[qMax(file.length, 0)] = '\0';
+	}
+
+	return true;
+#else
+	return false;
+#endif
+}
+
+bool BatchFileReader::readRing()
+{
+#ifdef DIGIHMS_HAS_IO_URING
+	const auto complete = [this](quint64 index, qint32 result) {
+		auto& file = m_files[static_cast<qint32>(index)];
+		file.length = result < 0 ? -1 : result;
+		m_buffer[file.offset + qMax(file.length, 0)] = '\0';
+	};
+
+	// 文件数量不超过队列容量时只有一次提交
+	quint32 queued = 0;
+	for (auto i = 0; i < m_files.count(); ++i)
+	{
+		const auto& file = m_files[i];
+		if (file.slot < 0)
+			continue;
+
+		m_ring->PrepareRead(static_cast<quint32>(file.slot), m_buffer.get() + file.offset, static_cast<quint32>(file.capacity), static_cast<quint64>(i));
+		if (++queued == m_ring->Entries())
+		{
+			if (!m_ring->SubmitAndWait(complete, &m_syscalls))
+				return false;
+			queued = 0;
+		}
+	}
+
+	return queued == 0 || m_ring->SubmitAndWait(complete, &m_syscalls);
+#else
+	return false;
+#endif
+}
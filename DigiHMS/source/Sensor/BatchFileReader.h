@@ -0,0 +1,119 @@
+﻿#pragma once
+
+#include <QString>
+#include <QVector>
+#include <memory>
+
+/// <summary>
+/// 批量读取小文件 (sysfs / procfs 传感器文件)
+/// <para>文件预先打开, 每次 Read 从偏移 0 重新读取所有文件 (sysfs 与 seq_file 在偏移 0 处重新生成内容)</para>
+/// <para>Linux 上优先使用 io_uring: 文件与缓冲区预先注册, 一次提交所有读取 (每次约一个系统调用)</para>
+/// <para>io_uring 不可用时 (内核过旧或被 seccomp 禁止) 逐个 pread</para>
+/// </summary>
+class BatchFileReader
+{
+public:
+	/// <summary>
+	/// 读取方式
+	/// </summary>
+	enum class Backend
+	{
+		/// <summary>
+		/// 尚未打开
+		/// </summary>
+		None,
+		/// <summary>
+		/// 逐个 pread
+		/// </summary>
+		Pread,
+		/// <summary>
+		/// io_uring 批量提交
+		/// </summary>
+		IoUring
+	};
+
+	BatchFileReader();
+	BatchFileReader(const BatchFileReader&) = delete;
+	BatchFileReader& operator=(const BatchFileReader&) = delete;
+	~BatchFileReader();
+
+	/// <summary>
+	/// 添加文件 (需要在 Open 之前调用)
+	/// </summary>
+	/// <param name="path">文件路径</param>
+	/// <param name="capacity">最多读取的字节数量</param>
+	/// <returns>文件索引</returns>
+	qint32 Add(const QString& path, qint32 capacity = 32);
+	/// <summary>
+	/// 打开所有文件并准备读取方式 (无法打开的文件读取长度为 -1)
+	/// </summary>
+	/// <param name="preferred">首选读取方式 IoUring 不可用时回退到 Pread</param>
+	/// <returns>是否至少打开了一个文件</returns>
+	bool Open(Backend preferred = Backend::IoUring);
+	/// <summary>
+	/// 关闭所有文件并释放 io_uring
+	/// </summary>
+	void Close();
+	/// <summary>
+	/// 重新读取所有文件
+	/// </summary>
+	/// <returns>是否执行了读取</returns>
+	bool Read();
+
+	/// <summary>
+	/// 文件数量
+	/// </summary>
+	qint32 Count() const;
+	/// <summary>
+	/// 上次 Read 读取的内容 (以 '\0' 结尾)
+	/// </summary>
+	/// <param name="index">文件索引</param>
+	/// <returns>内容</returns>
+	const char* Data(qint32 index) const;
+	/// <summary>
+	/// 上次 Read 读取的长度
+	/// </summary>
+	/// <param name="index">文件索引</param>
+	/// <returns>长度 读取失败时返回 -1</returns>
+	qint32 Length(qint32 index) const;
+	/// <summary>
+	/// 当前使用的读取方式
+	/// </summary>
+	/// <returns>读取方式</returns>
+	Backend CurrentBackend() const;
+	/// <summary>
+	/// Read 累计发起的系统调用次数 (用于统计)
+	/// </summary>
+	/// <returns>系统调用次数</returns>
+	quint64 Syscalls() const;
+
+private:
+	struct File
+	{
+		QString path;
+		int fd;
+		/// <summary>
+		/// io_uring 中注册的文件序号
+		/// </summary>
+		qint32 slot;
+		qint32 offset;
+		qint32 capacity;
+		qint32 length;
+	};
+
+	class Ring;
+
+	bool readPread();
+	bool readRing();
+
+private:
+	QVector<File> m_files;
+	/// <summary>
+	/// 所有文件共用的读取缓冲区 (每个文件 capacity + 1 字节)
+	/// </summary>
+	std::unique_ptr<char[]> m_buffer;
+	qint32 m_bufferSize;
+	std::unique_ptr<Ring> m_ring;
+	Backend m_backend;
+	quint64 m_syscalls;
+};
@@ -0,0 +1,433 @@
+﻿#include "FanControl.h"
+#include "SensorSnapshot.h"
+#include <QtMath>
+#include <algorithm>
+#include <limits>
+
+namespace
+{
+	const float NaN = std::numeric_limits<float>::quiet_NaN();
+
+	/// <summary>
+	/// 控制名称不存在 在传感器布局变化前不再重新解析
+	/// </summary>
+	const qint32 HandleMissing = -2;
+
+	/// <summary>
+	/// 温度平滑查询缓冲区容量
+	/// </summary>
+	const qint32 SmoothingPoints = 256;
+
+	QString pointsToString(const QVector<FanCurve::Point>& points)
+	{
+		QStringList list;
+		for (const auto& point : points)
+			list.append(QString("%1:%2").arg(point.temperature).arg(point.percent));
+
+		return list.join(',');
+	}
+
+	QVector<FanCurve::Point> pointsFromString(const QString& text)
+	{
+		QVector<FanCurve::Point> points;
+		for (const auto& item : text.split(',', Qt::SkipEmptyParts))
+		{
+			const auto pair = item.split(':');
+			if (pair.count() == 2)
+				points.append(FanCurve::Point{ pair.at(0).toFloat(), pair.at(1).toFloat() });
+		}
+
+		std::sort(points.begin(), points.end(), [](const FanCurve::Point& a, const FanCurve::Point& b) {
+			return a.temperature < b.temperature;
+		});
+
+		return points;
+	}
+}
+
+SimulatedFanBackend::SimulatedFanBackend(const QStringList& controls)
+	: m_controls(controls)
+	, m_percent(controls.count(), NaN)
+	, m_writes(0)
+{
+
+}
+
+float SimulatedFanBackend::Percent(const QString& control) const
+{
+	const auto handle = m_controls.indexOf(control);
+	return handle < 0 ? NaN : m_percent.at(handle);
+}
+
+qint64 SimulatedFanBackend::Writes() const
+{
+	return m_writes;
+}
+
+qint32 SimulatedFanBackend::Resolve(const QString& control)
+{
+	return m_controls.indexOf(control);
+}
+
+bool SimulatedFanBackend::Write(qint32 handle, float percent)
+{
+	if (handle < 0 || handle >= m_percent.count())
+		return false;
+
+	m_percent[handle] = percent;
+	m_writes++;
+	return true;
+}
+
+void SimulatedFanBackend::Restore(qint32 handle)
+{
+	if (handle >= 0 && handle < m_percent.count())
+		m_percent[handle] = NaN;
+}
+
+float FanCurve::Interpolate(float temperature) const
+{
+	// 没有节点时全速运行
+	if (points.isEmpty())
+		return maxPercent;
+
+	if (temperature <= points.first().temperature)
+		return points.first().percent;
+
+	for (auto i = 1; i < points.count(); ++i)
+	{
+		const auto& low = points.at(i - 1);
+		const auto& high = points.at(i);
+		if (temperature <= high.temperature)
+		{
+			const auto span = high.temperature - low.temperature;
+			if (span <= 0)
+				return high.percent;
+
+			return low.percent + (high.percent - low.percent) * (temperature - low.temperature) / span;
+		}
+	}
+
+	return points.last().percent;
+}
+
+QVector<FanChannel> FanChannel::FromVariant(const QVariantList& list)
+{
+	QVector<FanChannel> channels;
+	for (const auto& item : list)
+	{
+		const auto map = item.toMap();
+
+		FanChannel channel;
+		channel.control = map.value("control").toString();
+		channel.sensor = map.value("sensor").toString();
+		if (channel.control.isEmpty() || channel.sensor.isEmpty())
+			continue;
+
+		auto& curve = channel.curve;
+		curve.mode = map.value("mode").toString() == "pid" ? FanCurve::Mode::Pid : FanCurve::Mode::Linear;
+		curve.points = pointsFromString(map.value("points").toString());
+		curve.target = map.value("target", curve.target).toFloat();
+		curve.kp = map.value("kp", curve.kp).toFloat();
+		curve.ki = map.value("ki", curve.ki).toFloat();
+		curve.kd = map.value("kd", curve.kd).toFloat();
+		curve.minPercent = map.value("min", curve.minPercent).toFloat();
+		curve.maxPercent = map.value("max", curve.maxPercent).toFloat();
+
+		channel.hysteresis = map.value("hysteresis", channel.hysteresis).toFloat();
+		channel.maxStep = map.value("maxStep", channel.maxStep).toFloat();
+		channel.deadband = map.value("deadband", channel.deadband).toFloat();
+		channel.minWriteInterval = map.value("minWriteInterval", channel.minWriteInterval).toInt();
+		channel.smoothing = map.value("smoothing", channel.smoothing).toInt();
+		channel.failsafe = map.value("failsafe", channel.failsafe).toFloat();
+
+		channels.append(channel);
+	}
+
+	return channels;
+}
+
+QVariantList FanChannel::ToVariant(const QVector<FanChannel>& channels)
+{
+	QVariantList list;
+	for (const auto& channel : channels)
+	{
+		const auto& curve = channel.curve;
+
+		QVariantMap map;
+		map.insert("control", channel.control);
+		map.insert("sensor", channel.sensor);
+		map.insert("mode", QString(curve.mode == FanCurve::Mode::Pid ? "pid" : "linear"));
+		map.insert("points", pointsToString(curve.points));
+		map.insert("target", curve.target);
+		map.insert("kp", curve.kp);
+		map.insert("ki", curve.ki);
+		map.insert("kd", curve.kd);
+		map.insert("min", curve.minPercent);
+		map.insert("max", curve.maxPercent);
+		map.insert("hysteresis", channel.hysteresis);
+		map.insert("maxStep", channel.maxStep);
+		map.insert("deadband", channel.deadband);
+		map.insert("minWriteInterval", channel.minWriteInterval);
+		map.insert("smoothing", channel.smoothing);
+		map.insert("failsafe", channel.failsafe);
+		list.append(map);
+	}
+
+	return list;
+}
+
+FanController::FanController(FanBackend* backend, const SensorHistory* history)
+	: m_backend(backend)
+	, m_history(history)
+	, m_channelsChanged(false)
+	, m_interval(1000)
+	, m_lastEvaluation(-1)
+	, m_resolved(false)
+	, m_layoutVersion(0)
+	, m_points(SmoothingPoints)
+{
+	Q_ASSERT(backend);
+}
+
+FanController::~FanController()
+{
+
+}
+
+void FanController::SetChannels(const QVector<FanChannel>& channels)
+{
+	QMutexLocker lock(&m_mutex);
+	m_pendingChannels = channels;
+	m_channelsChanged = true;
+}
+
+QVector<FanChannel> FanController::Channels() const
+{
+	QMutexLocker lock(&m_mutex);
+	return m_channelsChanged ? m_pendingChannels : m_channels;
+}
+
+void FanController::SetInterval(qint32 intervalMs)
+{
+	Q_ASSERT(intervalMs > 0);
+
+	QMutexLocker lock(&m_mutex);
+	m_interval = qMax(intervalMs, 1);
+}
+
+bool FanController::SetOverride(const QString& control, float percent)
+{
+	QMutexLocker lock(&m_mutex);
+
+	const auto& channels = m_channelsChanged ? m_pendingChannels : m_channels;
+	const auto controlled = std::any_of(channels.cbegin(), channels.cend(), [&control](const FanChannel& channel) {
+		return channel.control == control;
+	});
+	if (!controlled)
+		return false;
+
+	if (qIsNaN(percent))
+		m_overrides.remove(control);
+	else
+		m_overrides.insert(control, qBound(0.0f, percent, 100.0f));
+
+	return true;
+}
+
+float FanController::Output(qint32 channel) const
+{
+	QMutexLocker lock(&m_mutex);
+	if (channel < 0 || channel >= m_states.count())
+		return NaN;
+
+	return m_states.at(channel).output;
+}
+
+void FanController::RestoreDefaults()
+{
+	QMutexLocker lock(&m_mutex);
+
+	for (auto& state : m_states)
+	{
+		if (state.handle >= 0)
+			m_backend->Restore(state.handle);
+
+		state = initialState();
+	}
+
+	m_resolved = false;
+}
+
+void FanController::OnSnapshot(const SensorSnapshot& snapshot)
+{
+	QMutexLocker lock(&m_mutex);
+
+	// 固定周期计算 采样周期更短时跳过中间的快照 (容许 10% 的定时抖动)
+	const auto timestamp = snapshot.Timestamp();
+	if (m_lastEvaluation >= 0 && timestamp - m_lastEvaluation < m_interval - m_interval / 10)
+		return;
+
+	const auto dt = m_lastEvaluation < 0 ? m_interval / 1000.0f : (timestamp - m_lastEvaluation) / 1000.0f;
+	m_lastEvaluation = timestamp;
+
+	if (m_channelsChanged)
+		applyChannels();
+
+	if (!m_resolved || m_layoutVersion != snapshot.LayoutVersion())
+		resolve(snapshot);
+
+	for (auto i = 0; i < m_channels.count(); ++i)
+		evaluate(snapshot, i, dt);
+}
+
+void FanController::applyChannels()
+{
+	// 新配置中不再存在的控制恢复默认
+	for (auto i = 0; i < m_states.count(); ++i)
+	{
+		const auto& control = m_channels.at(i).control;
+		const auto kept = std::any_of(m_pendingChannels.cbegin(), m_pendingChannels.cend(), [&control](const FanChannel& channel) {
+			return channel.control == control;
+		});
+
+		if (!kept && m_states.at(i).handle >= 0)
+			m_backend->Restore(m_states.at(i).handle);
+	}
+
+	m_channels = m_pendingChannels;
+	m_pendingChannels.clear();
+	m_channelsChanged = false;
+
+	// 手动覆盖只对仍然存在的通道有效
+	for (auto it = m_overrides.begin(); it != m_overrides.end();)
+	{
+		const auto& control = it.key();
+		const auto kept = std::any_of(m_channels.cbegin(), m_channels.cend(), [&control](const FanChannel& channel) {
+			return channel.control == control;
+		});
+		it = kept ? std::next(it) : m_overrides.erase(it);
+	}
+
+	m_states.fill(initialState(), m_channels.count());
+	m_resolved = false;
+}
+
+void FanController::evaluate(const SensorSnapshot& snapshot, qint32 index, float dt)
+{
+	const auto& channel = m_channels.at(index);
+	auto& state = m_states[index];
+
+	if (state.handle == -1)
+	{
+		const auto handle = m_backend->Resolve(channel.control);
+		state.handle = handle < 0 ? HandleMissing : handle;
+	}
+	if (state.handle < 0)
+		return;
+
+	// 传感器没有读数时立即切换到安全转速
+	const auto value = temperature(snapshot, channel, state);
+	const auto failsafe = qIsNaN(value);
+
+	// 手动覆盖时不计算曲线 (PID 不累积积分)
+	const auto manual = m_overrides.isEmpty() ? NaN : m_overrides.value(channel.control, NaN);
+	auto percent = failsafe ? channel.failsafe : (qIsNaN(manual) ? compute(channel, state, value, dt) : manual);
+	if (!failsafe)
+	{
+		percent = qBound(channel.curve.minPercent, percent, channel.curve.maxPercent);
+		if (!qIsNaN(state.output))
+			percent = qBound(state.output - channel.maxStep, percent, state.output + channel.maxStep);
+	}
+	percent = qBound(0.0f, percent, 100.0f);
+
+	// 限制写入频率 变化不足死区时保持
+	const auto timestamp = snapshot.Timestamp();
+	if (!qIsNaN(state.output))
+	{
+		if (qAbs(percent - state.output) < channel.deadband)
+			return;
+		if (!failsafe && timestamp - state.lastWrite < channel.minWriteInterval)
+			return;
+	}
+
+	// 句柄失效 (例如硬件被重新打开) 时下次重新解析
+	if (!m_backend->Write(state.handle, percent))
+	{
+		state.handle = -1;
+		return;
+	}
+
+	state.output = percent;
+	state.lastWrite = timestamp;
+}
+
+float FanController::temperature(const SensorSnapshot& snapshot, const FanChannel& channel, const State& state)
+{
+	if (state.slot < 0)
+		return NaN;
+
+	if (channel.smoothing <= 0 || m_history == Q_NULLPTR)
+		return snapshot.Value(state.slot);
+
+	const auto timestamp = snapshot.Timestamp();
+	const auto count = m_history->Query(state.slot, SensorHistory::Resolution::Raw,
+		timestamp - channel.smoothing, timestamp, m_points.data(), static_cast<qint32>(m_points.size()));
+	if (count <= 0)
+		return snapshot.Value(state.slot);
+
+	double sum = 0;
+	for (auto i = 0; i < count; ++i)
+		sum += m_points[i].avg;
+
+	return static_cast<float>(sum / count);
+}
+
+float FanController::compute(const FanChannel& channel, State& state, float temperature, float dt)
+{
+	const auto& curve = channel.curve;
+
+	if (curve.mode == FanCurve::Mode::Linear)
+	{
+		// 温度上升立即跟随 下降超过回差才降低转速
+		if (qIsNaN(state.anchor) || temperature >= state.anchor || state.anchor - temperature >= channel.hysteresis)
+			state.anchor = temperature;
+
+		return curve.Interpolate(state.anchor);
+	}
+
+	// PID: 温度高于目标时误差为正 转速增加
+	const auto error = temperature - curve.target;
+	const auto derivative = qIsNaN(state.previousError) || dt <= 0 ? 0.0f : (error - state.previousError) / dt;
+	state.previousError = error;
+
+	const auto integral = state.integral + error * dt;
+	const auto output = curve.kp * error + curve.ki * integral + curve.kd * derivative;
+
+	// 输出饱和时停止积分 防止积分饱和
+	if (output > curve.minPercent && output < curve.maxPercent)
+		state.integral = integral;
+
+	return output;
+}
+
+void FanController::resolve(const SensorSnapshot& snapshot)
+{
+	for (auto i = 0; i < m_channels.count(); ++i)
+	{
+		auto& state = m_states[i];
+		state.slot = snapshot.Slot(m_channels.at(i).sensor);
+
+		// 新的硬件可能带来新的控制
+		if (state.handle == HandleMissing)
+			state.handle = -1;
+	}
+
+	m_layoutVersion = snapshot.LayoutVersion();
+	m_resolved = true;
+}
+
+FanController::State FanController::initialState()
+{
+	return State{ -1, -1, NaN, NaN, 0, 0.0f, NaN };
+}
@@ -0,0 +1,278 @@
+﻿#pragma once
+
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QVariant>
+#include <memory>
+#include <vector>
+#include "SensorSource.h"
+#include "SensorHistory.h"
+
+/// <summary>
+/// 风扇控制后端
+/// <para>在采样线程中被调用, 与数据源的读取串行执行</para>
+/// </summary>
+class FanBackend
+{
+public:
+	virtual ~FanBackend() {}
+
+	/// <summary>
+	/// 按名称解析风扇控制 (结果由控制器缓存)
+	/// </summary>
+	/// <param name="control">控制名称</param>
+	/// <returns>控制句柄 未找到时返回 -1</returns>
+	virtual qint32 Resolve(const QString& control) = 0;
+	/// <summary>
+	/// 设置风扇转速
+	/// </summary>
+	/// <param name="handle">控制句柄</param>
+	/// <param name="percent">转速百分比</param>
+	/// <returns>句柄是否有效 (无效时控制器重新解析)</returns>
+	virtual bool Write(qint32 handle, float percent) = 0;
+	/// <summary>
+	/// 恢复硬件默认控制
+	/// </summary>
+	/// <param name="handle">控制句柄</param>
+	virtual void Restore(qint32 handle) = 0;
+};
+
+/// <summary>
+/// 模拟风扇后端 (用于测试与基准)
+/// <para>记录每个控制的最近一次写入与写入次数</para>
+/// </summary>
+class SimulatedFanBackend : public FanBackend
+{
+public:
+	explicit SimulatedFanBackend(const QStringList& controls);
+
+	/// <summary>
+	/// 获取控制的当前转速 (未写入或已恢复默认时为 NaN)
+	/// </summary>
+	/// <param name="control">控制名称</param>
+	/// <returns>转速百分比</returns>
+	float Percent(const QString& control) const;
+	/// <summary>
+	/// 获取累计写入次数
+	/// </summary>
+	/// <returns>写入次数</returns>
+	qint64 Writes() const;
+
+	/**
+	 * FanBackend 接口
+	 */
+public:
+	qint32 Resolve(const QString& control) override;
+	bool Write(qint32 handle, float percent) override;
+	void Restore(qint32 handle) override;
+
+private:
+	QStringList m_controls;
+	QVector<float> m_percent;
+	qint64 m_writes;
+};
+
+/// <summary>
+/// 风扇曲线
+/// </summary>
+struct FanCurve
+{
+	enum class Mode
+	{
+		/// <summary>
+		/// 分段线性 温度超出范围时取端点值
+		/// </summary>
+		Linear,
+		/// <summary>
+		/// PID 闭环 使温度趋近 target
+		/// </summary>
+		Pid
+	};
+
+	struct Point
+	{
+		float temperature;
+		float percent;
+	};
+
+	Mode mode = Mode::Linear;
+	/// <summary>
+	/// 分段线性曲线的节点 (按温度递增)
+	/// </summary>
+	QVector<Point> points;
+
+	float target = 60.0f;
+	float kp = 4.0f;
+	float ki = 0.2f;
+	float kd = 0.0f;
+
+	float minPercent = 0.0f;
+	float maxPercent = 100.0f;
+
+	/// <summary>
+	/// 计算分段线性曲线在指定温度下的转速
+	/// </summary>
+	/// <param name="temperature">温度</param>
+	/// <returns>转速百分比</returns>
+	float Interpolate(float temperature) const;
+};
+
+/// <summary>
+/// 风扇通道 将一个风扇控制绑定到一个温度传感器
+/// </summary>
+struct FanChannel
+{
+	/// <summary>
+	/// 风扇控制名称 (例如 "Fan Control #1")
+	/// </summary>
+	QString control;
+	/// <summary>
+	/// 温度传感器名称 (例如 "cpu.temp")
+	/// </summary>
+	QString sensor;
+	FanCurve curve;
+
+	/// <summary>
+	/// 温度回差 (°C) 温度下降不足回差时保持当前转速
+	/// </summary>
+	float hysteresis = 2.0f;
+	/// <summary>
+	/// 每次计算允许的最大转速变化 (百分比)
+	/// </summary>
+	float maxStep = 10.0f;
+	/// <summary>
+	/// 转速变化小于该值时不写入硬件 (百分比)
+	/// </summary>
+	float deadband = 1.0f;
+	/// <summary>
+	/// 两次写入硬件的最小间隔 (毫秒)
+	/// </summary>
+	qint32 minWriteInterval = 2000;
+	/// <summary>
+	/// 温度平滑窗口 (毫秒, 0 表示使用最新读数) 需要控制器关联 SensorHistory
+	/// </summary>
+	qint32 smoothing = 0;
+	/// <summary>
+	/// 传感器没有读数时使用的转速 (百分比)
+	/// </summary>
+	float failsafe = 100.0f;
+
+	/// <summary>
+	/// 与 QSettings 保存格式相互转换
+	/// </summary>
+	static QVector<FanChannel> FromVariant(const QVariantList& list);
+	static QVariantList ToVariant(const QVector<FanChannel>& channels);
+};
+
+/// <summary>
+/// 风扇控制器
+/// <para>作为快照消费者在采样线程中按固定周期计算曲线并写入风扇</para>
+/// <para>控制句柄与传感器槽位均被缓存, 稳态下每次计算不会遍历硬件或分配内存</para>
+/// </summary>
+class FanController : public SensorConsumer
+{
+public:
+	/// <summary>
+	/// 构造风扇控制器
+	/// </summary>
+	/// <param name="backend">控制后端 (接管所有权)</param>
+	/// <param name="history">用于温度平滑的历史存储 (可为空, 不接管所有权)</param>
+	explicit FanController(FanBackend* backend, const SensorHistory* history = Q_NULLPTR);
+	virtual ~FanController();
+
+	/// <summary>
+	/// 设置风扇通道 (线程安全) 被移除的通道恢复默认控制
+	/// </summary>
+	/// <param name="channels">风扇通道</param>
+	void SetChannels(const QVector<FanChannel>& channels);
+	/// <summary>
+	/// 获取风扇通道
+	/// </summary>
+	/// <returns>风扇通道</returns>
+	QVector<FanChannel> Channels() const;
+	/// <summary>
+	/// 设置计算周期 (毫秒)
+	/// </summary>
+	/// <param name="intervalMs">计算周期</param>
+	void SetInterval(qint32 intervalMs);
+	/// <summary>
+	/// 手动设置受控通道的转速 (线程安全)
+	/// <para>替代曲线的输出, 仍受转速范围, 变化速率, 死区与安全转速限制; 通道被移除时失效</para>
+	/// </summary>
+	/// <param name="control">风扇控制名称</param>
+	/// <param name="percent">转速百分比 为 NaN 时恢复曲线控制</param>
+	/// <returns>是否为已配置的通道 (否则不做任何修改)</returns>
+	bool SetOverride(const QString& control, float percent);
+	/// <summary>
+	/// 获取通道最近一次写入的转速 (尚未写入时为 NaN)
+	/// </summary>
+	/// <param name="channel">通道序号</param>
+	/// <returns>转速百分比</returns>
+	float Output(qint32 channel) const;
+	/// <summary>
+	/// 将所有通道恢复为默认控制
+	/// <para>必须在采样线程停止后或在采样线程中调用</para>
+	/// </summary>
+	void RestoreDefaults();
+
+	/**
+	 * SensorConsumer 接口
+	 */
+public:
+	void OnSnapshot(const SensorSnapshot& snapshot) override;
+
+private:
+	/// <summary>
+	/// 通道运行状态
+	/// </summary>
+	struct State
+	{
+		qint32 handle;
+		qint32 slot;
+		/// <summary>
+		/// 决定当前转速的温度 (用于回差)
+		/// </summary>
+		float anchor;
+		float output;
+		qint64 lastWrite;
+		float integral;
+		float previousError;
+	};
+
+	void applyChannels();
+	void evaluate(const SensorSnapshot& snapshot, qint32 index, float dt);
+	float temperature(const SensorSnapshot& snapshot, const FanChannel& channel, const State& state);
+	float compute(const FanChannel& channel, State& state, float temperature, float dt);
+	void resolve(const SensorSnapshot& snapshot);
+	static State initialState();
+
+private:
+	std::unique_ptr<FanBackend> m_backend;
+	const SensorHistory* m_history;
+
+	mutable QMutex m_mutex;
+	QVector<FanChannel> m_channels;
+	/// <summary>
+	/// SetChannels 设置的新通道 在采样线程中生效
+	/// </summary>
+	QVector<FanChannel> m_pendingChannels;
+	bool m_channelsChanged;
+	QVector<State> m_states;
+	/// <summary>
+	/// 手动覆盖的转速 (按控制名称)
+	/// </summary>
+	QHash<QString, float> m_overrides;
+	qint32 m_interval;
+	qint64 m_lastEvaluation;
+
+	bool m_resolved;
+	quint32 m_layoutVersion;
+
+	/// <summary>
+	/// 温度平滑使用的查询缓冲区
+	/// </summary>
+	std::vector<HistoryPoint> m_points;
+};
@@ -0,0 +1,310 @@
+﻿#include "GorillaCodec.h"
+#include <QtAlgorithms>
+#include <cstring>
+#include <limits>
+
+namespace
+{
+	/// <summary>
+	/// 单个数据点的最大编码长度 (位): 4 + 32 位时间戳, 2 + 5 + 5 + 32 位读数
+	/// </summary>
+	constexpr qint64 MaxPointBits = 80;
+	/// <summary>
+	/// 首个数据点直接存储 64 位时间戳与 32 位读数
+	/// </summary>
+	constexpr qint64 FirstPointBits = 96;
+
+	quint32 FloatBits(float value)
+	{
+		quint32 bits;
+		std::memcpy(&bits, &value, sizeof(bits));
+		return bits;
+	}
+
+	float BitsFloat(quint32 bits)
+	{
+		float value;
+		std::memcpy(&value, &bits, sizeof(value));
+		return value;
+	}
+
+	qint64 SignExtend(quint64 value, qint32 bits)
+	{
+		const auto sign = quint64(1) << (bits - 1);
+		return static_cast<qint64>((value ^ sign) - sign);
+	}
+}
+
+GorillaEncoder::GorillaEncoder()
+	: m_data(Q_NULLPTR)
+	, m_capacityBits(0)
+	, m_bitPos(0)
+	, m_count(0)
+	, m_firstTimestamp(0)
+	, m_lastTimestamp(0)
+	, m_lastDelta(0)
+	, m_lastValue(0)
+	, m_leading(-1)
+	, m_trailing(0)
+{
+}
+
+void GorillaEncoder::Reset(char* data, qint32 capacity)
+{
+	m_data = data;
+	m_capacityBits = qint64(capacity) * 8;
+	m_bitPos = 0;
+	m_count = 0;
+	m_firstTimestamp = 0;
+	m_lastTimestamp = 0;
+	m_lastDelta = 0;
+	m_lastValue = 0;
+	m_leading = -1;
+	m_trailing = 0;
+
+	// writeBits 以按位或的方式写入
+	std::memset(m_data, 0, capacity);
+}
+
+bool GorillaEncoder::Append(qint64 timestamp, float value)
+{
+	const auto bits = FloatBits(value);
+
+	if (m_count == 0)
+	{
+		if (m_bitPos + FirstPointBits > m_capacityBits)
+			return false;
+
+		writeBits(static_cast<quint64>(timestamp), 64);
+		writeBits(bits, 32);
+
+		m_firstTimestamp = timestamp;
+		m_lastTimestamp = timestamp;
+		m_lastValue = bits;
+		m_count++;
+		return true;
+	}
+
+	const auto delta = timestamp - m_lastTimestamp;
+	const auto dod = delta - m_lastDelta;
+
+	if (delta < 0 || dod < std::numeric_limits<qint32>::min() || dod > std::numeric_limits<qint32>::max())
+		return false;
+	if (m_bitPos + MaxPointBits > m_capacityBits || m_count == std::numeric_limits<quint16>::max())
+		return false;
+
+	// 时间戳 delta-of-delta
+	if (dod == 0)
+	{
+		writeBits(0b0, 1);
+	}
+	else if (dod >= -64 && dod <= 63)
+	{
+		writeBits(0b10, 2);
+		writeBits(static_cast<quint64>(dod), 7);
+	}
+	else if (dod >= -256 && dod <= 255)
+	{
+		writeBits(0b110, 3);
+		writeBits(static_cast<quint64>(dod), 9);
+	}
+	else if (dod >= -2048 && dod <= 2047)
+	{
+		writeBits(0b1110, 4);
+		writeBits(static_cast<quint64>(dod), 12);
+	}
+	else
+	{
+		writeBits(0b1111, 4);
+		writeBits(static_cast<quint64>(dod), 32);
+	}
+
+	// 读数 XOR
+	const auto xored = bits ^ m_lastValue;
+	if (xored == 0)
+	{
+		writeBits(0b0, 1);
+	}
+	else
+	{
+		const qint32 leading = qCountLeadingZeroBits(xored);
+		const qint32 trailing = qCountTrailingZeroBits(xored);
+
+		if (m_leading >= 0 && leading >= m_leading && trailing >= m_trailing)
+		{
+			// 有效位落在上一个窗口内 复用窗口
+			writeBits(0b10, 2);
+			writeBits(xored >> m_trailing, 32 - m_leading - m_trailing);
+		}
+		else
+		{
+			const auto meaningful = 32 - leading - trailing;
+			writeBits(0b11, 2);
+			writeBits(static_cast<quint64>(leading), 5);
+			writeBits(static_cast<quint64>(meaningful - 1), 5);
+			writeBits(xored >> trailing, meaningful);
+
+			m_leading = leading;
+			m_trailing = trailing;
+		}
+	}
+
+	m_lastDelta = delta;
+	m_lastTimestamp = timestamp;
+	m_lastValue = bits;
+	m_count++;
+	return true;
+}
+
+qint32 GorillaEncoder::Count() const
+{
+	return m_count;
+}
+
+qint64 GorillaEncoder::FirstTimestamp() const
+{
+	return m_firstTimestamp;
+}
+
+qint64 GorillaEncoder::LastTimestamp() const
+{
+	return m_lastTimestamp;
+}
+
+qint64 GorillaEncoder::BitLength() const
+{
+	return m_bitPos;
+}
+
+void GorillaEncoder::writeBits(quint64 value, qint32 bits)
+{
+	// 高位在前
+	while (bits > 0)
+	{
+		const auto offset = static_cast<qint32>(m_bitPos & 7);
+		const auto room = 8 - offset;
+		const auto count = qMin(room, bits);
+		const auto chunk = static_cast<quint8>((value >> (bits - count)) & ((1u << count) - 1));
+
+		m_data[m_bitPos >> 3] |= static_cast<char>(chunk << (room - count));
+
+		m_bitPos += count;
+		bits -= count;
+	}
+}
+
+GorillaDecoder::GorillaDecoder(const char* data, qint64 bitLength, qint32 count)
+	: m_data(data)
+	, m_bitLength(bitLength)
+	, m_bitPos(0)
+	, m_count(count)
+	, m_index(0)
+	, m_lastTimestamp(0)
+	, m_lastDelta(0)
+	, m_lastValue(0)
+	, m_leading(-1)
+	, m_trailing(0)
+{
+}
+
+bool GorillaDecoder::Next(qint64& timestamp, float& value)
+{
+	if (m_index >= m_count)
+		return false;
+
+	quint64 bits = 0;
+
+	if (m_index == 0)
+	{
+		quint64 first = 0;
+		if (!readBits(64, first) || !readBits(32, bits))
+			return false;
+
+		m_lastTimestamp = static_cast<qint64>(first);
+		m_lastValue = static_cast<quint32>(bits);
+	}
+	else
+	{
+		// 时间戳: 前缀中 1 的个数决定 delta-of-delta 的位宽
+		static const qint32 widths[] = { 0, 7, 9, 12, 32 };
+		qint32 ones = 0;
+		while (ones < 4)
+		{
+			if (!readBits(1, bits))
+				return false;
+			if (bits == 0)
+				break;
+			ones++;
+		}
+
+		qint64 dod = 0;
+		if (ones > 0)
+		{
+			if (!readBits(widths[ones], bits))
+				return false;
+			dod = SignExtend(bits, widths[ones]);
+		}
+
+		m_lastDelta += dod;
+		m_lastTimestamp += m_lastDelta;
+
+		// 读数
+		if (!readBits(1, bits))
+			return false;
+
+		if (bits != 0)
+		{
+			if (!readBits(1, bits))
+				return false;
+
+			if (bits != 0)
+			{
+				quint64 leading = 0;
+				quint64 meaningful = 0;
+				if (!readBits(5, leading) || !readBits(5, meaningful))
+					return false;
+
+				m_leading = static_cast<qint32>(leading);
+				m_trailing = 32 - m_leading - static_cast<qint32>(meaningful + 1);
+				if (m_trailing < 0)
+					return false;
+			}
+			else if (m_leading < 0)
+			{
+				return false;
+			}
+
+			if (!readBits(32 - m_leading - m_trailing, bits))
+				return false;
+
+			m_lastValue ^= static_cast<quint32>(bits << m_trailing);
+		}
+	}
+
+	timestamp = m_lastTimestamp;
+	value = BitsFloat(m_lastValue);
+	m_index++;
+	return true;
+}
+
+bool GorillaDecoder::readBits(qint32 bits, quint64& value)
+{
+	if (m_bitPos + bits > m_bitLength)
+		return false;
+
+	value = 0;
+	while (bits > 0)
+	{
+		const auto offset = static_cast<qint32>(m_bitPos & 7);
+		const auto room = 8 - offset;
+		const auto count = qMin(room, bits);
+		const auto byte = static_cast<quint8>(m_data[m_bitPos >> 3]);
+
+		value = (value << count) | ((byte >> (room - count)) & ((1u << count) - 1));
+
+		m_bitPos += count;
+		bits -= count;
+	}
+
+	return true;
+}
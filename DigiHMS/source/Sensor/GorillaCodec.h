@@ -0,0 +1,92 @@
+﻿#pragma once
+
+#include <QtGlobal>
+
+/// <summary>
+/// Gorilla 风格的时间序列编码器
+/// <para>时间戳使用 delta-of-delta 编码, 读数使用与前值 XOR 后的有效位编码</para>
+/// <para>直接写入调用方提供的定长缓冲区, 不分配内存</para>
+/// </summary>
+class GorillaEncoder
+{
+public:
+	GorillaEncoder();
+
+	/// <summary>
+	/// 开始新的编码块 (缓冲区会被清零)
+	/// </summary>
+	/// <param name="data">输出缓冲区</param>
+	/// <param name="capacity">缓冲区大小 (字节)</param>
+	void Reset(char* data, qint32 capacity);
+	/// <summary>
+	/// 追加一个数据点
+	/// </summary>
+	/// <param name="timestamp">时间戳 (毫秒, 必须不小于上一个时间戳)</param>
+	/// <param name="value">读数</param>
+	/// <returns>缓冲区已满或时间间隔过大时返回 false 且不写入任何数据</returns>
+	bool Append(qint64 timestamp, float value);
+
+	qint32 Count() const;
+	qint64 FirstTimestamp() const;
+	qint64 LastTimestamp() const;
+	/// <summary>
+	/// 获取已写入的位数
+	/// </summary>
+	/// <returns>位数</returns>
+	qint64 BitLength() const;
+
+private:
+	void writeBits(quint64 value, qint32 bits);
+
+private:
+	char* m_data;
+	qint64 m_capacityBits;
+	qint64 m_bitPos;
+
+	qint32 m_count;
+	qint64 m_firstTimestamp;
+	qint64 m_lastTimestamp;
+	qint64 m_lastDelta;
+	quint32 m_lastValue;
+	qint32 m_leading;
+	qint32 m_trailing;
+};
+
+/// <summary>
+/// Gorilla 风格的时间序列解码器
+/// </summary>
+class GorillaDecoder
+{
+public:
+	/// <summary>
+	/// 构造解码器
+	/// </summary>
+	/// <param name="data">编码数据</param>
+	/// <param name="bitLength">有效位数</param>
+	/// <param name="count">数据点数量</param>
+	GorillaDecoder(const char* data, qint64 bitLength, qint32 count);
+
+	/// <summary>
+	/// 读取下一个数据点
+	/// </summary>
+	/// <param name="timestamp">输出时间戳</param>
+	/// <param name="value">输出读数</param>
+	/// <returns>没有更多数据或数据损坏时返回 false</returns>
+	bool Next(qint64& timestamp, float& value);
+
+private:
+	bool readBits(qint32 bits, quint64& value);
+
+private:
+	const char* m_data;
+	qint64 m_bitLength;
+	qint64 m_bitPos;
+
+	qint32 m_count;
+	qint32 m_index;
+	qint64 m_lastTimestamp;
+	qint64 m_lastDelta;
+	quint32 m_lastValue;
+	qint32 m_leading;
+	qint32 m_trailing;
+};
@@ -0,0 +1,79 @@
+﻿#pragma once
+
+#include <QtGlobal>
+
+/// <summary>
+/// 历史文件格式
+/// <para>文件由固定大小的块组成, 第 0 块为文件头, 之后每块为名称块或数据块</para>
+/// <para>所有字段按主机字节序 (小端) 存储, 文件可直接 mmap 读取</para>
+/// </summary>
+namespace HistoryFormat
+{
+	/// <summary>
+	/// 文件标识
+	/// </summary>
+	constexpr char Magic[8] = { 'D', 'H', 'M', 'S', 'H', 'I', 'S', 'T' };
+	/// <summary>
+	/// 格式版本
+	/// </summary>
+	constexpr quint32 Version = 1;
+	/// <summary>
+	/// 默认块大小 (字节)
+	/// </summary>
+	constexpr qint32 DefaultBlockSize = 1024;
+	/// <summary>
+	/// 最小块大小 (字节)
+	/// </summary>
+	constexpr qint32 MinBlockSize = 256;
+
+	enum class BlockType : quint8
+	{
+		Empty = 0,
+		/// <summary>
+		/// 名称块: 声明此后的数据块中 slot 对应的传感器名称与单位
+		/// <para>负载为 quint16 名称长度 + UTF-8 名称 + quint16 单位长度 + UTF-8 单位</para>
+		/// </summary>
+		Names = 1,
+		/// <summary>
+		/// 数据块: 单个传感器的 Gorilla 压缩数据点
+		/// </summary>
+		Data = 2,
+		/// <summary>
+		/// 运行开始块: 每次打开文件追加时写在所有名称块之前, 之前声明的 slot 映射全部失效
+		/// <para>firstTimestamp 为打开时间, 无负载</para>
+		/// </summary>
+		RunStart = 3
+	};
+
+#pragma pack(push, 1)
+	struct FileHeader
+	{
+		char magic[8];
+		quint32 version;
+		quint32 blockSize;
+	};
+
+	struct BlockHeader
+	{
+		quint8 type;
+		quint8 reserved;
+		/// <summary>
+		/// 数据点数量
+		/// </summary>
+		quint16 count;
+		quint32 slot;
+		qint64 firstTimestamp;
+		qint64 lastTimestamp;
+		/// <summary>
+		/// 负载有效长度 (位)
+		/// </summary>
+		quint32 bitLength;
+		/// <summary>
+		/// 整个块的 CRC32 (计算时此字段为 0) 用于识别写入不完整的块
+		/// </summary>
+		quint32 crc;
+	};
+#pragma pack(pop)
+
+	static_assert(sizeof(BlockHeader) == 32, "BlockHeader must be 32 bytes");
+}
@@ -0,0 +1,254 @@
+﻿#include "HistoryReader.h"
+#include "HistoryFormat.h"
+#include "GorillaCodec.h"
+#include <Common/Checksum.h>
+#include <QCoreApplication>
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+
+HistoryReader::HistoryReader()
+	: m_data(Q_NULLPTR)
+	, m_size(0)
+	, m_blockSize(0)
+	, m_corruptBlocks(0)
+{
+}
+
+HistoryReader::~HistoryReader()
+{
+	Close();
+}
+
+bool HistoryReader::Open(const QString& path)
+{
+	Close();
+
+	m_file.setFileName(path);
+	if (!m_file.open(QIODevice::ReadOnly))
+	{
+		m_errorString = m_file.errorString();
+		return false;
+	}
+
+	m_size = m_file.size();
+	m_data = m_size > 0 ? m_file.map(0, m_size) : Q_NULLPTR;
+	if (m_data == Q_NULLPTR)
+	{
+		m_errorString = m_size > 0 ? m_file.errorString() : QCoreApplication::translate("HistoryReader", "File is empty");
+		Close();
+		return false;
+	}
+
+	if (!buildIndex())
+	{
+		Close();
+		return false;
+	}
+
+	return true;
+}
+
+void HistoryReader::Close()
+{
+	if (m_data)
+		m_file.unmap(const_cast<uchar*>(m_data));
+
+	m_file.close();
+	m_data = Q_NULLPTR;
+	m_size = 0;
+	m_blockSize = 0;
+	m_corruptBlocks = 0;
+	m_sensors.clear();
+	m_sensorIndex.clear();
+}
+
+bool HistoryReader::IsOpen() const
+{
+	return m_data != Q_NULLPTR;
+}
+
+QString HistoryReader::ErrorString() const
+{
+	return m_errorString;
+}
+
+QStringList HistoryReader::Sensors() const
+{
+	QStringList names;
+	for (const auto& sensor : m_sensors)
+		names.append(sensor.name);
+
+	return names;
+}
+
+QString HistoryReader::Unit(const QString& name) const
+{
+	const auto index = m_sensorIndex.value(name, -1);
+	return index >= 0 ? m_sensors.at(index).unit : QString();
+}
+
+qint32 HistoryReader::CorruptBlocks() const
+{
+	return m_corruptBlocks;
+}
+
+qint32 HistoryReader::Query(const QString& name, qint64 from, qint64 to, const std::function<void(qint64 timestamp, float value)>& visitor) const
+{
+	const auto index = m_sensorIndex.value(name, -1);
+	if (index < 0 || from > to)
+		return 0;
+
+	const auto& blocks = m_sensors.at(index).blocks;
+	const auto headerSize = static_cast<qint32>(sizeof(HistoryFormat::BlockHeader));
+
+	// 块按起始时间排序 跳过在 from 之前结束的块
+	auto iter = std::lower_bound(blocks.cbegin(), blocks.cend(), from, [](const BlockIndex& block, qint64 time) {
+		return block.lastTimestamp < time;
+	});
+
+	qint32 count = 0;
+	for (; iter != blocks.cend() && iter->firstTimestamp <= to; ++iter)
+	{
+		HistoryFormat::BlockHeader header;
+		std::memcpy(&header, m_data + iter->offset, sizeof(header));
+
+		GorillaDecoder decoder(reinterpret_cast<const char*>(m_data + iter->offset + headerSize), header.bitLength, header.count);
+
+		qint64 timestamp = 0;
+		float value = 0;
+		while (decoder.Next(timestamp, value))
+		{
+			if (timestamp > to)
+				break;
+
+			if (timestamp >= from)
+			{
+				if (visitor)
+					visitor(timestamp, value);
+				count++;
+			}
+		}
+	}
+
+	return count;
+}
+
+QVector<HistorySample> HistoryReader::Query(const QString& name, qint64 from, qint64 to) const
+{
+	QVector<HistorySample> samples;
+	Query(name, from, to, [&samples](qint64 timestamp, float value) {
+		samples.append(HistorySample{ timestamp, value });
+	});
+
+	return samples;
+}
+
+bool HistoryReader::buildIndex()
+{
+	HistoryFormat::FileHeader fileHeader;
+	if (m_size < qint64(sizeof(fileHeader)))
+	{
+		m_errorString = QCoreApplication::translate("HistoryReader", "File is too small");
+		return false;
+	}
+
+	std::memcpy(&fileHeader, m_data, sizeof(fileHeader));
+	if (std::memcmp(fileHeader.magic, HistoryFormat::Magic, sizeof(fileHeader.magic)) != 0
+		|| fileHeader.version != HistoryFormat::Version
+		|| fileHeader.blockSize < quint32(HistoryFormat::MinBlockSize))
+	{
+		m_errorString = QCoreApplication::translate("HistoryReader", "Not a compatible history file");
+		return false;
+	}
+
+	m_blockSize = static_cast<qint32>(fileHeader.blockSize);
+
+	const auto headerSize = static_cast<qint32>(sizeof(HistoryFormat::BlockHeader));
+	const auto crcOffset = static_cast<qint32>(offsetof(HistoryFormat::BlockHeader, crc));
+	const auto payloadBits = qint64(m_blockSize - headerSize) * 8;
+
+	// 名称块声明的 slot -> 传感器 映射只对同一次运行中其后的数据块生效
+	// 同一文件可能由多次运行追加, 遇到运行开始块或 slot 不再递增的名称块 (运行开始块损坏时) 即清空映射
+	// 未在当前运行中声明的 slot 的数据块被丢弃
+	QHash<quint32, qint32> slotMap;
+	qint64 lastDeclared = -1;
+	QByteArray scratch(m_blockSize, '\0');
+
+	for (qint64 offset = m_blockSize; offset + m_blockSize <= m_size; offset += m_blockSize)
+	{
+		HistoryFormat::BlockHeader header;
+		std::memcpy(&header, m_data + offset, sizeof(header));
+
+		std::memcpy(scratch.data(), m_data + offset, m_blockSize);
+		std::memset(scratch.data() + crcOffset, 0, sizeof(header.crc));
+		if (static_cast<quint32>(CRC32(scratch.constData(), m_blockSize)) != header.crc || header.bitLength > payloadBits)
+		{
+			m_corruptBlocks++;
+			continue;
+		}
+
+		if (header.type == static_cast<quint8>(HistoryFormat::BlockType::RunStart))
+		{
+			slotMap.clear();
+			lastDeclared = -1;
+		}
+		else if (header.type == static_cast<quint8>(HistoryFormat::BlockType::Names))
+		{
+			auto payload = reinterpret_cast<const char*>(m_data + offset + headerSize);
+			const auto length = qint64(header.bitLength / 8);
+
+			quint16 nameLength = 0;
+			quint16 unitLength = 0;
+			std::memcpy(&nameLength, payload, sizeof(nameLength));
+			if (qint64(sizeof(nameLength)) + nameLength + qint64(sizeof(unitLength)) > length)
+			{
+				m_corruptBlocks++;
+				continue;
+			}
+			std::memcpy(&unitLength, payload + sizeof(nameLength) + nameLength, sizeof(unitLength));
+			if (qint64(sizeof(nameLength)) + nameLength + qint64(sizeof(unitLength)) + unitLength > length)
+			{
+				m_corruptBlocks++;
+				continue;
+			}
+
+			const auto name = QString::fromUtf8(payload + sizeof(nameLength), nameLength);
+			const auto unit = QString::fromUtf8(payload + sizeof(nameLength) + nameLength + sizeof(unitLength), unitLength);
+
+			auto index = m_sensorIndex.value(name, -1);
+			if (index < 0)
+			{
+				index = m_sensors.count();
+				m_sensors.append(Sensor{ name, unit, QVector<BlockIndex>() });
+				m_sensorIndex.insert(name, index);
+			}
+
+			// 一次运行中名称块按 slot 递增写入
+			if (qint64(header.slot) <= lastDeclared)
+				slotMap.clear();
+
+			slotMap.insert(header.slot, index);
+			lastDeclared = header.slot;
+		}
+		else if (header.type == static_cast<quint8>(HistoryFormat::BlockType::Data))
+		{
+			// 名称块损坏时无法确定数据属于哪个传感器
+			const auto index = slotMap.value(header.slot, -1);
+			if (index >= 0)
+				m_sensors[index].blocks.append(BlockIndex{ header.firstTimestamp, header.lastTimestamp, offset });
+			else
+				m_corruptBlocks++;
+		}
+	}
+
+	// 同一文件可能由多次运行追加 按时间排序
+	for (auto& sensor : m_sensors)
+	{
+		std::stable_sort(sensor.blocks.begin(), sensor.blocks.end(), [](const BlockIndex& a, const BlockIndex& b) {
+			return a.firstTimestamp < b.firstTimestamp;
+		});
+	}
+
+	return true;
+}
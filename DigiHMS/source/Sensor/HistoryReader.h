@@ -0,0 +1,105 @@
+﻿#pragma once
+
+#include <QFile>
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <functional>
+
+/// <summary>
+/// 历史数据点
+/// </summary>
+struct HistorySample
+{
+	qint64 timestamp;
+	float value;
+};
+
+/// <summary>
+/// 历史文件读取器
+/// <para>通过 mmap 映射文件, 打开时建立每个传感器的块索引, 查询时只解码与时间范围重叠的块</para>
+/// <para>读取的是打开时刻的文件内容, 可与写入器同时使用</para>
+/// </summary>
+class HistoryReader
+{
+public:
+	HistoryReader();
+	~HistoryReader();
+
+	/// <summary>
+	/// 打开历史文件
+	/// </summary>
+	/// <param name="path">文件路径</param>
+	/// <returns>是否成功</returns>
+	bool Open(const QString& path);
+	void Close();
+	bool IsOpen() const;
+	QString ErrorString() const;
+
+	/// <summary>
+	/// 获取文件中记录的所有传感器名称
+	/// </summary>
+	/// <returns>传感器名称</returns>
+	QStringList Sensors() const;
+	/// <summary>
+	/// 获取传感器单位
+	/// </summary>
+	/// <param name="name">传感器名称</param>
+	/// <returns>单位</returns>
+	QString Unit(const QString& name) const;
+	/// <summary>
+	/// 获取 CRC 校验失败, 或所属传感器未在本次运行中声明而被忽略的块数量
+	/// </summary>
+	/// <returns>块数量</returns>
+	qint32 CorruptBlocks() const;
+
+	/// <summary>
+	/// 按时间顺序遍历时间范围 [from, to] 内的数据点
+	/// </summary>
+	/// <param name="name">传感器名称</param>
+	/// <param name="from">起始时间 (毫秒, 包含)</param>
+	/// <param name="to">结束时间 (毫秒, 包含)</param>
+	/// <param name="visitor">回调</param>
+	/// <returns>数据点数量</returns>
+	qint32 Query(const QString& name, qint64 from, qint64 to, const std::function<void(qint64 timestamp, float value)>& visitor) const;
+	/// <summary>
+	/// 查询时间范围 [from, to] 内的数据点
+	/// </summary>
+	/// <param name="name">传感器名称</param>
+	/// <param name="from">起始时间 (毫秒, 包含)</param>
+	/// <param name="to">结束时间 (毫秒, 包含)</param>
+	/// <returns>数据点</returns>
+	QVector<HistorySample> Query(const QString& name, qint64 from, qint64 to) const;
+
+private:
+	/// <summary>
+	/// 数据块索引
+	/// </summary>
+	struct BlockIndex
+	{
+		qint64 firstTimestamp;
+		qint64 lastTimestamp;
+		qint64 offset;
+	};
+
+	struct Sensor
+	{
+		QString name;
+		QString unit;
+		QVector<BlockIndex> blocks;
+	};
+
+	bool buildIndex();
+
+private:
+	QFile m_file;
+	const uchar* m_data;
+	qint64 m_size;
+	qint32 m_blockSize;
+	QString m_errorString;
+	qint32 m_corruptBlocks;
+
+	QVector<Sensor> m_sensors;
+	QHash<QString, qint32> m_sensorIndex;
+};
@@ -0,0 +1,312 @@
+﻿#include "HistoryWriter.h"
+#include "SensorSnapshot.h"
+#include <Common/Checksum.h>
+#include <QDateTime>
+#include <QTimer>
+#include <QtMath>
+#include <cstddef>
+#include <cstring>
+
+#ifdef Q_OS_WIN
+#include <io.h>
+#include <Windows.h>
+#else
+#include <unistd.h>
+#endif
+
+HistoryWriter::HistoryWriter(const HistoryWriterConfig& config, QObject* parent)
+	: QObject(parent)
+	, m_config(config)
+	, m_timer(Q_NULLPTR)
+	, m_blocksWritten(0)
+{
+	m_config.blockSize = qMax(m_config.blockSize, HistoryFormat::MinBlockSize);
+
+	m_thread.setObjectName("HistoryWriter");
+
+	m_timer = new QTimer();
+	m_timer->moveToThread(&m_thread);
+	connect(m_timer, &QTimer::timeout, m_timer, [this]() {
+		flush();
+	});
+}
+
+HistoryWriter::~HistoryWriter()
+{
+	Close();
+	delete m_timer;
+}
+
+bool HistoryWriter::Open()
+{
+	if (m_file.isOpen())
+		return true;
+
+	m_file.setFileName(m_config.path);
+	if (!m_file.open(QIODevice::ReadWrite))
+	{
+		m_errorString = m_file.errorString();
+		return false;
+	}
+
+	const auto blockSize = m_config.blockSize;
+
+	if (m_file.size() == 0)
+	{
+		QByteArray header(blockSize, '\0');
+		HistoryFormat::FileHeader fileHeader;
+		std::memcpy(fileHeader.magic, HistoryFormat::Magic, sizeof(fileHeader.magic));
+		fileHeader.version = HistoryFormat::Version;
+		fileHeader.blockSize = blockSize;
+		std::memcpy(header.data(), &fileHeader, sizeof(fileHeader));
+
+		if (m_file.write(header) != blockSize || !sync())
+		{
+			m_errorString = m_file.errorString();
+			m_file.close();
+			return false;
+		}
+	}
+	else
+	{
+		HistoryFormat::FileHeader fileHeader;
+		if (m_file.read(reinterpret_cast<char*>(&fileHeader), sizeof(fileHeader)) != sizeof(fileHeader)
+			|| std::memcmp(fileHeader.magic, HistoryFormat::Magic, sizeof(fileHeader.magic)) != 0
+			|| fileHeader.version != HistoryFormat::Version
+			|| fileHeader.blockSize != quint32(blockSize))
+		{
+			m_errorString = tr("\"%1\" is not a compatible history file").arg(m_config.path);
+			m_file.close();
+			return false;
+		}
+
+		// 丢弃上次异常退出时写了一半的块
+		m_file.resize(m_file.size() / blockSize * blockSize);
+	}
+
+	m_file.seek(m_file.size());
+	m_streams.clear();
+
+	// 标记新的运行 读取时不会把本次的数据块归入上次运行声明的传感器
+	auto runStart = takeBlock();
+	runStart.fill('\0');
+	HistoryFormat::BlockHeader header = {};
+	header.type = static_cast<quint8>(HistoryFormat::BlockType::RunStart);
+	header.firstTimestamp = QDateTime::currentMSecsSinceEpoch();
+	header.lastTimestamp = header.firstTimestamp;
+	std::memcpy(runStart.data(), &header, sizeof(header));
+	enqueue(runStart);
+
+	m_thread.start();
+	QMetaObject::invokeMethod(m_timer, [this]() {
+		m_timer->start(m_config.flushInterval);
+	}, Qt::QueuedConnection);
+
+	return true;
+}
+
+void HistoryWriter::Close()
+{
+	if (!m_file.isOpen())
+		return;
+
+	if (m_thread.isRunning())
+	{
+		QMetaObject::invokeMethod(m_timer, [this]() {
+			m_timer->stop();
+		}, Qt::BlockingQueuedConnection);
+
+		m_thread.quit();
+		m_thread.wait();
+	}
+
+	for (auto slot = 0; slot < static_cast<qint32>(m_streams.size()); ++slot)
+		seal(slot);
+
+	flush();
+	m_file.close();
+	m_streams.clear();
+}
+
+bool HistoryWriter::IsOpen() const
+{
+	return m_file.isOpen();
+}
+
+QString HistoryWriter::ErrorString() const
+{
+	return m_errorString;
+}
+
+quint64 HistoryWriter::BlocksWritten() const
+{
+	return m_blocksWritten;
+}
+
+void HistoryWriter::OnSnapshot(const SensorSnapshot& snapshot)
+{
+	if (!m_file.isOpen())
+		return;
+
+	const auto count = snapshot.Count();
+	const auto values = snapshot.Values();
+	const auto timestamp = snapshot.Timestamp();
+
+	// 新的传感器: 先写名称块 再写数据块
+	while (static_cast<qint32>(m_streams.size()) < count)
+		declare(snapshot, static_cast<qint32>(m_streams.size()));
+
+	for (auto slot = 0; slot < count; ++slot)
+	{
+		if (qIsNaN(values[slot]))
+			continue;
+
+		auto& stream = m_streams[slot];
+
+		if (stream.encoder.Count() > 0 && timestamp - stream.encoder.FirstTimestamp() >= m_config.maxBlockSpan)
+			seal(slot);
+
+		if (!stream.encoder.Append(timestamp, values[slot]))
+		{
+			seal(slot);
+			stream.encoder.Append(timestamp, values[slot]);
+		}
+	}
+}
+
+void HistoryWriter::declare(const SensorSnapshot& snapshot, qint32 slot)
+{
+	const auto& info = snapshot.Info(slot);
+	const auto name = info.name.toUtf8();
+	const auto unit = info.unit.toUtf8();
+	const auto headerSize = static_cast<qint32>(sizeof(HistoryFormat::BlockHeader));
+
+	auto block = takeBlock();
+	block.fill('\0');
+	auto data = block.data();
+
+	HistoryFormat::BlockHeader header = {};
+	header.type = static_cast<quint8>(HistoryFormat::BlockType::Names);
+	header.slot = slot;
+
+	// 名称过长时截断
+	const auto room = m_config.blockSize - headerSize - 2 * qint32(sizeof(quint16));
+	const quint16 nameLength = static_cast<quint16>(qMin(name.size(), room));
+	const quint16 unitLength = static_cast<quint16>(qMin(unit.size(), room - nameLength));
+
+	auto offset = headerSize;
+	std::memcpy(data + offset, &nameLength, sizeof(nameLength));
+	offset += sizeof(nameLength);
+	std::memcpy(data + offset, name.constData(), nameLength);
+	offset += nameLength;
+	std::memcpy(data + offset, &unitLength, sizeof(unitLength));
+	offset += sizeof(unitLength);
+	std::memcpy(data + offset, unit.constData(), unitLength);
+	offset += unitLength;
+
+	header.bitLength = quint32(offset - headerSize) * 8;
+	std::memcpy(data, &header, sizeof(header));
+	enqueue(block);
+
+	Stream stream;
+	stream.block = takeBlock();
+	stream.encoder.Reset(stream.block.data() + headerSize, m_config.blockSize - headerSize);
+	m_streams.push_back(std::move(stream));
+}
+
+void HistoryWriter::seal(qint32 slot)
+{
+	auto& stream = m_streams[slot];
+	if (stream.encoder.Count() == 0)
+		return;
+
+	const auto headerSize = static_cast<qint32>(sizeof(HistoryFormat::BlockHeader));
+
+	HistoryFormat::BlockHeader header = {};
+	header.type = static_cast<quint8>(HistoryFormat::BlockType::Data);
+	header.count = static_cast<quint16>(stream.encoder.Count());
+	header.slot = slot;
+	header.firstTimestamp = stream.encoder.FirstTimestamp();
+	header.lastTimestamp = stream.encoder.LastTimestamp();
+	header.bitLength = static_cast<quint32>(stream.encoder.BitLength());
+	std::memcpy(stream.block.data(), &header, sizeof(header));
+
+	enqueue(stream.block);
+
+	stream.block = takeBlock();
+	stream.encoder.Reset(stream.block.data() + headerSize, m_config.blockSize - headerSize);
+}
+
+void HistoryWriter::enqueue(QByteArray& block)
+{
+	QMutexLocker lock(&m_mutex);
+	m_pending.append(std::move(block));
+}
+
+QByteArray HistoryWriter::takeBlock()
+{
+	{
+		QMutexLocker lock(&m_mutex);
+		if (!m_free.isEmpty())
+		{
+			auto block = std::move(m_free.last());
+			m_free.removeLast();
+			return block;
+		}
+	}
+
+	// 块缓冲区循环使用 只在池为空时分配
+	return QByteArray(m_config.blockSize, '\0');
+}
+
+void HistoryWriter::flush()
+{
+	QVector<QByteArray> pending;
+	{
+		QMutexLocker lock(&m_mutex);
+		pending.swap(m_pending);
+	}
+
+	if (pending.isEmpty())
+		return;
+
+	const auto crcOffset = static_cast<qint32>(offsetof(HistoryFormat::BlockHeader, crc));
+	auto failed = false;
+
+	for (auto& block : pending)
+	{
+		const quint32 zero = 0;
+		std::memcpy(block.data() + crcOffset, &zero, sizeof(zero));
+		const auto crc = static_cast<quint32>(CRC32(block.constData(), block.size()));
+		std::memcpy(block.data() + crcOffset, &crc, sizeof(crc));
+
+		if (!failed && m_file.write(block) != block.size())
+			failed = true;
+	}
+
+	if (failed || !sync())
+	{
+		emit errorOccurred(m_file.errorString());
+	}
+	else
+	{
+		m_blocksWritten += pending.count();
+	}
+
+	// 归还缓冲区
+	QMutexLocker lock(&m_mutex);
+	for (auto& block : pending)
+		m_free.append(std::move(block));
+}
+
+bool HistoryWriter::sync()
+{
+	if (!m_file.flush())
+		return false;
+
+#ifdef Q_OS_WIN
+	return FlushFileBuffers(reinterpret_cast<HANDLE>(_get_osfhandle(m_file.handle()))) != 0;
+#else
+	return ::fsync(m_file.handle()) == 0;
+#endif
+}
@@ -0,0 +1,124 @@
+﻿#pragma once
+
+#include <QObject>
+#include <QThread>
+#include <QMutex>
+#include <QFile>
+#include <QVector>
+#include <QByteArray>
+#include <atomic>
+#include <vector>
+#include "SensorSource.h"
+#include "GorillaCodec.h"
+#include "HistoryFormat.h"
+
+class QTimer;
+
+/// <summary>
+/// 历史文件写入配置
+/// </summary>
+struct HistoryWriterConfig
+{
+	/// <summary>
+	/// 文件路径 (已存在时追加)
+	/// </summary>
+	QString path;
+	/// <summary>
+	/// 块大小 (字节)
+	/// </summary>
+	qint32 blockSize = HistoryFormat::DefaultBlockSize;
+	/// <summary>
+	/// 写入并 fsync 的周期 (毫秒)
+	/// </summary>
+	qint32 flushInterval = 5000;
+	/// <summary>
+	/// 单个数据块覆盖的最长时间 (毫秒) 超过后提前封闭
+	/// <para>决定异常退出时最多丢失多少数据</para>
+	/// </summary>
+	qint64 maxBlockSpan = 10 * 60 * 1000;
+};
+
+/// <summary>
+/// 压缩的持久化传感器历史写入器
+/// <para>在采样线程中将读数编码到每个传感器的当前块中 (不涉及 IO)</para>
+/// <para>写满或超时的块交给写入线程, 由其按 flushInterval 批量写入并 fsync</para>
+/// </summary>
+class HistoryWriter : public QObject, public SensorConsumer
+{
+	Q_OBJECT
+
+public:
+	explicit HistoryWriter(const HistoryWriterConfig& config, QObject* parent = Q_NULLPTR);
+	virtual ~HistoryWriter();
+
+	/// <summary>
+	/// 打开历史文件并启动写入线程
+	/// </summary>
+	/// <returns>是否成功</returns>
+	bool Open();
+	/// <summary>
+	/// 封闭所有未写满的块, 写入并关闭文件
+	/// <para>调用前需先将写入器从采样器中移除</para>
+	/// </summary>
+	void Close();
+	bool IsOpen() const;
+	QString ErrorString() const;
+
+	/// <summary>
+	/// 获取已写入的块数量
+	/// </summary>
+	/// <returns>块数量</returns>
+	quint64 BlocksWritten() const;
+
+	/**
+	 * SensorConsumer 接口
+	 */
+public:
+	void OnSnapshot(const SensorSnapshot& snapshot) override;
+
+signals:
+	/// <summary>
+	/// 写入失败 (从写入线程发出)
+	/// </summary>
+	/// <param name="message">错误信息</param>
+	void errorOccurred(const QString& message);
+
+private:
+	/// <summary>
+	/// 单个传感器的当前块
+	/// </summary>
+	struct Stream
+	{
+		QByteArray block;
+		GorillaEncoder encoder;
+	};
+
+	void declare(const SensorSnapshot& snapshot, qint32 slot);
+	void seal(qint32 slot);
+	void enqueue(QByteArray& block);
+	QByteArray takeBlock();
+	void flush();
+	bool sync();
+
+private:
+	HistoryWriterConfig m_config;
+	QFile m_file;
+	QString m_errorString;
+
+	QThread m_thread;
+	QTimer* m_timer;
+
+	/// <summary>
+	/// 仅在采样线程中访问
+	/// </summary>
+	std::vector<Stream> m_streams;
+
+	/// <summary>
+	/// 保护待写入与空闲块列表
+	/// </summary>
+	QMutex m_mutex;
+	QVector<QByteArray> m_pending;
+	QVector<QByteArray> m_free;
+
+	std::atomic<quint64> m_blocksWritten;
+};
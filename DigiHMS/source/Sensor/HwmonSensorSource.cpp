@@ -0,0 +1,244 @@
+﻿#include "HwmonSensorSource.h"
+#include "SensorSnapshot.h"
+#include <QDir>
+#include <QFile>
+#include <QRegularExpression>
+#include <QSet>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+
+namespace
+{
+	/// <summary>
+	/// hwmon 通道类型 sysfs 中的单位与快照单位的换算
+	/// </summary>
+	struct ChannelType
+	{
+		const char* prefix;
+		const char* unit;
+		float scale;
+	};
+
+	const ChannelType ChannelTypes[] = {
+		{ "temp", "°C", 0.001f },
+		{ "fan", "RPM", 1.0f },
+		{ "in", "V", 0.001f },
+		{ "power", "W", 0.000001f },
+		{ "curr", "A", 0.001f },
+	};
+
+	/// <summary>
+	/// 作为 cpu.temp 的通道 (Intel coretemp / AMD k10temp)
+	/// </summary>
+	bool isCpuPackage(const QString& chip, const QString& label)
+	{
+		return (chip == "coretemp" && label == "Package id 0")
+			|| (chip == "k10temp" && (label == "Tctl" || label == "Tdie"));
+	}
+
+	QString readLine(const QString& path)
+	{
+		QFile file(path);
+		if (!file.open(QIODevice::ReadOnly))
+			return QString();
+
+		return QString::fromUtf8(file.readLine()).trimmed();
+	}
+
+	/// <summary>
+	/// 在 procfs 文本中查找字段后的整数 (例如 "MemTotal:")
+	/// </summary>
+	bool findField(const char* text, const char* field, quint64* value)
+	{
+		const auto position = std::strstr(text, field);
+		if (position == Q_NULLPTR)
+			return false;
+
+		*value = std::strtoull(position + std::strlen(field), Q_NULLPTR, 10);
+		return true;
+	}
+}
+
+HwmonSensorSource::HwmonSensorSource(const QString& hwmonRoot, const QString& procRoot, BatchFileReader::Backend backend)
+	: m_hwmonRoot(hwmonRoot)
+	, m_procRoot(procRoot)
+	, m_preferred(backend)
+	, m_scanned(false)
+	, m_statFile(-1)
+	, m_meminfoFile(-1)
+	, m_cpuLoad(-1)
+	, m_memoryLoad(-1)
+	, m_memoryUsed(-1)
+	, m_memoryAvailable(-1)
+	, m_lastIdle(0)
+	, m_lastTotal(0)
+{
+}
+
+qint32 HwmonSensorSource::ChannelCount() const
+{
+	return static_cast<qint32>(m_channels.count());
+}
+
+BatchFileReader::Backend HwmonSensorSource::Backend() const
+{
+	return m_reader.CurrentBackend();
+}
+
+quint64 HwmonSensorSource::Syscalls() const
+{
+	return m_reader.Syscalls();
+}
+
+QString HwmonSensorSource::Name() const
+{
+	return "hwmon";
+}
+
+bool HwmonSensorSource::Update(SensorSnapshot& snapshot)
+{
+	if (!m_scanned)
+		scan(snapshot);
+
+	// 所有通道一次读取
+	if (!m_reader.Read())
+		return false;
+
+	const auto nan = std::numeric_limits<float>::quiet_NaN();
+	for (const auto& channel : m_channels)
+	{
+		if (m_reader.Length(channel.file) <= 0)
+		{
+			snapshot.SetValue(channel.slot, nan);
+			continue;
+		}
+
+		const auto data = m_reader.Data(channel.file);
+		char* end = Q_NULLPTR;
+		const auto value = std::strtoll(data, &end, 10);
+		snapshot.SetValue(channel.slot, end == data ? nan : value * channel.scale);
+	}
+
+	if (m_statFile >= 0)
+		updateCpuLoad(snapshot);
+	if (m_meminfoFile >= 0)
+		updateMemory(snapshot);
+
+	return true;
+}
+
+void HwmonSensorSource::scan(SensorSnapshot& snapshot)
+{
+	m_scanned = true;
+
+	static const QRegularExpression inputPattern("^(temp|fan|in|power|curr)(\\d+)_input$");
+
+	QSet<QString> chips;
+	bool hasCpuTemp = false;
+	const QDir root(m_hwmonRoot);
+	for (const auto& entry : root.entryList({ "hwmon*" }, QDir::Dirs | QDir::NoDotAndDotDot, QDir::Name))
+	{
+		const QDir device(root.filePath(entry));
+
+		// 同名芯片 (例如多块 NVMe) 使用 hwmon 序号区分
+		auto chip = readLine(device.filePath("name"));
+		if (chip.isEmpty())
+			chip = entry;
+		const auto deviceName = chips.contains(chip) ? chip + "." + entry : chip;
+		chips.insert(chip);
+
+		for (const auto& input : device.entryList({ "*_input" }, QDir::Files, QDir::Name))
+		{
+			const auto match = inputPattern.match(input);
+			if (!match.hasMatch())
+				continue;
+
+			const auto prefix = match.captured(1) + match.captured(2);
+			auto label = readLine(device.filePath(prefix + "_label"));
+			if (label.isEmpty())
+				label = prefix;
+
+			for (const auto& type : ChannelTypes)
+			{
+				if (match.captured(1) != QLatin1String(type.prefix))
+					continue;
+
+				const auto unit = QString::fromUtf8(type.unit);
+				const auto file = m_reader.Add(device.filePath(input));
+				m_channels.append(Channel{ file, snapshot.AddSensor("hwmon." + deviceName + "." + label, unit), type.scale });
+
+				// 与 LibreHardwareMonitor 的 cpu.temp 对应 (托盘与告警默认使用)
+				if (!hasCpuTemp && isCpuPackage(chip, label))
+				{
+					m_channels.append(Channel{ file, snapshot.AddSensor("cpu.temp", unit), type.scale });
+					hasCpuTemp = true;
+				}
+			}
+		}
+	}
+
+	if (!m_procRoot.isEmpty())
+	{
+		// 只需要 /proc/stat 第一行与 /proc/meminfo 前三行
+		m_statFile = m_reader.Add(m_procRoot + "/stat", 256);
+		m_meminfoFile = m_reader.Add(m_procRoot + "/meminfo", 256);
+		m_cpuLoad = snapshot.AddSensor("cpu.load", "%");
+		m_memoryLoad = snapshot.AddSensor("memory.load", "%");
+		m_memoryUsed = snapshot.AddSensor("memory.used", "GB");
+		m_memoryAvailable = snapshot.AddSensor("memory.available", "GB");
+	}
+
+	m_reader.Open(m_preferred);
+}
+
+void HwmonSensorSource::updateCpuLoad(SensorSnapshot& snapshot)
+{
+	const auto data = m_reader.Data(m_statFile);
+	if (m_reader.Length(m_statFile) <= 0 || std::strncmp(data, "cpu ", 4) != 0)
+		return;
+
+	// user nice system idle iowait irq softirq steal
+	quint64 fields[8] = {};
+	auto position = data + 4;
+	for (auto& field : fields)
+	{
+		char* end = Q_NULLPTR;
+		field = std::strtoull(position, &end, 10);
+		position = end;
+	}
+
+	quint64 total = 0;
+	for (auto field : fields)
+		total += field;
+	const auto idle = fields[3] + fields[4];
+
+	// 首次采样没有上一次的计数
+	if (m_lastTotal > 0 && total > m_lastTotal)
+	{
+		const auto busy = 1.0 - static_cast<double>(idle - m_lastIdle) / (total - m_lastTotal);
+		snapshot.SetValue(m_cpuLoad, static_cast<float>(qBound(0.0, busy * 100.0, 100.0)));
+	}
+
+	m_lastIdle = idle;
+	m_lastTotal = total;
+}
+
+void HwmonSensorSource::updateMemory(SensorSnapshot& snapshot)
+{
+	if (m_reader.Length(m_meminfoFile) <= 0)
+		return;
+
+	// 单位为 kB
+	const auto data = m_reader.Data(m_meminfoFile);
+	quint64 total = 0;
+	quint64 available = 0;
+	if (!findField(data, "MemTotal:", &total) || !findField(data, "MemAvailable:", &available) || total == 0)
+		return;
+
+	const auto used = total - qMin(available, total);
+	const auto kbPerGb = 1024.0f * 1024.0f;
+	snapshot.SetValue(m_memoryLoad, used * 100.0f / total);
+	snapshot.SetValue(m_memoryUsed, used / kbPerGb);
+	snapshot.SetValue(m_memoryAvailable, available / kbPerGb);
+}
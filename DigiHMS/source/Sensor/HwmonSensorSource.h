@@ -0,0 +1,81 @@
+﻿#pragma once
+
+#include "SensorSource.h"
+#include "BatchFileReader.h"
+#include <QVector>
+
+/// <summary>
+/// 基于 Linux hwmon 与 procfs 的传感器数据源
+/// <para>首次 Update 时扫描 /sys/class/hwmon 下所有 temp / fan / in / power / curr 通道并注册槽位</para>
+/// <para>之后每次采样通过 BatchFileReader 一次读取所有通道与 /proc/stat, /proc/meminfo</para>
+/// <para>传感器名称为 hwmon.芯片名称.通道标签, 另外提供与 LibreHardwareMonitor 相同名称的 cpu.temp, cpu.load 与 memory.*</para>
+/// </summary>
+class HwmonSensorSource : public SensorSource
+{
+public:
+	/// <summary>
+	/// 构造数据源
+	/// </summary>
+	/// <param name="hwmonRoot">hwmon 目录</param>
+	/// <param name="procRoot">procfs 目录 为空时不读取 CPU 负载与内存</param>
+	/// <param name="backend">首选读取方式</param>
+	explicit HwmonSensorSource(const QString& hwmonRoot = "/sys/class/hwmon",
+		const QString& procRoot = "/proc",
+		BatchFileReader::Backend backend = BatchFileReader::Backend::IoUring);
+
+	/// <summary>
+	/// 已注册的 hwmon 通道数量
+	/// </summary>
+	/// <returns>通道数量</returns>
+	qint32 ChannelCount() const;
+	/// <summary>
+	/// 实际使用的读取方式
+	/// </summary>
+	/// <returns>读取方式</returns>
+	BatchFileReader::Backend Backend() const;
+	/// <summary>
+	/// 采样累计的系统调用次数
+	/// </summary>
+	/// <returns>系统调用次数</returns>
+	quint64 Syscalls() const;
+
+	/**
+	 * SensorSource 接口
+	 */
+public:
+	QString Name() const override;
+	bool Update(SensorSnapshot& snapshot) override;
+
+private:
+	/// <summary>
+	/// 一个 hwmon 通道 (读数 * scale 为快照中的值)
+	/// </summary>
+	struct Channel
+	{
+		qint32 file;
+		qint32 slot;
+		float scale;
+	};
+
+	void scan(SensorSnapshot& snapshot);
+	void updateCpuLoad(SensorSnapshot& snapshot);
+	void updateMemory(SensorSnapshot& snapshot);
+
+private:
+	QString m_hwmonRoot;
+	QString m_procRoot;
+	BatchFileReader::Backend m_preferred;
+	BatchFileReader m_reader;
+	bool m_scanned;
+
+	QVector<Channel> m_channels;
+
+	qint32 m_statFile;
+	qint32 m_meminfoFile;
+	qint32 m_cpuLoad;
+	qint32 m_memoryLoad;
+	qint32 m_memoryUsed;
+	qint32 m_memoryAvailable;
+	quint64 m_lastIdle;
+	quint64 m_lastTotal;
+};
@@ -0,0 +1,145 @@
+﻿#include "LhmSensorSource.h"
+#include "SensorSnapshot.h"
+#include <LibreHardwareMonitorApi.h>
+#include <algorithm>
+#include <limits>
+
+LhmSensorSource::LhmSensorSource()
+	: m_registered(false)
+{
+	m_monitor = LibreHardwareMonitorApi::CreateInstance();
+
+	std::fill(std::begin(m_fixed), std::end(m_fixed), -1);
+
+	m_cpuTemps = SlotCache{ "cpu.temp.", QString::fromUtf8("°C") };
+	m_cpuLoads = SlotCache{ "cpu.load.", "%" };
+	m_mainboardFans = SlotCache{ "mainboard.fan.", "RPM" };
+	m_storageTemps = SlotCache{ "storage.temp.", QString::fromUtf8("°C") };
+	m_storageReads = SlotCache{ "storage.read.", "B/s" };
+	m_storageWrites = SlotCache{ "storage.write.", "B/s" };
+	m_networkUploads = SlotCache{ "network.upload.", "B/s" };
+	m_networkDownloads = SlotCache{ "network.download.", "B/s" };
+}
+
+LhmSensorSource::~LhmSensorSource()
+{
+
+}
+
+std::shared_ptr<LibreHardwareMonitorApi::ILibreHardwareMonitor> LhmSensorSource::Monitor() const
+{
+	return m_monitor;
+}
+
+QString LhmSensorSource::Name() const
+{
+	return "LibreHardwareMonitor";
+}
+
+bool LhmSensorSource::Update(SensorSnapshot& snapshot)
+{
+	if (!m_monitor)
+		return false;
+
+	if (!m_registered)
+	{
+		const QString celsius = QString::fromUtf8("°C");
+
+		m_fixed[CpuLoad] = snapshot.AddSensor("cpu.load", "%");
+		m_fixed[CpuTemp] = snapshot.AddSensor("cpu.temp", celsius);
+		m_fixed[CpuPower] = snapshot.AddSensor("cpu.power", "W");
+		m_fixed[CpuClock] = snapshot.AddSensor("cpu.clock", "MHz");
+		m_fixed[MainboardTemp] = snapshot.AddSensor("mainboard.temp", celsius);
+		m_fixed[MemoryLoad] = snapshot.AddSensor("memory.load", "%");
+		m_fixed[MemoryUsed] = snapshot.AddSensor("memory.used", "GB");
+		m_fixed[MemoryAvailable] = snapshot.AddSensor("memory.available", "GB");
+		m_fixed[GpuTemp] = snapshot.AddSensor("gpu.temp", celsius);
+		m_fixed[GpuPower] = snapshot.AddSensor("gpu.power", "W");
+		m_fixed[GpuLoad] = snapshot.AddSensor("gpu.load", "%");
+		m_fixed[GpuFan] = snapshot.AddSensor("gpu.fan", "RPM");
+		m_registered = true;
+	}
+
+	m_monitor->GetHardwareInfo();
+
+	setValue(snapshot, m_fixed[CpuLoad], m_monitor->GetCpuLoad());
+	setValue(snapshot, m_fixed[CpuTemp], m_monitor->GetCpuTemperature());
+	setValue(snapshot, m_fixed[CpuPower], m_monitor->GetCpuPower());
+	setValue(snapshot, m_fixed[CpuClock], m_monitor->GetCpuClock());
+	setValue(snapshot, m_fixed[MainboardTemp], m_monitor->GetMainboardTemperature());
+	setValue(snapshot, m_fixed[MemoryLoad], m_monitor->GetMemoryLoad());
+	setValue(snapshot, m_fixed[MemoryUsed], m_monitor->GetMemoryUsed());
+	setValue(snapshot, m_fixed[MemoryAvailable], m_monitor->GetMemoryAvailable());
+	setValue(snapshot, m_fixed[GpuTemp], m_monitor->GetGpuTemperature());
+	setValue(snapshot, m_fixed[GpuPower], m_monitor->GetGpuPower());
+	setValue(snapshot, m_fixed[GpuLoad], m_monitor->GetGpuLoad());
+	setValue(snapshot, m_fixed[GpuFan], m_monitor->GetGpuFanSpeed());
+
+	updateMap(snapshot, m_cpuTemps, m_monitor->GetAllCpuTemperature());
+	updateMap(snapshot, m_cpuLoads, m_monitor->GetAllCpuLoad());
+	updateMap(snapshot, m_mainboardFans, m_monitor->GetMainboardFanSpeed());
+	updateMap(snapshot, m_storageTemps, m_monitor->GetAllStorageTemperature());
+
+	// 存储为 (读取, 写入) 网络为 (上传, 下载)
+	for (const auto& storage : m_monitor->GetAllStorageReadWriteSpeed())
+	{
+		setValue(snapshot, slotOf(snapshot, m_storageReads, storage.first), storage.second.first);
+		setValue(snapshot, slotOf(snapshot, m_storageWrites, storage.first), storage.second.second);
+	}
+
+	for (const auto& network : m_monitor->GetAllNetworkSpeed())
+	{
+		setValue(snapshot, slotOf(snapshot, m_networkUploads, network.first), network.second.first);
+		setValue(snapshot, slotOf(snapshot, m_networkDownloads, network.first), network.second.second);
+	}
+
+	return true;
+}
+
+void LhmSensorSource::updateMap(SensorSnapshot& snapshot, SlotCache& cache, const std::map<std::wstring, float>& values)
+{
+	for (const auto& value : values)
+		setValue(snapshot, slotOf(snapshot, cache, value.first), value.second);
+}
+
+qint32 LhmSensorSource::slotOf(SensorSnapshot& snapshot, SlotCache& cache, const std::wstring& name)
+{
+	// 只有首次出现的传感器需要构造名称字符串
+	auto iter = cache.slotMap.find(name);
+	if (iter != cache.slotMap.end())
+		return iter->second;
+
+	const auto slot = snapshot.AddSensor(cache.prefix + QString::fromStdWString(name), cache.unit);
+	cache.slotMap.emplace(name, slot);
+	return slot;
+}
+
+void LhmSensorSource::setValue(SensorSnapshot& snapshot, qint32 slot, float value)
+{
+	snapshot.SetValue(slot, value < 0 ? std::numeric_limits<float>::quiet_NaN() : value);
+}
+
+LhmFanBackend::LhmFanBackend(const std::shared_ptr<LibreHardwareMonitorApi::ILibreHardwareMonitor>& monitor)
+	: m_monitor(monitor)
+{
+
+}
+
+qint32 LhmFanBackend::Resolve(const QString& control)
+{
+	if (!m_monitor)
+		return -1;
+
+	return m_monitor->FindFanControl(control.toStdWString());
+}
+
+bool LhmFanBackend::Write(qint32 handle, float percent)
+{
+	return m_monitor && m_monitor->SetFanSpeed(handle, percent);
+}
+
+void LhmFanBackend::Restore(qint32 handle)
+{
+	if (m_monitor)
+		m_monitor->SetFanSpeed(handle, -1);
+}
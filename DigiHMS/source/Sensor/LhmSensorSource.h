@@ -0,0 +1,106 @@
+﻿#pragma once
+
+#include "SensorSource.h"
+#include "FanControl.h"
+#include <map>
+#include <memory>
+#include <string>
+
+namespace LibreHardwareMonitorApi
+{
+	class ILibreHardwareMonitor;
+}
+
+/// <summary>
+/// 基于 LibreHardwareMonitor 的传感器数据源 (仅 Windows)
+/// <para>LibreHardwareMonitor 使用负数表示没有读数, 写入快照时转换为 NaN</para>
+/// </summary>
+class LhmSensorSource : public SensorSource
+{
+public:
+	LhmSensorSource();
+	virtual ~LhmSensorSource();
+
+	/// <summary>
+	/// 获取 LibreHardwareMonitor 实例 (创建失败时为空)
+	/// </summary>
+	/// <returns>LibreHardwareMonitor 实例</returns>
+	std::shared_ptr<LibreHardwareMonitorApi::ILibreHardwareMonitor> Monitor() const;
+
+	/**
+	 * SensorSource 接口
+	 */
+public:
+	QString Name() const override;
+	bool Update(SensorSnapshot& snapshot) override;
+
+private:
+	/// <summary>
+	/// 按名称缓存槽位的一组传感器 (例如各核心温度)
+	/// </summary>
+	struct SlotCache
+	{
+		QString prefix;
+		QString unit;
+		std::map<std::wstring, qint32> slotMap;
+	};
+
+	void updateMap(SensorSnapshot& snapshot, SlotCache& cache, const std::map<std::wstring, float>& values);
+	qint32 slotOf(SensorSnapshot& snapshot, SlotCache& cache, const std::wstring& name);
+	static void setValue(SensorSnapshot& snapshot, qint32 slot, float value);
+
+private:
+	std::shared_ptr<LibreHardwareMonitorApi::ILibreHardwareMonitor> m_monitor;
+
+	/// <summary>
+	/// 固定名称的传感器槽位 首次 Update 时注册
+	/// </summary>
+	enum FixedSensor
+	{
+		CpuLoad,
+		CpuTemp,
+		CpuPower,
+		CpuClock,
+		MainboardTemp,
+		MemoryLoad,
+		MemoryUsed,
+		MemoryAvailable,
+		GpuTemp,
+		GpuPower,
+		GpuLoad,
+		GpuFan,
+		FixedCount
+	};
+	qint32 m_fixed[FixedCount];
+	bool m_registered;
+
+	SlotCache m_cpuTemps;
+	SlotCache m_cpuLoads;
+	SlotCache m_mainboardFans;
+	SlotCache m_storageTemps;
+	SlotCache m_storageReads;
+	SlotCache m_storageWrites;
+	SlotCache m_networkUploads;
+	SlotCache m_networkDownloads;
+};
+
+/// <summary>
+/// 基于 LibreHardwareMonitor 的风扇控制后端
+/// <para>控制按名称解析一次后使用缓存的句柄写入</para>
+/// </summary>
+class LhmFanBackend : public FanBackend
+{
+public:
+	explicit LhmFanBackend(const std::shared_ptr<LibreHardwareMonitorApi::ILibreHardwareMonitor>& monitor);
+
+	/**
+	 * FanBackend 接口
+	 */
+public:
+	qint32 Resolve(const QString& control) override;
+	bool Write(qint32 handle, float percent) override;
+	void Restore(qint32 handle) override;
+
+private:
+	std::shared_ptr<LibreHardwareMonitorApi::ILibreHardwareMonitor> m_monitor;
+};
@@ -0,0 +1,367 @@
+﻿#include "MetricsExporter.h"
+#include "SensorSnapshot.h"
+#include <QMutexLocker>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTimer>
+#include <QtMath>
+#include <cstdio>
+#include <cstring>
+
+namespace
+{
+	/// <summary>
+	/// 请求头的最大长度 超过后断开连接
+	/// </summary>
+	constexpr qint64 MaxRequestSize = 8192;
+	/// <summary>
+	/// 连接在此时间内没有完成请求与响应时断开 (毫秒)
+	/// </summary>
+	constexpr qint32 ConnectionTimeout = 5000;
+	/// <summary>
+	/// 最多同时处理的连接数量 超出时直接断开新的连接
+	/// </summary>
+	constexpr qint32 MaxConnections = 16;
+	constexpr qint32 SequenceWidth = 20;
+	constexpr qint32 TimestampWidth = 20;
+
+	/// <summary>
+	/// 将文本右对齐写入固定宽度的区域 (左侧补空格)
+	/// </summary>
+	void writeFixed(char* target, qint32 width, const char* text, qint32 length)
+	{
+		length = qMin(length, width);
+		std::memset(target, ' ', width - length);
+		std::memcpy(target + width - length, text, length);
+	}
+
+	void writeValue(char* target, float value)
+	{
+		// float 最多 9 位有效数字, 最长如 -1.17549435e-38 共 15 个字符
+		char text[32];
+		qint32 length;
+		if (qIsNaN(value))
+			length = std::snprintf(text, sizeof(text), "NaN");
+		else if (qIsInf(value))
+			length = std::snprintf(text, sizeof(text), value > 0 ? "+Inf" : "-Inf");
+		else
+			length = std::snprintf(text, sizeof(text), "%.9g", static_cast<double>(value));
+
+		writeFixed(target, MetricsExporter::ValueWidth, text, length);
+	}
+
+	void writeSequence(char* target, quint64 sequence)
+	{
+		char text[32];
+		const auto length = std::snprintf(text, sizeof(text), "%llu", static_cast<unsigned long long>(sequence));
+		writeFixed(target, SequenceWidth, text, length);
+	}
+
+	void writeTimestamp(char* target, qint64 timestamp)
+	{
+		char text[32];
+		const auto length = std::snprintf(text, sizeof(text), "%.3f", static_cast<double>(timestamp) / 1000.0);
+		writeFixed(target, TimestampWidth, text, length);
+	}
+
+	/// <summary>
+	/// 转义标签值 (反斜杠, 双引号与换行)
+	/// </summary>
+	QByteArray escapeLabel(const QString& text)
+	{
+		auto value = text.toUtf8();
+		value.replace('\\', "\\\\");
+		value.replace('"', "\\\"");
+		value.replace('\n', "\\n");
+		return value;
+	}
+
+	QByteArray responseHeader(const QByteArray& status, const QByteArray& contentType, qint32 contentLength)
+	{
+		return "HTTP/1.1 " + status + "\r\n"
+			"Content-Type: " + contentType + "\r\n"
+			"Content-Length: " + QByteArray::number(contentLength) + "\r\n"
+			"Connection: close\r\n"
+			"\r\n";
+	}
+
+	QByteArray plainResponse(const QByteArray& status)
+	{
+		const auto body = status + "\n";
+		return responseHeader(status, "text/plain; charset=utf-8", body.size()) + body;
+	}
+}
+
+MetricsExporter::MetricsExporter(QObject* parent)
+	: QObject(parent)
+	, m_server(Q_NULLPTR)
+	, m_connections(0)
+	, m_port(0)
+	, m_back(0)
+	, m_scrapes(0)
+	, m_renderedValues(0)
+	, m_rebuilds(0)
+{
+	m_thread.setObjectName("MetricsExporter");
+
+	m_server = new QTcpServer();
+	m_server->moveToThread(&m_thread);
+	connect(m_server, &QTcpServer::newConnection, m_server, [this]() {
+		handleConnection();
+	});
+}
+
+MetricsExporter::~MetricsExporter()
+{
+	Stop();
+	delete m_server;
+}
+
+bool MetricsExporter::Start(const QHostAddress& address, quint16 port)
+{
+	if (IsRunning())
+		return true;
+
+	m_thread.start();
+
+	auto ok = false;
+	QMetaObject::invokeMethod(m_server, [this, address, port, &ok]() {
+		ok = m_server->listen(address, port);
+		if (ok)
+			m_port = m_server->serverPort();
+		else
+			m_errorString = m_server->errorString();
+	}, Qt::BlockingQueuedConnection);
+
+	if (!ok)
+	{
+		m_thread.quit();
+		m_thread.wait();
+	}
+
+	return ok;
+}
+
+void MetricsExporter::Stop()
+{
+	if (!m_thread.isRunning())
+		return;
+
+	QMetaObject::invokeMethod(m_server, [this]() {
+		m_server->close();
+		qDeleteAll(m_server->findChildren<QTcpSocket*>());
+	}, Qt::BlockingQueuedConnection);
+
+	m_thread.quit();
+	m_thread.wait();
+	m_port = 0;
+}
+
+bool MetricsExporter::IsRunning() const
+{
+	return m_port != 0;
+}
+
+QString MetricsExporter::ErrorString() const
+{
+	return m_errorString;
+}
+
+quint16 MetricsExporter::Port() const
+{
+	return m_port;
+}
+
+QByteArray MetricsExporter::Response() const
+{
+	QMutexLocker locker(&m_mutex);
+	return m_published;
+}
+
+quint64 MetricsExporter::Scrapes() const
+{
+	return m_scrapes;
+}
+
+quint64 MetricsExporter::RenderedValues() const
+{
+	return m_renderedValues;
+}
+
+quint64 MetricsExporter::Rebuilds() const
+{
+	return m_rebuilds;
+}
+
+void MetricsExporter::OnSnapshot(const SensorSnapshot& snapshot)
+{
+	auto& buffer = m_buffers[m_back];
+	if (!buffer.valid || buffer.layoutVersion != snapshot.LayoutVersion() || buffer.offsets.size() != snapshot.Count())
+		rebuild(buffer, snapshot);
+	else
+		patch(buffer, snapshot);
+
+	// 只交换引用 正在发送旧响应的连接仍持有旧数据
+	{
+		QMutexLocker locker(&m_mutex);
+		m_published = buffer.data;
+	}
+
+	m_back ^= 1;
+}
+
+void MetricsExporter::rebuild(Buffer& buffer, const SensorSnapshot& snapshot)
+{
+	const auto count = snapshot.Count();
+	const QByteArray valuePlaceholder(ValueWidth, ' ');
+
+	QByteArray body;
+	body.reserve(256 + count * 96);
+	buffer.offsets.resize(count);
+	buffer.rendered.resize(count);
+
+	body += "# HELP digihms_sensor_value Latest sensor reading.\n"
+		"# TYPE digihms_sensor_value gauge\n";
+	for (auto slot = 0; slot < count; ++slot)
+	{
+		const auto& info = snapshot.Info(slot);
+		body += "digihms_sensor_value{sensor=\"" + escapeLabel(info.name) + "\",unit=\"" + escapeLabel(info.unit) + "\"} ";
+		buffer.offsets[slot] = body.size();
+		body += valuePlaceholder;
+		body += '\n';
+	}
+
+	body += "# HELP digihms_sample_sequence Sequence number of the latest sample.\n"
+		"# TYPE digihms_sample_sequence counter\n"
+		"digihms_sample_sequence ";
+	buffer.sequenceOffset = body.size();
+	body += QByteArray(SequenceWidth, ' ');
+	body += "\n# HELP digihms_sample_timestamp_seconds Time of the latest sample.\n"
+		"# TYPE digihms_sample_timestamp_seconds gauge\n"
+		"digihms_sample_timestamp_seconds ";
+	buffer.timestampOffset = body.size();
+	body += QByteArray(TimestampWidth, ' ');
+	body += '\n';
+
+	// 读数固定宽度 响应长度只在布局变化时改变
+	const auto header = responseHeader("200 OK", "text/plain; version=0.0.4; charset=utf-8", body.size());
+	buffer.data = header + body;
+	buffer.sequenceOffset += header.size();
+	buffer.timestampOffset += header.size();
+
+	auto data = buffer.data.data();
+	const auto values = snapshot.Values();
+	for (auto slot = 0; slot < count; ++slot)
+	{
+		buffer.offsets[slot] += header.size();
+		buffer.rendered[slot] = values[slot];
+		writeValue(data + buffer.offsets[slot], values[slot]);
+	}
+
+	writeSequence(data + buffer.sequenceOffset, snapshot.Sequence());
+	writeTimestamp(data + buffer.timestampOffset, snapshot.Timestamp());
+
+	buffer.layoutVersion = snapshot.LayoutVersion();
+	buffer.valid = true;
+	m_rebuilds++;
+}
+
+void MetricsExporter::patch(Buffer& buffer, const SensorSnapshot& snapshot)
+{
+	// 仍被未发送完的连接引用时 data() 会先复制一份
+	auto data = buffer.data.data();
+	const auto values = snapshot.Values();
+	auto rendered = buffer.rendered.data();
+	const auto count = buffer.offsets.size();
+
+	quint64 changed = 0;
+	for (auto slot = 0; slot < count; ++slot)
+	{
+		if (std::memcmp(&rendered[slot], &values[slot], sizeof(float)) == 0)
+			continue;
+
+		rendered[slot] = values[slot];
+		writeValue(data + buffer.offsets[slot], values[slot]);
+		changed++;
+	}
+
+	writeSequence(data + buffer.sequenceOffset, snapshot.Sequence());
+	writeTimestamp(data + buffer.timestampOffset, snapshot.Timestamp());
+	m_renderedValues += changed;
+}
+
+void MetricsExporter::handleConnection()
+{
+	while (auto socket = m_server->nextPendingConnection())
+	{
+		connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+
+		// 本机任意进程都可以连接 不发送请求的连接不能无限期占用
+		if (m_connections >= MaxConnections)
+		{
+			socket->abort();
+			continue;
+		}
+
+		m_connections++;
+		connect(socket, &QObject::destroyed, m_server, [this]() {
+			m_connections--;
+		});
+
+		auto timeout = new QTimer(socket);
+		timeout->setSingleShot(true);
+		connect(timeout, &QTimer::timeout, socket, &QTcpSocket::abort);
+		timeout->start(ConnectionTimeout);
+
+		connect(socket, &QTcpSocket::readyRead, socket, [this, socket]() {
+			handleRequest(socket);
+		});
+	}
+}
+
+void MetricsExporter::handleRequest(QTcpSocket* socket)
+{
+	static const auto notFound = plainResponse("404 Not Found");
+	static const auto notAllowed = plainResponse("405 Method Not Allowed");
+	static const auto unavailable = plainResponse("503 Service Unavailable");
+
+	const auto available = socket->bytesAvailable();
+	if (available > MaxRequestSize)
+	{
+		socket->abort();
+		return;
+	}
+
+	// 请求头完整后再响应
+	const auto request = socket->peek(available);
+	if (!request.contains("\r\n\r\n"))
+		return;
+
+	disconnect(socket, &QTcpSocket::readyRead, Q_NULLPTR, Q_NULLPTR);
+	socket->readAll();
+
+	// 请求行: 方法 路径 版本
+	const auto line = request.left(request.indexOf("\r\n")).split(' ');
+	auto path = line.value(1);
+	const auto query = path.indexOf('?');
+	if (query >= 0)
+		path.truncate(query);
+
+	QByteArray response;
+	if (line.value(0) != "GET")
+		response = notAllowed;
+	else if (path != "/metrics")
+		response = notFound;
+	else
+	{
+		response = Response();
+		if (response.isEmpty())
+			response = unavailable;
+		else
+			m_scrapes++;
+	}
+
+	// 预先生成的完整响应 一次写入
+	socket->write(response);
+	socket->disconnectFromHost();
+}
@@ -0,0 +1,129 @@
+﻿#pragma once
+
+#include <QObject>
+#include <QThread>
+#include <QMutex>
+#include <QVector>
+#include <QByteArray>
+#include <QHostAddress>
+#include <atomic>
+#include "SensorSource.h"
+
+class QTcpServer;
+class QTcpSocket;
+
+/// <summary>
+/// Prometheus 指标导出 (HTTP GET /metrics, 文本格式 0.0.4)
+/// <para>完整的 HTTP 响应 (包含响应头) 在采样线程中预先生成, 读数使用固定宽度, 每次采样只改写变化的读数</para>
+/// <para>两个响应缓冲区交替写入, 发布时只交换隐式共享的 QByteArray; 服务线程响应时不格式化也不复制, 一次写入整个响应</para>
+/// <para>传感器布局变化 (新的传感器) 时才重新生成完整响应</para>
+/// <para>每个连接最多保持 5 秒, 同时最多 16 个连接</para>
+/// </summary>
+class MetricsExporter : public QObject, public SensorConsumer
+{
+	Q_OBJECT
+
+public:
+	/// <summary>
+	/// 读数的固定宽度 (左侧补空格)
+	/// </summary>
+	static constexpr qint32 ValueWidth = 16;
+
+	explicit MetricsExporter(QObject* parent = Q_NULLPTR);
+	virtual ~MetricsExporter();
+
+	/// <summary>
+	/// 启动服务线程并监听端口
+	/// </summary>
+	/// <param name="address">监听地址 (默认仅本机)</param>
+	/// <param name="port">端口 为 0 时由系统分配</param>
+	/// <returns>是否成功</returns>
+	bool Start(const QHostAddress& address = QHostAddress::LocalHost, quint16 port = 9810);
+	/// <summary>
+	/// 停止监听并结束服务线程
+	/// </summary>
+	void Stop();
+	bool IsRunning() const;
+	QString ErrorString() const;
+	/// <summary>
+	/// 实际监听的端口
+	/// </summary>
+	/// <returns>端口</returns>
+	quint16 Port() const;
+
+	/// <summary>
+	/// 获取当前发布的完整 HTTP 响应 (隐式共享, 不复制)
+	/// </summary>
+	/// <returns>响应 尚未采样时为空</returns>
+	QByteArray Response() const;
+	/// <summary>
+	/// 累计响应的 /metrics 请求数量
+	/// </summary>
+	quint64 Scrapes() const;
+	/// <summary>
+	/// 累计重新格式化的读数数量 (不包含完整生成)
+	/// </summary>
+	quint64 RenderedValues() const;
+	/// <summary>
+	/// 累计完整生成响应的次数
+	/// </summary>
+	quint64 Rebuilds() const;
+
+	/**
+	 * SensorConsumer 接口
+	 */
+public:
+	void OnSnapshot(const SensorSnapshot& snapshot) override;
+
+private:
+	/// <summary>
+	/// 预先生成的响应 以及其中各读数的位置与已写入的值
+	/// </summary>
+	struct Buffer
+	{
+		QByteArray data;
+		/// <summary>
+		/// 各槽位读数在 data 中的偏移
+		/// </summary>
+		QVector<qint32> offsets;
+		/// <summary>
+		/// 已写入 data 的读数 (按位比较, NaN 视为相同)
+		/// </summary>
+		QVector<float> rendered;
+		qint32 sequenceOffset = -1;
+		qint32 timestampOffset = -1;
+		quint32 layoutVersion = 0;
+		bool valid = false;
+	};
+
+	void rebuild(Buffer& buffer, const SensorSnapshot& snapshot);
+	void patch(Buffer& buffer, const SensorSnapshot& snapshot);
+	void handleConnection();
+	void handleRequest(QTcpSocket* socket);
+
+private:
+	QThread m_thread;
+	QTcpServer* m_server;
+	/// <summary>
+	/// 当前的连接数量 (仅在服务线程中访问)
+	/// </summary>
+	qint32 m_connections;
+	QString m_errorString;
+	std::atomic<quint16> m_port;
+
+	/// <summary>
+	/// 仅在采样线程中访问
+	/// </summary>
+	Buffer m_buffers[2];
+	qint32 m_back;
+
+	/// <summary>
+	/// 保护已发布的响应
+	/// </summary>
+	mutable QMutex m_mutex;
+	QByteArray m_published;
+
+	std::atomic<quint64> m_scrapes;
+	std::atomic<quint64> m_renderedValues;
+	std::atomic<quint64> m_rebuilds;
+};
@@ -0,0 +1,146 @@
+﻿#include "PayloadPublisher.h"
+#include "SensorSampler.h"
+#include <IO/Manager/Manager.h>
+
+#define SETTINGS_PAYLOADTEMPLATE "Sensor_PayloadTemplate"
+#define SETTINGS_PAYLOADENABLED  "Sensor_PayloadEnabled"
+
+namespace
+{
+	/// <summary>
+	/// 转义序列中的花括号 使其在模板中作为字面量输出
+	/// </summary>
+	QString escapeBraces(QString text)
+	{
+		return text.replace('{', "{{").replace('}', "}}");
+	}
+
+	/// <summary>
+	/// 默认模板 使用 Manager 当前的起始/结束/分隔序列
+	/// </summary>
+	QString defaultTemplate()
+	{
+		static const QStringList fields = { "{cpu.load:.0f}", "{cpu.temp:.0f}", "{gpu.load:.0f}", "{gpu.temp:.0f}", "{memory.load:.0f}" };
+
+		const auto& manager = Manager::Instance();
+		return escapeBraces(manager.StartSequence())
+			+ fields.join(escapeBraces(manager.SeparatorSequence()))
+			+ escapeBraces(manager.FinishSequence());
+	}
+}
+
+PayloadPublisher::PayloadPublisher(QObject* parent)
+	: QObject(parent)
+	, m_enabled(true)
+	, m_default(true)
+{
+	readSettings();
+
+	// 快照从采样线程发出 在本对象所在线程中执行模板
+	connect(&SensorSampler::Instance(), &SensorSampler::snapshotUpdated, this, &PayloadPublisher::publish);
+
+	// 使用默认模板时跟随帧序列的修改
+	auto& manager = Manager::Instance();
+	connect(&manager, &Manager::startSequenceChanged, this, &PayloadPublisher::updateDefaultTemplate);
+	connect(&manager, &Manager::finishSequenceChanged, this, &PayloadPublisher::updateDefaultTemplate);
+	connect(&manager, &Manager::separatorSequenceChanged, this, &PayloadPublisher::updateDefaultTemplate);
+}
+
+PayloadPublisher::~PayloadPublisher()
+{
+	writeSettings();
+}
+
+QString PayloadPublisher::Template() const
+{
+	return m_text;
+}
+
+bool PayloadPublisher::Enabled() const
+{
+	return m_enabled;
+}
+
+void PayloadPublisher::setTemplate(const QString& text)
+{
+	if (text == m_text && m_template.IsValid())
+		return;
+
+	if (!m_template.Compile(ADD_ESCAPE_SEQUENCES(text)))
+	{
+		emit templateError(m_template.ErrorString());
+		return;
+	}
+
+	m_text = text;
+	m_default = false;
+	writeSettings();
+
+	emit templateChanged();
+}
+
+void PayloadPublisher::setEnabled(const bool enabled)
+{
+	if (m_enabled == enabled)
+		return;
+
+	m_enabled = enabled;
+	writeSettings();
+
+	emit enabledChanged();
+}
+
+void PayloadPublisher::publish()
+{
+	auto& manager = Manager::Instance();
+	if (!m_enabled || !m_template.IsValid() || !manager.Connected())
+		return;
+
+	// 直接读取采样器的快照 模板输出到自身的缓冲区后再写入设备
+	const QByteArray* payload = Q_NULLPTR;
+	SensorSampler::Instance().ReadLatest([this, &payload](const SensorSnapshot& snapshot) {
+		payload = &m_template.Execute(snapshot);
+	});
+
+	manager.WriteData(*payload);
+}
+
+void PayloadPublisher::updateDefaultTemplate()
+{
+	if (!m_default)
+		return;
+
+	const auto text = defaultTemplate();
+	if (text == m_text || !m_template.Compile(text))
+		return;
+
+	m_text = text;
+	emit templateChanged();
+}
+
+void PayloadPublisher::readSettings()
+{
+	const auto text = m_settings.value(SETTINGS_PAYLOADTEMPLATE).toString();
+	m_enabled = m_settings.value(SETTINGS_PAYLOADENABLED, true).toBool();
+
+	// 没有保存的模板或保存的模板无效时使用默认模板
+	m_default = text.isEmpty() || !m_template.Compile(ADD_ESCAPE_SEQUENCES(text));
+	if (!m_default)
+	{
+		m_text = text;
+		return;
+	}
+
+	m_text = defaultTemplate();
+	m_template.Compile(m_text);
+}
+
+void PayloadPublisher::writeSettings()
+{
+	// 默认模板不保存 以便跟随帧序列
+	if (m_default)
+		m_settings.remove(SETTINGS_PAYLOADTEMPLATE);
+	else
+		m_settings.setValue(SETTINGS_PAYLOADTEMPLATE, m_text);
+	m_settings.setValue(SETTINGS_PAYLOADENABLED, m_enabled);
+}
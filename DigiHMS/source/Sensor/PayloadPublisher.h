@@ -0,0 +1,85 @@
+﻿#pragma once
+
+#include <QObject>
+#include <QSettings>
+#include "PayloadTemplate.h"
+
+/// <summary>
+/// 负载发布器
+/// <para>每次采样完成后执行负载模板, 并通过 Manager 写入显示设备</para>
+/// </summary>
+class PayloadPublisher : public QObject
+{
+	Q_OBJECT
+
+	Q_PROPERTY(QString payloadTemplate
+		READ Template
+		WRITE setTemplate
+		NOTIFY templateChanged)
+	Q_PROPERTY(bool enabled
+		READ Enabled
+		WRITE setEnabled
+		NOTIFY enabledChanged)
+
+public:
+	explicit PayloadPublisher(QObject* parent = Q_NULLPTR);
+	virtual ~PayloadPublisher();
+
+	/// <summary>
+	/// 获取负载模板 (未转义)
+	/// </summary>
+	/// <returns>负载模板</returns>
+	QString Template() const;
+	/// <summary>
+	/// 获取是否启用发布
+	/// </summary>
+	/// <returns>是否启用</returns>
+	bool Enabled() const;
+
+signals:
+	void templateChanged();
+	void enabledChanged();
+	/// <summary>
+	/// 模板编译失败
+	/// </summary>
+	/// <param name="message">错误信息</param>
+	void templateError(const QString& message);
+
+public slots:
+	/// <summary>
+	/// 设置负载模板
+	/// <para>支持与起始/结束序列相同的转义字符 例如 \n</para>
+	/// </summary>
+	/// <param name="text">负载模板</param>
+	void setTemplate(const QString& text);
+	/// <summary>
+	/// 启用或禁用发布
+	/// </summary>
+	/// <param name="enabled">是否启用</param>
+	void setEnabled(const bool enabled);
+	/// <summary>
+	/// 按最新快照执行模板并写入设备
+	/// <para>每次采样完成后自动调用, 也可由设备请求立即发送一帧完整数据</para>
+	/// </summary>
+	void publish();
+
+private slots:
+	/// <summary>
+	/// 帧序列修改后重新生成默认模板 (仅在使用默认模板时)
+	/// </summary>
+	void updateDefaultTemplate();
+
+private:
+	void readSettings();
+	void writeSettings();
+
+private:
+	QString m_text;
+	bool m_enabled;
+	/// <summary>
+	/// 是否使用由帧序列生成的默认模板 (未设置模板或保存的模板无效)
+	/// </summary>
+	bool m_default;
+	PayloadTemplate m_template;
+	QSettings m_settings;
+};
@@ -0,0 +1,310 @@
+﻿#include "PayloadTemplate.h"
+#include "SensorSnapshot.h"
+#include <Common/FrameFormatter.h>
+#include <QCoreApplication>
+#include <QtMath>
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+
+namespace
+{
+	/// <summary>
+	/// 最大宽度与精度 保证单个数值的格式化结果不超过栈缓冲区
+	/// </summary>
+	constexpr qint32 MaxWidth = 32;
+	constexpr qint32 MaxPrecision = FloatFormat::MaxPrecision;
+	constexpr qint32 NumberBufferSize = 128;
+
+	QString TemplateError(const char* text, qint32 position)
+	{
+		return QCoreApplication::translate("PayloadTemplate", text) + QString(" (%1)").arg(position);
+	}
+
+	/// <summary>
+	/// 转换 std::to_chars 的结果 与 FloatFormat 一致, 失败时返回 Q_NULLPTR
+	/// </summary>
+	char* ResultEnd(const std::to_chars_result& result)
+	{
+		return result.ec == std::errc() ? result.ptr : Q_NULLPTR;
+	}
+}
+
+PayloadTemplate::PayloadTemplate()
+	: m_missingText("-")
+	, m_layoutVersion(0)
+	, m_resolved(false)
+{
+}
+
+bool PayloadTemplate::Compile(const QString& source)
+{
+	QVector<Op> ops;
+	QByteArray literals;
+	QStringList sensors;
+	QString literal;
+
+	// 连续的字面量合并为一条指令
+	auto flushLiteral = [&]() {
+		if (literal.isEmpty())
+			return;
+
+		const auto bytes = literal.toUtf8();
+		ops.append(Op{ OpType::Literal, 0, false, 0, 0, static_cast<qint32>(literals.size()), static_cast<qint32>(bytes.size()), -1 });
+		literals.append(bytes);
+		literal.clear();
+	};
+
+	const auto length = source.length();
+	for (auto i = 0; i < length; ++i)
+	{
+		const auto ch = source.at(i);
+
+		if (ch == '}')
+		{
+			if (i + 1 < length && source.at(i + 1) == '}')
+			{
+				literal.append('}');
+				++i;
+				continue;
+			}
+
+			m_errorString = TemplateError("Unmatched '}'", i);
+			return false;
+		}
+
+		if (ch != '{')
+		{
+			literal.append(ch);
+			continue;
+		}
+
+		if (i + 1 < length && source.at(i + 1) == '{')
+		{
+			literal.append('{');
+			++i;
+			continue;
+		}
+
+		const auto close = source.indexOf('}', i + 1);
+		if (close < 0)
+		{
+			m_errorString = TemplateError("Unterminated placeholder", i);
+			return false;
+		}
+
+		const auto field = source.mid(i + 1, close - i - 1);
+		const auto colon = field.indexOf(':');
+		const auto name = (colon < 0 ? field : field.left(colon)).trimmed();
+		const auto spec = colon < 0 ? QString() : field.mid(colon + 1);
+
+		if (name.isEmpty() || name.contains('{'))
+		{
+			m_errorString = TemplateError("Invalid sensor name", i + 1);
+			return false;
+		}
+
+		// 格式: [0][宽度][.精度][类型]
+		Op op{ OpType::Sensor, 'r', false, 0, -1, 0, 0, -1 };
+		auto p = 0;
+		if (p < spec.length() && spec.at(p) == '0')
+		{
+			op.zeroPad = true;
+			++p;
+		}
+
+		qint32 width = 0;
+		while (p < spec.length() && spec.at(p).isDigit())
+			width = width * 10 + spec.at(p++).digitValue();
+
+		if (p < spec.length() && spec.at(p) == '.')
+		{
+			++p;
+			qint32 precision = 0;
+			auto digits = 0;
+			while (p < spec.length() && spec.at(p).isDigit())
+			{
+				precision = precision * 10 + spec.at(p++).digitValue();
+				++digits;
+			}
+
+			if (digits == 0 || precision > MaxPrecision)
+			{
+				m_errorString = TemplateError("Invalid precision", i + 1 + colon + 1 + p);
+				return false;
+			}
+
+			op.precision = static_cast<qint8>(precision);
+			op.format = 'f';
+		}
+
+		if (p < spec.length())
+		{
+			const auto type = spec.at(p++).toLatin1();
+			if (type != 'f' && type != 'e' && type != 'g' && type != 'd')
+			{
+				m_errorString = TemplateError("Unknown format type", i + 1 + colon + p);
+				return false;
+			}
+
+			op.format = type;
+		}
+
+		if (p != spec.length() || width > MaxWidth)
+		{
+			m_errorString = TemplateError("Invalid format specification", i + 1 + colon + 1);
+			return false;
+		}
+
+		op.width = static_cast<qint8>(width);
+
+		auto sensor = sensors.indexOf(name);
+		if (sensor < 0)
+		{
+			sensor = sensors.count();
+			sensors.append(name);
+		}
+		op.sensor = sensor;
+
+		flushLiteral();
+		ops.append(op);
+		i = close;
+	}
+
+	flushLiteral();
+
+	m_source = source;
+	m_errorString.clear();
+	m_ops = ops;
+	m_literals = literals;
+	m_sensors = sensors;
+	m_slots.fill(-1, sensors.count());
+	m_resolved = false;
+
+	// 预留输出缓冲区 之后执行时不再分配
+	m_output.reserve(literals.size() + sensors.count() * 16 + 64);
+	return true;
+}
+
+bool PayloadTemplate::IsValid() const
+{
+	return !m_ops.isEmpty();
+}
+
+QString PayloadTemplate::Source() const
+{
+	return m_source;
+}
+
+QString PayloadTemplate::ErrorString() const
+{
+	return m_errorString;
+}
+
+QStringList PayloadTemplate::Sensors() const
+{
+	return m_sensors;
+}
+
+void PayloadTemplate::SetMissingText(const QByteArray& text)
+{
+	m_missingText = text;
+}
+
+const QByteArray& PayloadTemplate::Execute(const SensorSnapshot& snapshot)
+{
+	if (!m_resolved || m_layoutVersion != snapshot.LayoutVersion())
+		resolve(snapshot);
+
+	m_output.resize(0);
+
+	const auto values = snapshot.Values();
+	const auto count = snapshot.Count();
+
+	for (const auto& op : m_ops)
+	{
+		if (op.type == OpType::Literal)
+		{
+			m_output.append(m_literals.constData() + op.offset, op.length);
+			continue;
+		}
+
+		// 无穷大按缺失处理 (整数格式无法表示)
+		const auto slot = m_slots.at(op.sensor);
+		if (slot < 0 || slot >= count || !qIsFinite(values[slot]))
+			m_output.append(m_missingText);
+		else
+			appendValue(op, values[slot]);
+	}
+
+	return m_output;
+}
+
+void PayloadTemplate::resolve(const SensorSnapshot& snapshot)
+{
+	// 只在传感器布局变化时查找名称
+	for (auto i = 0; i < m_sensors.count(); ++i)
+		m_slots[i] = snapshot.Slot(m_sensors.at(i));
+
+	m_layoutVersion = snapshot.LayoutVersion();
+	m_resolved = true;
+}
+
+void PayloadTemplate::appendValue(const Op& op, float value)
+{
+	char buffer[NumberBufferSize];
+	auto first = buffer + MaxWidth;
+	const auto last = buffer + sizeof(buffer);
+
+	char* end = Q_NULLPTR;
+	switch (op.format)
+	{
+	case 'f':
+		// 定点格式与 FrameFormatter 共用同一实现
+		end = FloatFormat::Fixed(first, last, value, op.precision < 0 ? 6 : op.precision);
+		break;
+	case 'e':
+		end = ResultEnd(op.precision < 0
+			? std::to_chars(first, last, value, std::chars_format::scientific)
+			: std::to_chars(first, last, value, std::chars_format::scientific, op.precision));
+		break;
+	case 'g':
+		end = ResultEnd(op.precision < 0
+			? std::to_chars(first, last, value, std::chars_format::general)
+			: std::to_chars(first, last, value, std::chars_format::general, op.precision));
+		break;
+	case 'd':
+		end = ResultEnd(std::to_chars(first, last, static_cast<long long>(std::llround(value))));
+		break;
+	default:
+		// 未指定格式时输出可还原的最短表示
+		end = ResultEnd(std::to_chars(first, last, value));
+		break;
+	}
+
+	if (end == Q_NULLPTR)
+	{
+		m_output.append(m_missingText);
+		return;
+	}
+
+	// 左侧填充到指定宽度 (数值最长不超过缓冲区中预留的 MaxWidth 之后的空间)
+	const auto padding = op.width - static_cast<qint32>(end - first);
+	if (padding > 0)
+	{
+		if (op.zeroPad && *first == '-')
+		{
+			// 负号保持在最前
+			first -= padding;
+			first[0] = '-';
+			std::fill(first + 1, first + 1 + padding, '0');
+		}
+		else
+		{
+			first -= padding;
+			std::fill(first, first + padding, op.zeroPad ? '0' : ' ');
+		}
+	}
+
+	m_output.append(first, static_cast<qint32>(end - first));
+}
@@ -0,0 +1,107 @@
+﻿#pragma once
+
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+class SensorSnapshot;
+
+/// <summary>
+/// 发送给显示设备的负载模板
+/// <para>例如 /*{cpu.load:.0f},{gpu.temp:.1f}*/, 编译一次后每次采样执行</para>
+/// <para>占位符格式 {传感器名称[:[0][宽度][.精度][f|e|g|d]]}, 使用 {{ 与 }} 输出花括号</para>
+/// <para>执行时只做字面量拷贝与数值格式化 (定点格式使用 FloatFormat::Fixed, 其余为 std::to_chars), 输出缓冲区重复使用</para>
+/// </summary>
+class PayloadTemplate
+{
+public:
+	PayloadTemplate();
+
+	/// <summary>
+	/// 编译模板
+	/// <para>失败时保留之前编译的模板</para>
+	/// </summary>
+	/// <param name="source">模板</param>
+	/// <returns>是否成功</returns>
+	bool Compile(const QString& source);
+	/// <summary>
+	/// 获取模板是否已编译
+	/// </summary>
+	/// <returns>是否有效</returns>
+	bool IsValid() const;
+	/// <summary>
+	/// 获取当前模板
+	/// </summary>
+	/// <returns>模板</returns>
+	QString Source() const;
+	/// <summary>
+	/// 获取最近一次编译失败的原因
+	/// </summary>
+	/// <returns>错误信息</returns>
+	QString ErrorString() const;
+	/// <summary>
+	/// 获取模板引用的传感器名称
+	/// </summary>
+	/// <returns>传感器名称</returns>
+	QStringList Sensors() const;
+
+	/// <summary>
+	/// 设置没有读数或读数为 NaN/无穷大时输出的文本 (默认为 "-")
+	/// </summary>
+	/// <param name="text">文本</param>
+	void SetMissingText(const QByteArray& text);
+
+	/// <summary>
+	/// 使用快照执行模板
+	/// <para>返回内部缓冲区的引用, 下次执行时被覆盖</para>
+	/// </summary>
+	/// <param name="snapshot">快照</param>
+	/// <returns>负载</returns>
+	const QByteArray& Execute(const SensorSnapshot& snapshot);
+
+private:
+	enum class OpType : quint8
+	{
+		Literal,
+		Sensor
+	};
+
+	/// <summary>
+	/// 编译后的指令
+	/// <para>Literal: 拷贝 m_literals[offset, offset + length)</para>
+	/// <para>Sensor: 格式化 m_slots[sensor] 对应的读数</para>
+	/// </summary>
+	struct Op
+	{
+		OpType type;
+		char format;
+		bool zeroPad;
+		qint8 width;
+		qint8 precision;
+		qint32 offset;
+		qint32 length;
+		qint32 sensor;
+	};
+
+	void resolve(const SensorSnapshot& snapshot);
+	void appendValue(const Op& op, float value);
+
+private:
+	QString m_source;
+	QString m_errorString;
+	QByteArray m_missingText;
+
+	QVector<Op> m_ops;
+	QByteArray m_literals;
+	QStringList m_sensors;
+
+	/// <summary>
+	/// 传感器槽位 快照布局版本变化时重新解析
+	/// </summary>
+	QVector<qint32> m_slots;
+	quint32 m_layoutVersion;
+	bool m_resolved;
+
+	QByteArray m_output;
+};
@@ -0,0 +1,206 @@
+﻿#include "SensorHistory.h"
+#include "SensorSnapshot.h"
+#include <QtMath>
+
+qint64 SensorHistoryConfig::MemoryBudget() const
+{
+	// 每个分辨率各有一个环形缓冲区状态与累加器
+	const qint64 points = qint64(rawCapacity) + secondCapacity + minuteCapacity;
+	const qint64 resolutions = static_cast<qint64>(SensorHistory::Resolution::Count);
+	const qint64 perSensor = points * qint64(sizeof(HistoryPoint))
+		+ resolutions * qint64(sizeof(SensorHistory::Ring) + sizeof(SensorHistory::Accumulator));
+
+	return perSensor * maxSensors;
+}
+
+SensorHistory::SensorHistory(const SensorHistoryConfig& config)
+	: m_config(config)
+{
+	Q_ASSERT(config.maxSensors > 0);
+	Q_ASSERT(config.rawCapacity > 0 && config.secondCapacity > 0 && config.minuteCapacity > 0);
+
+	// 一次性分配全部内存 之后追加与查询都不再分配
+	for (auto i = 0; i < static_cast<int>(Resolution::Count); ++i)
+	{
+		const auto resolution = static_cast<Resolution>(i);
+		m_points[i].resize(m_config.maxSensors * capacity(resolution));
+		m_rings[i].resize(m_config.maxSensors);
+		m_accumulators[i].resize(m_config.maxSensors);
+	}
+
+	Clear();
+}
+
+const SensorHistoryConfig& SensorHistory::Config() const
+{
+	return m_config;
+}
+
+void SensorHistory::Append(qint32 slot, qint64 timestamp, float value)
+{
+	if (slot < 0 || slot >= m_config.maxSensors || qIsNaN(value))
+		return;
+
+	QMutexLocker lock(&m_mutex);
+
+	push(slot, Resolution::Raw, HistoryPoint{ timestamp, value, value, value });
+	accumulate(slot, Resolution::Second, 1000, timestamp, value);
+	accumulate(slot, Resolution::Minute, 60 * 1000, timestamp, value);
+}
+
+qint32 SensorHistory::Query(qint32 slot, Resolution resolution, qint64 from, qint64 to, HistoryPoint* output, qint32 maxPoints) const
+{
+	if (slot < 0 || slot >= m_config.maxSensors || output == Q_NULLPTR || maxPoints <= 0 || from > to)
+		return 0;
+
+	QMutexLocker lock(&m_mutex);
+
+	const auto count = m_rings[static_cast<int>(resolution)].at(slot).count;
+
+	// 数据点按时间递增排列 使用二分查找定位范围
+	qint32 low = 0;
+	qint32 high = count;
+	while (low < high)
+	{
+		const auto mid = (low + high) / 2;
+		if (at(slot, resolution, mid).timestamp < from)
+			low = mid + 1;
+		else
+			high = mid;
+	}
+	const auto first = low;
+
+	high = count;
+	while (low < high)
+	{
+		const auto mid = (low + high) / 2;
+		if (at(slot, resolution, mid).timestamp <= to)
+			low = mid + 1;
+		else
+			high = mid;
+	}
+	const auto last = low;
+
+	// 超出输出容量时保留最新的数据点
+	const auto begin = qMax(first, last - maxPoints);
+	for (auto i = begin; i < last; ++i)
+		output[i - begin] = at(slot, resolution, i);
+
+	return last - begin;
+}
+
+bool SensorHistory::Latest(qint32 slot, Resolution resolution, HistoryPoint& point) const
+{
+	if (slot < 0 || slot >= m_config.maxSensors)
+		return false;
+
+	QMutexLocker lock(&m_mutex);
+
+	const auto count = m_rings[static_cast<int>(resolution)].at(slot).count;
+	if (count == 0)
+		return false;
+
+	point = at(slot, resolution, count - 1);
+	return true;
+}
+
+qint32 SensorHistory::Size(qint32 slot, Resolution resolution) const
+{
+	if (slot < 0 || slot >= m_config.maxSensors)
+		return 0;
+
+	QMutexLocker lock(&m_mutex);
+	return m_rings[static_cast<int>(resolution)].at(slot).count;
+}
+
+void SensorHistory::Clear()
+{
+	QMutexLocker lock(&m_mutex);
+
+	for (auto i = 0; i < static_cast<int>(Resolution::Count); ++i)
+	{
+		m_rings[i].fill(Ring{ 0, 0 });
+		m_accumulators[i].fill(Accumulator{ -1, 0, 0, 0, 0 });
+	}
+}
+
+void SensorHistory::OnSnapshot(const SensorSnapshot& snapshot)
+{
+	const auto count = qMin(snapshot.Count(), m_config.maxSensors);
+	const auto values = snapshot.Values();
+	const auto timestamp = snapshot.Timestamp();
+
+	for (auto slot = 0; slot < count; ++slot)
+		Append(slot, timestamp, values[slot]);
+}
+
+void SensorHistory::push(qint32 slot, Resolution resolution, const HistoryPoint& point)
+{
+	const auto level = static_cast<int>(resolution);
+	const auto cap = capacity(resolution);
+	auto& ring = m_rings[level][slot];
+
+	m_points[level][slot * cap + ring.head] = point;
+	ring.head = (ring.head + 1) % cap;
+	if (ring.count < cap)
+		ring.count++;
+}
+
+void SensorHistory::accumulate(qint32 slot, Resolution resolution, qint64 bucketMs, qint64 timestamp, float value)
+{
+	auto& accumulator = m_accumulators[static_cast<int>(resolution)][slot];
+	const auto bucket = timestamp - (timestamp % bucketMs);
+
+	// 进入新的时间桶时 输出上一个桶的 min/max/avg
+	if (bucket != accumulator.bucket)
+	{
+		if (accumulator.count > 0)
+		{
+			push(slot, resolution, HistoryPoint{
+				accumulator.bucket,
+				accumulator.min,
+				accumulator.max,
+				static_cast<float>(accumulator.sum / accumulator.count) });
+		}
+
+		accumulator.bucket = bucket;
+		accumulator.min = value;
+		accumulator.max = value;
+		accumulator.sum = 0;
+		accumulator.count = 0;
+	}
+
+	accumulator.min = qMin(accumulator.min, value);
+	accumulator.max = qMax(accumulator.max, value);
+	accumulator.sum += value;
+	accumulator.count++;
+}
+
+qint32 SensorHistory::capacity(Resolution resolution) const
+{
+	switch (resolution)
+	{
+	case Resolution::Raw:
+		return m_config.rawCapacity;
+	case Resolution::Second:
+		return m_config.secondCapacity;
+	case Resolution::Minute:
+		return m_config.minuteCapacity;
+	default:
+		return 0;
+	}
+}
+
+const HistoryPoint& SensorHistory::at(qint32 slot, Resolution resolution, qint32 index) const
+{
+	const auto level = static_cast<int>(resolution);
+	const auto cap = capacity(resolution);
+	const auto& ring = m_rings[level].at(slot);
+
+	// index 0 为最旧的数据点
+	auto physical = ring.head - ring.count + index;
+	if (physical < 0)
+		physical += cap;
+
+	return m_points[level].at(slot * cap + physical);
+}
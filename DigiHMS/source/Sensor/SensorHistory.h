@@ -0,0 +1,162 @@
+﻿#pragma once
+
+#include <QMutex>
+#include <QVector>
+#include "SensorSource.h"
+
+/// <summary>
+/// 历史数据点
+/// <para>原始分辨率下 min/max/avg 均为原始读数</para>
+/// </summary>
+struct HistoryPoint
+{
+	/// <summary>
+	/// 时间戳 (自 1970 年起的毫秒数), 降采样时为时间桶起点
+	/// </summary>
+	qint64 timestamp;
+	float min;
+	float max;
+	float avg;
+};
+
+/// <summary>
+/// 历史数据存储配置
+/// <para>内存占用固定为 MemoryBudget() 字节, 构造时一次性分配</para>
+/// </summary>
+struct SensorHistoryConfig
+{
+	/// <summary>
+	/// 最多记录的传感器数量 (槽位超出范围的传感器被忽略)
+	/// </summary>
+	qint32 maxSensors = 256;
+	/// <summary>
+	/// 每个传感器保留的原始采样数量
+	/// </summary>
+	qint32 rawCapacity = 600;
+	/// <summary>
+	/// 每个传感器保留的 1 秒数据点数量 (默认 1 小时)
+	/// </summary>
+	qint32 secondCapacity = 3600;
+	/// <summary>
+	/// 每个传感器保留的 1 分钟数据点数量 (默认 24 小时)
+	/// </summary>
+	qint32 minuteCapacity = 1440;
+
+	/// <summary>
+	/// 计算存储所需的内存 (字节)
+	/// </summary>
+	/// <returns>内存预算</returns>
+	qint64 MemoryBudget() const;
+};
+
+/// <summary>
+/// 内存中的多分辨率传感器历史存储
+/// <para>每个传感器在原始 / 1 秒 / 1 分钟三个分辨率下各有一个环形缓冲区</para>
+/// <para>追加为 O(1), 查询结果写入调用方提供的缓冲区, 不会分配内存</para>
+/// </summary>
+class SensorHistory : public SensorConsumer
+{
+public:
+	enum class Resolution
+	{
+		Raw,
+		Second,
+		Minute,
+		Count
+	};
+
+	explicit SensorHistory(const SensorHistoryConfig& config = SensorHistoryConfig());
+	virtual ~SensorHistory() {}
+
+	/// <summary>
+	/// 获取存储配置
+	/// </summary>
+	/// <returns>存储配置</returns>
+	const SensorHistoryConfig& Config() const;
+	/// <summary>
+	/// 追加一个原始读数 并更新降采样数据
+	/// <para>NaN 读数被忽略</para>
+	/// </summary>
+	/// <param name="slot">传感器槽位</param>
+	/// <param name="timestamp">时间戳 (毫秒)</param>
+	/// <param name="value">读数</param>
+	void Append(qint32 slot, qint64 timestamp, float value);
+	/// <summary>
+	/// 查询时间范围 [from, to] 内的数据点
+	/// <para>降采样分辨率只包含已经结束的时间桶</para>
+	/// </summary>
+	/// <param name="slot">传感器槽位</param>
+	/// <param name="resolution">分辨率</param>
+	/// <param name="from">起始时间 (毫秒, 包含)</param>
+	/// <param name="to">结束时间 (毫秒, 包含)</param>
+	/// <param name="output">输出缓冲区</param>
+	/// <param name="maxPoints">输出缓冲区容量</param>
+	/// <returns>写入的数据点数量 (超出容量时返回最新的 maxPoints 个)</returns>
+	qint32 Query(qint32 slot, Resolution resolution, qint64 from, qint64 to, HistoryPoint* output, qint32 maxPoints) const;
+	/// <summary>
+	/// 获取最新的数据点
+	/// </summary>
+	/// <param name="slot">传感器槽位</param>
+	/// <param name="resolution">分辨率</param>
+	/// <param name="point">输出数据点</param>
+	/// <returns>是否存在数据</returns>
+	bool Latest(qint32 slot, Resolution resolution, HistoryPoint& point) const;
+	/// <summary>
+	/// 获取指定分辨率下保存的数据点数量
+	/// </summary>
+	/// <param name="slot">传感器槽位</param>
+	/// <param name="resolution">分辨率</param>
+	/// <returns>数据点数量</returns>
+	qint32 Size(qint32 slot, Resolution resolution) const;
+	/// <summary>
+	/// 清空所有数据
+	/// </summary>
+	void Clear();
+
+	/**
+	 * SensorConsumer 接口
+	 */
+public:
+	void OnSnapshot(const SensorSnapshot& snapshot) override;
+
+private:
+	// 内存预算按实际的结构大小计算
+	friend struct SensorHistoryConfig;
+
+	/// <summary>
+	/// 单个环形缓冲区的状态
+	/// </summary>
+	struct Ring
+	{
+		qint32 head;
+		qint32 count;
+	};
+
+	/// <summary>
+	/// 降采样累加器
+	/// </summary>
+	struct Accumulator
+	{
+		qint64 bucket;
+		float min;
+		float max;
+		double sum;
+		qint32 count;
+	};
+
+	void push(qint32 slot, Resolution resolution, const HistoryPoint& point);
+	void accumulate(qint32 slot, Resolution resolution, qint64 bucketMs, qint64 timestamp, float value);
+	qint32 capacity(Resolution resolution) const;
+	const HistoryPoint& at(qint32 slot, Resolution resolution, qint32 index) const;
+
+private:
+	SensorHistoryConfig m_config;
+	mutable QMutex m_mutex;
+
+	/// <summary>
+	/// 每个分辨率一块连续内存 按 [slot][capacity] 排列
+	/// </summary>
+	QVector<HistoryPoint> m_points[static_cast<int>(Resolution::Count)];
+	QVector<Ring> m_rings[static_cast<int>(Resolution::Count)];
+	QVector<Accumulator> m_accumulators[static_cast<int>(Resolution::Count)];
+};
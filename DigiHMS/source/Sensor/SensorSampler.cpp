@@ -0,0 +1,165 @@
+﻿#include "SensorSampler.h"
+#include "SensorSource.h"
+#include <QTimer>
+#include <QDateTime>
+
+SensorSampler::SensorSampler()
+	: m_timer(Q_NULLPTR)
+	, m_period(1000)
+{
+	m_thread.setObjectName("SensorSampler");
+
+	// 定时器属于采样线程 超时回调在采样线程中执行
+	m_timer = new QTimer();
+	m_timer->setTimerType(Qt::PreciseTimer);
+	m_timer->moveToThread(&m_thread);
+	connect(m_timer, &QTimer::timeout, m_timer, [this]() {
+		sample();
+	});
+}
+
+SensorSampler::~SensorSampler()
+{
+	stop();
+	delete m_timer;
+}
+
+SensorSampler& SensorSampler::Instance()
+{
+	static SensorSampler singleton;
+	return singleton;
+}
+
+void SensorSampler::AddSource(SensorSource* source)
+{
+	if (source)
+	{
+		QMutexLocker lock(&m_mutex);
+		m_sources.emplace_back(source);
+	}
+}
+
+void SensorSampler::AddConsumer(SensorConsumer* consumer)
+{
+	QMutexLocker lock(&m_mutex);
+	if (consumer && !m_consumers.contains(consumer))
+		m_consumers.append(consumer);
+}
+
+void SensorSampler::RemoveConsumer(SensorConsumer* consumer)
+{
+	QMutexLocker lock(&m_mutex);
+	m_consumers.removeAll(consumer);
+}
+
+qint32 SensorSampler::Period() const
+{
+	return m_period;
+}
+
+bool SensorSampler::IsRunning() const
+{
+	return m_thread.isRunning();
+}
+
+SensorSnapshot SensorSampler::LatestSnapshot() const
+{
+	QMutexLocker lock(&m_latestMutex);
+	return m_latest;
+}
+
+void SensorSampler::ReadLatest(const std::function<void(const SensorSnapshot&)>& reader) const
+{
+	QMutexLocker lock(&m_latestMutex);
+	reader(m_latest);
+}
+
+QThread* SensorSampler::Thread()
+{
+	return &m_thread;
+}
+
+void SensorSampler::Post(const std::function<void()>& function)
+{
+	if (!function)
+		return;
+
+	// 采样线程未运行时 函数在线程启动后执行
+	QMetaObject::invokeMethod(m_timer, [this, function]() {
+		QMutexLocker lock(&m_mutex);
+		function();
+	}, Qt::QueuedConnection);
+}
+
+void SensorSampler::start()
+{
+	if (m_thread.isRunning())
+		return;
+
+	m_thread.start();
+	QMetaObject::invokeMethod(m_timer, [this]() {
+		sample();
+		m_timer->start(m_period);
+	}, Qt::QueuedConnection);
+
+	emit runningChanged();
+}
+
+void SensorSampler::stop()
+{
+	if (!m_thread.isRunning())
+		return;
+
+	QMetaObject::invokeMethod(m_timer, [this]() {
+		m_timer->stop();
+	}, Qt::BlockingQueuedConnection);
+
+	m_thread.quit();
+	m_thread.wait();
+
+	emit runningChanged();
+}
+
+void SensorSampler::setPeriod(qint32 periodMs)
+{
+	Q_ASSERT(periodMs > 0);
+
+	if (periodMs <= 0 || periodMs == m_period)
+		return;
+
+	m_period = periodMs;
+	QMetaObject::invokeMethod(m_timer, [this, periodMs]() {
+		if (m_timer->isActive())
+			m_timer->start(periodMs);
+	}, Qt::QueuedConnection);
+
+	emit periodChanged();
+}
+
+void SensorSampler::sample()
+{
+	quint64 sequence = 0;
+
+	{
+		QMutexLocker lock(&m_mutex);
+
+		// 未被数据源更新的传感器保持 NaN
+		m_snapshot.ClearValues();
+		m_snapshot.SetTimestamp(QDateTime::currentMSecsSinceEpoch());
+		m_snapshot.SetSequence(m_snapshot.Sequence() + 1);
+
+		for (auto& source : m_sources)
+			source->Update(m_snapshot);
+
+		for (auto consumer : m_consumers)
+			consumer->OnSnapshot(m_snapshot);
+
+		sequence = m_snapshot.Sequence();
+
+		// 复制而不是共享读数数组 否则下次 ClearValues 会分离并分配内存
+		QMutexLocker latestLock(&m_latestMutex);
+		m_latest.CopyFrom(m_snapshot);
+	}
+
+	emit snapshotUpdated(sequence);
+}
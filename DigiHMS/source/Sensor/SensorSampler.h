@@ -0,0 +1,146 @@
+﻿#pragma once
+
+#include <QObject>
+#include <QThread>
+#include <QMutex>
+#include <QVector>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+#include "SensorSnapshot.h"
+
+class QTimer;
+class SensorSource;
+class SensorConsumer;
+
+/// <summary>
+/// 传感器采样器
+/// <para>在独立的采样线程中按固定周期读取所有数据源, 并将快照分发给消费者</para>
+/// </summary>
+class SensorSampler : public QObject
+{
+	Q_OBJECT
+
+	Q_PROPERTY(qint32 period
+		READ Period
+		WRITE setPeriod
+		NOTIFY periodChanged)
+	Q_PROPERTY(bool running
+		READ IsRunning
+		NOTIFY runningChanged)
+
+	/**
+	*  只能通过 Instance() 获取 SensorSampler 实例
+	*/
+private:
+	explicit SensorSampler();
+	SensorSampler(SensorSampler&&) = delete;
+	SensorSampler(const SensorSampler&) = delete;
+	SensorSampler& operator=(SensorSampler&&) = delete;
+	SensorSampler& operator=(const SensorSampler&) = delete;
+	virtual ~SensorSampler();
+
+public:
+	/// <summary>
+	/// 获取 SensorSampler 单例
+	/// </summary>
+	/// <returns>SensorSampler 实例</returns>
+	static SensorSampler& Instance();
+
+	/// <summary>
+	/// 添加数据源 (接管所有权)
+	/// </summary>
+	/// <param name="source">数据源</param>
+	void AddSource(SensorSource* source);
+	/// <summary>
+	/// 添加快照消费者 (不接管所有权)
+	/// <para>消费者在采样线程中被调用</para>
+	/// </summary>
+	/// <param name="consumer">消费者</param>
+	void AddConsumer(SensorConsumer* consumer);
+	/// <summary>
+	/// 移除快照消费者
+	/// <para>返回后保证该消费者不会再被调用</para>
+	/// </summary>
+	/// <param name="consumer">消费者</param>
+	void RemoveConsumer(SensorConsumer* consumer);
+
+	/// <summary>
+	/// 获取采样周期 (毫秒)
+	/// </summary>
+	/// <returns>采样周期</returns>
+	qint32 Period() const;
+	/// <summary>
+	/// 获取采样器是否在运行
+	/// </summary>
+	/// <returns>运行状态</returns>
+	bool IsRunning() const;
+	/// <summary>
+	/// 获取最近一次采样的快照副本
+	/// </summary>
+	/// <returns>快照</returns>
+	SensorSnapshot LatestSnapshot() const;
+	/// <summary>
+	/// 直接读取最近一次采样的快照 (不复制)
+	/// <para>函数执行期间采样线程无法更新该快照, 函数中不要执行耗时操作或调用 SensorSampler</para>
+	/// </summary>
+	/// <param name="reader">读取函数</param>
+	void ReadLatest(const std::function<void(const SensorSnapshot&)>& reader) const;
+	/// <summary>
+	/// 获取采样线程 (用于将需要在采样线程中运行的对象移入)
+	/// </summary>
+	/// <returns>采样线程</returns>
+	QThread* Thread();
+	/// <summary>
+	/// 在采样线程中异步执行函数 (与采样串行, 不会与数据源的读取并发)
+	/// </summary>
+	/// <param name="function">函数</param>
+	void Post(const std::function<void()>& function);
+
+signals:
+	void periodChanged();
+	void runningChanged();
+	/// <summary>
+	/// 新的快照采样完成 (从采样线程发出)
+	/// </summary>
+	/// <param name="sequence">采样序号</param>
+	void snapshotUpdated(quint64 sequence);
+
+public slots:
+	/// <summary>
+	/// 启动采样线程
+	/// </summary>
+	void start();
+	/// <summary>
+	/// 停止采样线程
+	/// </summary>
+	void stop();
+	/// <summary>
+	/// 设置采样周期
+	/// </summary>
+	/// <param name="periodMs">采样周期 (毫秒)</param>
+	void setPeriod(qint32 periodMs);
+
+private:
+	/// <summary>
+	/// 执行一次采样 (在采样线程中)
+	/// </summary>
+	void sample();
+
+private:
+	QThread m_thread;
+	QTimer* m_timer;
+	std::atomic<qint32> m_period;
+
+	/// <summary>
+	/// 保护数据源与消费者列表 采样期间持有
+	/// </summary>
+	QMutex m_mutex;
+	std::vector<std::unique_ptr<SensorSource>> m_sources;
+	QVector<SensorConsumer*> m_consumers;
+	SensorSnapshot m_snapshot;
+
+	mutable QMutex m_latestMutex;
+	SensorSnapshot m_latest;
+};
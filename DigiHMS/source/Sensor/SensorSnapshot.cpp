@@ -0,0 +1,105 @@
+﻿#include "SensorSnapshot.h"
+#include <algorithm>
+#include <limits>
+
+SensorSnapshot::SensorSnapshot()
+	: m_timestamp(0)
+	, m_sequence(0)
+	, m_layoutVersion(0)
+{
+}
+
+qint32 SensorSnapshot::AddSensor(const QString& name, const QString& unit)
+{
+	auto it = m_slots.constFind(name);
+	if (it != m_slots.constEnd())
+		return it.value();
+
+	const auto slot = m_sensors.count();
+	m_sensors.append(SensorInfo{ name, unit });
+	m_values.append(std::numeric_limits<float>::quiet_NaN());
+	m_slots.insert(name, slot);
+	m_layoutVersion++;
+
+	return slot;
+}
+
+qint32 SensorSnapshot::Slot(const QString& name) const
+{
+	return m_slots.value(name, -1);
+}
+
+qint32 SensorSnapshot::Count() const
+{
+	return m_sensors.count();
+}
+
+const SensorInfo& SensorSnapshot::Info(qint32 slot) const
+{
+	return m_sensors.at(slot);
+}
+
+float SensorSnapshot::Value(qint32 slot) const
+{
+	if (slot >= 0 && slot < m_values.count())
+		return m_values.at(slot);
+
+	return std::numeric_limits<float>::quiet_NaN();
+}
+
+const float* SensorSnapshot::Values() const
+{
+	return m_values.constData();
+}
+
+void SensorSnapshot::SetValue(qint32 slot, float value)
+{
+	if (slot >= 0 && slot < m_values.count())
+		m_values[slot] = value;
+}
+
+void SensorSnapshot::ClearValues()
+{
+	m_values.fill(std::numeric_limits<float>::quiet_NaN());
+}
+
+qint64 SensorSnapshot::Timestamp() const
+{
+	return m_timestamp;
+}
+
+void SensorSnapshot::SetTimestamp(qint64 timestamp)
+{
+	m_timestamp = timestamp;
+}
+
+quint64 SensorSnapshot::Sequence() const
+{
+	return m_sequence;
+}
+
+void SensorSnapshot::SetSequence(quint64 sequence)
+{
+	m_sequence = sequence;
+}
+
+quint32 SensorSnapshot::LayoutVersion() const
+{
+	return m_layoutVersion;
+}
+
+void SensorSnapshot::CopyFrom(const SensorSnapshot& other)
+{
+	if (m_layoutVersion != other.m_layoutVersion || m_values.count() != other.m_values.count())
+	{
+		// 描述只在添加传感器时改变 可以共享
+		m_sensors = other.m_sensors;
+		m_slots = other.m_slots;
+		m_values.resize(other.m_values.count());
+		m_layoutVersion = other.m_layoutVersion;
+	}
+
+	std::copy(other.m_values.cbegin(), other.m_values.cend(), m_values.begin());
+	m_timestamp = other.m_timestamp;
+	m_sequence = other.m_sequence;
+}
\ No newline at end of file
@@ -0,0 +1,110 @@
+﻿#pragma once
+
+#include <QString>
+#include <QVector>
+#include <QHash>
+
+/// <summary>
+/// 传感器描述
+/// </summary>
+struct SensorInfo
+{
+	/// <summary>
+	/// 传感器名称 例如 cpu.load, storage.temp.Samsung SSD 970
+	/// </summary>
+	QString name;
+	/// <summary>
+	/// 单位 例如 %, °C, W, MHz, B/s
+	/// </summary>
+	QString unit;
+};
+
+/// <summary>
+/// 传感器快照
+/// <para>所有传感器按槽位 (slot) 平铺在连续数组中, 槽位一旦分配便不会改变</para>
+/// <para>没有读数的传感器值为 NaN</para>
+/// </summary>
+class SensorSnapshot
+{
+public:
+	SensorSnapshot();
+
+	/// <summary>
+	/// 添加传感器 已存在时返回原有槽位
+	/// </summary>
+	/// <param name="name">传感器名称</param>
+	/// <param name="unit">单位</param>
+	/// <returns>槽位</returns>
+	qint32 AddSensor(const QString& name, const QString& unit = QString());
+	/// <summary>
+	/// 根据名称查找槽位
+	/// </summary>
+	/// <param name="name">传感器名称</param>
+	/// <returns>槽位 不存在时返回 -1</returns>
+	qint32 Slot(const QString& name) const;
+	/// <summary>
+	/// 获取传感器数量
+	/// </summary>
+	/// <returns>传感器数量</returns>
+	qint32 Count() const;
+	/// <summary>
+	/// 获取传感器描述
+	/// </summary>
+	/// <param name="slot">槽位</param>
+	/// <returns>传感器描述</returns>
+	const SensorInfo& Info(qint32 slot) const;
+	/// <summary>
+	/// 获取传感器读数
+	/// </summary>
+	/// <param name="slot">槽位</param>
+	/// <returns>读数</returns>
+	float Value(qint32 slot) const;
+	/// <summary>
+	/// 获取所有读数的连续数组
+	/// </summary>
+	/// <returns>读数数组</returns>
+	const float* Values() const;
+	/// <summary>
+	/// 设置传感器读数
+	/// </summary>
+	/// <param name="slot">槽位</param>
+	/// <param name="value">读数</param>
+	void SetValue(qint32 slot, float value);
+	/// <summary>
+	/// 将所有读数置为 NaN
+	/// </summary>
+	void ClearValues();
+
+	/// <summary>
+	/// 获取采样时间戳 (自 1970 年起的毫秒数)
+	/// </summary>
+	/// <returns>时间戳</returns>
+	qint64 Timestamp() const;
+	void SetTimestamp(qint64 timestamp);
+	/// <summary>
+	/// 获取采样序号
+	/// </summary>
+	/// <returns>采样序号</returns>
+	quint64 Sequence() const;
+	void SetSequence(quint64 sequence);
+	/// <summary>
+	/// 获取槽位布局版本 每次添加新的传感器时递增
+	/// </summary>
+	/// <returns>布局版本</returns>
+	quint32 LayoutVersion() const;
+	/// <summary>
+	/// 将读数复制到本快照已有的存储中 (不与源快照共享读数数组)
+	/// <para>布局未变化时不分配内存, 否则同时复制传感器描述</para>
+	/// </summary>
+	/// <param name="other">源快照</param>
+	void CopyFrom(const SensorSnapshot& other);
+
+private:
+	QVector<SensorInfo> m_sensors;
+	QHash<QString, qint32> m_slots;
+	QVector<float> m_values;
+
+	qint64 m_timestamp;
+	quint64 m_sequence;
+	quint32 m_layoutVersion;
+};
@@ -0,0 +1,44 @@
+﻿#pragma once
+
+#include <QString>
+
+class SensorSnapshot;
+
+/// <summary>
+/// 传感器数据源接口
+/// <para>在采样线程中被调用, 将最新读数写入快照</para>
+/// </summary>
+class SensorSource
+{
+public:
+	virtual ~SensorSource() {}
+
+	/// <summary>
+	/// 获取数据源名称
+	/// </summary>
+	/// <returns>数据源名称</returns>
+	virtual QString Name() const = 0;
+	/// <summary>
+	/// 读取传感器并更新快照
+	/// <para>首次出现的传感器通过 SensorSnapshot::AddSensor 注册槽位</para>
+	/// </summary>
+	/// <param name="snapshot">快照</param>
+	/// <returns>是否读取成功</returns>
+	virtual bool Update(SensorSnapshot& snapshot) = 0;
+};
+
+/// <summary>
+/// 快照消费者接口
+/// <para>在采样线程中被调用, 实现必须快速返回且不得阻塞</para>
+/// </summary>
+class SensorConsumer
+{
+public:
+	virtual ~SensorConsumer() {}
+
+	/// <summary>
+	/// 新的快照采样完成
+	/// </summary>
+	/// <param name="snapshot">快照</param>
+	virtual void OnSnapshot(const SensorSnapshot& snapshot) = 0;
+};
@@ -0,0 +1,81 @@
+﻿#include "SnapshotPublisher.h"
+#include "SensorSnapshot.h"
+
+#ifdef DIGIHMS_WITH_SHM
+#include <SharedSnapshot.h>
+#else
+// 未启用时只需要完整类型以析构 unique_ptr
+class SharedSnapshotWriter
+{
+};
+#endif
+
+SnapshotPublisher::SnapshotPublisher()
+	: m_layoutVersion(0)
+	, m_hasLayout(false)
+{
+}
+
+SnapshotPublisher::~SnapshotPublisher()
+{
+	Close();
+}
+
+bool SnapshotPublisher::Open(const char* name)
+{
+#ifdef DIGIHMS_WITH_SHM
+	Close();
+
+	auto writer = std::make_unique<SharedSnapshotWriter>();
+	if (!writer->Open(name ? name : SharedSnapshotFormat::DefaultName))
+		return false;
+
+	m_writer = std::move(writer);
+	m_hasLayout = false;
+	return true;
+#else
+	Q_UNUSED(name);
+	return false;
+#endif
+}
+
+void SnapshotPublisher::Close()
+{
+	m_writer.reset();
+}
+
+bool SnapshotPublisher::IsOpen() const
+{
+	return m_writer != Q_NULLPTR;
+}
+
+void SnapshotPublisher::OnSnapshot(const SensorSnapshot& snapshot)
+{
+#ifdef DIGIHMS_WITH_SHM
+	if (!m_writer)
+		return;
+
+	const auto count = static_cast<quint32>(snapshot.Count());
+	m_writer->Begin();
+
+	// 布局变化 (新的传感器) 时才改写目录
+	if (!m_hasLayout || snapshot.LayoutVersion() != m_layoutVersion)
+	{
+		for (quint32 slot = 0; slot < count && slot < m_writer->Capacity(); ++slot)
+		{
+			const auto& info = snapshot.Info(static_cast<qint32>(slot));
+			m_writer->SetEntry(slot, info.name.toUtf8().constData(), info.unit.toUtf8().constData());
+		}
+
+		m_writer->SetLayout(snapshot.LayoutVersion(), count);
+		m_layoutVersion = snapshot.LayoutVersion();
+		m_hasLayout = true;
+	}
+
+	m_writer->SetValues(snapshot.Values(), count);
+	m_writer->SetSample(snapshot.Timestamp(), snapshot.Sequence());
+	m_writer->Commit();
+#else
+	Q_UNUSED(snapshot);
+#endif
+}
@@ -0,0 +1,41 @@
+﻿#pragma once
+
+#include "SensorSource.h"
+#include <memory>
+
+class SharedSnapshotWriter;
+
+/// <summary>
+/// 将快照发布到共享内存 供本机其他进程读取 (POSIX shm, 需要 DIGIHMS_WITH_SHM)
+/// <para>格式见 SharedSnapshot/include/SharedSnapshotFormat.h, 读取方使用 SharedSnapshotReader</para>
+/// <para>每次采样只复制读数数组, 目录仅在快照布局版本变化时改写; 读取方不加锁, 不影响采样线程</para>
+/// </summary>
+class SnapshotPublisher : public SensorConsumer
+{
+public:
+	SnapshotPublisher();
+	virtual ~SnapshotPublisher();
+
+	/// <summary>
+	/// 创建共享内存
+	/// </summary>
+	/// <param name="name">共享内存名称 为空时使用默认名称</param>
+	/// <returns>是否成功 (未启用 DIGIHMS_WITH_SHM 时返回 false)</returns>
+	bool Open(const char* name = Q_NULLPTR);
+	void Close();
+	bool IsOpen() const;
+
+	/**
+	 * SensorConsumer 接口
+	 */
+public:
+	void OnSnapshot(const SensorSnapshot& snapshot) override;
+
+private:
+	std::unique_ptr<SharedSnapshotWriter> m_writer;
+	/// <summary>
+	/// 已写入共享内存的布局版本
+	/// </summary>
+	quint32 m_layoutVersion;
+	bool m_hasLayout;
+};
@@ -2,12 +2,11 @@
 #include <QScreen>
 #include <QApplication>
 #include <QMenu>
-#include <QSvgRenderer>
-#include <QPainter>
 
 TrayIcon::TrayIcon(QObject *parent)
 	: QObject(parent)
 	, m_Parent(parent)
+	, m_Renderer(":/DigiHMS/icons/TestSvg.svg")
 {
 	Init();
 }
@@ -36,11 +35,31 @@ void TrayIcon::SetIcon(QIcon& icon)
 	}
 }
 
+QMenu* TrayIcon::Menu() const
+{
+	return m_Menu;
+}
+
 void TrayIcon::ShowMessage(const QString& message)
 {
 	m_TrayIcon->showMessage(tr("DigiHMS Notification"), message);
 }
 
+void TrayIcon::SetText(const QString& text)
+{
+	if (text == m_Text)
+		return;
+
+	m_Text = text;
+	UpdateIcon();
+}
+
+void TrayIcon::SetToolTip(const QString& text)
+{
+	if (text != m_TrayIcon->toolTip())
+		m_TrayIcon->setToolTip(text);
+}
+
 void TrayIcon::onTrayIconActivated(QSystemTrayIcon::ActivationReason reason)
 {
 	if (reason == QSystemTrayIcon::DoubleClick)
@@ -63,24 +82,25 @@ void TrayIcon::Init()
 	m_TrayIcon->setToolTip(tr("DigiHMS"));
 	m_TrayIcon->show();
 
-	QRect rect = m_TrayIcon->geometry();
+	UpdateIcon();
 
+	// 像素比变化时按新尺寸重新栅格化 (每种尺寸只栅格化一次)
 	QScreen* screen = QApplication::primaryScreen();
+	connect(screen, &QScreen::logicalDotsPerInchChanged, this, &TrayIcon::UpdateIcon);
 
-	qint32 minSize = qMin(rect.width(), rect.height());
-	minSize = minSize ? minSize : 48;
-	minSize *= screen->devicePixelRatio();
+	connect(m_TrayIcon, &QSystemTrayIcon::activated, this, &TrayIcon::onTrayIconActivated);
+}
 
-	QPixmap pixmap(minSize, minSize);
-	pixmap.fill(Qt::transparent);
+void TrayIcon::UpdateIcon()
+{
+	QRect rect = m_TrayIcon->geometry();
 
-	QSvgRenderer renderer(QString(":/DigiHMS/icons/TestSvg.svg"));
-	QPainter painter(&pixmap);
-	renderer.render(&painter);
+	QScreen* screen = QApplication::primaryScreen();
 
-	QIcon icon(pixmap);
-	icon.setIsMask(true);
-	m_TrayIcon->setIcon(icon);
+	qint32 minSize = qMin(rect.width(), rect.height());
+	minSize = minSize ? minSize : 48;
 
-	connect(m_TrayIcon, &QSystemTrayIcon::activated, this, &TrayIcon::onTrayIconActivated);
+	QIcon icon;
+	if (m_Renderer.Render(m_Text, minSize, screen->devicePixelRatio(), icon))
+		m_TrayIcon->setIcon(icon);
 }
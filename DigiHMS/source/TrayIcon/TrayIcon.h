@@ -2,6 +2,7 @@
 
 #include <QObject>
 #include <QSystemTrayIcon>
+#include "TrayRenderer.h"
 
 class TrayIcon  : public QObject
 {
@@ -15,16 +16,31 @@ public:
 	virtual void AddAction(const QString& text, QObject* receiver, const char* member);
 	virtual void AddSeparator();
 	virtual void SetIcon(QIcon& icon);
+	virtual QMenu* Menu() const;
 
 public slots:
 	virtual void ShowMessage(const QString& message);
+	/// <summary>
+	/// 在图标上显示实时数值 为空时恢复默认图标
+	/// <para>文本未变化时不会重新生成图标</para>
+	/// </summary>
+	/// <param name="text">显示文本</param>
+	virtual void SetText(const QString& text);
+	/// <summary>
+	/// 设置工具提示 文本未变化时不会更新
+	/// </summary>
+	/// <param name="text">工具提示</param>
+	virtual void SetToolTip(const QString& text);
 	virtual void onTrayIconActivated(QSystemTrayIcon::ActivationReason reason);
 
 private:
 	void Init();
+	void UpdateIcon();
 
 private:
 	QObject* m_Parent;
 	QSystemTrayIcon* m_TrayIcon;
 	QMenu* m_Menu;
+	TrayRenderer m_Renderer;
+	QString m_Text;
 };
@@ -0,0 +1,224 @@
+﻿#include "TrayMenuModel.h"
+#include "TrayIcon.h"
+#include <IO/Manager/Manager.h>
+#include <IO/Serial/Serial.h>
+#include <Common/TimerEvents.h>
+#include <Common/NotifyCoalescer.h>
+#include <Sensor/SensorSampler.h>
+#include <QAction>
+#include <QMenu>
+#include <QtMath>
+
+namespace
+{
+	/// <summary>
+	/// 刷新周期 (毫秒)
+	/// </summary>
+	const qint32 RefreshInterval = 250;
+
+	const QString PortPrefix = "port:";
+	const QString SensorPrefix = "sensor:";
+}
+
+TrayMenuModel::TrayMenuModel(TrayIcon* trayIcon, const QStringList& sensors)
+	: QObject(trayIcon)
+	, m_trayIcon(trayIcon)
+	, m_menu(trayIcon->Menu())
+	, m_anchor(Q_NULLPTR)
+	, m_sensors(sensors)
+	, m_consumerId(0)
+	, m_dirty(true)
+	, m_updates(0)
+{
+	// 模型条目始终位于菜单顶部
+	m_anchor = new QAction(this);
+	m_anchor->setSeparator(true);
+	m_menu->insertAction(m_menu->actions().value(0, Q_NULLPTR), m_anchor);
+
+	// 设备状态变化经合并后每帧最多通知一次
+	auto& coalescer = NotifyCoalescer::Instance();
+	auto serial = &Serial::Instance();
+	coalescer.Connect(serial, &Serial::availablePortsChanged, this, [this]() { invalidate(); });
+	coalescer.Connect(serial, &Serial::portIndexChanged, this, [this]() { invalidate(); });
+	coalescer.Connect(&Manager::Instance(), &Manager::connectedChanged, this, [this]() { invalidate(); });
+	coalescer.Connect(&Manager::Instance(), &Manager::connectingChanged, this, [this]() { invalidate(); });
+	if (!m_sensors.isEmpty())
+		connect(&SensorSampler::Instance(), &SensorSampler::snapshotUpdated, this, &TrayMenuModel::invalidate);
+
+	m_consumerId = TimerEvents::Instance().RegisterConsumer("TrayMenu", RefreshInterval, [this]() {
+		flush();
+	});
+}
+
+TrayMenuModel::~TrayMenuModel()
+{
+	TimerEvents::Instance().UnregisterConsumer(m_consumerId);
+}
+
+qint64 TrayMenuModel::ActionUpdates() const
+{
+	return m_updates;
+}
+
+void TrayMenuModel::invalidate()
+{
+	if (m_dirty)
+		return;
+
+	m_dirty = true;
+	TimerEvents::Instance().SetConsumerActive(m_consumerId, true);
+}
+
+void TrayMenuModel::flush()
+{
+	// 没有变化时停止刷新 直到下一次 invalidate
+	TimerEvents::Instance().SetConsumerActive(m_consumerId, false);
+	if (!m_dirty)
+		return;
+
+	m_dirty = false;
+
+	QString toolTip;
+	apply(build(toolTip));
+	m_trayIcon->SetToolTip(toolTip);
+}
+
+QVector<TrayMenuModel::Item> TrayMenuModel::build(QString& toolTip) const
+{
+	QVector<Item> items;
+
+	// 串口列表 第一个元素为 "Select port" 占位项
+	const auto& serial = Serial::Instance();
+	const auto ports = serial.PortList();
+	const auto connected = Manager::Instance().Connected()
+		&& Manager::Instance().GetSelectedDriver() == Manager::SelectedDriver::Serial;
+
+	for (auto i = 1; i < ports.count(); ++i)
+	{
+		const auto current = connected && serial.PortIndex() == i;
+		items.append(Item{ PortPrefix + ports.at(i), ports.at(i), false, true, true, current });
+	}
+	if (ports.count() <= 1)
+		items.append(Item{ PortPrefix, tr("No serial ports"), false, false, false, false });
+
+	toolTip = tr("DigiHMS");
+	if (connected)
+		toolTip += " - " + serial.PortName();
+	else if (Manager::Instance().Connecting())
+		toolTip += " - " + tr("Connecting...");
+
+	if (m_sensors.isEmpty())
+		return items;
+
+	// 传感器读数来自采样器缓存的最新快照
+	items.append(Item{ "separator:sensors", QString(), true, true, false, false });
+
+	const auto snapshot = SensorSampler::Instance().LatestSnapshot();
+	for (const auto& name : m_sensors)
+	{
+		const auto slot = snapshot.Slot(name);
+		const auto value = slot < 0 ? qQNaN() : snapshot.Value(slot);
+
+		QString text;
+		if (qIsNaN(value))
+			text = QString("%1: -").arg(name);
+		else
+			text = QString("%1: %2 %3").arg(name).arg(value, 0, 'f', 1).arg(snapshot.Info(slot).unit);
+
+		items.append(Item{ SensorPrefix + name, text, false, false, false, false });
+		toolTip += '\n' + text;
+	}
+
+	return items;
+}
+
+void TrayMenuModel::apply(const QVector<Item>& items)
+{
+	// 条目顺序不变时只更新发生变化的属性
+	bool sameLayout = items.count() == m_items.count();
+	for (auto i = 0; sameLayout && i < items.count(); ++i)
+		sameLayout = items.at(i).key == m_items.at(i).key;
+
+	if (!sameLayout)
+	{
+		QHash<QString, QAction*> actions;
+		for (const auto& item : items)
+		{
+			auto action = m_actions.take(item.key);
+			if (action == Q_NULLPTR)
+				action = createAction(item);
+
+			actions.insert(item.key, action);
+
+			// 已在菜单中的 QAction 会被移动到新位置
+			m_menu->insertAction(m_anchor, action);
+		}
+
+		// 不再存在的条目
+		for (auto action : m_actions)
+		{
+			m_menu->removeAction(action);
+			action->deleteLater();
+		}
+
+		m_actions = actions;
+	}
+
+	for (const auto& item : items)
+	{
+		auto action = m_actions.value(item.key);
+		if (action->text() != item.text)
+		{
+			action->setText(item.text);
+			m_updates++;
+		}
+		if (action->isEnabled() != item.enabled)
+			action->setEnabled(item.enabled);
+		if (action->isChecked() != item.checked)
+			action->setChecked(item.checked);
+	}
+
+	m_items = items;
+}
+
+QAction* TrayMenuModel::createAction(const Item& item)
+{
+	auto action = new QAction(item.text, this);
+	action->setSeparator(item.separator);
+	action->setCheckable(item.checkable);
+
+	const auto key = item.key;
+	connect(action, &QAction::triggered, this, [this, key]() {
+		triggered(key);
+	});
+
+	m_updates++;
+	return action;
+}
+
+void TrayMenuModel::triggered(const QString& key)
+{
+	if (!key.startsWith(PortPrefix) || key.length() == PortPrefix.length())
+		return;
+
+	// 再次点击当前连接的串口时断开连接
+	auto& manager = Manager::Instance();
+	auto& serial = Serial::Instance();
+	const auto index = serial.PortList().indexOf(key.mid(PortPrefix.length()));
+	if (index <= 0)
+		return;
+
+	const auto current = (manager.Connected() || manager.Connecting())
+		&& manager.GetSelectedDriver() == Manager::SelectedDriver::Serial
+		&& serial.PortIndex() == index;
+
+	manager.disconnectDriver();
+	if (!current)
+	{
+		manager.setSelectedDriver(Manager::SelectedDriver::Serial);
+		serial.setPortIndex(index);
+		manager.connectDevice();
+	}
+
+	invalidate();
+}
@@ -0,0 +1,80 @@
+﻿#pragma once
+
+#include <QObject>
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+class QMenu;
+class QAction;
+class TrayIcon;
+
+/// <summary>
+/// 托盘菜单模型
+/// <para>菜单顶部列出串口设备 (Serial::PortList) 与所选传感器的最新读数</para>
+/// <para>状态变化只标记为脏, 由 TimerEvents 以最多 4 Hz 的频率合并刷新</para>
+/// <para>刷新时与上一次的状态比较, 只更新发生变化的 QAction 与工具提示</para>
+/// <para>打开菜单不会枚举串口或读取传感器, 所有数据均来自缓存</para>
+/// </summary>
+class TrayMenuModel : public QObject
+{
+	Q_OBJECT
+
+public:
+	/// <summary>
+	/// 构造菜单模型
+	/// </summary>
+	/// <param name="trayIcon">托盘图标 (模型的条目插入到菜单顶部)</param>
+	/// <param name="sensors">显示读数的传感器名称</param>
+	TrayMenuModel(TrayIcon* trayIcon, const QStringList& sensors);
+	virtual ~TrayMenuModel();
+
+	/// <summary>
+	/// 获取累计更新的 QAction 数量 (用于诊断)
+	/// </summary>
+	/// <returns>更新次数</returns>
+	qint64 ActionUpdates() const;
+
+public slots:
+	/// <summary>
+	/// 标记需要刷新 在下一个刷新周期生效
+	/// </summary>
+	void invalidate();
+
+private:
+	/// <summary>
+	/// 菜单条目 key 在模型内唯一
+	/// </summary>
+	struct Item
+	{
+		QString key;
+		QString text;
+		bool separator;
+		bool enabled;
+		bool checkable;
+		bool checked;
+	};
+
+	void flush();
+	QVector<Item> build(QString& toolTip) const;
+	void apply(const QVector<Item>& items);
+	QAction* createAction(const Item& item);
+	void triggered(const QString& key);
+
+private:
+	TrayIcon* m_trayIcon;
+	QMenu* m_menu;
+	/// <summary>
+	/// 模型条目插入在该分隔符之前 其后为通过 TrayIcon::AddAction 添加的条目
+	/// </summary>
+	QAction* m_anchor;
+	QStringList m_sensors;
+
+	QVector<Item> m_items;
+	QHash<QString, QAction*> m_actions;
+
+	qint32 m_consumerId;
+	bool m_dirty;
+	qint64 m_updates;
+};
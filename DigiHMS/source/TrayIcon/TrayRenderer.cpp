@@ -0,0 +1,151 @@
+﻿#include "TrayRenderer.h"
+#include <QFont>
+#include <QFontMetrics>
+#include <QPainter>
+#include <QSvgRenderer>
+#include <QtMath>
+
+const QString TrayRenderer::Glyphs = QString::fromUtf8("0123456789.-%°CkMG");
+
+TrayRenderer::TrayRenderer(const QString& svgPath)
+	: m_svgPath(svgPath)
+	, m_textColor(Qt::white)
+	, m_pixels(0)
+{
+
+}
+
+void TrayRenderer::SetTextColor(const QColor& color)
+{
+	if (color == m_textColor)
+		return;
+
+	m_textColor = color;
+	m_atlases.clear();
+	Invalidate();
+}
+
+bool TrayRenderer::Render(const QString& text, qint32 size, qreal ratio, QIcon& icon)
+{
+	const auto pixels = qMax(16, qCeil(size * ratio));
+
+	// 文本与尺寸都未变化时不生成新图标
+	if (pixels == m_pixels && text == m_text)
+		return false;
+
+	m_pixels = pixels;
+	m_text = text;
+
+	const auto& cache = atlas(pixels);
+	if (text.isEmpty())
+	{
+		icon = QIcon(cache.base);
+		icon.setIsMask(true);
+	}
+	else
+	{
+		compose(cache, text, pixels, ratio, icon);
+	}
+
+	return true;
+}
+
+void TrayRenderer::Invalidate()
+{
+	m_pixels = 0;
+	m_text.clear();
+}
+
+qint32 TrayRenderer::AtlasCount() const
+{
+	return m_atlases.count();
+}
+
+const TrayRenderer::Atlas& TrayRenderer::atlas(qint32 pixels)
+{
+	auto it = m_atlases.find(pixels);
+	if (it != m_atlases.end())
+		return it.value();
+
+	Atlas cache;
+
+	// SVG 底图
+	cache.base = QPixmap(pixels, pixels);
+	cache.base.fill(Qt::transparent);
+	{
+		QSvgRenderer renderer(m_svgPath);
+		QPainter painter(&cache.base);
+		renderer.render(&painter);
+	}
+
+	// 字形图集: 所有字形横向排列在一张图中 高度为图标的 3/4
+	QFont font;
+	font.setBold(true);
+	font.setPixelSize(qMax(8, pixels * 3 / 4));
+	const QFontMetrics metrics(font);
+
+	cache.height = metrics.height();
+	qint32 width = 0;
+	for (const auto& glyph : Glyphs)
+	{
+		const auto advance = metrics.horizontalAdvance(glyph);
+		cache.tiles.append(qMakePair(width, advance));
+		width += advance;
+	}
+
+	cache.glyphs = QImage(qMax(width, 1), cache.height, QImage::Format_ARGB32_Premultiplied);
+	cache.glyphs.fill(Qt::transparent);
+	{
+		QPainter painter(&cache.glyphs);
+		painter.setRenderHint(QPainter::TextAntialiasing);
+		painter.setFont(font);
+		painter.setPen(m_textColor);
+		for (auto i = 0; i < Glyphs.length(); ++i)
+			painter.drawText(cache.tiles.at(i).first, metrics.ascent(), QString(Glyphs.at(i)));
+	}
+
+	return m_atlases.insert(pixels, cache).value();
+}
+
+void TrayRenderer::compose(const Atlas& atlas, const QString& text, qint32 pixels, qreal ratio, QIcon& icon)
+{
+	if (m_canvas.width() != pixels)
+		m_canvas = QImage(pixels, pixels, QImage::Format_ARGB32_Premultiplied);
+	m_canvas.fill(Qt::transparent);
+
+	// 计算拼接后的总宽度
+	qint32 width = 0;
+	for (const auto& ch : text)
+	{
+		const auto index = Glyphs.indexOf(ch);
+		if (index >= 0)
+			width += atlas.tiles.at(index).second;
+	}
+
+	if (width > 0)
+	{
+		// 超出图标宽度时整体缩小 否则水平居中
+		const auto scale = width > pixels ? qreal(pixels) / width : 1.0;
+		const auto height = atlas.height * scale;
+		qreal x = (pixels - width * scale) / 2;
+		const qreal y = (pixels - height) / 2;
+
+		QPainter painter(&m_canvas);
+		painter.setRenderHint(QPainter::SmoothPixmapTransform, scale < 1.0);
+		for (const auto& ch : text)
+		{
+			const auto index = Glyphs.indexOf(ch);
+			if (index < 0)
+				continue;
+
+			const auto& tile = atlas.tiles.at(index);
+			const QRectF target(x, y, tile.second * scale, height);
+			painter.drawImage(target, atlas.glyphs, QRectF(tile.first, 0, tile.second, atlas.height));
+			x += target.width();
+		}
+	}
+
+	auto pixmap = QPixmap::fromImage(m_canvas);
+	pixmap.setDevicePixelRatio(ratio);
+	icon = QIcon(pixmap);
+}
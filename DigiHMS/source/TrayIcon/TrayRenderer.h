@@ -0,0 +1,85 @@
+﻿#pragma once
+
+#include <QColor>
+#include <QHash>
+#include <QIcon>
+#include <QImage>
+#include <QPair>
+#include <QPixmap>
+#include <QString>
+#include <QVector>
+
+/// <summary>
+/// 托盘图标渲染器
+/// <para>SVG 底图与字形图集 (数字与常用符号) 在每种尺寸 / 像素比下只栅格化一次</para>
+/// <para>实时数值图标由缓存的字形拼接而成, 只有显示文本或尺寸变化时才生成新的图标</para>
+/// </summary>
+class TrayRenderer
+{
+public:
+	/// <summary>
+	/// 构造渲染器
+	/// </summary>
+	/// <param name="svgPath">底图 SVG 路径</param>
+	explicit TrayRenderer(const QString& svgPath);
+
+	/// <summary>
+	/// 图集包含的字形 其他字符被忽略
+	/// </summary>
+	static const QString Glyphs;
+
+	/// <summary>
+	/// 设置字形颜色 (清空已缓存的图集)
+	/// </summary>
+	/// <param name="color">颜色</param>
+	void SetTextColor(const QColor& color);
+	/// <summary>
+	/// 渲染图标
+	/// </summary>
+	/// <param name="text">显示文本 为空时显示 SVG 底图</param>
+	/// <param name="size">图标边长 (逻辑像素)</param>
+	/// <param name="ratio">设备像素比</param>
+	/// <param name="icon">输出图标 (未变化时不修改)</param>
+	/// <returns>图标是否需要更新</returns>
+	bool Render(const QString& text, qint32 size, qreal ratio, QIcon& icon);
+	/// <summary>
+	/// 使下一次 Render 必定生成新图标
+	/// </summary>
+	void Invalidate();
+	/// <summary>
+	/// 获取已栅格化的图集数量 (用于诊断)
+	/// </summary>
+	/// <returns>图集数量</returns>
+	qint32 AtlasCount() const;
+
+private:
+	/// <summary>
+	/// 单一尺寸下的缓存
+	/// </summary>
+	struct Atlas
+	{
+		QPixmap base;
+		QImage glyphs;
+		/// <summary>
+		/// 每个字形在图集中的横向偏移与宽度
+		/// </summary>
+		QVector<QPair<qint32, qint32>> tiles;
+		qint32 height;
+	};
+
+	const Atlas& atlas(qint32 pixels);
+	void compose(const Atlas& atlas, const QString& text, qint32 pixels, qreal ratio, QIcon& icon);
+
+private:
+	QString m_svgPath;
+	QColor m_textColor;
+	QHash<qint32, Atlas> m_atlases;
+
+	/// <summary>
+	/// 拼接使用的画布 尺寸不变时复用
+	/// </summary>
+	QImage m_canvas;
+
+	QString m_text;
+	qint32 m_pixels;
+};
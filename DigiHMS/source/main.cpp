@@ -2,6 +2,7 @@
 #include <QSerialPort>
 #include <QSerialPortInfo>
 #include "Common/Utilities.h"
+#include "Common/Trace.h"
 #include "DigiHMS.h"
 
 
@@ -14,5 +15,13 @@ int32_t main(int32_t argc, char* argv[])
 
 	DigiHMS w;
 
-	return a.exec();
+	auto result = a.exec();
+
+#ifdef DIGIHMS_ENABLE_TRACE
+	// 退出时导出追踪数据 可通过环境变量 DIGIHMS_TRACE_FILE 指定路径
+	auto tracePath = qEnvironmentVariable("DIGIHMS_TRACE_FILE", "DigiHMS.trace.json");
+	Trace::ExportChromeJson(tracePath.toStdString());
+#endif
+
+	return result;
 }
\ No newline at end of file
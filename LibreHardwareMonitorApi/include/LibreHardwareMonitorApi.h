@@ -4,6 +4,7 @@
 #include <memory>
 #include <string>
 #include <map>
+#include <cstdint>
 
 namespace LibreHardwareMonitorApi
 {
@@ -45,6 +46,20 @@ namespace LibreHardwareMonitorApi
 		virtual std::map<std::wstring, std::pair<float, float>>& GetAllNetworkSpeed() = 0;
 
 		virtual bool SetFanSpeed(const std::wstring& name, float percent) = 0;
+		/// <summary>
+		/// 按名称查找风扇控制 结果被缓存, 之后按句柄设置转速不再遍历硬件
+		/// <para>启用或禁用主板 / CPU / GPU 后缓存失效, 旧句柄的 SetFanSpeed 返回 false</para>
+		/// </summary>
+		/// <param name="name">控制传感器名称</param>
+		/// <returns>控制句柄 未找到时返回 -1</returns>
+		virtual int32_t FindFanControl(const std::wstring& name) = 0;
+		/// <summary>
+		/// 按句柄设置风扇转速
+		/// </summary>
+		/// <param name="handle">FindFanControl 返回的句柄</param>
+		/// <param name="percent">转速百分比 -1 表示恢复默认控制</param>
+		/// <returns>句柄是否有效</returns>
+		virtual bool SetFanSpeed(int32_t handle, float percent) = 0;
 
 		virtual void SetMainboardEnable(bool enable) = 0;
 		virtual void SetCpuEnable(bool enable) = 0;
@@ -53,6 +53,8 @@ namespace LibreHardwareMonitorApi
 		virtual std::map<std::wstring, std::pair<float, float>>& GetAllNetworkSpeed() override;				// B/s
 
 		virtual bool SetFanSpeed(const std::wstring& name, float percent) override;
+		virtual int32_t FindFanControl(const std::wstring& name) override;
+		virtual bool SetFanSpeed(int32_t handle, float percent) override;
 
 		virtual void SetMainboardEnable(bool enable) override;
 		virtual void SetCpuEnable(bool enable) override;
@@ -95,6 +97,8 @@ namespace LibreHardwareMonitorApi
 
 		bool NetworkSpeed(IHardware^ hardware, std::pair<float, float>& speed);
 
+		IControl^ FindControl(String^ name);
+
 	private:
 		std::wstring m_MainboardName{};
 		float m_MainboardTemperature{};
@@ -152,6 +156,8 @@ namespace LibreHardwareMonitorApi
 		void Init()
 		{
 			updateVisitor = gcnew UpdateVisitor();
+			controls = gcnew System::Collections::Generic::Dictionary<int32_t, IControl^>();
+			controlHandles = gcnew System::Collections::Generic::Dictionary<String^, int32_t>();
 			computer = gcnew Computer();
 			computer->IsMotherboardEnabled = true;
 			computer->IsCpuEnabled = true;
@@ -164,11 +170,24 @@ namespace LibreHardwareMonitorApi
 
 		void UnInit()
 		{
+			ResetControls();
 			computer->Close();
 		}
 
+		/// <summary>
+		/// 硬件重新打开后控制对象失效 清空缓存 (句柄不会被复用)
+		/// </summary>
+		void ResetControls()
+		{
+			controls->Clear();
+			controlHandles->Clear();
+		}
+
 		Computer^ computer;
 		UpdateVisitor^ updateVisitor{};
+		System::Collections::Generic::Dictionary<int32_t, IControl^>^ controls;
+		System::Collections::Generic::Dictionary<String^, int32_t>^ controlHandles;
+		int32_t nextControlHandle{};
 
 	private:
 		static MonitorGlobal^ m_Instance{};
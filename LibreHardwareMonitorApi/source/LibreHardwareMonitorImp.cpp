@@ -273,9 +273,50 @@ namespace LibreHardwareMonitorApi
 
 	bool CLibreHardwareMonitor::SetFanSpeed(const std::wstring& name, float percent)
 	{
-		auto computer = MonitorGlobal::Instance()->computer;
+		auto handle = FindFanControl(name);
+		if (handle < 0)
+			return false;
+
+		return SetFanSpeed(handle, percent);
+	}
+
+	int32_t CLibreHardwareMonitor::FindFanControl(const std::wstring& name)
+	{
+		auto global = MonitorGlobal::Instance();
 		String^ clrName = gcnew String(name.c_str());
 
+		int32_t handle = -1;
+		if (global->controlHandles->TryGetValue(clrName, handle))
+			return handle;
+
+		auto control = FindControl(clrName);
+		if (control == nullptr)
+			return -1;
+
+		handle = global->nextControlHandle++;
+		global->controls->Add(handle, control);
+		global->controlHandles->Add(clrName, handle);
+		return handle;
+	}
+
+	bool CLibreHardwareMonitor::SetFanSpeed(int32_t handle, float percent)
+	{
+		IControl^ control = nullptr;
+		if (!MonitorGlobal::Instance()->controls->TryGetValue(handle, control))
+			return false;
+
+		if (percent == -1)
+			control->SetDefault();
+		else
+			control->SetSoftware(percent);
+
+		return true;
+	}
+
+	IControl^ CLibreHardwareMonitor::FindControl(String^ name)
+	{
+		auto computer = MonitorGlobal::Instance()->computer;
+
 		for (int32_t i = 0; i < computer->Hardware->Count; i++)
 		{
 			if (computer->Hardware[i]->SubHardware->Length > 0)
@@ -285,46 +326,32 @@ namespace LibreHardwareMonitorApi
 					auto subHardware = computer->Hardware[i]->SubHardware[j];
 					for each (auto item in subHardware->Sensors)
 					{
-						if (item->SensorType == SensorType::Control && item->Name == clrName)
-						{
-							if (percent == -1)
-							{
-								item->Control->SetDefault();
-								return true;
-							}
-							item->Control->SetSoftware(percent);
-							return true;
-						}
+						if (item->SensorType == SensorType::Control && item->Name == name)
+							return item->Control;
 					}
 				}
 			}
-			
+
 			for each (auto item in computer->Hardware[i]->Sensors)
 			{
-				if (item->SensorType == SensorType::Control && item->Name == clrName)
-				{
-					if (percent == -1)
-					{
-						item->Control->SetDefault();
-						return true;
-					}
-					item->Control->SetSoftware(percent);
-					return true;
-				}
+				if (item->SensorType == SensorType::Control && item->Name == name)
+					return item->Control;
 			}
 		}
 
-		return false;
+		return nullptr;
 	}
 
 	void CLibreHardwareMonitor::SetMainboardEnable(bool enable)
 	{
 		MonitorGlobal::Instance()->computer->IsMotherboardEnabled = enable;
+		MonitorGlobal::Instance()->ResetControls();
 	}
 
 	void CLibreHardwareMonitor::SetCpuEnable(bool enable)
 	{
 		MonitorGlobal::Instance()->computer->IsCpuEnabled = enable;
+		MonitorGlobal::Instance()->ResetControls();
 	}
 
 	void CLibreHardwareMonitor::SetMemoryEnable(bool enable)
@@ -335,6 +362,7 @@ namespace LibreHardwareMonitorApi
 	void CLibreHardwareMonitor::SetGpuEnable(bool enable)
 	{
 		MonitorGlobal::Instance()->computer->IsGpuEnabled = enable;
+		MonitorGlobal::Instance()->ResetControls();
 	}
 
 	void CLibreHardwareMonitor::SetStorageEnable(bool enable)
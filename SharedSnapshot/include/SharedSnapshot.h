@@ -0,0 +1,146 @@
+﻿#pragma once
+
+#include "SharedSnapshotFormat.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/// <summary>
+/// 快照共享内存写入方 (单个进程 单个线程写入)
+/// <para>写入顺序: Begin -> SetEntry / SetValues / SetSample -> Commit</para>
+/// </summary>
+class SharedSnapshotWriter
+{
+public:
+	SharedSnapshotWriter();
+	SharedSnapshotWriter(const SharedSnapshotWriter&) = delete;
+	SharedSnapshotWriter& operator=(const SharedSnapshotWriter&) = delete;
+	~SharedSnapshotWriter();
+
+	/// <summary>
+	/// 创建共享内存
+	/// <para>同名共享内存的写入方仍在运行时失败 (errno 为 EEXIST); 已关闭或异常退出的写入方留下的共享内存被替换, 旧的读取方需要重新打开</para>
+	/// </summary>
+	/// <param name="name">共享内存名称</param>
+	/// <param name="capacity">最多传感器数量</param>
+	/// <returns>是否成功</returns>
+	bool Open(const char* name = SharedSnapshotFormat::DefaultName, uint32_t capacity = SharedSnapshotFormat::DefaultCapacity);
+	/// <summary>
+	/// 标记为已关闭并删除共享内存名称
+	/// </summary>
+	void Close();
+	bool IsOpen() const;
+	uint32_t Capacity() const;
+
+	/// <summary>
+	/// 开始写入 (读取方此后读取会重试)
+	/// </summary>
+	void Begin();
+	/// <summary>
+	/// 写入目录项 (超出长度的名称被截断)
+	/// </summary>
+	/// <param name="index">槽位</param>
+	/// <param name="name">名称 (UTF-8)</param>
+	/// <param name="unit">单位 (UTF-8)</param>
+	void SetEntry(uint32_t index, const char* name, const char* unit);
+	/// <summary>
+	/// 写入目录版本与有效数量
+	/// </summary>
+	/// <param name="layoutVersion">目录版本</param>
+	/// <param name="count">有效传感器数量 (超出容量时截断)</param>
+	void SetLayout(uint32_t layoutVersion, uint32_t count);
+	/// <summary>
+	/// 写入读数
+	/// </summary>
+	/// <param name="values">读数数组</param>
+	/// <param name="count">读数数量 (超出容量时截断)</param>
+	void SetValues(const float* values, uint32_t count);
+	/// <summary>
+	/// 写入采样时间戳与序号
+	/// </summary>
+	void SetSample(int64_t timestamp, uint64_t sequence);
+	/// <summary>
+	/// 完成写入
+	/// </summary>
+	void Commit();
+
+private:
+	std::string m_name;
+	void* m_memory;
+	uint64_t m_size;
+	uint32_t m_capacity;
+	SharedSnapshotFormat::Header* m_header;
+	SharedSnapshotFormat::DirectoryEntry* m_entries;
+	float* m_values;
+};
+
+/// <summary>
+/// 快照共享内存读取方 (只读映射, 可以有任意数量)
+/// <para>Read 复制一次一致的快照到本地, 目录只在写入方布局变化时复制</para>
+/// </summary>
+class SharedSnapshotReader
+{
+public:
+	SharedSnapshotReader();
+	SharedSnapshotReader(const SharedSnapshotReader&) = delete;
+	SharedSnapshotReader& operator=(const SharedSnapshotReader&) = delete;
+	~SharedSnapshotReader();
+
+	/// <summary>
+	/// 打开共享内存
+	/// </summary>
+	/// <param name="name">共享内存名称</param>
+	/// <returns>是否成功 (写入方未运行时失败)</returns>
+	bool Open(const char* name = SharedSnapshotFormat::DefaultName);
+	void Close();
+	bool IsOpen() const;
+	/// <summary>
+	/// 写入方是否仍在运行 (已关闭或进程已退出时返回 false, 需要重新 Open)
+	/// </summary>
+	bool WriterAlive() const;
+
+	/// <summary>
+	/// 读取一致的快照
+	/// </summary>
+	/// <param name="maxRetries">写入冲突时最多重试次数</param>
+	/// <returns>是否成功</returns>
+	bool Read(uint32_t maxRetries = 1000);
+
+	uint32_t Count() const;
+	const char* Name(uint32_t index) const;
+	const char* Unit(uint32_t index) const;
+	float Value(uint32_t index) const;
+	const float* Values() const;
+	/// <summary>
+	/// 根据名称查找槽位
+	/// </summary>
+	/// <returns>槽位 不存在时返回 -1</returns>
+	int32_t Find(const char* name) const;
+	int64_t Timestamp() const;
+	uint64_t SampleSequence() const;
+	uint32_t LayoutVersion() const;
+	/// <summary>
+	/// 累计因写入冲突而重试的次数
+	/// </summary>
+	uint64_t Retries() const;
+
+private:
+	const void* m_memory;
+	uint64_t m_size;
+	uint32_t m_capacity;
+	const SharedSnapshotFormat::Header* m_header;
+	const SharedSnapshotFormat::DirectoryEntry* m_entries;
+	const float* m_values;
+
+	/// <summary>
+	/// 本地副本 (目录仅在布局变化时更新)
+	/// </summary>
+	std::vector<SharedSnapshotFormat::DirectoryEntry> m_directory;
+	std::vector<float> m_localValues;
+	bool m_hasLayout;
+	uint32_t m_layoutVersion;
+	uint32_t m_count;
+	int64_t m_timestamp;
+	uint64_t m_sampleSequence;
+	uint64_t m_retries;
+};
@@ -0,0 +1,112 @@
+﻿#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+/// <summary>
+/// 传感器快照共享内存格式 (POSIX shm, 不依赖 Qt)
+/// <para>布局: Header | DirectoryEntry[capacity] | float values[capacity]</para>
+/// <para>写入方使用顺序锁 (seqlock): 写入前 sequence 加 1 (奇数), 写入后再加 1 (偶数)</para>
+/// <para>读取方复制数据前后 sequence 相同且为偶数时数据一致, 否则重试; 读取方不加锁 不影响写入方</para>
+/// <para>目录只在 layoutVersion 变化时改写, 读取方缓存目录, 平时只复制读数</para>
+/// </summary>
+namespace SharedSnapshotFormat
+{
+	/// <summary>
+	/// 默认共享内存名称 (shm_open)
+	/// </summary>
+	constexpr const char* DefaultName = "/DigiHMS.snapshot";
+	/// <summary>
+	/// 格式标识
+	/// </summary>
+	constexpr char Magic[8] = { 'D', 'H', 'M', 'S', 'S', 'H', 'M', '1' };
+	/// <summary>
+	/// 格式版本
+	/// </summary>
+	constexpr uint32_t Version = 1;
+	/// <summary>
+	/// 默认最多传感器数量
+	/// </summary>
+	constexpr uint32_t DefaultCapacity = 1024;
+	/// <summary>
+	/// 传感器名称与单位的最大长度 (UTF-8, 包含 '\0')
+	/// </summary>
+	constexpr uint32_t NameSize = 96;
+	constexpr uint32_t UnitSize = 32;
+
+	static_assert(std::atomic<uint64_t>::is_always_lock_free, "shared memory requires lock-free 64-bit atomics");
+	static_assert(std::atomic<uint32_t>::is_always_lock_free, "shared memory requires lock-free 32-bit atomics");
+
+	struct alignas(64) Header
+	{
+		char magic[8];
+		uint32_t version;
+		uint32_t headerSize;
+		/// <summary>
+		/// 目录与读数数组的容量
+		/// </summary>
+		uint32_t capacity;
+		uint32_t entrySize;
+		/// <summary>
+		/// 写入进程 ID (用于判断写入方是否仍在运行)
+		/// </summary>
+		int32_t writerPid;
+		/// <summary>
+		/// 写入方打开期间为 1, 关闭后为 0 (读取方需要重新打开)
+		/// </summary>
+		std::atomic<uint32_t> alive;
+
+		/// <summary>
+		/// 顺序锁计数 奇数表示正在写入
+		/// </summary>
+		alignas(64) std::atomic<uint64_t> sequence;
+
+		// 以下字段受顺序锁保护
+		/// <summary>
+		/// 目录版本 目录变化时递增
+		/// </summary>
+		uint32_t layoutVersion;
+		/// <summary>
+		/// 有效传感器数量
+		/// </summary>
+		uint32_t count;
+		/// <summary>
+		/// 采样时间戳 (自 1970 年起的毫秒数)
+		/// </summary>
+		int64_t timestamp;
+		/// <summary>
+		/// 采样序号
+		/// </summary>
+		uint64_t sampleSequence;
+	};
+
+	struct DirectoryEntry
+	{
+		char name[NameSize];
+		char unit[UnitSize];
+	};
+
+	/// <summary>
+	/// 目录起始偏移
+	/// </summary>
+	constexpr uint64_t DirectoryOffset()
+	{
+		return sizeof(Header);
+	}
+
+	/// <summary>
+	/// 读数数组起始偏移
+	/// </summary>
+	constexpr uint64_t ValuesOffset(uint32_t capacity)
+	{
+		return sizeof(Header) + static_cast<uint64_t>(capacity) * sizeof(DirectoryEntry);
+	}
+
+	/// <summary>
+	/// 共享内存总大小
+	/// </summary>
+	constexpr uint64_t SegmentSize(uint32_t capacity)
+	{
+		return ValuesOffset(capacity) + static_cast<uint64_t>(capacity) * sizeof(float);
+	}
+}
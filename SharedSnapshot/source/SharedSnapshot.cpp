@@ -0,0 +1,389 @@
+﻿#include "SharedSnapshot.h"
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <new>
+#include <fcntl.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace SharedSnapshotFormat;
+
+namespace
+{
+	void copyString(char* target, uint32_t size, const char* source)
+	{
+		if (source == nullptr)
+			source = "";
+
+		const auto length = std::min<size_t>(std::strlen(source), size - 1);
+		std::memcpy(target, source, length);
+		std::memset(target + length, 0, size - length);
+	}
+
+	/// <summary>
+	/// 同名共享内存的写入方是否仍在运行 (已关闭, 进程已退出或无法读取时返回 false)
+	/// </summary>
+	bool writerRunning(const char* name)
+	{
+		const auto fd = ::shm_open(name, O_RDONLY, 0);
+		if (fd < 0)
+			return false;
+
+		bool running = false;
+		struct stat info;
+		if (::fstat(fd, &info) == 0 && static_cast<uint64_t>(info.st_size) >= sizeof(Header))
+		{
+			auto memory = ::mmap(nullptr, sizeof(Header), PROT_READ, MAP_SHARED, fd, 0);
+			if (memory != MAP_FAILED)
+			{
+				auto header = static_cast<const Header*>(memory);
+				running = header->alive.load(std::memory_order_acquire) == 1
+					&& (::kill(header->writerPid, 0) == 0 || errno != ESRCH);
+				::munmap(memory, sizeof(Header));
+			}
+		}
+
+		::close(fd);
+		return running;
+	}
+}
+
+SharedSnapshotWriter::SharedSnapshotWriter()
+	: m_memory(nullptr)
+	, m_size(0)
+	, m_capacity(0)
+	, m_header(nullptr)
+	, m_entries(nullptr)
+	, m_values(nullptr)
+{
+}
+
+SharedSnapshotWriter::~SharedSnapshotWriter()
+{
+	Close();
+}
+
+bool SharedSnapshotWriter::Open(const char* name, uint32_t capacity)
+{
+	Close();
+	if (capacity == 0)
+		return false;
+
+	// 写入方仍在运行时失败 只替换已关闭或异常退出的写入方留下的名称
+	auto fd = ::shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0644);
+	if (fd < 0 && errno == EEXIST && !writerRunning(name))
+	{
+		// 仍映射旧共享内存的读取方不受影响
+		::shm_unlink(name);
+		fd = ::shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0644);
+	}
+	if (fd < 0)
+		return false;
+
+	const auto size = SegmentSize(capacity);
+	if (::ftruncate(fd, static_cast<off_t>(size)) != 0)
+	{
+		::close(fd);
+		::shm_unlink(name);
+		return false;
+	}
+
+	auto memory = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	::close(fd);
+	if (memory == MAP_FAILED)
+	{
+		::shm_unlink(name);
+		return false;
+	}
+
+	m_name = name;
+	m_memory = memory;
+	m_size = size;
+	m_capacity = capacity;
+
+	// ftruncate 后内容为 0, 最后设置 alive 读取方才会接受
+	auto bytes = static_cast<char*>(memory);
+	m_header = new (bytes) Header();
+	m_entries = reinterpret_cast<DirectoryEntry*>(bytes + DirectoryOffset());
+	m_values = reinterpret_cast<float*>(bytes + ValuesOffset(capacity));
+
+	std::memcpy(m_header->magic, Magic, sizeof(Magic));
+	m_header->version = Version;
+	m_header->headerSize = sizeof(Header);
+	m_header->capacity = capacity;
+	m_header->entrySize = sizeof(DirectoryEntry);
+	m_header->writerPid = static_cast<int32_t>(::getpid());
+	m_header->sequence.store(0, std::memory_order_relaxed);
+	m_header->alive.store(1, std::memory_order_release);
+	return true;
+}
+
+void SharedSnapshotWriter::Close()
+{
+	if (m_memory == nullptr)
+		return;
+
+	m_header->alive.store(0, std::memory_order_release);
+	::munmap(m_memory, m_size);
+	::shm_unlink(m_name.c_str());
+
+	m_memory = nullptr;
+	m_header = nullptr;
+	m_entries = nullptr;
+	m_values = nullptr;
+	m_size = 0;
+	m_capacity = 0;
+}
+
+bool SharedSnapshotWriter::IsOpen() const
+{
+	return m_memory != nullptr;
+}
+
+uint32_t SharedSnapshotWriter::Capacity() const
+{
+	return m_capacity;
+}
+
+void SharedSnapshotWriter::Begin()
+{
+	// 奇数: 写入中 后续的普通写入不能被重排到此之前
+	m_header->sequence.store(m_header->sequence.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+}
+
+void SharedSnapshotWriter::SetEntry(uint32_t index, const char* name, const char* unit)
+{
+	if (index >= m_capacity)
+		return;
+
+	copyString(m_entries[index].name, NameSize, name);
+	copyString(m_entries[index].unit, UnitSize, unit);
+}
+
+void SharedSnapshotWriter::SetLayout(uint32_t layoutVersion, uint32_t count)
+{
+	m_header->layoutVersion = layoutVersion;
+	m_header->count = std::min(count, m_capacity);
+}
+
+void SharedSnapshotWriter::SetValues(const float* values, uint32_t count)
+{
+	std::memcpy(m_values, values, std::min(count, m_capacity) * sizeof(float));
+}
+
+void SharedSnapshotWriter::SetSample(int64_t timestamp, uint64_t sequence)
+{
+	m_header->timestamp = timestamp;
+	m_header->sampleSequence = sequence;
+}
+
+void SharedSnapshotWriter::Commit()
+{
+	// 偶数: 写入完成
+	m_header->sequence.store(m_header->sequence.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+SharedSnapshotReader::SharedSnapshotReader()
+	: m_memory(nullptr)
+	, m_size(0)
+	, m_capacity(0)
+	, m_header(nullptr)
+	, m_entries(nullptr)
+	, m_values(nullptr)
+	, m_hasLayout(false)
+	, m_layoutVersion(0)
+	, m_count(0)
+	, m_timestamp(0)
+	, m_sampleSequence(0)
+	, m_retries(0)
+{
+}
+
+SharedSnapshotReader::~SharedSnapshotReader()
+{
+	Close();
+}
+
+bool SharedSnapshotReader::Open(const char* name)
+{
+	Close();
+
+	const auto fd = ::shm_open(name, O_RDONLY, 0);
+	if (fd < 0)
+		return false;
+
+	struct stat info;
+	if (::fstat(fd, &info) != 0 || static_cast<uint64_t>(info.st_size) < sizeof(Header))
+	{
+		::close(fd);
+		return false;
+	}
+
+	const auto size = static_cast<uint64_t>(info.st_size);
+	auto memory = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+	::close(fd);
+	if (memory == MAP_FAILED)
+		return false;
+
+	auto header = static_cast<const Header*>(memory);
+	if (header->alive.load(std::memory_order_acquire) != 1
+		|| std::memcmp(header->magic, Magic, sizeof(Magic)) != 0
+		|| header->version != Version
+		|| header->headerSize != sizeof(Header)
+		|| header->entrySize != sizeof(DirectoryEntry)
+		|| SegmentSize(header->capacity) > size)
+	{
+		::munmap(memory, size);
+		return false;
+	}
+
+	auto bytes = static_cast<const char*>(memory);
+	m_memory = memory;
+	m_size = size;
+	m_header = header;
+	m_capacity = header->capacity;
+	m_entries = reinterpret_cast<const DirectoryEntry*>(bytes + DirectoryOffset());
+	m_values = reinterpret_cast<const float*>(bytes + ValuesOffset(m_capacity));
+	m_directory.assign(m_capacity, DirectoryEntry());
+	m_localValues.assign(m_capacity, 0.0f);
+	m_hasLayout = false;
+	return true;
+}
+
+void SharedSnapshotReader::Close()
+{
+	if (m_memory == nullptr)
+		return;
+
+	::munmap(const_cast<void*>(m_memory), m_size);
+	m_memory = nullptr;
+	m_header = nullptr;
+	m_entries = nullptr;
+	m_values = nullptr;
+	m_capacity = 0;
+	m_count = 0;
+	m_hasLayout = false;
+}
+
+bool SharedSnapshotReader::IsOpen() const
+{
+	return m_memory != nullptr;
+}
+
+bool SharedSnapshotReader::WriterAlive() const
+{
+	if (m_header == nullptr || m_header->alive.load(std::memory_order_acquire) != 1)
+		return false;
+
+	// 写入方异常退出时 alive 不会被清除
+	return ::kill(m_header->writerPid, 0) == 0 || errno != ESRCH;
+}
+
+bool SharedSnapshotReader::Read(uint32_t maxRetries)
+{
+	if (m_header == nullptr || m_header->alive.load(std::memory_order_acquire) != 1)
+		return false;
+
+	for (uint32_t attempt = 0; attempt <= maxRetries; ++attempt)
+	{
+		const auto begin = m_header->sequence.load(std::memory_order_acquire);
+		if (begin & 1)
+		{
+			m_retries++;
+			::sched_yield();
+			continue;
+		}
+
+		const auto layoutVersion = m_header->layoutVersion;
+		const auto count = std::min(m_header->count, m_capacity);
+		const auto timestamp = m_header->timestamp;
+		const auto sampleSequence = m_header->sampleSequence;
+
+		// 目录只在布局变化时复制
+		const auto layoutChanged = !m_hasLayout || layoutVersion != m_layoutVersion;
+		if (layoutChanged)
+			std::memcpy(m_directory.data(), m_entries, count * sizeof(DirectoryEntry));
+		std::memcpy(m_localValues.data(), m_values, count * sizeof(float));
+
+		// 复制完成后 sequence 未变化才说明没有与写入重叠
+		std::atomic_thread_fence(std::memory_order_acquire);
+		if (m_header->sequence.load(std::memory_order_relaxed) != begin)
+		{
+			// 重叠时目录副本可能不完整 下次需要重新复制
+			if (layoutChanged)
+				m_hasLayout = false;
+			m_retries++;
+			continue;
+		}
+
+		m_layoutVersion = layoutVersion;
+		m_hasLayout = true;
+		m_count = count;
+		m_timestamp = timestamp;
+		m_sampleSequence = sampleSequence;
+		return true;
+	}
+
+	return false;
+}
+
+uint32_t SharedSnapshotReader::Count() const
+{
+	return m_count;
+}
+
+const char* SharedSnapshotReader::Name(uint32_t index) const
+{
+	return index < m_count ? m_directory[index].name : "";
+}
+
+const char* SharedSnapshotReader::Unit(uint32_t index) const
+{
+	return index < m_count ? m_directory[index].unit : "";
+}
+
+float SharedSnapshotReader::Value(uint32_t index) const
+{
+	return index < m_count ? m_localValues[index] : 0.0f;
+}
+
+const float* SharedSnapshotReader::Values() const
+{
+	return m_localValues.data();
+}
+
+int32_t SharedSnapshotReader::Find(const char* name) const
+{
+	for (uint32_t i = 0; i < m_count; ++i)
+	{
+		if (std::strncmp(m_directory[i].name, name, NameSize) == 0)
+			return static_cast<int32_t>(i);
+	}
+
+	return -1;
+}
+
+int64_t SharedSnapshotReader::Timestamp() const
+{
+	return m_timestamp;
+}
+
+uint64_t SharedSnapshotReader::SampleSequence() const
+{
+	return m_sampleSequence;
+}
+
+uint32_t SharedSnapshotReader::LayoutVersion() const
+{
+	return m_layoutVersion;
+}
+
+uint64_t SharedSnapshotReader::Retries() const
+{
+	return m_retries;
+}
@@ -0,0 +1,154 @@
+﻿#include <SharedSnapshot.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+/// <summary>
+/// 打印正在运行的 DigiHMS 发布的快照
+/// </summary>
+static int Dump(const char* name, int32_t seconds)
+{
+	SharedSnapshotReader reader;
+	if (!reader.Open(name))
+	{
+		std::printf("Shared snapshot \"%s\" is not available (is DigiHMS running?)\n", name);
+		return 1;
+	}
+
+	for (int32_t i = 0; i <= seconds; ++i)
+	{
+		if (!reader.Read())
+		{
+			std::printf("Writer closed\n");
+			return 1;
+		}
+
+		std::printf("sample %llu  timestamp %lld  sensors %u  layout %u\n",
+			static_cast<unsigned long long>(reader.SampleSequence()), static_cast<long long>(reader.Timestamp()),
+			reader.Count(), reader.LayoutVersion());
+		for (uint32_t slot = 0; slot < reader.Count(); ++slot)
+			std::printf("  %-48s %10.2f %s\n", reader.Name(slot), reader.Value(slot), reader.Unit(slot));
+
+		if (i < seconds)
+			std::this_thread::sleep_for(std::chrono::seconds(1));
+	}
+
+	return 0;
+}
+
+/// <summary>
+/// 自测: 写入线程持续发布 (每次所有读数相同, 周期性改变目录), 读取方检查是否读到不一致的快照
+/// </summary>
+static int SelfTest()
+{
+	const auto name = "/DigiHMS.snapshot.test." + std::to_string(::getpid());
+	const uint32_t count = 256;
+
+	SharedSnapshotWriter writer;
+	if (!writer.Open(name.c_str(), count))
+	{
+		std::printf("FAIL: cannot create shared memory %s\n", name.c_str());
+		return 1;
+	}
+
+	// 写入方运行期间 同名的第二个写入方不能接管
+	SharedSnapshotWriter second;
+	if (second.Open(name.c_str(), count))
+	{
+		std::printf("FAIL: second writer replaced a running writer\n");
+		return 1;
+	}
+
+	std::atomic<bool> running(true);
+	std::thread producer([&]() {
+		std::vector<float> values(count);
+		char label[32];
+		uint64_t sample = 0;
+		uint32_t layout = 0;
+		while (running)
+		{
+			sample++;
+			writer.Begin();
+			if (sample % 1000 == 1)
+			{
+				layout++;
+				for (uint32_t slot = 0; slot < count; ++slot)
+				{
+					std::snprintf(label, sizeof(label), "layout%u.sensor%u", layout, slot);
+					writer.SetEntry(slot, label, "unit");
+				}
+				writer.SetLayout(layout, count);
+			}
+
+			std::fill(values.begin(), values.end(), static_cast<float>(sample));
+			writer.SetValues(values.data(), count);
+			writer.SetSample(static_cast<int64_t>(sample), sample);
+			writer.Commit();
+		}
+	});
+
+	SharedSnapshotReader reader;
+	if (!reader.Open(name.c_str()))
+	{
+		running = false;
+		producer.join();
+		std::printf("FAIL: cannot open shared memory %s\n", name.c_str());
+		return 1;
+	}
+
+	uint64_t reads = 0;
+	uint64_t torn = 0;
+	uint64_t lastSample = 0;
+	char expected[32];
+	const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+	while (std::chrono::steady_clock::now() < deadline)
+	{
+		if (!reader.Read() || reader.Count() == 0)
+			continue;
+
+		reads++;
+		const auto sample = static_cast<float>(reader.SampleSequence());
+		bool consistent = reader.SampleSequence() >= lastSample;
+		for (uint32_t slot = 0; slot < reader.Count() && consistent; ++slot)
+			consistent = reader.Value(slot) == sample;
+
+		// 目录与布局版本一致
+		std::snprintf(expected, sizeof(expected), "layout%u.sensor%u", reader.LayoutVersion(), count - 1);
+		consistent = consistent && std::strcmp(reader.Name(count - 1), expected) == 0;
+
+		if (!consistent)
+			torn++;
+		lastSample = reader.SampleSequence();
+	}
+
+	running = false;
+	producer.join();
+
+	std::printf("reads %llu  retries %llu  samples %llu  inconsistent %llu\n",
+		static_cast<unsigned long long>(reads), static_cast<unsigned long long>(reader.Retries()),
+		static_cast<unsigned long long>(lastSample), static_cast<unsigned long long>(torn));
+
+	const auto ok = reads > 0 && torn == 0;
+	std::printf(ok ? "PASS\n" : "FAIL\n");
+	return ok ? 0 : 1;
+}
+
+int main(int argc, char* argv[])
+{
+	std::printf("SHARED SNAPSHOT TEST\n");
+
+	if (argc > 1 && std::strcmp(argv[1], "--self-test") == 0)
+		return SelfTest();
+
+	// SnapshotTest [秒数] [共享内存名称]
+	const auto seconds = argc > 1 ? std::atoi(argv[1]) : 0;
+	const auto name = argc > 2 ? argv[2] : SharedSnapshotFormat::DefaultName;
+	return Dump(name, seconds);
+}
@@ -0,0 +1,212 @@
+﻿#include <gtest/gtest.h>
+#include <Sensor/AlertEngine.h>
+#include <Sensor/SensorSnapshot.h>
+#include <limits>
+
+TEST(AlertRule, ParsesRules)
+{
+	QVector<AlertRule> rules;
+	ASSERT_TRUE(AlertRule::Parse(
+		"# comment\n"
+		"cpu.temp > 90 for 5s\n"
+		"\n"
+		"  gpu.load>=99.5 for 250ms  \n"
+		"storage.temp.* < -10 for 2m\n"
+		"fan.rpm == 0 for 3\n"
+		"cpu.load != 1", rules));
+
+	ASSERT_EQ(rules.count(), 5);
+	EXPECT_EQ(rules[0].sensor, QString("cpu.temp"));
+	EXPECT_EQ(rules[0].comparator, AlertRule::Comparator::Greater);
+	EXPECT_FLOAT_EQ(rules[0].threshold, 90.0f);
+	EXPECT_EQ(rules[0].hold, 5000);
+
+	EXPECT_EQ(rules[1].comparator, AlertRule::Comparator::GreaterEqual);
+	EXPECT_FLOAT_EQ(rules[1].threshold, 99.5f);
+	EXPECT_EQ(rules[1].hold, 250);
+	EXPECT_EQ(rules[1].text, QString("gpu.load>=99.5 for 250ms"));
+
+	EXPECT_EQ(rules[2].sensor, QString("storage.temp.*"));
+	EXPECT_EQ(rules[2].comparator, AlertRule::Comparator::Less);
+	EXPECT_FLOAT_EQ(rules[2].threshold, -10.0f);
+	EXPECT_EQ(rules[2].hold, 120000);
+
+	// 省略单位时按秒计算
+	EXPECT_EQ(rules[3].comparator, AlertRule::Comparator::Equal);
+	EXPECT_EQ(rules[3].hold, 3000);
+
+	EXPECT_EQ(rules[4].comparator, AlertRule::Comparator::NotEqual);
+	EXPECT_EQ(rules[4].hold, 0);
+}
+
+TEST(AlertRule, RejectsInvalidLine)
+{
+	QVector<AlertRule> rules;
+	QString error;
+	EXPECT_FALSE(AlertRule::Parse("cpu.temp > 90\ncpu.temp ~ 90", rules, &error));
+	EXPECT_TRUE(rules.isEmpty());
+	EXPECT_TRUE(error.contains("line 2")) << error.toStdString();
+
+	EXPECT_FALSE(AlertRule::Parse("cpu.temp > hot", rules));
+	EXPECT_FALSE(AlertRule::Parse("cpu.temp > 90 for 5h", rules));
+}
+
+namespace
+{
+	/// <summary>
+	/// 告警引擎与传感器快照 记录发出的通知
+	/// </summary>
+	class AlertRig : public ::testing::Test
+	{
+	protected:
+		void SetUp() override
+		{
+			engine.setNotifyInterval(0);
+			QObject::connect(&engine, &AlertEngine::alertRaised, [this](const QString& sensor, const QString&, float) {
+				raised.append(sensor);
+			});
+			QObject::connect(&engine, &AlertEngine::alertCleared, [this](const QString& sensor, const QString&, float) {
+				cleared.append(sensor);
+			});
+		}
+
+		qint32 Add(const QString& name)
+		{
+			return snapshot.AddSensor(name);
+		}
+
+		/// <summary>
+		/// 在指定时间采样一次
+		/// </summary>
+		void Sample(qint64 time, qint32 slot, float value)
+		{
+			snapshot.SetValue(slot, value);
+			snapshot.SetTimestamp(time);
+			engine.OnSnapshot(snapshot);
+		}
+
+		AlertEngine engine;
+		SensorSnapshot snapshot;
+		QStringList raised;
+		QStringList cleared;
+	};
+}
+
+TEST_F(AlertRig, HoldDebouncesRaise)
+{
+	engine.setRules("cpu.temp > 90 for 2s");
+	const auto slot = Add("cpu.temp");
+
+	// 短暂超过阈值不触发
+	Sample(1000, slot, 95.0f);
+	Sample(2000, slot, 80.0f);
+	Sample(3500, slot, 95.0f);
+	Sample(5000, slot, 95.0f);
+	EXPECT_TRUE(raised.isEmpty());
+
+	Sample(5500, slot, 95.0f);
+	EXPECT_EQ(raised, QStringList({ "cpu.temp" }));
+
+	// 持续触发状态不重复通知
+	Sample(6000, slot, 96.0f);
+	EXPECT_EQ(raised.count(), 1);
+}
+
+TEST_F(AlertRig, HoldDebouncesClear)
+{
+	engine.setRules("cpu.temp > 90 for 2s");
+	const auto slot = Add("cpu.temp");
+
+	Sample(0, slot, 95.0f);
+	Sample(2000, slot, 95.0f);
+	ASSERT_EQ(raised.count(), 1);
+
+	// 短暂回落不解除
+	Sample(3000, slot, 80.0f);
+	Sample(4000, slot, 95.0f);
+	Sample(5000, slot, 80.0f);
+	Sample(6000, slot, 80.0f);
+	EXPECT_TRUE(cleared.isEmpty());
+
+	Sample(7000, slot, 80.0f);
+	EXPECT_EQ(cleared, QStringList({ "cpu.temp" }));
+	EXPECT_EQ(raised.count(), 1);
+}
+
+TEST_F(AlertRig, WildcardExpandsToMatchingSensors)
+{
+	engine.setRules("storage.temp.* > 55");
+	const auto nvme = Add("storage.temp.nvme0");
+	const auto sata = Add("storage.temp.sda");
+	Add("cpu.temp");
+
+	Sample(1000, nvme, 40.0f);
+	EXPECT_EQ(engine.CompiledCount(), 2);
+
+	Sample(2000, sata, 60.0f);
+	EXPECT_EQ(raised, QStringList({ "storage.temp.sda" }));
+
+	// 新的传感器在下次采样时加入规则表 已有条目保留状态
+	const auto usb = Add("storage.temp.sdb");
+	Sample(3000, usb, 70.0f);
+	EXPECT_EQ(engine.CompiledCount(), 3);
+	EXPECT_EQ(raised, QStringList({ "storage.temp.sda", "storage.temp.sdb" }));
+}
+
+TEST_F(AlertRig, NotifyIntervalLimitsRepeats)
+{
+	engine.setNotifyInterval(10000);
+	engine.setRules("cpu.temp > 90");
+	const auto slot = Add("cpu.temp");
+
+	Sample(1000, slot, 95.0f);
+	Sample(2000, slot, 80.0f);
+	EXPECT_EQ(raised.count(), 1);
+	EXPECT_EQ(cleared.count(), 1);
+
+	// 间隔内再次触发不通知 对应的解除也不通知
+	Sample(3000, slot, 95.0f);
+	Sample(4000, slot, 80.0f);
+	EXPECT_EQ(raised.count(), 1);
+	EXPECT_EQ(cleared.count(), 1);
+
+	Sample(11000, slot, 95.0f);
+	EXPECT_EQ(raised.count(), 2);
+}
+
+TEST_F(AlertRig, NaNIsInactive)
+{
+	engine.setRules("cpu.temp > 90\ncpu.load != 0");
+	const auto temp = Add("cpu.temp");
+	const auto load = Add("cpu.load");
+	const auto nan = std::numeric_limits<float>::quiet_NaN();
+
+	Sample(1000, temp, nan);
+	Sample(1000, load, nan);
+	EXPECT_TRUE(raised.isEmpty());
+
+	Sample(2000, load, 5.0f);
+	EXPECT_EQ(raised, QStringList({ "cpu.load" }));
+
+	// 读数丢失时解除告警
+	Sample(3000, load, nan);
+	EXPECT_EQ(cleared, QStringList({ "cpu.load" }));
+}
+
+TEST_F(AlertRig, InvalidRulesKeepPrevious)
+{
+	engine.setRules("cpu.temp > 90");
+
+	QString error;
+	QObject::connect(&engine, &AlertEngine::rulesError, [&error](const QString& message) {
+		error = message;
+	});
+	engine.setRules("cpu.temp >");
+
+	EXPECT_FALSE(error.isEmpty());
+	EXPECT_EQ(engine.Rules(), QString("cpu.temp > 90"));
+
+	const auto slot = Add("cpu.temp");
+	Sample(1000, slot, 95.0f);
+	EXPECT_EQ(raised.count(), 1);
+}
@@ -0,0 +1,112 @@
+﻿#include <gtest/gtest.h>
+#include <IO/Compression/Codec.h>
+
+namespace
+{
+	QByteArray TelemetryFrames(qint32 count)
+	{
+		QByteArray data;
+		for (auto i = 0; i < count; ++i)
+			data += "/*" + QByteArray::number(40 + i % 7) + ",55,12,3.5,1024*/";
+		return data;
+	}
+
+	/// <summary>
+	/// 依次解析所有信封并拼接原始数据
+	/// </summary>
+	bool UnpackAll(const QByteArray& envelopes, QByteArray& raw, qint32* count = Q_NULLPTR)
+	{
+		raw.clear();
+		qint32 offset = 0;
+		qint32 envelopesRead = 0;
+		while (offset < envelopes.length())
+		{
+			QByteArray output;
+			qint32 consumed = 0;
+			if (!Codec::Unpack(envelopes.constData() + offset, envelopes.length() - offset, output, &consumed))
+				return false;
+
+			raw += output;
+			offset += consumed;
+			envelopesRead++;
+		}
+
+		if (count)
+			*count = envelopesRead;
+		return true;
+	}
+}
+
+TEST(Codec, LzssRoundTrip)
+{
+	auto codec = Codec::Create(Codec::Type::Lzss);
+	ASSERT_TRUE(codec);
+
+	const auto data = TelemetryFrames(64);
+	QByteArray envelope;
+	EXPECT_TRUE(codec->Pack(data.constData(), data.length(), envelope));
+	EXPECT_LT(envelope.length(), data.length());
+	EXPECT_EQ(static_cast<quint8>(envelope.at(0)), Codec::EnvelopeMagic);
+	EXPECT_EQ(static_cast<Codec::Type>(envelope.at(1)), Codec::Type::Lzss);
+
+	QByteArray raw;
+	ASSERT_TRUE(UnpackAll(envelope, raw));
+	EXPECT_EQ(raw, data);
+}
+
+TEST(Codec, IncompressibleDataUsesNoneEnvelope)
+{
+	auto codec = Codec::Create(Codec::Type::Lzss);
+	ASSERT_TRUE(codec);
+
+	// 以 0xDC 开头的短帧 同样必须封装为信封
+	const QByteArray data("\xDC" "ab", 3);
+	QByteArray envelope;
+	EXPECT_FALSE(codec->Pack(data.constData(), data.length(), envelope));
+	ASSERT_EQ(envelope.length(), Codec::EnvelopeHeaderSize + data.length());
+	EXPECT_EQ(static_cast<Codec::Type>(envelope.at(1)), Codec::Type::None);
+
+	QByteArray raw;
+	ASSERT_TRUE(UnpackAll(envelope, raw));
+	EXPECT_EQ(raw, data);
+}
+
+TEST(Codec, LongDataIsSplitIntoEnvelopes)
+{
+	auto codec = Codec::Create(Codec::Type::Lzss);
+	ASSERT_TRUE(codec);
+
+	const auto data = TelemetryFrames(4000);
+	ASSERT_GT(data.length(), Codec::MaxEnvelopePayload);
+
+	QByteArray envelopes;
+	codec->Pack(data.constData(), data.length(), envelopes);
+
+	QByteArray raw;
+	qint32 count = 0;
+	ASSERT_TRUE(UnpackAll(envelopes, raw, &count));
+	EXPECT_EQ(count, (data.length() + Codec::MaxEnvelopePayload - 1) / Codec::MaxEnvelopePayload);
+	EXPECT_EQ(raw, data);
+}
+
+TEST(Codec, UnpackRejectsIncompleteEnvelope)
+{
+	auto codec = Codec::Create(Codec::Type::Lzss);
+	ASSERT_TRUE(codec);
+
+	const auto data = TelemetryFrames(8);
+	QByteArray envelope;
+	codec->Pack(data.constData(), data.length(), envelope);
+
+	QByteArray output;
+	qint32 consumed = -1;
+	EXPECT_FALSE(Codec::Unpack(envelope.constData(), envelope.length() - 1, output, &consumed));
+	EXPECT_EQ(consumed, 0);
+}
+
+TEST(Codec, TypesFromNames)
+{
+	const QList<Codec::Type> expected{ Codec::Type::Lzss, Codec::Type::None };
+	EXPECT_EQ(Codec::TypesFromNames(" LZSS, none,unknown,lzss,"), expected);
+	EXPECT_TRUE(Codec::TypesFromNames(QString()).isEmpty());
+}
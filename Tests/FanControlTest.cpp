@@ -0,0 +1,199 @@
+﻿#include <gtest/gtest.h>
+#include <Sensor/FanControl.h>
+#include <Sensor/SensorSnapshot.h>
+#include <QtMath>
+
+namespace
+{
+	/// <summary>
+	/// 线性曲线 30°C 20% 至 80°C 100% (每度 1.6%), 默认不做回差, 限速, 死区与写入间隔限制
+	/// </summary>
+	FanChannel LinearChannel()
+	{
+		FanChannel channel;
+		channel.control = "fan";
+		channel.sensor = "cpu.temp";
+		channel.curve.points = { { 30.0f, 20.0f }, { 80.0f, 100.0f } };
+		channel.hysteresis = 0.0f;
+		channel.maxStep = 100.0f;
+		channel.deadband = 0.0f;
+		channel.minWriteInterval = 0;
+		return channel;
+	}
+
+	FanChannel PidChannel(float kp, float ki)
+	{
+		auto channel = LinearChannel();
+		channel.curve.mode = FanCurve::Mode::Pid;
+		channel.curve.target = 60.0f;
+		channel.curve.kp = kp;
+		channel.curve.ki = ki;
+		channel.curve.kd = 0.0f;
+		return channel;
+	}
+
+	/// <summary>
+	/// 通过模拟后端驱动控制器 每一步间隔一个计算周期 (1 秒)
+	/// </summary>
+	class FanRig
+	{
+	public:
+		explicit FanRig(const FanChannel& channel)
+			: m_backend(new SimulatedFanBackend({ "fan" }))
+			, m_controller(m_backend)
+			, m_timestamp(0)
+		{
+			m_snapshot.AddSensor("cpu.temp", "°C");
+			m_controller.SetInterval(1000);
+			m_controller.SetChannels({ channel });
+		}
+
+		float Step(float temperature)
+		{
+			m_timestamp += 1000;
+			m_snapshot.SetTimestamp(m_timestamp);
+			m_snapshot.SetValue(0, temperature);
+			m_controller.OnSnapshot(m_snapshot);
+			return m_backend->Percent("fan");
+		}
+
+		FanController& Controller()
+		{
+			return m_controller;
+		}
+
+		qint64 Writes() const
+		{
+			return m_backend->Writes();
+		}
+
+	private:
+		SimulatedFanBackend* m_backend;
+		FanController m_controller;
+		SensorSnapshot m_snapshot;
+		qint64 m_timestamp;
+	};
+}
+
+TEST(FanControl, LinearCurveFollowsTemperature)
+{
+	FanRig rig{ LinearChannel() };
+	EXPECT_FLOAT_EQ(rig.Step(10.0f), 20.0f);
+	EXPECT_FLOAT_EQ(rig.Step(55.0f), 60.0f);
+	EXPECT_FLOAT_EQ(rig.Step(95.0f), 100.0f);
+}
+
+TEST(FanControl, HysteresisHoldsSpeedOnSmallDrops)
+{
+	auto channel = LinearChannel();
+	channel.hysteresis = 5.0f;
+
+	FanRig rig(channel);
+	EXPECT_FLOAT_EQ(rig.Step(60.0f), 68.0f);
+	// 下降不足回差 保持
+	EXPECT_FLOAT_EQ(rig.Step(57.0f), 68.0f);
+	// 下降达到回差 跟随
+	EXPECT_FLOAT_EQ(rig.Step(54.0f), 58.4f);
+	// 上升立即跟随
+	EXPECT_FLOAT_EQ(rig.Step(55.0f), 60.0f);
+}
+
+TEST(FanControl, SlewLimitsChangePerStep)
+{
+	auto channel = LinearChannel();
+	channel.maxStep = 10.0f;
+
+	FanRig rig(channel);
+	EXPECT_FLOAT_EQ(rig.Step(30.0f), 20.0f);
+	EXPECT_FLOAT_EQ(rig.Step(80.0f), 30.0f);
+	EXPECT_FLOAT_EQ(rig.Step(80.0f), 40.0f);
+	EXPECT_FLOAT_EQ(rig.Step(30.0f), 30.0f);
+}
+
+TEST(FanControl, DeadbandSkipsSmallChanges)
+{
+	auto channel = LinearChannel();
+	channel.deadband = 5.0f;
+
+	FanRig rig(channel);
+	EXPECT_FLOAT_EQ(rig.Step(50.0f), 52.0f);
+	EXPECT_FLOAT_EQ(rig.Step(52.0f), 52.0f);
+	EXPECT_EQ(rig.Writes(), 1);
+	EXPECT_FLOAT_EQ(rig.Step(54.0f), 58.4f);
+	EXPECT_EQ(rig.Writes(), 2);
+}
+
+TEST(FanControl, MinWriteIntervalDelaysWrites)
+{
+	auto channel = LinearChannel();
+	channel.minWriteInterval = 2500;
+
+	FanRig rig(channel);
+	EXPECT_FLOAT_EQ(rig.Step(30.0f), 20.0f);
+	EXPECT_FLOAT_EQ(rig.Step(80.0f), 20.0f);
+	EXPECT_FLOAT_EQ(rig.Step(80.0f), 20.0f);
+	EXPECT_FLOAT_EQ(rig.Step(80.0f), 100.0f);
+}
+
+TEST(FanControl, FailsafeBypassesSlewAndWriteInterval)
+{
+	auto channel = LinearChannel();
+	channel.maxStep = 10.0f;
+	channel.minWriteInterval = 60000;
+	channel.failsafe = 90.0f;
+
+	FanRig rig(channel);
+	EXPECT_FLOAT_EQ(rig.Step(30.0f), 20.0f);
+	EXPECT_FLOAT_EQ(rig.Step(qQNaN()), 90.0f);
+}
+
+TEST(FanControl, PidIntegratesWhileUnsaturated)
+{
+	FanRig rig(PidChannel(1.0f, 1.0f));
+
+	// 误差 5: P = 5, I 每秒增加 5
+	EXPECT_FLOAT_EQ(rig.Step(65.0f), 10.0f);
+	EXPECT_FLOAT_EQ(rig.Step(65.0f), 15.0f);
+}
+
+TEST(FanControl, PidAntiWindupStopsIntegratingWhenSaturated)
+{
+	FanRig rig(PidChannel(4.0f, 1.0f));
+
+	// 误差 40 时比例项已超过上限 积分不应累积
+	for (auto i = 0; i < 20; ++i)
+		EXPECT_FLOAT_EQ(rig.Step(100.0f), 100.0f);
+
+	// 回到目标温度后立即降速 (积分饱和时会保持 100%)
+	EXPECT_FLOAT_EQ(rig.Step(60.0f), 0.0f);
+}
+
+TEST(FanControl, OverrideReplacesCurveOutput)
+{
+	FanRig rig{ LinearChannel() };
+	EXPECT_FLOAT_EQ(rig.Step(30.0f), 20.0f);
+
+	EXPECT_TRUE(rig.Controller().SetOverride("fan", 75.0f));
+	EXPECT_FALSE(rig.Controller().SetOverride("other", 50.0f));
+	EXPECT_FLOAT_EQ(rig.Step(30.0f), 75.0f);
+
+	// 安全转速优先于手动覆盖
+	EXPECT_FLOAT_EQ(rig.Step(qQNaN()), 100.0f);
+
+	EXPECT_TRUE(rig.Controller().SetOverride("fan", qQNaN()));
+	EXPECT_FLOAT_EQ(rig.Step(30.0f), 20.0f);
+}
+
+TEST(FanControl, OverrideClearedWhenChannelRemoved)
+{
+	FanRig rig{ LinearChannel() };
+	EXPECT_TRUE(rig.Controller().SetOverride("fan", 75.0f));
+	EXPECT_FLOAT_EQ(rig.Step(30.0f), 75.0f);
+
+	rig.Controller().SetChannels({ LinearChannel() });
+	EXPECT_FLOAT_EQ(rig.Step(30.0f), 75.0f);
+
+	rig.Controller().SetChannels({});
+	rig.Step(30.0f);
+	EXPECT_FALSE(rig.Controller().SetOverride("fan", 75.0f));
+}
@@ -0,0 +1,61 @@
+﻿#include <gtest/gtest.h>
+#include <Common/FrameFormatter.h>
+#include <limits>
+#include <vector>
+
+TEST(FrameFormatter, FormatsFieldsWithPrecision)
+{
+	FrameFormatter formatter;
+	formatter.SetFields(3, 1);
+	formatter.SetPrecision(2, 0);
+
+	const float values[] = { 1.0f, 2.26f, -3.4f };
+	formatter.Format(values, 3);
+	EXPECT_EQ(formatter.Frame(), QByteArray("/*1.0,2.3,-3*/"));
+	EXPECT_EQ(formatter.Frame(), QByteArray(formatter.Data(), formatter.Size()));
+}
+
+TEST(FrameFormatter, MissingValues)
+{
+	FrameFormatter formatter;
+	formatter.SetFields(3, 0);
+	formatter.SetMissingText("?");
+
+	const float values[] = { std::numeric_limits<float>::quiet_NaN(), 5.0f };
+	formatter.Format(values, 2);
+	EXPECT_EQ(formatter.Frame(), QByteArray("/*?,5,?*/"));
+}
+
+TEST(FrameFormatter, CustomSequences)
+{
+	FrameFormatter formatter;
+	formatter.SetSequences("<", ";", ">\n");
+	formatter.SetFields(2, 2);
+
+	const float values[] = { 0.5f, 10.0f };
+	formatter.Format(values, 2);
+	EXPECT_EQ(formatter.Frame(), QByteArray("<0.50;10.00>\n"));
+}
+
+TEST(FrameFormatter, WorstCaseFitsCapacity)
+{
+	FrameFormatter formatter;
+	formatter.SetFields(4, FloatFormat::MaxPrecision);
+	formatter.SetMissingText("?");
+
+	const std::vector<float> values(4, -std::numeric_limits<float>::max());
+	const auto size = formatter.Format(values.data(), static_cast<qint32>(values.size()));
+	EXPECT_LE(size, formatter.Capacity());
+	EXPECT_FALSE(formatter.Frame().contains('?'));
+	EXPECT_TRUE(formatter.Frame().startsWith("/*-340282346638528859811704183484516925440.000000000,"));
+}
+
+TEST(FloatFormat, FixedClampsPrecisionAndReportsOverflow)
+{
+	char buffer[16];
+	auto end = FloatFormat::Fixed(buffer, buffer + sizeof(buffer), 1.5f, 20);
+	ASSERT_NE(end, nullptr);
+	EXPECT_EQ(QByteArray(buffer, static_cast<qint32>(end - buffer)), QByteArray("1.500000000"));
+
+	EXPECT_EQ(FloatFormat::Fixed(buffer, buffer + 3, 12345.0f, 0), nullptr);
+}
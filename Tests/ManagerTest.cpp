@@ -0,0 +1,159 @@
+﻿#include <gtest/gtest.h>
+#include <IO/Manager/Manager.h>
+#include <IO/Reactor/FdDriver.h>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <functional>
+
+#ifdef Q_OS_LINUX
+#include <fcntl.h>
+#include <poll.h>
+#include <pty.h>
+#include <termios.h>
+#include <unistd.h>
+
+namespace
+{
+	/// <summary>
+	/// 处理事件直到条件成立或超时
+	/// </summary>
+	bool WaitFor(const std::function<bool()>& condition, qint32 timeoutMs = 2000)
+	{
+		QElapsedTimer timer;
+		timer.start();
+		while (!condition())
+		{
+			if (timer.elapsed() > timeoutMs)
+				return false;
+			QCoreApplication::processEvents(QEventLoop::AllEvents, 10);
+		}
+
+		return true;
+	}
+
+	/// <summary>
+	/// 伪终端: 主端模拟显示设备, Manager 通过从端路径连接
+	/// </summary>
+	class CodecHandshake : public ::testing::Test
+	{
+	protected:
+		void SetUp() override
+		{
+			termios options;
+			::cfmakeraw(&options);
+			char name[128] = {};
+			ASSERT_EQ(::openpty(&m_master, &m_slave, name, &options, Q_NULLPTR), 0);
+			::fcntl(m_master, F_SETFL, ::fcntl(m_master, F_GETFL) | O_NONBLOCK);
+
+			m_manager = Manager::CreateIsolated();
+			m_manager->setSelectedDriver(Manager::SelectedDriver::Device);
+			m_manager->DeviceDriver()->setDevicePath(QString::fromLocal8Bit(name));
+		}
+
+		void TearDown() override
+		{
+			if (m_manager)
+				m_manager->disconnectDriver();
+			m_manager.reset();
+			if (m_master >= 0)
+				::close(m_master);
+			if (m_slave >= 0)
+				::close(m_slave);
+		}
+
+		/// <summary>
+		/// 从主端读取 直到收到指定长度的数据或超时
+		/// </summary>
+		QByteArray ReadDevice(qint32 length)
+		{
+			QByteArray data;
+			WaitFor([&]() {
+				char buffer[4096];
+				pollfd descriptor{ m_master, POLLIN, 0 };
+				while (::poll(&descriptor, 1, 0) > 0)
+				{
+					const auto bytes = ::read(m_master, buffer, sizeof(buffer));
+					if (bytes <= 0)
+						break;
+					data.append(buffer, static_cast<qint32>(bytes));
+				}
+				return data.length() >= length;
+			});
+			return data;
+		}
+
+		void WriteDevice(const QByteArray& data)
+		{
+			ASSERT_EQ(::write(m_master, data.constData(), data.length()), data.length());
+		}
+
+	protected:
+		int m_master = -1;
+		int m_slave = -1;
+		std::unique_ptr<Manager> m_manager;
+	};
+}
+
+TEST_F(CodecHandshake, DeviceConfirmationEnablesCompression)
+{
+	m_manager->setPreferredCodecs({ Codec::Type::Lzss });
+	m_manager->connectDevice();
+	ASSERT_TRUE(WaitFor([&]() { return m_manager->Connected(); }));
+
+	const QByteArray query("/*#codecs?*/");
+	EXPECT_EQ(ReadDevice(query.length()), query);
+	EXPECT_EQ(m_manager->ActiveCodec(), Codec::Type::None);
+
+	// 响应不作为遥测帧分发
+	auto telemetry = 0;
+	QObject::connect(m_manager.get(), &Manager::frameReceived, [&](const QByteArray&) { telemetry++; });
+
+	WriteDevice("/*#codecs:none,lzss*/");
+	ASSERT_TRUE(WaitFor([&]() { return m_manager->ActiveCodec() == Codec::Type::Lzss; }));
+	EXPECT_EQ(telemetry, 0);
+
+	// 切换宣告以原始帧发送 之后的写入都是信封
+	const QByteArray select("/*#codec=lzss*/");
+	EXPECT_EQ(ReadDevice(select.length()), select);
+
+	const QByteArray frame("/*42,42,42,42,42,42,42,42,42,42,42,42*/");
+	EXPECT_EQ(m_manager->WriteData(frame), frame.length());
+
+	auto envelope = ReadDevice(Codec::EnvelopeHeaderSize);
+	ASSERT_GE(envelope.length(), Codec::EnvelopeHeaderSize);
+	EXPECT_EQ(static_cast<quint8>(envelope.at(0)), Codec::EnvelopeMagic);
+
+	const auto length = Codec::EnvelopeHeaderSize + (static_cast<quint8>(envelope.at(4)) | (static_cast<quint8>(envelope.at(5)) << 8));
+	if (envelope.length() < length)
+		envelope += ReadDevice(length - static_cast<qint32>(envelope.length()));
+
+	QByteArray raw;
+	ASSERT_TRUE(Codec::Unpack(envelope.constData(), static_cast<qint32>(envelope.length()), raw));
+	EXPECT_EQ(raw, frame);
+}
+
+TEST_F(CodecHandshake, SilentDeviceKeepsPlainFrames)
+{
+	m_manager->setPreferredCodecs({ Codec::Type::Lzss });
+	m_manager->connectDevice();
+	ASSERT_TRUE(WaitFor([&]() { return m_manager->Connected(); }));
+
+	const QByteArray query("/*#codecs?*/");
+	EXPECT_EQ(ReadDevice(query.length()), query);
+
+	const QByteArray frame("/*42,42,42,42,42,42,42,42,42,42,42,42*/");
+	EXPECT_EQ(m_manager->WriteData(frame), frame.length());
+	EXPECT_EQ(ReadDevice(frame.length()), frame);
+	EXPECT_EQ(m_manager->ActiveCodec(), Codec::Type::None);
+}
+
+TEST_F(CodecHandshake, NoQueryWithoutPreferredCodec)
+{
+	m_manager->connectDevice();
+	ASSERT_TRUE(WaitFor([&]() { return m_manager->Connected(); }));
+
+	const QByteArray frame("/*1,2,3*/");
+	EXPECT_EQ(m_manager->WriteData(frame), frame.length());
+	EXPECT_EQ(ReadDevice(frame.length()), frame);
+}
+#endif
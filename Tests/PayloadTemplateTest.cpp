@@ -0,0 +1,103 @@
+﻿#include <gtest/gtest.h>
+#include <Sensor/PayloadTemplate.h>
+#include <Sensor/SensorSnapshot.h>
+#include <QtMath>
+#include <limits>
+
+namespace
+{
+	QByteArray Execute(const QString& source, const SensorSnapshot& snapshot)
+	{
+		PayloadTemplate payload;
+		EXPECT_TRUE(payload.Compile(source)) << payload.ErrorString().toStdString();
+		return payload.Execute(snapshot);
+	}
+
+	SensorSnapshot Snapshot(std::initializer_list<std::pair<const char*, float>> values)
+	{
+		SensorSnapshot snapshot;
+		for (const auto& value : values)
+			snapshot.SetValue(snapshot.AddSensor(value.first), value.second);
+		return snapshot;
+	}
+}
+
+TEST(PayloadTemplate, FormatsPlaceholders)
+{
+	const auto snapshot = Snapshot({ { "cpu.load", 42.4f }, { "gpu.temp", 65.27f } });
+	EXPECT_EQ(Execute("/*{cpu.load:.0f},{gpu.temp:.1f}*/", snapshot), QByteArray("/*42,65.3*/"));
+}
+
+TEST(PayloadTemplate, FormatTypes)
+{
+	const auto snapshot = Snapshot({ { "x", 1.5f }, { "y", 7.6f }, { "z", 1250.0f } });
+	EXPECT_EQ(Execute("{x}", snapshot), QByteArray("1.5"));
+	EXPECT_EQ(Execute("{y:d}", snapshot), QByteArray("8"));
+	EXPECT_EQ(Execute("{z:.2e}", snapshot), QByteArray("1.25e+03"));
+	EXPECT_EQ(Execute("{z:g}", snapshot), QByteArray("1250"));
+}
+
+TEST(PayloadTemplate, WidthAndZeroPadding)
+{
+	const auto snapshot = Snapshot({ { "x", -3.5f }, { "y", 7.0f } });
+	EXPECT_EQ(Execute("[{y:4d}]", snapshot), QByteArray("[   7]"));
+	EXPECT_EQ(Execute("[{y:04d}]", snapshot), QByteArray("[0007]"));
+	// 负号保持在填充之前
+	EXPECT_EQ(Execute("[{x:06.1f}]", snapshot), QByteArray("[-003.5]"));
+}
+
+TEST(PayloadTemplate, EscapedBraces)
+{
+	const auto snapshot = Snapshot({ { "x", 3.0f } });
+	EXPECT_EQ(Execute("{{{x:d}}}", snapshot), QByteArray("{3}"));
+}
+
+TEST(PayloadTemplate, MissingAndNonFiniteValues)
+{
+	const auto snapshot = Snapshot({
+		{ "nan", std::numeric_limits<float>::quiet_NaN() },
+		{ "inf", std::numeric_limits<float>::infinity() } });
+
+	EXPECT_EQ(Execute("{absent},{nan:.1f},{inf:d}", snapshot), QByteArray("-,-,-"));
+
+	PayloadTemplate payload;
+	ASSERT_TRUE(payload.Compile("{absent}"));
+	payload.SetMissingText("?");
+	EXPECT_EQ(payload.Execute(snapshot), QByteArray("?"));
+}
+
+TEST(PayloadTemplate, ResolvesSensorsAddedLater)
+{
+	PayloadTemplate payload;
+	ASSERT_TRUE(payload.Compile("{a:d},{b:d}"));
+
+	SensorSnapshot snapshot;
+	snapshot.SetValue(snapshot.AddSensor("a"), 1.0f);
+	EXPECT_EQ(payload.Execute(snapshot), QByteArray("1,-"));
+
+	// 布局版本变化后重新查找槽位
+	snapshot.SetValue(snapshot.AddSensor("b"), 2.0f);
+	EXPECT_EQ(payload.Execute(snapshot), QByteArray("1,2"));
+}
+
+TEST(PayloadTemplate, ListsReferencedSensorsOnce)
+{
+	PayloadTemplate payload;
+	ASSERT_TRUE(payload.Compile("{a},{b},{a:.1f}"));
+	EXPECT_EQ(payload.Sensors(), QStringList({ "a", "b" }));
+}
+
+TEST(PayloadTemplate, InvalidTemplateKeepsPrevious)
+{
+	PayloadTemplate payload;
+	ASSERT_TRUE(payload.Compile("{a:d}"));
+
+	for (const auto& source : { "{a", "a}", "{:d}", "{a:.}", "{a:q}", "{a:.10f}", "{a:99d}" })
+	{
+		EXPECT_FALSE(payload.Compile(source)) << source;
+		EXPECT_FALSE(payload.ErrorString().isEmpty()) << source;
+	}
+
+	EXPECT_TRUE(payload.IsValid());
+	EXPECT_EQ(payload.Source(), QString("{a:d}"));
+}
@@ -0,0 +1,130 @@
+﻿#include <gtest/gtest.h>
+#include <IO/Reactor/RingBuffer.h>
+#include <thread>
+#include <vector>
+
+namespace
+{
+	/// <summary>
+	/// 写入尽可能多的数据 (可能分两段)
+	/// </summary>
+	qint32 WriteAll(RingBuffer& buffer, const char* data, qint32 length)
+	{
+		qint32 written = 0;
+		while (written < length)
+		{
+			qint32 region = 0;
+			const auto target = buffer.WriteRegion(&region);
+			if (region == 0)
+				break;
+
+			const auto bytes = qMin(region, length - written);
+			std::memcpy(target, data + written, bytes);
+			buffer.Commit(bytes);
+			written += bytes;
+		}
+
+		return written;
+	}
+}
+
+TEST(RingBuffer, CapacityRoundsUpToPowerOfTwo)
+{
+	EXPECT_EQ(RingBuffer(1).Capacity(), 64);
+	EXPECT_EQ(RingBuffer(64).Capacity(), 64);
+	EXPECT_EQ(RingBuffer(100).Capacity(), 128);
+}
+
+TEST(RingBuffer, StopsWritingWhenFull)
+{
+	RingBuffer buffer(64);
+	const std::vector<char> data(100, 'x');
+	EXPECT_EQ(WriteAll(buffer, data.data(), 100), 64);
+	EXPECT_EQ(buffer.Size(), 64);
+
+	qint32 region = -1;
+	buffer.WriteRegion(&region);
+	EXPECT_EQ(region, 0);
+}
+
+TEST(RingBuffer, WrapsAround)
+{
+	RingBuffer buffer(64);
+	std::vector<char> data(48);
+	std::vector<char> output(64);
+
+	// 读写位置推进到末尾附近 之后的写入分为两段
+	for (auto i = 0; i < 48; ++i)
+		data[i] = static_cast<char>(i);
+	ASSERT_EQ(WriteAll(buffer, data.data(), 48), 48);
+	ASSERT_EQ(buffer.Read(output.data(), 48), 48);
+
+	qint32 region = 0;
+	buffer.WriteRegion(&region);
+	EXPECT_EQ(region, 16);
+
+	for (auto i = 0; i < 48; ++i)
+		data[i] = static_cast<char>(100 + i);
+	ASSERT_EQ(WriteAll(buffer, data.data(), 48), 48);
+	EXPECT_EQ(buffer.Size(), 48);
+
+	ASSERT_EQ(buffer.Read(output.data(), 64), 48);
+	EXPECT_TRUE(std::equal(data.begin(), data.end(), output.begin()));
+	EXPECT_EQ(buffer.Size(), 0);
+}
+
+TEST(RingBuffer, ClearDiscardsData)
+{
+	RingBuffer buffer(64);
+	const char data[] = "abcdef";
+	WriteAll(buffer, data, 6);
+	buffer.Clear();
+	EXPECT_EQ(buffer.Size(), 0);
+
+	char output[8];
+	EXPECT_EQ(buffer.Read(output, sizeof(output)), 0);
+}
+
+TEST(RingBuffer, ProducerAndConsumerThreads)
+{
+	// 生产者与消费者各在一个线程 数据按顺序完整到达
+	constexpr qint32 Total = 1 << 20;
+	RingBuffer buffer(256);
+
+	std::thread producer([&]() {
+		char chunk[97];
+		qint32 sent = 0;
+		while (sent < Total)
+		{
+			const auto length = qMin<qint32>(sizeof(chunk), Total - sent);
+			for (auto i = 0; i < length; ++i)
+				chunk[i] = static_cast<char>((sent + i) & 0xFF);
+
+			qint32 written = 0;
+			while (written < length)
+			{
+				written += WriteAll(buffer, chunk + written, length - written);
+				if (written < length)
+					std::this_thread::yield();
+			}
+			sent += length;
+		}
+	});
+
+	qint32 received = 0;
+	bool ordered = true;
+	char output[61];
+	while (received < Total)
+	{
+		const auto bytes = buffer.Read(output, sizeof(output));
+		for (auto i = 0; i < bytes; ++i)
+			ordered = ordered && output[i] == static_cast<char>((received + i) & 0xFF);
+		received += bytes;
+		if (bytes == 0)
+			std::this_thread::yield();
+	}
+
+	producer.join();
+	EXPECT_TRUE(ordered);
+	EXPECT_EQ(received, Total);
+}
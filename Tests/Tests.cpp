@@ -0,0 +1,19 @@
+﻿#include <QCoreApplication>
+#include <QStandardPaths>
+#include <gtest/gtest.h>
+
+/**
+ * DigiHMS 单元测试入口
+ *
+ * 测试中的 QSettings 写入测试专用的位置, 不影响应用程序的设置。
+ */
+int main(int argc, char* argv[])
+{
+	QCoreApplication app(argc, argv);
+	QCoreApplication::setOrganizationName("DigiHMS");
+	QCoreApplication::setApplicationName("DigiHMS Tests");
+	QStandardPaths::setTestModeEnabled(true);
+
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}